@@ -24,10 +24,11 @@ void save_log_to_file	( Command& cmd );
 void print_all_registered_commands	( Command& cmd );
 void HookDevConsoleToLogSystem( Command &cmd );
 void UnhookDevConsoleToLogSystem( Command &cmd );
+void ConvertBinaryLog( Command &cmd );
 
 void LogHookWritesToConsole( LogData const *logData, void * )
 {
-	std::string logStr = Stringf( "%s: %s", logData->tag.c_str(), logData->text.c_str() );
+	std::string logStr = Stringf( "%s: %s", logData->tag, logData->text );
 	DevConsole::GetInstance()->WriteToOutputBuffer( logStr, RGBA_GRAY_COLOR );
 }
 
@@ -46,6 +47,7 @@ DevConsole::DevConsole( Renderer* currentRenderer )
 	CommandRegister( "scroll_bottom", DevConsole::ResetTheScroll );
 	CommandRegister( "log_hook_devconsole", HookDevConsoleToLogSystem );
 	CommandRegister( "log_unhook_devconsole", UnhookDevConsoleToLogSystem );
+	CommandRegister( "log_convert", ConvertBinaryLog );
 }
 
 DevConsole::~DevConsole()
@@ -568,4 +570,25 @@ void UnhookDevConsoleToLogSystem( Command &cmd )
 {
 	UNUSED( cmd );
 	LogSystem::GetInstance()->LogUnhook( LogHookWritesToConsole, nullptr );
+}
+
+void ConvertBinaryLog( Command &cmd )
+{
+	std::string binaryLogPath	= cmd.GetNextString();
+	std::string outputPath		= cmd.GetNextString();
+	std::string formatStr		= cmd.GetNextString();
+
+	if( binaryLogPath == "" || outputPath == "" )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "Usage: log_convert <binaryLogPath> <outputPath> [html|text]" );
+		return;
+	}
+
+	eLogFileFormat	outputFormat	= ( formatStr == "text" ) ? LOG_FILE_FORMAT_TEXT : LOG_FILE_FORMAT_HTML;
+	bool			success			= BinaryLogReader::ConvertToFile( binaryLogPath.c_str(), outputPath.c_str(), outputFormat );
+
+	if( success )
+		ConsolePrintf( RGBA_GREEN_COLOR, "Converted \"%s\" to \"%s\"", binaryLogPath.c_str(), outputPath.c_str() );
+	else
+		ConsolePrintf( RGBA_RED_COLOR, "Couldn't convert \"%s\"!", binaryLogPath.c_str() );
 }
\ No newline at end of file
@@ -16,7 +16,9 @@ void EngineStartup()
 	g_engineClock = new Clock();
 
 	// LogSystem Startup
-	if( g_logSystemEnabled )	
+	if( g_logSystemEnabled && g_logSystemWritesBinary )
+		LogSystem::GetInstance()->LoggerStartup( DEFAULT_BINARY_LOG_FILE_PATH, LOG_FILE_FORMAT_BINARY );
+	else if( g_logSystemEnabled )
 		LogSystem::GetInstance()->LoggerStartup();
 
 	// Renderer Startup
@@ -62,6 +64,11 @@ void TickMasterClock()
 	g_engineClock->BeginFrame();
 }
 
+void AdvanceMasterClock( double seconds )
+{
+	g_engineClock->AdvanceClock( Clock::GetHPCFromSeconds( seconds ) );
+}
+
 void FireEvent( std::string const &eventName )
 {
 	NamedProperties dummyProperties;
@@ -16,6 +16,7 @@ typedef unsigned char	byte_t;
 const	float		g_aspectRatio = 1.77f;
 const	bool		g_networkSessionEnabled	= false;
 const	bool		g_logSystemEnabled		= false;
+const	bool		g_logSystemWritesBinary	= false;		// Compact binary log; convert it with "log_convert"
 
 #define GAME_PORT 10084
 #define ETHERNET_MTU 1500  // maximum transmission unit - determined by hardware part of OSI model.
@@ -47,9 +48,16 @@ const	bool		g_logSystemEnabled		= false;
 #define MAX_NETWORK_MESSAGE_CHANNELS					(8)
 #define MAX_NETWORK_TIME_DILATION						(0.1f)		// This controls how much the clock is allowed to speed up/slow down to match a snapshot
 #define NETWORK_CONNECTION_TIMEOUT_SECONDS				(10)
+#define MAX_SNAPSHOT_HISTORY							(32)		// Sent/received snapshots kept as delta baselines
+#define MAX_UNRELIABLE_DEFER_SECONDS					(0.25)		// Unreliables left out of packets for longer than this get dropped
+#define NETWORK_FRAGMENT_BYTE_COUNT						(1280)		// Of a blob, per fragment message
+#define MAX_FRAGMENTS_IN_FLIGHT							(32)		// Per connection; half the reliable window, the rest is for everything else
+#define MAX_FRAGMENT_PACKETS_PER_FLUSH					(4)			// On top of the regular packet, if the packet budget allows
+#define MAX_NETWORK_BLOB_BYTE_COUNT						(64U * 1024U * 1024U)
 
 #define INVALID_INDEX_IN_SESSION						MAX_SESSION_CONNECTIONS
 #define INVALID_PACKET_ACK								(0xffff)
+#define INVALID_SNAPSHOT_ID								(0xffff)
 #define NETWORK_PACKET_HEADER_SIZE						(8)
 #define NETWORK_UNRELIABLE_MESSAGE_HEADER_SIZE			(1)
 #define NETWORK_RELIABLE_MESSAGE_HEADER_SIZE			(3)
@@ -83,6 +91,7 @@ void EngineShutdown();
 
 Clock const*	GetMasterClock();
 void			TickMasterClock();		// Advances the master clock by a frame
+void			AdvanceMasterClock( double seconds );	// A frame of exactly that long, regardless of the wall clock; for deterministic simulations
 
 extern EventSystem *g_eventSystem;
 
@@ -0,0 +1,64 @@
+#pragma once
+#include "MemoryMappedFile.hpp"
+#include "Engine/Internal/WindowsCommon.hpp"
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	Close();
+}
+
+bool MemoryMappedFile::Open( std::string const &filePath )
+{
+	Close();
+
+	HANDLE file = CreateFileA( filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+	if( file == INVALID_HANDLE_VALUE )
+		return false;
+
+	// Zero sized files can't have a mapping
+	LARGE_INTEGER fileSize;
+	if( GetFileSizeEx( file, &fileSize ) == FALSE || fileSize.QuadPart <= 0 )
+	{
+		CloseHandle( file );
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+	if( mapping == NULL )
+	{
+		CloseHandle( file );
+		return false;
+	}
+
+	void *view = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+	if( view == nullptr )
+	{
+		CloseHandle( mapping );
+		CloseHandle( file );
+		return false;
+	}
+
+	m_fileHandle	= file;
+	m_mappingHandle	= mapping;
+	m_data			= (byte_t const *) view;
+	m_size			= (size_t) fileSize.QuadPart;
+
+	return true;
+}
+
+void MemoryMappedFile::Close()
+{
+	if( m_data != nullptr )
+		UnmapViewOfFile( m_data );
+
+	if( m_mappingHandle != nullptr )
+		CloseHandle( (HANDLE) m_mappingHandle );
+
+	if( m_fileHandle != nullptr )
+		CloseHandle( (HANDLE) m_fileHandle );
+
+	m_fileHandle	= nullptr;
+	m_mappingHandle	= nullptr;
+	m_data			= nullptr;
+	m_size			= 0;
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+#include <string>
+#include "Engine/Core/EngineCommon.hpp"
+
+//------------------------------------------------------------------------------------------
+// Read only view of a whole file; the OS pages it in on first touch, nothing is copied
+//	- The view stays valid until Close(), or the destructor
+//	- Empty files can't be mapped, Open() fails on them
+//
+class MemoryMappedFile
+{
+public:
+	 MemoryMappedFile() { }
+	~MemoryMappedFile();
+
+private:
+	void			*m_fileHandle		= nullptr;		// Win32 HANDLEs; void* keeps Windows.h out of this header
+	void			*m_mappingHandle	= nullptr;
+	byte_t const	*m_data				= nullptr;
+	size_t			 m_size				= 0;
+
+public:
+	bool			Open( std::string const &filePath );
+	void			Close();
+
+	bool inline		IsOpen()  const { return m_data != nullptr; }
+	byte_t const*	GetData() const { return m_data; }
+	size_t			GetSize() const { return m_size; }
+};
\ No newline at end of file
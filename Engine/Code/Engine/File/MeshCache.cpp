@@ -0,0 +1,229 @@
+#pragma once
+#include "MeshCache.hpp"
+#include <stdio.h>
+#include <string.h>
+
+static inline uint64_t AlignNMeshOffset( uint64_t offset )
+{
+	return (offset + (NMESH_DATA_ALIGNMENT - 1)) & ~( (uint64_t)NMESH_DATA_ALIGNMENT - 1 );
+}
+
+static bool WriteNMeshPadding( FILE *file, uint64_t &currentOffset, uint64_t targetOffset )
+{
+	static byte_t const zeros[ NMESH_DATA_ALIGNMENT ] = { 0 };
+
+	size_t paddingSize = (size_t)(targetOffset - currentOffset);
+	if( paddingSize > 0 && fwrite( zeros, 1, paddingSize, file ) != paddingSize )
+		return false;
+
+	currentOffset = targetOffset;
+	return true;
+}
+
+MeshCache::~MeshCache()
+{
+	Close();
+}
+
+bool MeshCache::Open( std::string const &cachePath, uint64_t sourceHash, VertexLayout const &layout )
+{
+	Close();
+
+	if( m_file.Open( cachePath ) == false )
+		return false;
+
+	byte_t const	*data		= m_file.GetData();
+	uint64_t		 fileSize	= (uint64_t) m_file.GetSize();
+
+	// Header
+	NMeshFileHeader header;
+	bool headerIsValid = fileSize >= sizeof(header);
+	if( headerIsValid )
+	{
+		memcpy( &header, data, sizeof(header) );
+
+		headerIsValid = (header.magic			== NMESH_FILE_MAGIC)
+					 && (header.version			== NMESH_FILE_VERSION)
+					 && (header.sourceHash		== sourceHash)
+					 && (header.layoutID		== layout.GetLayoutID())
+					 && (header.vertexStride	== layout.m_stride)
+					 && (sizeof(header) + (uint64_t)header.subMeshCount * sizeof(NMeshSubMeshEntry) <= fileSize);
+	}
+
+	if( headerIsValid == false )
+	{
+		Close();
+		return false;
+	}
+
+	// Sub meshes; offsets & sizes are checked against the file, so a truncated cache counts as stale
+	NMeshSubMeshEntry const *entries = (NMeshSubMeshEntry const *)( data + sizeof(header) );
+	for( uint i = 0; i < header.subMeshCount; i++ )
+	{
+		NMeshSubMeshEntry const &entry = entries[i];
+
+		uint64_t vertexBlockSize	= (uint64_t)entry.vertexCount * header.vertexStride;
+		uint64_t indexBlockSize		= (uint64_t)entry.indexCount  * sizeof(uint);
+
+		bool entryIsValid = (entry.primitiveType < NUM_PRIMITIVE_TYPES)
+						 && (entry.vertexOffset	% NMESH_DATA_ALIGNMENT == 0)
+						 && (entry.indexOffset	% NMESH_DATA_ALIGNMENT == 0)
+						 && (entry.vertexOffset	<= fileSize) && (vertexBlockSize <= fileSize - entry.vertexOffset)
+						 && (entry.indexOffset	<= fileSize) && (indexBlockSize  <= fileSize - entry.indexOffset)
+						 && (memchr( entry.materialName, '\0', NMESH_MAX_MATERIAL_NAME_LENGTH ) != nullptr);
+
+		// The draw has to stay inside of its buffers, or the GPU reads past them
+		uint64_t drawEnd		= (uint64_t)entry.startIndex + entry.elementCount;
+		uint64_t drawLimit		= (entry.isUsingIndices != 0) ? entry.indexCount : entry.vertexCount;
+		entryIsValid			= entryIsValid && (drawEnd <= drawLimit);
+
+		uint const *indices		= (uint const *)( data + entry.indexOffset );
+		for( uint idx = 0; entryIsValid && idx < entry.indexCount; idx++ )
+			entryIsValid = indices[ idx ] < entry.vertexCount;
+
+		if( entryIsValid == false )
+		{
+			Close();
+			return false;
+		}
+
+		MeshCacheSubMesh subMesh;
+		subMesh.materialName	= entry.materialName;
+		subMesh.drawInstruction	= DrawInstruction( (ePrimitiveType)entry.primitiveType, entry.startIndex, entry.elementCount, entry.isUsingIndices != 0 );
+		subMesh.vertices		= data + entry.vertexOffset;
+		subMesh.vertexCount		= entry.vertexCount;
+		subMesh.indices			= (uint const *)( data + entry.indexOffset );
+		subMesh.indexCount		= entry.indexCount;
+
+		m_subMeshes.push_back( subMesh );
+	}
+
+	return true;
+}
+
+void MeshCache::Close()
+{
+	m_subMeshes.clear();
+	m_file.Close();
+}
+
+bool MeshCache::Write( std::string const &cachePath, uint64_t sourceHash, VertexLayout const &layout, std::vector< MeshCacheSubMesh > const &subMeshes )
+{
+	NMeshFileHeader header;
+	header.magic		= NMESH_FILE_MAGIC;
+	header.version		= NMESH_FILE_VERSION;
+	header.sourceHash	= sourceHash;
+	header.layoutID		= layout.GetLayoutID();
+	header.vertexStride	= layout.m_stride;
+	header.subMeshCount	= (uint32_t) subMeshes.size();
+	header.reserved		= 0;
+
+	// Lay the data blocks out, before writing anything
+	std::vector< NMeshSubMeshEntry > entries( subMeshes.size() );
+	uint64_t offset = sizeof(header) + entries.size() * sizeof(NMeshSubMeshEntry);
+
+	for( size_t i = 0; i < subMeshes.size(); i++ )
+	{
+		MeshCacheSubMesh const	&subMesh	= subMeshes[i];
+		NMeshSubMeshEntry		&entry		= entries[i];
+
+		// Names which don't fit would come back truncated, don't cache those
+		size_t nameLength = strlen( subMesh.materialName );
+		if( nameLength >= NMESH_MAX_MATERIAL_NAME_LENGTH )
+			return false;
+
+		memset( &entry, 0, sizeof(entry) );
+		memcpy( entry.materialName, subMesh.materialName, nameLength );
+
+		entry.primitiveType		= (uint32_t) subMesh.drawInstruction.primitiveType;
+		entry.startIndex		= subMesh.drawInstruction.startIndex;
+		entry.elementCount		= subMesh.drawInstruction.elementCount;
+		entry.isUsingIndices	= subMesh.drawInstruction.isUsingIndices ? 1U : 0U;
+		entry.vertexCount		= subMesh.vertexCount;
+		entry.indexCount		= subMesh.indexCount;
+
+		entry.vertexOffset		= AlignNMeshOffset( offset );
+		offset					= entry.vertexOffset + (uint64_t)subMesh.vertexCount * layout.m_stride;
+		entry.indexOffset		= AlignNMeshOffset( offset );
+		offset					= entry.indexOffset + (uint64_t)subMesh.indexCount * sizeof(uint);
+	}
+
+	FILE *file = nullptr;
+	fopen_s( &file, cachePath.c_str(), "wb" );
+	if( file == nullptr )
+		return false;
+
+	uint64_t	currentOffset	= 0;
+	bool		succeeded		= fwrite( &header, sizeof(header), 1, file ) == 1;
+	currentOffset += sizeof(header);
+
+	if( succeeded && entries.empty() == false )
+	{
+		succeeded		= fwrite( entries.data(), sizeof(NMeshSubMeshEntry), entries.size(), file ) == entries.size();
+		currentOffset  += entries.size() * sizeof(NMeshSubMeshEntry);
+	}
+
+	for( size_t i = 0; succeeded && i < subMeshes.size(); i++ )
+	{
+		MeshCacheSubMesh const	&subMesh	= subMeshes[i];
+		NMeshSubMeshEntry const	&entry		= entries[i];
+
+		succeeded = WriteNMeshPadding( file, currentOffset, entry.vertexOffset )
+				 && fwrite( subMesh.vertices, layout.m_stride, subMesh.vertexCount, file ) == subMesh.vertexCount;
+		currentOffset += (uint64_t)subMesh.vertexCount * layout.m_stride;
+
+		succeeded = succeeded
+				 && WriteNMeshPadding( file, currentOffset, entry.indexOffset )
+				 && fwrite( subMesh.indices, sizeof(uint), subMesh.indexCount, file ) == subMesh.indexCount;
+		currentOffset += (uint64_t)subMesh.indexCount * sizeof(uint);
+	}
+
+	fclose( file );
+
+	// Don't leave a half written cache behind
+	if( succeeded == false )
+		remove( cachePath.c_str() );
+
+	return succeeded;
+}
+
+uint64_t MeshCache::HashContent( void const *data, size_t size )
+{
+	// Eight bytes at a time with multiply-rotate mixing; it is a cache key, not a cryptographic hash
+	uint64_t const	prime1	= 0x9E3779B185EBCA87ULL;
+	uint64_t const	prime2	= 0xC2B2AE3D27D4EB4FULL;
+	byte_t const	*bytes	= (byte_t const *) data;
+	uint64_t		 hash	= 0xCBF29CE484222325ULL ^ ( (uint64_t)size * prime1 );
+
+	size_t wordCount = size / sizeof(uint64_t);
+	for( size_t i = 0; i < wordCount; i++ )
+	{
+		uint64_t word;
+		memcpy( &word, bytes + i * sizeof(uint64_t), sizeof(word) );
+
+		hash ^= word * prime1;
+		hash  = ( (hash << 31) | (hash >> 33) ) * prime2;
+	}
+
+	for( size_t i = wordCount * sizeof(uint64_t); i < size; i++ )
+		hash = (hash ^ bytes[i]) * prime1;
+
+	// Final avalanche
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDULL;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+std::string MeshCache::GetCachePathFor( std::string const &sourcePath )
+{
+	size_t extensionStart	= sourcePath.find_last_of( '.' );
+	size_t directoryEnd		= sourcePath.find_last_of( "/\\" );
+
+	// A dot in a directory name isn't an extension
+	if( extensionStart == std::string::npos || (directoryEnd != std::string::npos && extensionStart < directoryEnd) )
+		return sourcePath + NMESH_FILE_EXTENSION;
+
+	return sourcePath.substr( 0, extensionStart ) + NMESH_FILE_EXTENSION;
+}
\ No newline at end of file
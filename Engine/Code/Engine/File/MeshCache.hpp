@@ -0,0 +1,94 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/File/MemoryMappedFile.hpp"
+#include "Engine/Renderer/Mesh.hpp"
+
+//------------------------------------------------------------------------------------------
+// Binary mesh cache file ( .nmesh )
+//	- Header     :	uint32_t magic, uint32_t version, uint64_t sourceHash, uint32_t layoutID, uint32_t vertexStride, uint32_t subMeshCount, uint32_t reserved
+//	- Sub meshes :	subMeshCount x NMeshSubMeshEntry
+//	- Data       :	per sub mesh, interleaved vertices in the final VERTTYPE then uint32_t indices; every block is 16 byte aligned
+//	- sourceHash is the hash of the file it was built from, a cache which doesn't match it is stale
+//	- Written in the native ( little ) endianness
+//
+#define NMESH_FILE_MAGIC				(0x48534d4eU)		// "NMSH"
+#define NMESH_FILE_VERSION				(1U)
+#define NMESH_FILE_EXTENSION			".nmesh"
+#define NMESH_DATA_ALIGNMENT			(16U)
+#define NMESH_MAX_MATERIAL_NAME_LENGTH	(64U)				// Including the null terminator
+
+struct NMeshFileHeader
+{
+	uint32_t	magic;
+	uint32_t	version;
+	uint64_t	sourceHash;
+	uint32_t	layoutID;
+	uint32_t	vertexStride;
+	uint32_t	subMeshCount;
+	uint32_t	reserved;
+};
+
+struct NMeshSubMeshEntry
+{
+	uint32_t	primitiveType;
+	uint32_t	startIndex;
+	uint32_t	elementCount;
+	uint32_t	isUsingIndices;
+	uint32_t	vertexCount;
+	uint32_t	indexCount;
+	uint64_t	vertexOffset;
+	uint64_t	indexOffset;
+	char		materialName[ NMESH_MAX_MATERIAL_NAME_LENGTH ];
+};
+
+// Points in to the mapped cache when read, in to the caller's arrays when written
+struct MeshCacheSubMesh
+{
+	char const		*materialName	= "";
+	DrawInstruction	 drawInstruction;
+	void const		*vertices		= nullptr;
+	uint			 vertexCount	= 0;
+	uint const		*indices		= nullptr;
+	uint			 indexCount		= 0;
+};
+
+class MeshCache
+{
+public:
+	 MeshCache() { }
+	~MeshCache();
+
+private:
+	MemoryMappedFile					m_file;
+	std::vector< MeshCacheSubMesh >		m_subMeshes;
+
+public:
+	// Maps the cache; fails if it is missing, corrupt, stale or built for a different vertex layout
+	bool	Open( std::string const &cachePath, uint64_t sourceHash, VertexLayout const &layout );
+	void	Close();
+
+	uint						GetSubMeshCount() const { return (uint) m_subMeshes.size(); }
+	MeshCacheSubMesh const&		GetSubMesh( uint idx ) const { return m_subMeshes[ idx ]; }
+
+	// Uploads straight from the mapped file, no conversion; VERTTYPE has to be the layout passed to Open()
+	template <typename VERTTYPE>
+	Mesh* CreateMesh( uint idx ) const
+	{
+		MeshCacheSubMesh const &subMesh = m_subMeshes[ idx ];
+
+		Mesh *mesh = new Mesh();
+		mesh->SetVertices<VERTTYPE>( subMesh.vertexCount, (VERTTYPE const *) subMesh.vertices );
+		mesh->SetIndices( subMesh.indexCount, subMesh.indices );
+		mesh->SetDrawInstruction( subMesh.drawInstruction );
+		mesh->SetBoundsFromVertices<VERTTYPE>( subMesh.vertexCount, (VERTTYPE const *) subMesh.vertices );
+
+		return mesh;
+	}
+
+public:
+	static bool			Write( std::string const &cachePath, uint64_t sourceHash, VertexLayout const &layout, std::vector< MeshCacheSubMesh > const &subMeshes );
+	static uint64_t		HashContent( void const *data, size_t size );
+	static std::string	GetCachePathFor( std::string const &sourcePath );		// "Data/Models/x.obj" => "Data/Models/x.nmesh"
+};
\ No newline at end of file
@@ -1,216 +1,726 @@
 #pragma once
+#include <string.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <thread>
 #include "Engine/Math/MathUtil.hpp"
 #include "Engine/File/File.hpp"
+#include "Engine/File/MeshCache.hpp"
+#include "Engine/File/MemoryMappedFile.hpp"
 #include "Engine/File/ModelLoader.hpp"
+#include "Engine/Core/StringUtils.hpp"
 #include "Engine/Renderer/Mesh.hpp"
 #include "Engine/Renderer/Material.hpp"
 #include "Engine/Renderer/Renderable.hpp"
-#include "Engine/Renderer/MeshBuilder.hpp"
 
-struct VUNpair {
-	Vector3 vertex;
-	Vector2 UV;
-	Vector3 normal;
+#define OBJ_INVALID_INDEX				(-1)
+#define OBJ_VERTEX_TABLE_MIN_CAPACITY	(1024)		// Has to be a power of two
+#define OBJ_MAX_FACE_CORNERS			(64)		// Corners after these are ignored
+#define OBJ_PARSE_MIN_CHUNK_SIZE		(1024U * 1024U)		// Smaller files aren't worth another thread
+
+//------------------------------------------------------------------------------------------
+// Tokenizer helpers - all of them work in place on the file buffer, they never allocate
+//
+static double const s_objPowersOfTen[] =
+{
+	1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+	1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
 };
 
-bool ModelLoader::LoadObjectModelFromPath( std::string path, Renderable &newRenderable )
+static inline bool IsObjDigit( char c )
 {
+	return (c >= '0') && (c <= '9');
+}
 
-	// To store all the data..
-	std::vector< Mesh* >		allMeshes;
-	std::vector< Material* >	allMaterials;
-	MeshBuilder					theMeshBuilder;
-	theMeshBuilder.Begin( PRIMITIVE_TRIANGES, false );
+static inline bool IsObjSpace( char c )
+{
+	return (c == ' ') || (c == '\t') || (c == '\r');
+}
 
-	// See if you can successfully load the file
-	const char *buffer = (const char *) FileReadToNewBuffer( path.c_str() );
-	// Failed to load the file
-	if( buffer == nullptr )
-		return false;
+static inline char const* SkipObjSpaces( char const *cursor, char const *end )
+{
+	while( cursor < end && IsObjSpace(*cursor) )
+		cursor++;
 
-	std::vector< Vector3 >		allVertices;
-	std::vector< Vector3 >		allNormals;
-	std::vector< Vector2 >		allUVs;
+	return cursor;
+}
 
-	std::vector< std::string >	allNewLines = SplitIntoStringsByDelimiter( buffer, '\n' );
-	// Start reading it line-by-line..
-	for each ( std::string thisLine in allNewLines )
+static char const* ParseObjInt( char const *cursor, char const *end, int &out_value )
+{
+	bool negative = false;
+	if( cursor < end && (*cursor == '-' || *cursor == '+') )
 	{
-		std::vector< std::string > elementInThisLine = SplitIntoStringsByDelimiter( thisLine, ' ' );
+		negative = (*cursor == '-');
+		cursor++;
+	}
 
-		if( elementInThisLine.size() <= 0 )
-			continue;
+	int value = 0;
+	while( cursor < end && IsObjDigit(*cursor) )
+	{
+		value = (value * 10) + (*cursor - '0');
+		cursor++;
+	}
 
-		std::string &firstElement = elementInThisLine[0];
-		// Add Vertex: starts with "v"
-		if ( firstElement == "v" )
+	out_value = negative ? -value : value;
+	return cursor;
+}
+
+// Good to float precision; takes up to 19 significant digits, the rest only move the exponent
+static char const* ParseObjFloat( char const *cursor, char const *end, float &out_value )
+{
+	bool negative = false;
+	if( cursor < end && (*cursor == '-' || *cursor == '+') )
+	{
+		negative = (*cursor == '-');
+		cursor++;
+	}
+
+	uint64_t	mantissa		= 0;
+	int			exponent		= 0;
+	int			significant		= 0;
+
+	// Integer part
+	while( cursor < end && IsObjDigit(*cursor) )
+	{
+		if( significant < 19 )
+		{
+			mantissa = (mantissa * 10) + (*cursor - '0');
+			significant += (mantissa != 0) ? 1 : 0;
+		}
+		else
+			exponent++;
+
+		cursor++;
+	}
+
+	// Fraction part
+	if( cursor < end && *cursor == '.' )
+	{
+		cursor++;
+		while( cursor < end && IsObjDigit(*cursor) )
 		{
-			Vector3 newVertex;
-			newVertex.x = -1.f * (float) atof( elementInThisLine[1].c_str() );		// Flip x value, b/c Obj files' positive x-axis is on left (ours is on right)
-			newVertex.y =		 (float) atof( elementInThisLine[2].c_str() );
-			newVertex.z =		 (float) atof( elementInThisLine[3].c_str() );
+			if( significant < 19 )
+			{
+				mantissa = (mantissa * 10) + (*cursor - '0');
+				significant += (mantissa != 0) ? 1 : 0;
+				exponent--;
+			}
 
-			allVertices.push_back ( newVertex );
-			continue;
+			cursor++;
 		}
-		// Add Normal: starts with "vn"
-		if( firstElement == "vn" )
+	}
+
+	// Exponent part
+	if( cursor < end && (*cursor == 'e' || *cursor == 'E') )
+	{
+		int explicitExponent = 0;
+		cursor	  = ParseObjInt( cursor + 1, end, explicitExponent );
+		exponent += explicitExponent;
+	}
+
+	double value = (double)mantissa;
+	if( mantissa != 0 )
+	{
+		while( exponent > 22 )
+		{
+			value	 *= 1e22;
+			exponent -= 22;
+		}
+		while( exponent < -22 )
 		{
-			Vector3 newNormal;
-			newNormal.x = -1.f * (float) atof( elementInThisLine[1].c_str() );		// Flip x value, b/c Obj files' positive x-axis is on left (ours is on right)
-			newNormal.y =		 (float) atof( elementInThisLine[2].c_str() );
-			newNormal.z =		 (float) atof( elementInThisLine[3].c_str() );
+			value	 /= 1e22;
+			exponent += 22;
+		}
+
+		if( exponent >= 0 )
+			value *= s_objPowersOfTen[  exponent ];
+		else
+			value /= s_objPowersOfTen[ -exponent ];
+	}
+
+	out_value = (float)( negative ? -value : value );
+	return cursor;
+}
+
+// OBJ indices are one based, negative ones are relative to the end of the list
+static inline int ResolveObjIndex( int objIndex, size_t listSize )
+{
+	int resolved = OBJ_INVALID_INDEX;
+	if( objIndex > 0 )
+		resolved = objIndex - 1;
+	else if( objIndex < 0 )
+		resolved = (int)listSize + objIndex;
+
+	if( resolved < 0 || resolved >= (int)listSize )
+		return OBJ_INVALID_INDEX;
+
+	return resolved;
+}
+
+//------------------------------------------------------------------------------------------
+// Open addressing hash table from a v/vt/vn triple to its index in the vertex buffer
+//	- Keys and values live in one flat array, so lookups don't chase pointers & inserts don't allocate
+//
+struct ObjVertexKey
+{
+	int position;
+	int uv;
+	int normal;
+};
+
+class ObjVertexTable
+{
+private:
+	struct Slot
+	{
+		ObjVertexKey	key;
+		uint			vertexIndex;		// UINT_MAX when the slot is empty
+	};
+
+	std::vector< Slot >	m_slots;
+	uint				m_count		= 0;
+
+public:
+	void Reset( uint expectedCount )
+	{
+		uint capacity = OBJ_VERTEX_TABLE_MIN_CAPACITY;
+		while( capacity < expectedCount * 2 )
+			capacity *= 2;
+
+		Slot emptySlot;
+		emptySlot.vertexIndex = UINT_MAX;
+
+		m_slots.assign( capacity, emptySlot );
+		m_count = 0;
+	}
 
-			allNormals.push_back ( newNormal );
-			continue;
+	// Returns true if the key was new; out_vertexIndex is the existing index or newVertexIndex
+	bool FindOrInsert( ObjVertexKey const &key, uint newVertexIndex, uint &out_vertexIndex )
+	{
+		// Stay under half full
+		if( (m_count + 1) * 2 > (uint)m_slots.size() )
+			Grow();
+
+		Slot &slot = FindSlot( key );
+		if( slot.vertexIndex != UINT_MAX )
+		{
+			out_vertexIndex = slot.vertexIndex;
+			return false;
 		}
-		// Add UVs	 : starts with "vt"
-		if( firstElement == "vt" )
+
+		slot.key			= key;
+		slot.vertexIndex	= newVertexIndex;
+		out_vertexIndex		= newVertexIndex;
+		m_count++;
+
+		return true;
+	}
+
+private:
+	static inline uint Hash( ObjVertexKey const &key )
+	{
+		uint hash = ( (uint)key.position * 0x9E3779B1u ) ^ ( (uint)key.uv * 0x85EBCA77u ) ^ ( (uint)key.normal * 0xC2B2AE3Du );
+		return hash ^ (hash >> 15);
+	}
+
+	Slot& FindSlot( ObjVertexKey const &key )
+	{
+		uint mask = (uint)m_slots.size() - 1;
+		for( uint i = Hash( key ) & mask; ; i = (i + 1) & mask )
 		{
-			Vector2 newUV;
-			newUV.x = (float) atof( elementInThisLine[1].c_str() );
-			newUV.y = (float) atof( elementInThisLine[2].c_str() );
+			Slot &slot = m_slots[i];
+			if( slot.vertexIndex == UINT_MAX )
+				return slot;
 
-			allUVs.push_back ( newUV );
-			continue;
+			if( slot.key.position == key.position && slot.key.uv == key.uv && slot.key.normal == key.normal )
+				return slot;
 		}
-		// Look for usemtl
-		if( firstElement == "usemtl" )
+	}
+
+	void Grow()
+	{
+		std::vector< Slot > oldSlots;
+		oldSlots.swap( m_slots );
+
+		Slot emptySlot;
+		emptySlot.vertexIndex = UINT_MAX;
+		m_slots.assign( oldSlots.size() * 2, emptySlot );
+
+		for( size_t i = 0; i < oldSlots.size(); i++ )
 		{
-			// Flush out all data from MeshBuilder to allMeshes
-			theMeshBuilder.End();
-			if( theMeshBuilder.m_vertices.size() != 0 )
-				allMeshes.push_back( theMeshBuilder.ConstructMesh<Vertex_Lit>() );
+			if( oldSlots[i].vertexIndex != UINT_MAX )
+				FindSlot( oldSlots[i].key ) = oldSlots[i];
+		}
+	}
+};
+
+//------------------------------------------------------------------------------------------
+// Line classification & parsing, shared by every chunk
+//
+enum eObjLineType
+{
+	OBJ_LINE_POSITION = 0,		// "v"
+	OBJ_LINE_UV,				// "vt"
+	OBJ_LINE_NORMAL,			// "vn"
+	OBJ_LINE_FACE,				// "f"
+	OBJ_LINE_USEMTL,			// "usemtl"
+	OBJ_LINE_OTHER
+};
 
-			// Reset the MeshBuilder
-			theMeshBuilder = MeshBuilder();
-			theMeshBuilder.Begin( PRIMITIVE_TRIANGES, false );
+// line starts at its first non-space character
+static eObjLineType GetObjLineType( char const *line, char const *lineEnd )
+{
+	size_t length = lineEnd - line;
 
-			// Construct and push new material
-			std::string materialName	= elementInThisLine[1];
-			std::string materialPath	= "Data//Materials//" + materialName + ".material";
-			Material* newMaterial		= Material::CreateNewFromFile( materialPath );
-			allMaterials.push_back( newMaterial );
+	if( length >= 2 && line[0] == 'v' )
+	{
+		if( IsObjSpace( line[1] ) )
+			return OBJ_LINE_POSITION;
+		if( length >= 3 && line[1] == 't' && IsObjSpace( line[2] ) )
+			return OBJ_LINE_UV;
+		if( length >= 3 && line[1] == 'n' && IsObjSpace( line[2] ) )
+			return OBJ_LINE_NORMAL;
+	}
+	else if( length >= 2 && line[0] == 'f' && IsObjSpace( line[1] ) )
+		return OBJ_LINE_FACE;
+	else if( length > 6 && strncmp( line, "usemtl", 6 ) == 0 && IsObjSpace( line[6] ) )
+		return OBJ_LINE_USEMTL;
+
+	return OBJ_LINE_OTHER;
+}
+
+// Calls lineFunction( line, lineEnd ) for every line in [start, end), with its leading spaces skipped
+template <typename LINE_FUNCTION>
+static void ForEachObjLine( char const *start, char const *end, LINE_FUNCTION lineFunction )
+{
+	char const *cursor = start;
+	while( cursor < end )
+	{
+		cursor = SkipObjSpaces( cursor, end );
+
+		char const *lineEnd = (char const *) memchr( cursor, '\n', end - cursor );
+		if( lineEnd == nullptr )
+			lineEnd = end;
+
+		if( cursor < lineEnd )
+			lineFunction( cursor, lineEnd );
+
+		cursor = lineEnd + 1;
+	}
+}
+
+//------------------------------------------------------------------------------------------
+// Parallel parsing
+//	- Pass 1: every chunk counts its v/vt/vn lines; a prefix sum gives each chunk its place in the whole file's lists
+//	- Pass 2: every chunk parses its lines straight in to those places, and resolves its faces' indices
+//	- Merge : faces get deduplicated in file order, so the result doesn't depend on the number of chunks
+//
+struct ObjMaterialSwitch
+{
+	uint		faceIndex;			// In the chunk; first face which uses the material
+	std::string	materialName;
+};
+
+struct ObjChunk
+{
+	char const	*start			= nullptr;
+	char const	*end			= nullptr;		// Chunks start & end at line boundaries
+
+	// Pass 1
+	uint		 positionCount	= 0;
+	uint		 uvCount		= 0;
+	uint		 normalCount	= 0;
+	uint		 positionBase	= 0;			// Lines in all the chunks before this one
+	uint		 uvBase			= 0;
+	uint		 normalBase		= 0;
+
+	// Pass 2
+	std::vector< ObjVertexKey >			corners;			// Every face's corners, back to back
+	std::vector< byte_t >				cornerCounts;		// Per face
+	std::vector< ObjMaterialSwitch >	materialSwitches;
+	uint								skippedFaces	= 0;
+};
+
+// Runs jobFunction( chunk ) for every chunk, on a thread each; the calling thread takes the first one
+template <typename JOB_FUNCTION>
+static void RunObjChunkJobs( std::vector< ObjChunk > &chunks, JOB_FUNCTION jobFunction )
+{
+	std::vector< std::thread > workers;
+	for( size_t i = 1; i < chunks.size(); i++ )
+		workers.push_back( std::thread( [ &jobFunction, &chunks, i ]() { jobFunction( chunks[i] ); } ) );
+
+	jobFunction( chunks[0] );
+
+	for( size_t i = 0; i < workers.size(); i++ )
+		workers[i].join();
+}
+
+static void CountObjChunkLines( ObjChunk &chunk )
+{
+	ForEachObjLine( chunk.start, chunk.end, [ &chunk ]( char const *line, char const *lineEnd )
+	{
+		switch( GetObjLineType( line, lineEnd ) )
+		{
+		case OBJ_LINE_POSITION:
+			chunk.positionCount++;
+			break;
+		case OBJ_LINE_UV:
+			chunk.uvCount++;
+			break;
+		case OBJ_LINE_NORMAL:
+			chunk.normalCount++;
+			break;
+		default:
+			break;
+		}
+	} );
+}
+
+static void ParseObjChunk( ObjChunk &chunk, Vector3 *allVertices, Vector2 *allUVs, Vector3 *allNormals )
+{
+	// Counts so far, in the whole file; negative indices are relative to these
+	uint vertexCount	= chunk.positionBase;
+	uint uvCount		= chunk.uvBase;
+	uint normalCount	= chunk.normalBase;
+
+	ForEachObjLine( chunk.start, chunk.end, [ & ]( char const *line, char const *lineEnd )
+	{
+		char const *args = nullptr;
+
+		switch( GetObjLineType( line, lineEnd ) )
+		{
+		// Add Vertex: starts with "v"
+		case OBJ_LINE_POSITION:
+		{
+			Vector3 &newVertex = allVertices[ vertexCount++ ];
+			args = ParseObjFloat( SkipObjSpaces( line + 1, lineEnd ), lineEnd, newVertex.x );
+			args = ParseObjFloat( SkipObjSpaces( args, lineEnd ), lineEnd, newVertex.y );
+			args = ParseObjFloat( SkipObjSpaces( args, lineEnd ), lineEnd, newVertex.z );
+			newVertex.x *= -1.f;		// Flip x value, b/c Obj files' positive x-axis is on left (ours is on right)
+			break;
+		}
+		// Add Normal: starts with "vn"
+		case OBJ_LINE_NORMAL:
+		{
+			Vector3 &newNormal = allNormals[ normalCount++ ];
+			args = ParseObjFloat( SkipObjSpaces( line + 2, lineEnd ), lineEnd, newNormal.x );
+			args = ParseObjFloat( SkipObjSpaces( args, lineEnd ), lineEnd, newNormal.y );
+			args = ParseObjFloat( SkipObjSpaces( args, lineEnd ), lineEnd, newNormal.z );
+			newNormal.x *= -1.f;		// Flip x value, b/c Obj files' positive x-axis is on left (ours is on right)
+			break;
+		}
+		// Add UVs	 : starts with "vt"
+		case OBJ_LINE_UV:
+		{
+			Vector2 &newUV = allUVs[ uvCount++ ];
+			args = ParseObjFloat( SkipObjSpaces( line + 2, lineEnd ), lineEnd, newUV.x );
+			args = ParseObjFloat( SkipObjSpaces( args, lineEnd ), lineEnd, newUV.y );
+			break;
+		}
+		// Look for usemtl
+		case OBJ_LINE_USEMTL:
+		{
+			char const *nameStart	= SkipObjSpaces( line + 6, lineEnd );
+			char const *nameEnd		= lineEnd;
+			while( nameEnd > nameStart && IsObjSpace( nameEnd[-1] ) )
+				nameEnd--;
+
+			ObjMaterialSwitch materialSwitch;
+			materialSwitch.faceIndex	= (uint) chunk.cornerCounts.size();
+			materialSwitch.materialName.assign( nameStart, nameEnd );
+			chunk.materialSwitches.push_back( materialSwitch );
+			break;
 		}
 		// Add Faces : starts with "f"
-		if( firstElement == "f" )
+		case OBJ_LINE_FACE:
 		{
-			bool normalsAreProvided = true;
-			std::vector< VUNpair > newFace;
+			ObjVertexKey	faceKeys[ OBJ_MAX_FACE_CORNERS ];
+			uint			cornerCount	= 0;
+			bool			faceIsValid	= true;
 
-			for (unsigned int i = 1; i < elementInThisLine.size(); i++)
+			for( args = SkipObjSpaces( line + 1, lineEnd ); args < lineEnd && cornerCount < OBJ_MAX_FACE_CORNERS; args = SkipObjSpaces( args, lineEnd ) )
 			{
-				std::string pairString = elementInThisLine[i];
-				std::vector< std::string > vunStrings = SplitIntoStringsByDelimiter( pairString, '/' );
-
-				// Check if normals are in face data or not
-				if( vunStrings.size() == 3 )
-					normalsAreProvided = true;
-				else
-					normalsAreProvided = false;
-
-				VUNpair thisPair;
-				thisPair.vertex = allVertices	[ atoi( vunStrings[0].c_str() ) - 1 ];
-				thisPair.UV		= allUVs		[ atoi( vunStrings[1].c_str() ) - 1 ];
-				// Add normal, if provided
-				if( normalsAreProvided )
-					thisPair.normal = allNormals	[ atoi( vunStrings[2].c_str() ) - 1 ];
-
-				newFace.push_back( thisPair );
+				int	positionIdx	= 0;
+				int	uvIdx		= 0;
+				int	normalIdx	= 0;
+
+				// v, v/vt, v//vn or v/vt/vn
+				args = ParseObjInt( args, lineEnd, positionIdx );
+				if( args < lineEnd && *args == '/' )
+				{
+					args = ParseObjInt( args + 1, lineEnd, uvIdx );
+					if( args < lineEnd && *args == '/' )
+						args = ParseObjInt( args + 1, lineEnd, normalIdx );
+				}
+
+				// Skip whatever is left of a malformed token
+				while( args < lineEnd && IsObjSpace( *args ) == false )
+					args++;
+
+				ObjVertexKey &key	= faceKeys[ cornerCount++ ];
+				key.position		= ResolveObjIndex( positionIdx, vertexCount );
+				key.uv				= ResolveObjIndex( uvIdx,		uvCount );
+				key.normal			= ResolveObjIndex( normalIdx,	normalCount );
+
+				faceIsValid			= faceIsValid && (key.position != OBJ_INVALID_INDEX);
 			}
 
-			// If normals were not provided, construct em using cross-product
-			if( normalsAreProvided == false )
+			if( faceIsValid == false || cornerCount < 3 )
 			{
-				Vector3 faceSide1 = newFace[2].vertex - newFace[1].vertex;
-				Vector3 faceSide2 = newFace[1].vertex - newFace[0].vertex;
+				chunk.skippedFaces++;
+				break;
+			}
 
-				Vector3 normalVec = Vector3::CrossProduct( faceSide1, faceSide2 );
-				normalVec		  = normalVec.GetNormalized();
+			chunk.corners.insert( chunk.corners.end(), faceKeys, faceKeys + cornerCount );
+			chunk.cornerCounts.push_back( (byte_t) cornerCount );
+			break;
+		}
+		default:
+			break;
+		}
+	} );
+}
 
-				// Assign calculated Normal
-				for( unsigned int faceIdx = 0; faceIdx < newFace.size(); faceIdx++ )
-					newFace[ faceIdx ].normal = normalVec;
-			}
+//------------------------------------------------------------------------------------------
+// ModelLoader
+//
+uint ModelLoader::s_parseThreadCount = 0U;
+
+static void FlushObjSubMesh( ObjSubMesh &currentSubMesh, std::vector< ObjSubMesh > &out_subMeshes )
+{
+	out_subMeshes.push_back( ObjSubMesh() );
+	out_subMeshes.back().materialName.swap( currentSubMesh.materialName );
+	out_subMeshes.back().vertices.swap( currentSubMesh.vertices );
+	out_subMeshes.back().indices.swap( currentSubMesh.indices );
+}
 
-			// Add this face to meshBuilder
-			if( newFace.size() == 3 )
-				AddTriangleFaceToMeshBuilder( newFace, theMeshBuilder );
-			else
-				AddQuadFaceToMeshBuilder( newFace, theMeshBuilder );
+static Vertex_Lit MakeObjVertex( Vector3 const &position, Vector2 const &uv, Vector3 const &normal )
+{
+	Vector3 tangent;
+	normal.GetTangentAndBitangent( &tangent, nullptr );
 
-			continue;
-		}
+	return Vertex_Lit( position, RGBA_WHITE_COLOR, uv, normal, Vector4( tangent.x, tangent.y, tangent.z, 1.f ) );
+}
+
+static void AddObjSubMeshToRenderable( Mesh *mesh, std::string const &materialName, Renderable &newRenderable )
+{
+	newRenderable.AddSubMesh( mesh );
+
+	if( materialName.empty() == false )
+	{
+		std::string materialPath	= "Data//Materials//" + materialName + ".material";
+		Material* newMaterial		= Material::CreateNewFromFile( materialPath );
+		newRenderable.AddSubMaterial( newMaterial );
 	}
+}
 
-	// Add last mesh from theMeshBuilder
-	theMeshBuilder.End();
-	// It should not be empty
-	if( theMeshBuilder.m_vertices.size() != 0 )
-		allMeshes.push_back( theMeshBuilder.ConstructMesh<Vertex_Lit>() );
-	else
+bool ModelLoader::LoadObjectModelFromPath( std::string path, Renderable &newRenderable )
+{
+	// See if you can successfully load the file
+	MemoryMappedFile objFile;
+	// Failed to load the file
+	if( objFile.Open( path ) == false )
 		return false;
 
-	// Copy all the data to Renderable
-	for each( Mesh *mesh in allMeshes )
-		newRenderable.AddSubMesh( mesh );
+	char const	*buffer		= (char const *) objFile.GetData();
+	size_t		 bufferSize	= objFile.GetSize();
+	uint64_t	 sourceHash	= MeshCache::HashContent( buffer, bufferSize );
+	std::string	 cachePath	= MeshCache::GetCachePathFor( path );
 
-	for each( Material *material in allMaterials )
-		newRenderable.AddSubMaterial( material );
+	// Cache is up to date: meshes go to the GPU straight from the mapped .nmesh
+	MeshCache cache;
+	if( cache.Open( cachePath, sourceHash, Vertex_Lit::s_layout ) )
+	{
+		for( uint i = 0; i < cache.GetSubMeshCount(); i++ )
+			AddObjSubMeshToRenderable( cache.CreateMesh<Vertex_Lit>( i ), cache.GetSubMesh(i).materialName, newRenderable );
+
+		return true;
+	}
+
+	std::vector< ObjSubMesh > subMeshes;
+	bool parsed = ParseObjectModel( buffer, bufferSize, subMeshes, s_parseThreadCount );
+	objFile.Close();
+
+	if( parsed == false )
+		return false;
+
+	// Create GPU meshes straight from the final vertex format
+	std::vector< MeshCacheSubMesh > cacheSubMeshes( subMeshes.size() );
+	for( size_t i = 0; i < subMeshes.size(); i++ )
+	{
+		ObjSubMesh const	&subMesh		= subMeshes[i];
+		MeshCacheSubMesh	&cacheSubMesh	= cacheSubMeshes[i];
+
+		cacheSubMesh.materialName		= subMesh.materialName.c_str();
+		cacheSubMesh.drawInstruction	= DrawInstruction( PRIMITIVE_TRIANGES, 0U, (uint)subMesh.indices.size(), true );
+		cacheSubMesh.vertices			= subMesh.vertices.data();
+		cacheSubMesh.vertexCount		= (uint)subMesh.vertices.size();
+		cacheSubMesh.indices			= subMesh.indices.data();
+		cacheSubMesh.indexCount			= (uint)subMesh.indices.size();
+
+		Mesh *mesh = new Mesh();
+		mesh->SetVertices<Vertex_Lit>( cacheSubMesh.vertexCount, subMesh.vertices.data() );
+		mesh->SetIndices( cacheSubMesh.indexCount, cacheSubMesh.indices );
+		mesh->SetDrawInstruction( cacheSubMesh.drawInstruction );
+		mesh->SetBoundsFromVertices<Vertex_Lit>( cacheSubMesh.vertexCount, subMesh.vertices.data() );
+
+		AddObjSubMeshToRenderable( mesh, subMesh.materialName, newRenderable );
+	}
+
+	// Next run loads the cache instead; failing to write it only costs the next run a parse
+	MeshCache::Write( cachePath, sourceHash, Vertex_Lit::s_layout, cacheSubMeshes );
 
 	return true;
 }
 
-void ModelLoader::AddTriangleFaceToMeshBuilder( std::vector< VUNpair > &triangleFace, MeshBuilder &mb )
+static void AddObjFace( ObjVertexKey const *faceKeys, uint cornerCount, std::vector< Vector3 > const &allVertices, std::vector< Vector2 > const &allUVs, std::vector< Vector3 > const &allNormals, ObjVertexTable &vertexTable, ObjSubMesh &subMesh )
 {
-	for (unsigned int i = 0; i < 3; i++)
+	bool normalsAreProvided = true;
+	for( uint i = 0; i < cornerCount; i++ )
+		normalsAreProvided = normalsAreProvided && (faceKeys[i].normal != OBJ_INVALID_INDEX);
+
+	// If normals were not provided, construct em using cross-product; these corners can't be shared
+	Vector3 faceNormal;
+	if( normalsAreProvided == false )
+	{
+		Vector3 faceSide1 = allVertices[ faceKeys[2].position ] - allVertices[ faceKeys[1].position ];
+		Vector3 faceSide2 = allVertices[ faceKeys[1].position ] - allVertices[ faceKeys[0].position ];
+
+		faceNormal = Vector3::CrossProduct( faceSide1, faceSide2 ).GetNormalized();
+	}
+
+	uint cornerIndices[ OBJ_MAX_FACE_CORNERS ];
+	for( uint i = 0; i < cornerCount; i++ )
 	{
-		Vector3 tangent;
-		triangleFace[i].normal.GetTangentAndBitangent( &tangent, nullptr );
+		ObjVertexKey const	&key			= faceKeys[i];
+		uint				 newIndex		= (uint)subMesh.vertices.size();
+		bool				 isNewVertex	= true;
+
+		if( normalsAreProvided )
+			isNewVertex = vertexTable.FindOrInsert( key, newIndex, cornerIndices[i] );
+		else
+			cornerIndices[i] = newIndex;
 
-		mb.SetColor( RGBA_WHITE_COLOR );
-		mb.SetUV( triangleFace[i].UV );
-		mb.SetNormal( triangleFace[i].normal );
-		mb.SetTangent4( tangent.x, tangent.y, tangent.z, 1.f );
-		mb.PushVertex( triangleFace[i].vertex );
+		if( isNewVertex )
+		{
+			Vector2 uv		= (key.uv == OBJ_INVALID_INDEX) ? Vector2::ZERO : allUVs[ key.uv ];
+			Vector3 normal	= normalsAreProvided ? allNormals[ key.normal ] : faceNormal;
+			subMesh.vertices.push_back( MakeObjVertex( allVertices[ key.position ], uv, normal ) );
+		}
+	}
+
+	// Triangle fan: quads become ( 0, 1, 2 ) & ( 0, 2, 3 )
+	for( uint i = 2; i < cornerCount; i++ )
+	{
+		subMesh.indices.push_back( cornerIndices[ 0 ] );
+		subMesh.indices.push_back( cornerIndices[ i - 1 ] );
+		subMesh.indices.push_back( cornerIndices[ i ] );
 	}
 }
 
-void ModelLoader::AddQuadFaceToMeshBuilder( std::vector< VUNpair > &quadFace, MeshBuilder &mb )
+bool ModelLoader::ParseObjectModel( char const *buffer, size_t bufferSize, std::vector< ObjSubMesh > &out_subMeshes, uint threadCount )
 {
-	// Push quad as two triangles..
+	if( threadCount == 0 )
+		threadCount = std::thread::hardware_concurrency();
+
+	// Small files aren't worth a thread per core
+	size_t chunkCount = bufferSize / OBJ_PARSE_MIN_CHUNK_SIZE;
+	if( chunkCount > threadCount )
+		chunkCount = threadCount;
+	if( chunkCount == 0 )
+		chunkCount = 1;
+
+	// Split at line boundaries
+	std::vector< ObjChunk > chunks( chunkCount );
+	char const *bufferEnd = buffer + bufferSize;
+	for( size_t i = 0; i < chunkCount; i++ )
+	{
+		chunks[i].start = (i == 0) ? buffer : chunks[i - 1].end;
+		chunks[i].end	= bufferEnd;
+
+		if( i + 1 < chunkCount )
+		{
+			char const *splitPoint	= buffer + (bufferSize * (i + 1)) / chunkCount;
+			if( splitPoint < chunks[i].start )
+				splitPoint = chunks[i].start;		// Previous chunk's last line ran past it
+
+			char const *lineEnd		= (char const *) memchr( splitPoint, '\n', bufferEnd - splitPoint );
+			chunks[i].end			= (lineEnd == nullptr) ? bufferEnd : lineEnd + 1;
+		}
+	}
+
+	// Pass 1: count, then place every chunk in the whole file's lists
+	RunObjChunkJobs( chunks, CountObjChunkLines );
 
-	// Triangle I - 0, 1, 2
-	for (unsigned int i = 0; i <= 2; i++)
+	uint totalVertices	= 0;
+	uint totalUVs		= 0;
+	uint totalNormals	= 0;
+	for( size_t i = 0; i < chunkCount; i++ )
 	{
-		Vector3 tangent;
-		quadFace[i].normal.GetTangentAndBitangent( &tangent, nullptr );
+		chunks[i].positionBase	= totalVertices;
+		chunks[i].uvBase		= totalUVs;
+		chunks[i].normalBase	= totalNormals;
 
-		mb.SetColor( RGBA_WHITE_COLOR );
-		mb.SetUV( quadFace[i].UV );
-		mb.SetNormal( quadFace[i].normal );
-		mb.SetTangent4( tangent.x, tangent.y, tangent.z, 1.f );
-		mb.PushVertex( quadFace[i].vertex );
+		totalVertices	+= chunks[i].positionCount;
+		totalUVs		+= chunks[i].uvCount;
+		totalNormals	+= chunks[i].normalCount;
 	}
 
-	// Triangle II - 2, 3, 0
-	for (unsigned int i = 2; i <= 3; i++)
+	std::vector< Vector3 >	allVertices( totalVertices );
+	std::vector< Vector3 >	allNormals( totalNormals );
+	std::vector< Vector2 >	allUVs( totalUVs );
+
+	// Pass 2: parse
+	RunObjChunkJobs( chunks, [ & ]( ObjChunk &chunk )
+	{
+		ParseObjChunk( chunk, allVertices.data(), allUVs.data(), allNormals.data() );
+	} );
+
+	// Merge, in file order
+	ObjVertexTable	vertexTable;
+	ObjSubMesh		currentSubMesh;
+	uint			skippedFaces = 0;
+
+	vertexTable.Reset( 0U );
+
+	for( size_t c = 0; c < chunkCount; c++ )
 	{
-		Vector3 tangent;
-		quadFace[i].normal.GetTangentAndBitangent( &tangent, nullptr );
+		ObjChunk const	&chunk			= chunks[c];
+		uint			 faceCount		= (uint) chunk.cornerCounts.size();
+		size_t			 cornerOffset	= 0;
+		size_t			 switchIdx		= 0;
+
+		for( uint face = 0; face <= faceCount; face++ )
+		{
+			// usemtl: flush out all faces so far in to a sub mesh
+			while( switchIdx < chunk.materialSwitches.size() && chunk.materialSwitches[ switchIdx ].faceIndex == face )
+			{
+				if( currentSubMesh.indices.empty() == false )
+				{
+					FlushObjSubMesh( currentSubMesh, out_subMeshes );
+					vertexTable.Reset( 0U );
+				}
+
+				currentSubMesh.materialName = chunk.materialSwitches[ switchIdx ].materialName;
+				switchIdx++;
+			}
+
+			if( face == faceCount )
+				break;
 
-		mb.SetColor( RGBA_WHITE_COLOR );
-		mb.SetUV( quadFace[i].UV );
-		mb.SetNormal( quadFace[i].normal );
-		mb.SetTangent4( tangent.x, tangent.y, tangent.z, 1.f );
-		mb.PushVertex( quadFace[i].vertex );
+			AddObjFace( &chunk.corners[ cornerOffset ], chunk.cornerCounts[ face ], allVertices, allUVs, allNormals, vertexTable, currentSubMesh );
+			cornerOffset += chunk.cornerCounts[ face ];
+		}
+
+		skippedFaces += chunk.skippedFaces;
 	}
-		Vector3 tangent;
-		quadFace[0].normal.GetTangentAndBitangent( &tangent, nullptr );
 
-		mb.SetColor( RGBA_WHITE_COLOR );
-		mb.SetUV( quadFace[0].UV );
-		mb.SetNormal( quadFace[0].normal );
-		mb.SetTangent4( tangent.x, tangent.y, tangent.z, 1.f );
-		mb.PushVertex( quadFace[0].vertex );
-}
+	// Add last sub mesh
+	if( currentSubMesh.indices.empty() == false )
+		FlushObjSubMesh( currentSubMesh, out_subMeshes );
+
+	GUARANTEE_RECOVERABLE( skippedFaces == 0, Stringf( "ModelLoader: skipped %u faces with invalid vertex indices!", skippedFaces ) );
+
+	// It should not be empty
+	return out_subMeshes.empty() == false;
+}
\ No newline at end of file
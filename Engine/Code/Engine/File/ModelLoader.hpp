@@ -1,16 +1,29 @@
 #pragma once
+#include <string>
+#include <vector>
+#include "Engine/Core/Vertex.hpp"
+#include "Engine/Core/EngineCommon.hpp"
 
 class	Renderer;
 class	Renderable;
-class	MeshBuilder;
-struct	VUNpair;
+
+// Faces between two "usemtl"s, with their v/vt/vn triples deduplicated in to an index buffer
+struct ObjSubMesh
+{
+	std::string					materialName;		// Empty for faces before the first usemtl
+	std::vector< Vertex_Lit >	vertices;
+	std::vector< uint >			indices;
+};
 
 class ModelLoader
 {
+public:
+	static uint s_parseThreadCount;		// Used by LoadObjectModelFromPath(); zero => one per hardware thread
+
 public:
 	static bool LoadObjectModelFromPath( std::string path, Renderable &newRenderable );
 
-private:
-	static void AddTriangleFaceToMeshBuilder( std::vector< VUNpair > &triangleFace, MeshBuilder &mb );
-	static void AddQuadFaceToMeshBuilder( std::vector< VUNpair > &quadFace, MeshBuilder &mb );
+	// Parses the whole buffer; touches no GPU objects. Returns false if there were no faces
+	//	- Splits it at line boundaries across up to threadCount threads ( zero => one per hardware thread ); the result is the same either way
+	static bool ParseObjectModel( char const *buffer, size_t bufferSize, std::vector< ObjSubMesh > &out_subMeshes, uint threadCount = 1U );
 };
\ No newline at end of file
@@ -0,0 +1,374 @@
+#pragma once
+#include "BinaryLog.hpp"
+#include <string.h>
+#include "Engine/File/File.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/LogSystem/LogSystem.hpp"
+#include "Engine/LogSystem/LogFormat.hpp"
+
+// FNV-1a
+static uint64_t HashLogString( char const *str )
+{
+	uint64_t hash = 14695981039346656037ULL;
+
+	for( char const *c = str; *c != '\0'; c++ )
+	{
+		hash ^= (uint64_t)(uchar)*c;
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+// ID of the string, if it is in the dictionary; compares the strings with the same hash
+static bool FindLogStringID( std::unordered_multimap< uint64_t, uint16_t > const &ids, std::vector< std::string > const &strings, uint64_t hash, char const *str, uint16_t &out_id )
+{
+	auto range = ids.equal_range( hash );
+	for( auto it = range.first; it != range.second; it++ )
+	{
+		if( strcmp( strings[ it->second ].c_str(), str ) == 0 )
+		{
+			out_id = it->second;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+//------------------------------------------------------------------------------------------
+// Writer
+//
+BinaryLogWriter::BinaryLogWriter()
+{
+	m_buffer.reserve( BINARY_LOG_WRITE_BUFFER_SIZE );
+}
+
+BinaryLogWriter::~BinaryLogWriter()
+{
+	Close();
+}
+
+bool BinaryLogWriter::Open( char const *filePath )
+{
+	Close();
+
+	// Let the File create the directory, if it doesn't exist
+	File directoryMaker;
+	if( directoryMaker.Open( filePath, FILE_OPEN_MODE_TRUNCATE ) == false )
+		return false;
+	directoryMaker.Close();
+
+	fopen_s( &m_file, filePath, "wb" );
+	if( m_file == nullptr )
+		return false;
+
+	Append( BINARY_LOG_MAGIC );
+	Append( BINARY_LOG_VERSION );
+
+	return true;
+}
+
+void BinaryLogWriter::Close()
+{
+	if( m_file == nullptr )
+		return;
+
+	Flush();
+
+	fclose( m_file );
+	m_file = nullptr;
+
+	ResetDictionaries();
+}
+
+void BinaryLogWriter::WriteMessage( LogData const &log )
+{
+	if( m_file == nullptr )
+		return;
+
+	// Out of IDs; a message adds at most one of each, so there's room after this check
+	if( m_tags.size() >= BINARY_LOG_MAX_IDS || m_formats.size() >= BINARY_LOG_MAX_IDS )
+		ResetDictionaries();
+
+	// Definitions go before the message which first uses them
+	uint16_t tagID		= GetOrWriteTagID( log.tag );
+	uint16_t formatID	= 0U;
+	uint16_t argsSize	= 0U;
+
+	if( log.isDeferred )
+	{
+		formatID	= GetOrWriteFormatID( log.text );
+		argsSize	= log.packedArgsSize;
+	}
+	else
+	{
+		// Already formatted text goes as a "%s" argument, so a '%' in it stays as it is
+		formatID	= GetOrWriteFormatID( "%s" );
+		argsSize	= (uint16_t)( sizeof( uint16_t ) + strlen( log.text ) );
+	}
+
+	Append( (uint8_t) BINARY_LOG_RECORD_MESSAGE );
+	Append( (int64_t) log.time );
+	Append( tagID );
+	Append( log.color.r );
+	Append( log.color.g );
+	Append( log.color.b );
+	Append( log.color.a );
+	Append( formatID );
+	Append( argsSize );
+
+	if( log.isDeferred )
+		Append( log.packedArgs, argsSize );
+	else
+	{
+		uint16_t textLength = (uint16_t)( argsSize - sizeof( uint16_t ) );
+		Append( textLength );
+		Append( log.text, textLength );
+	}
+}
+
+void BinaryLogWriter::Flush()
+{
+	if( m_file == nullptr || m_buffer.empty() )
+		return;
+
+	fwrite( m_buffer.data(), 1, m_buffer.size(), m_file );
+	fflush( m_file );
+
+	m_buffer.clear();
+}
+
+uint16_t BinaryLogWriter::GetOrWriteTagID( char const *tag )
+{
+	uint64_t	hash	= HashLogString( tag );
+	uint16_t	foundID	= 0U;
+	if( FindLogStringID( m_tagIDs, m_tags, hash, tag, foundID ) )
+		return foundID;
+
+	uint16_t	newID	= (uint16_t) m_tags.size();
+	uint8_t		length	= (uint8_t) strnlen( tag, 0xff );
+	m_tagIDs.insert( std::make_pair( hash, newID ) );
+	m_tags.push_back( tag );
+
+	Append( (uint8_t) BINARY_LOG_RECORD_TAG );
+	Append( newID );
+	Append( length );
+	Append( tag, length );
+
+	return newID;
+}
+
+uint16_t BinaryLogWriter::GetOrWriteFormatID( char const *format )
+{
+	uint64_t	hash	= HashLogString( format );
+	uint16_t	foundID	= 0U;
+	if( FindLogStringID( m_formatIDs, m_formats, hash, format, foundID ) )
+		return foundID;
+
+	uint16_t	newID		= (uint16_t) m_formats.size();
+	uint16_t	length		= (uint16_t) strnlen( format, 0xffff );
+	m_formatIDs.insert( std::make_pair( hash, newID ) );
+	m_formats.push_back( format );
+
+	Append( (uint8_t) BINARY_LOG_RECORD_FORMAT );
+	Append( newID );
+	Append( length );
+	Append( format, length );
+
+	return newID;
+}
+
+void BinaryLogWriter::ResetDictionaries()
+{
+	m_tagIDs.clear();
+	m_formatIDs.clear();
+	m_tags.clear();
+	m_formats.clear();
+}
+
+void BinaryLogWriter::Append( void const *data, size_t size )
+{
+	// Only hit the file in large chunks
+	if( m_buffer.size() + size > BINARY_LOG_WRITE_BUFFER_SIZE )
+		Flush();
+
+	byte_t const *bytes = (byte_t const*) data;
+	m_buffer.insert( m_buffer.end(), bytes, bytes + size );
+}
+
+//------------------------------------------------------------------------------------------
+// Reader
+//
+BinaryLogReader::BinaryLogReader()
+{
+
+}
+
+BinaryLogReader::~BinaryLogReader()
+{
+	Close();
+}
+
+bool BinaryLogReader::Open( char const *filePath )
+{
+	Close();
+
+	FILE *fp = nullptr;
+	fopen_s( &fp, filePath, "rb" );
+	if( fp == nullptr )
+		return false;
+
+	fseek( fp, 0L, SEEK_END );
+	m_size = (size_t) ftell( fp );
+	fseek( fp, 0L, SEEK_SET );
+
+	m_data = (byte_t*) malloc( m_size );
+	m_size = fread( m_data, 1, m_size, fp );
+	fclose( fp );
+
+	// Check the header
+	uint32_t magic		= 0U;
+	uint32_t version	= 0U;
+	bool	 isValid	= Read( magic ) && Read( version ) && ( magic == BINARY_LOG_MAGIC ) && ( version == BINARY_LOG_VERSION );
+
+	if( isValid == false )
+		Close();
+
+	return isValid;
+}
+
+void BinaryLogReader::Close()
+{
+	free( m_data );
+
+	m_data			= nullptr;
+	m_size			= 0U;
+	m_readOffset	= 0U;
+
+	m_tags.clear();
+	m_formats.clear();
+}
+
+bool BinaryLogReader::ReadNextMessage( LogData &out_log )
+{
+	uint8_t recordType = 0U;
+
+	while( Read( recordType ) )
+	{
+		switch( recordType )
+		{
+		case BINARY_LOG_RECORD_TAG:
+		{
+			uint16_t	id		= 0U;
+			uint8_t		length	= 0U;
+			if( Read( id ) == false || Read( length ) == false || m_readOffset + length > m_size )
+				return false;
+
+			if( id >= m_tags.size() )
+				m_tags.resize( id + 1U );
+			m_tags[ id ].assign( (char const*)( m_data + m_readOffset ), length );
+			m_readOffset += length;
+			break;
+		}
+
+		case BINARY_LOG_RECORD_FORMAT:
+		{
+			uint16_t id		= 0U;
+			uint16_t length	= 0U;
+			if( Read( id ) == false || Read( length ) == false || m_readOffset + length > m_size )
+				return false;
+
+			if( id >= m_formats.size() )
+				m_formats.resize( id + 1U );
+			m_formats[ id ].assign( (char const*)( m_data + m_readOffset ), length );
+			m_readOffset += length;
+			break;
+		}
+
+		case BINARY_LOG_RECORD_MESSAGE:
+		{
+			int64_t		time		= 0;
+			uint16_t	tagID		= 0U;
+			uint16_t	formatID	= 0U;
+			uint16_t	argsSize	= 0U;
+
+			bool headerIsRead =	Read( time ) && Read( tagID ) && 
+								Read( out_log.color.r ) && Read( out_log.color.g ) && Read( out_log.color.b ) && Read( out_log.color.a ) &&
+								Read( formatID ) && Read( argsSize );
+
+			bool isValid = headerIsRead && ( tagID < m_tags.size() ) && ( formatID < m_formats.size() ) && ( m_readOffset + argsSize <= m_size );
+			if( isValid == false )
+				return false;
+
+			out_log.time		= (time_t) time;
+			out_log.isDeferred	= false;
+			strncpy_s( out_log.tag, LOG_MAX_TAG_LENGTH, m_tags[ tagID ].c_str(), _TRUNCATE );
+			LogFormatPackedArguments( m_formats[ formatID ].c_str(), m_data + m_readOffset, argsSize, out_log.text, LOG_MAX_TEXT_LENGTH );
+
+			m_readOffset += argsSize;
+			return true;
+		}
+
+		default:
+			// Unknown record, can't tell its size
+			return false;
+		}
+	}
+
+	return false;
+}
+
+bool BinaryLogReader::ConvertToFile( char const *binaryLogPath, char const *outputPath, eLogFileFormat outputFormat )
+{
+	GUARANTEE_RECOVERABLE( outputFormat != LOG_FILE_FORMAT_BINARY, "BinaryLogReader: can only convert to HTML or text!" );
+
+	BinaryLogReader reader;
+	if( reader.Open( binaryLogPath ) == false )
+		return false;
+
+	File outputFile;
+	if( outputFile.Open( outputPath, FILE_OPEN_MODE_TRUNCATE ) == false )
+		return false;
+
+	bool isHTML = ( outputFormat == LOG_FILE_FORMAT_HTML );
+	if( isHTML )
+		outputFile.Write( Stringf( "<html>\n<head>\n<title> %s </title>\n</head>\n\n<body>\n", binaryLogPath ) );
+
+	// Same rendering as the live log file
+	LogData		log;
+	std::string	messageStr;
+	std::string	chunkStr;
+	while( reader.ReadNextMessage( log ) )
+	{
+		if( isHTML )
+			LogSystem::GetAsHTMLTagFromLogData( messageStr, &log );
+		else
+			LogSystem::GetAsStringFromLogData( messageStr, &log );
+
+		chunkStr += messageStr;
+		if( chunkStr.size() >= BINARY_LOG_WRITE_BUFFER_SIZE )
+		{
+			outputFile.Write( chunkStr );
+			chunkStr.clear();
+		}
+	}
+	outputFile.Write( chunkStr );
+
+	if( isHTML )
+		outputFile.Write( "</body>\n</html>" );
+
+	outputFile.Close();
+	return true;
+}
+
+bool BinaryLogReader::Read( void *out_data, size_t size )
+{
+	if( m_readOffset + size > m_size )
+		return false;
+
+	memcpy( out_data, m_data + m_readOffset, size );
+	m_readOffset += size;
+
+	return true;
+}
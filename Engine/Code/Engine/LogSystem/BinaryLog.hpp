@@ -0,0 +1,102 @@
+#pragma once
+#include <stdio.h>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include "Engine/Core/EngineCommon.hpp"
+
+//------------------------------------------------------------------------------------------
+// Binary log file
+//	- Header     :	uint32_t magic, uint32_t version
+//	- Records    :	uint8_t record type, then its data
+//		TAG      :	uint16_t tagID, uint8_t length, characters
+//		FORMAT   :	uint16_t formatID, uint16_t length, characters
+//		MESSAGE  :	int64_t time, uint16_t tagID, uint8_t r,g,b,a, uint16_t formatID, uint16_t packedArgsSize, packed arguments
+//	- Tags & format strings are written once, the first time they show up; messages refer to their IDs
+//	- Once either runs out of IDs, both start again from ZERO; a definition replaces the earlier one with its ID
+//	- Packed arguments are as per LogPackArguments()
+//	- Written in the native ( little ) endianness
+//
+#define BINARY_LOG_MAGIC				(0x474f4c4eU)		// "NLOG"
+#define BINARY_LOG_VERSION				(1U)
+#define BINARY_LOG_WRITE_BUFFER_SIZE	(64U * 1024U)
+#define BINARY_LOG_MAX_IDS				(0xffffU)			// Per dictionary, of tags or formats
+
+struct LogData;
+
+enum eBinaryLogRecordType : uint8_t
+{
+	BINARY_LOG_RECORD_TAG = 1,
+	BINARY_LOG_RECORD_FORMAT,
+	BINARY_LOG_RECORD_MESSAGE
+};
+
+enum eLogFileFormat
+{
+	LOG_FILE_FORMAT_HTML = 0,
+	LOG_FILE_FORMAT_TEXT,
+	LOG_FILE_FORMAT_BINARY,
+	NUM_LOG_FILE_FORMATS
+};
+
+class BinaryLogWriter
+{
+public:
+	 BinaryLogWriter();
+	~BinaryLogWriter();
+
+private:
+	FILE								*m_file		= nullptr;
+	std::vector< byte_t >				 m_buffer;				// Flushed to the file in large appends
+
+	// Keyed by hash of the string, so interning doesn't allocate per message; a hit gets its string compared, as hashes can collide
+	std::unordered_multimap< uint64_t, uint16_t >	m_tagIDs;
+	std::unordered_multimap< uint64_t, uint16_t >	m_formatIDs;
+	std::vector< std::string >						m_tags;			// Indexed by their IDs
+	std::vector< std::string >						m_formats;
+
+public:
+	bool	Open( char const *filePath );
+	void	Close();
+	bool	IsOpen() const { return m_file != nullptr; }
+
+	void	WriteMessage( LogData const &log );		// Not thread safe, call from the logger thread
+	void	Flush();
+
+private:
+	uint16_t	GetOrWriteTagID( char const *tag );
+	uint16_t	GetOrWriteFormatID( char const *format );
+	void		ResetDictionaries();
+	void		Append( void const *data, size_t size );
+
+	template <typename T>
+	void		Append( T const &value ) { Append( &value, sizeof( T ) ); }
+};
+
+class BinaryLogReader
+{
+public:
+	 BinaryLogReader();
+	~BinaryLogReader();
+
+private:
+	byte_t						*m_data			= nullptr;
+	size_t						 m_size			= 0U;
+	size_t						 m_readOffset	= 0U;
+
+	std::vector< std::string >	 m_tags;				// Indexed by their IDs
+	std::vector< std::string >	 m_formats;
+
+public:
+	bool	Open( char const *filePath );
+	void	Close();
+	bool	ReadNextMessage( LogData &out_log );		// Returns false at the end of the file ( or if it is corrupted )
+
+	static bool	ConvertToFile( char const *binaryLogPath, char const *outputPath, eLogFileFormat outputFormat );
+
+private:
+	bool	Read( void *out_data, size_t size );
+
+	template <typename T>
+	bool	Read( T &out_value ) { return Read( &out_value, sizeof( T ) ); }
+};
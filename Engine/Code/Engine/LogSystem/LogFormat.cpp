@@ -0,0 +1,437 @@
+#pragma once
+#include "LogFormat.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <stddef.h>
+#include <string>
+
+enum eLogArgumentType
+{
+	LOG_ARGUMENT_NONE = 0,		// "%%"
+	LOG_ARGUMENT_SIGNED,
+	LOG_ARGUMENT_UNSIGNED,
+	LOG_ARGUMENT_DOUBLE,
+	LOG_ARGUMENT_CHAR,
+	LOG_ARGUMENT_STRING,
+	LOG_ARGUMENT_POINTER,
+	LOG_ARGUMENT_UNSUPPORTED	// Wide strings, "%n", etc.
+};
+
+enum eLogArgumentSize
+{
+	LOG_ARGUMENT_SIZE_INT = 0,
+	LOG_ARGUMENT_SIZE_CHAR,			// "hh"
+	LOG_ARGUMENT_SIZE_SHORT,		// "h"
+	LOG_ARGUMENT_SIZE_LONG,
+	LOG_ARGUMENT_SIZE_LONG_LONG,
+	LOG_ARGUMENT_SIZE_POINTER,		// size_t, ptrdiff_t
+	LOG_ARGUMENT_SIZE_LONG_DOUBLE
+};
+
+struct LogFormatSpec
+{
+	char const			*start				= nullptr;		// At '%'
+	char const			*modifierStart		= nullptr;		// Where flags, width & precision end
+	char const			*end				= nullptr;		// One past the conversion character
+	char				 conversion			= '\0';
+	eLogArgumentType	 type				= LOG_ARGUMENT_NONE;
+	eLogArgumentSize	 size				= LOG_ARGUMENT_SIZE_INT;
+	uint				 starArgumentCount	= 0;			// '*' in width & precision
+};
+
+// Finds the next conversion specification, returns false if there's none
+static bool ParseNextFormatSpec( char const *cursor, LogFormatSpec &out_spec )
+{
+	char const *c = strchr( cursor, '%' );
+	if( c == nullptr )
+		return false;
+
+	out_spec				= LogFormatSpec();
+	out_spec.start			= c;
+	c++;
+
+	// Flags, width & precision
+	while( *c != '\0' && strchr( "-+ #0", *c ) != nullptr )
+		c++;
+	for( ; *c != '\0' && ( ( *c >= '0' && *c <= '9' ) || *c == '.' || *c == '*' ); c++ )
+	{
+		if( *c == '*' )
+			out_spec.starArgumentCount++;
+	}
+	out_spec.modifierStart = c;
+
+	// Length modifiers
+	if( c[0] == 'h' && c[1] == 'h' )
+	{
+		out_spec.size = LOG_ARGUMENT_SIZE_CHAR;
+		c += 2;
+	}
+	else if( c[0] == 'h' )
+	{
+		out_spec.size = LOG_ARGUMENT_SIZE_SHORT;
+		c += 1;
+	}
+	else if( c[0] == 'l' && c[1] == 'l' )
+	{
+		out_spec.size = LOG_ARGUMENT_SIZE_LONG_LONG;
+		c += 2;
+	}
+	else if( c[0] == 'l' )
+	{
+		out_spec.size = LOG_ARGUMENT_SIZE_LONG;
+		c += 1;
+	}
+	else if( c[0] == 'j' )
+	{
+		out_spec.size = LOG_ARGUMENT_SIZE_LONG_LONG;
+		c += 1;
+	}
+	else if( c[0] == 'z' || c[0] == 't' )
+	{
+		out_spec.size = LOG_ARGUMENT_SIZE_POINTER;
+		c += 1;
+	}
+	else if( c[0] == 'L' )
+	{
+		out_spec.size = LOG_ARGUMENT_SIZE_LONG_DOUBLE;
+		c += 1;
+	}
+	else if( c[0] == 'I' && c[1] == '6' && c[2] == '4' )
+	{
+		out_spec.size = LOG_ARGUMENT_SIZE_LONG_LONG;
+		c += 3;
+	}
+	else if( c[0] == 'I' && c[1] == '3' && c[2] == '2' )
+		c += 3;
+	else if( c[0] == 'I' )
+	{
+		out_spec.size = LOG_ARGUMENT_SIZE_POINTER;
+		c += 1;
+	}
+
+	// Conversion
+	out_spec.conversion = *c;
+	switch( *c )
+	{
+	case 'd':
+	case 'i':
+		out_spec.type = LOG_ARGUMENT_SIGNED;
+		break;
+	case 'u':
+	case 'o':
+	case 'x':
+	case 'X':
+		out_spec.type = LOG_ARGUMENT_UNSIGNED;
+		break;
+	case 'f':
+	case 'F':
+	case 'e':
+	case 'E':
+	case 'g':
+	case 'G':
+	case 'a':
+	case 'A':
+		out_spec.type = LOG_ARGUMENT_DOUBLE;
+		break;
+	case 'c':
+		out_spec.type = ( out_spec.size == LOG_ARGUMENT_SIZE_LONG ) ? LOG_ARGUMENT_UNSUPPORTED : LOG_ARGUMENT_CHAR;
+		break;
+	case 's':
+		out_spec.type = ( out_spec.size == LOG_ARGUMENT_SIZE_LONG ) ? LOG_ARGUMENT_UNSUPPORTED : LOG_ARGUMENT_STRING;
+		break;
+	case 'p':
+		out_spec.type = LOG_ARGUMENT_POINTER;
+		break;
+	case '%':
+		out_spec.type = LOG_ARGUMENT_NONE;
+		break;
+	case '\0':
+		// Dangling '%' at the end
+		out_spec.type = LOG_ARGUMENT_NONE;
+		out_spec.end = c;
+		return true;
+	default:
+		out_spec.type = LOG_ARGUMENT_UNSUPPORTED;
+		break;
+	}
+
+	out_spec.end = c + 1;
+	return true;
+}
+
+static bool PackInteger( int64_t value, byte_t *packedArgs, uint capacity, uint &offset )
+{
+	if( offset + sizeof( int64_t ) > capacity )
+		return false;
+
+	memcpy( packedArgs + offset, &value, sizeof( int64_t ) );
+	offset += sizeof( int64_t );
+	return true;
+}
+
+static bool PackDouble( double value, byte_t *packedArgs, uint capacity, uint &offset )
+{
+	if( offset + sizeof( double ) > capacity )
+		return false;
+
+	memcpy( packedArgs + offset, &value, sizeof( double ) );
+	offset += sizeof( double );
+	return true;
+}
+
+static bool PackString( char const *value, byte_t *packedArgs, uint capacity, uint &offset )
+{
+	if( offset + sizeof( uint16_t ) > capacity )
+		return false;
+
+	// Truncate the string to whatever room is left
+	size_t		fullLength	= ( value != nullptr ) ? strlen( value ) : 0U;
+	size_t		room		= capacity - offset - sizeof( uint16_t );
+	uint16_t	length		= (uint16_t) ( ( fullLength < room ) ? fullLength : room );
+
+	memcpy( packedArgs + offset, &length, sizeof( uint16_t ) );
+	offset += sizeof( uint16_t );
+
+	memcpy( packedArgs + offset, value, length );
+	offset += length;
+	return true;
+}
+
+uint LogPackArguments( char const *format, va_list args, byte_t *out_packedArgs, uint packedArgsCapacity )
+{
+	uint			offset		= 0U;
+	bool			hasRoom		= true;
+	LogFormatSpec	spec;
+
+	// Every argument has to be read with va_arg, even when it doesn't fit anymore
+	for( char const *cursor = format; ParseNextFormatSpec( cursor, spec ); cursor = spec.end )
+	{
+		for( uint s = 0; s < spec.starArgumentCount; s++ )
+		{
+			int starValue	= va_arg( args, int );
+			hasRoom			= hasRoom && PackInteger( starValue, out_packedArgs, packedArgsCapacity, offset );
+		}
+
+		switch( spec.type )
+		{
+		case LOG_ARGUMENT_SIGNED:
+		{
+			int64_t value;
+			if( spec.size == LOG_ARGUMENT_SIZE_LONG_LONG )
+				value = va_arg( args, long long );
+			else if( spec.size == LOG_ARGUMENT_SIZE_LONG )
+				value = va_arg( args, long );
+			else if( spec.size == LOG_ARGUMENT_SIZE_POINTER )
+				value = va_arg( args, ptrdiff_t );
+			else
+				value = va_arg( args, int );
+
+			hasRoom = hasRoom && PackInteger( value, out_packedArgs, packedArgsCapacity, offset );
+			break;
+		}
+		case LOG_ARGUMENT_UNSIGNED:
+		{
+			uint64_t value;
+			if( spec.size == LOG_ARGUMENT_SIZE_LONG_LONG )
+				value = va_arg( args, unsigned long long );
+			else if( spec.size == LOG_ARGUMENT_SIZE_LONG )
+				value = va_arg( args, unsigned long );
+			else if( spec.size == LOG_ARGUMENT_SIZE_POINTER )
+				value = va_arg( args, size_t );
+			else
+				value = va_arg( args, unsigned int );
+
+			// "hh" & "h" get narrowed by the formatter
+			hasRoom = hasRoom && PackInteger( (int64_t)value, out_packedArgs, packedArgsCapacity, offset );
+			break;
+		}
+		case LOG_ARGUMENT_DOUBLE:
+		{
+			double value = ( spec.size == LOG_ARGUMENT_SIZE_LONG_DOUBLE ) ? (double) va_arg( args, long double ) : va_arg( args, double );
+			hasRoom = hasRoom && PackDouble( value, out_packedArgs, packedArgsCapacity, offset );
+			break;
+		}
+		case LOG_ARGUMENT_CHAR:
+			hasRoom = hasRoom && PackInteger( va_arg( args, int ), out_packedArgs, packedArgsCapacity, offset );
+			break;
+		case LOG_ARGUMENT_STRING:
+		{
+			char const *value = va_arg( args, char const* );
+			hasRoom = hasRoom && PackString( value, out_packedArgs, packedArgsCapacity, offset );
+			break;
+		}
+		case LOG_ARGUMENT_POINTER:
+			hasRoom = hasRoom && PackInteger( (int64_t)(intptr_t) va_arg( args, void* ), out_packedArgs, packedArgsCapacity, offset );
+			break;
+		case LOG_ARGUMENT_UNSUPPORTED:
+			// Still consume it, so the following arguments line up
+			if( spec.conversion != '\0' )
+				va_arg( args, void* );
+			break;
+		case LOG_ARGUMENT_NONE:
+		default:
+			break;
+		}
+	}
+
+	return offset;
+}
+
+uint LogFormatPackedArguments( char const *format, byte_t const *packedArgs, uint packedArgsSize, char *out_text, uint textCapacity )
+{
+	if( textCapacity == 0 )
+		return 0U;
+
+	uint			textLength	= 0U;
+	uint			offset		= 0U;
+	LogFormatSpec	spec;
+
+	// Appends at most the room left, keeps it null terminated
+	auto AppendText = [&]( char const *text, size_t length )
+	{
+		size_t room		= textCapacity - 1U - textLength;
+		size_t toCopy	= ( length < room ) ? length : room;
+
+		memcpy( out_text + textLength, text, toCopy );
+		textLength += (uint) toCopy;
+		out_text[ textLength ] = '\0';
+	};
+
+	auto ReadInteger = [&]( int64_t &out_value ) -> bool
+	{
+		if( offset + sizeof( int64_t ) > packedArgsSize )
+			return false;
+
+		memcpy( &out_value, packedArgs + offset, sizeof( int64_t ) );
+		offset += sizeof( int64_t );
+		return true;
+	};
+
+	out_text[0] = '\0';
+
+	char const *cursor = format;
+	for( ; ParseNextFormatSpec( cursor, spec ); cursor = spec.end )
+	{
+		// Literal text before the spec
+		AppendText( cursor, spec.start - cursor );
+
+		if( spec.type == LOG_ARGUMENT_NONE )
+		{
+			if( spec.conversion == '%' )
+				AppendText( "%", 1 );
+			continue;
+		}
+
+		if( spec.type == LOG_ARGUMENT_UNSUPPORTED )
+		{
+			AppendText( "<?>", 3 );
+			continue;
+		}
+
+		// Rebuild the spec with '*' resolved, and a length modifier matching the packed type
+		char	rebuiltSpec[64];
+		uint	rebuiltLength	= 0U;
+		bool	hasArgument		= true;
+
+		for( char const *c = spec.start; c < spec.modifierStart && rebuiltLength < sizeof( rebuiltSpec ) - 24U; c++ )
+		{
+			if( *c != '*' )
+			{
+				rebuiltSpec[ rebuiltLength++ ] = *c;
+				continue;
+			}
+
+			int64_t starValue = 0;
+			hasArgument		= hasArgument && ReadInteger( starValue );
+			rebuiltLength  += (uint) snprintf( rebuiltSpec + rebuiltLength, sizeof( rebuiltSpec ) - rebuiltLength, "%d", (int)starValue );
+		}
+
+		if( spec.type == LOG_ARGUMENT_SIGNED || spec.type == LOG_ARGUMENT_UNSIGNED )
+		{
+			rebuiltSpec[ rebuiltLength++ ] = 'l';
+			rebuiltSpec[ rebuiltLength++ ] = 'l';
+		}
+		rebuiltSpec[ rebuiltLength++ ]	= spec.conversion;
+		rebuiltSpec[ rebuiltLength ]	= '\0';
+
+		// Render the argument
+		char	argumentText[512];
+		int		argumentLength = -1;
+
+		if( hasArgument )
+		{
+			switch( spec.type )
+			{
+			case LOG_ARGUMENT_SIGNED:
+			case LOG_ARGUMENT_UNSIGNED:
+			case LOG_ARGUMENT_CHAR:
+			case LOG_ARGUMENT_POINTER:
+			{
+				int64_t value = 0;
+				if( ReadInteger( value ) == false )
+					break;
+
+				// Packed at full width; "hh" & "h" narrow it here, as printf would have
+				if( spec.type == LOG_ARGUMENT_SIGNED && spec.size == LOG_ARGUMENT_SIZE_CHAR )
+					value = (int64_t)(signed char) value;
+				else if( spec.type == LOG_ARGUMENT_SIGNED && spec.size == LOG_ARGUMENT_SIZE_SHORT )
+					value = (int64_t)(short) value;
+				else if( spec.type == LOG_ARGUMENT_UNSIGNED && spec.size == LOG_ARGUMENT_SIZE_CHAR )
+					value = (int64_t)(unsigned char) value;
+				else if( spec.type == LOG_ARGUMENT_UNSIGNED && spec.size == LOG_ARGUMENT_SIZE_SHORT )
+					value = (int64_t)(unsigned short) value;
+
+				if( spec.type == LOG_ARGUMENT_CHAR )
+					argumentLength = snprintf( argumentText, sizeof( argumentText ), rebuiltSpec, (int)value );
+				else if( spec.type == LOG_ARGUMENT_POINTER )
+					argumentLength = snprintf( argumentText, sizeof( argumentText ), rebuiltSpec, (void*)(intptr_t)value );
+				else
+					argumentLength = snprintf( argumentText, sizeof( argumentText ), rebuiltSpec, (long long)value );
+				break;
+			}
+			case LOG_ARGUMENT_DOUBLE:
+			{
+				if( offset + sizeof( double ) > packedArgsSize )
+					break;
+
+				double value;
+				memcpy( &value, packedArgs + offset, sizeof( double ) );
+				offset += sizeof( double );
+
+				argumentLength = snprintf( argumentText, sizeof( argumentText ), rebuiltSpec, value );
+				break;
+			}
+			case LOG_ARGUMENT_STRING:
+			{
+				if( offset + sizeof( uint16_t ) > packedArgsSize )
+					break;
+
+				uint16_t length;
+				memcpy( &length, packedArgs + offset, sizeof( uint16_t ) );
+				offset += sizeof( uint16_t );
+
+				if( offset + length > packedArgsSize )
+					break;
+
+				std::string value( (char const*)( packedArgs + offset ), length );
+				argumentLength = snprintf( argumentText, sizeof( argumentText ), rebuiltSpec, value.c_str() );
+
+				offset += length;
+				break;
+			}
+			default:
+				break;
+			}
+		}
+
+		if( argumentLength >= 0 )
+			AppendText( argumentText, strlen( argumentText ) );
+		else
+			AppendText( "<?>", 3 );
+	}
+
+	// Text after the last spec
+	AppendText( cursor, strlen( cursor ) );
+
+	return textLength;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <stdarg.h>
+#include "Engine/Core/EngineCommon.hpp"
+
+//------------------------------------------------------------------------------------------
+// Deferred printf formatting
+//	- LogPackArguments() walks the format string & copies each argument in to a flat buffer
+//	- LogFormatPackedArguments() renders that buffer with the same format string, later
+//
+// Packed layout, in the order of the format string,
+//	- Integers, chars & pointers :	8 byte integer
+//	- Floating points            :	8 byte double
+//	- Strings                    :	uint16_t length, then the characters ( no null terminator )
+//	- '*' width & precision      :	8 byte integer, before the argument they belong to
+//
+// Arguments which don't fit in the buffer are rendered as "<?>"
+//
+
+// Returns number of bytes written in to out_packedArgs
+uint	LogPackArguments		( char const *format, va_list args, byte_t *out_packedArgs, uint packedArgsCapacity );
+
+// Returns length of the rendered text, without the null terminator
+uint	LogFormatPackedArguments( char const *format, byte_t const *packedArgs, uint packedArgsSize, char *out_text, uint textCapacity );
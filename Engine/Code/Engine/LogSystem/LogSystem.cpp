@@ -14,10 +14,96 @@
 #include "Engine/Core/StringUtils.hpp"
 #include "Engine/File/File.hpp"
 #include "Engine/Math/MathUtil.hpp"
+#include "Engine/Input/Command.hpp"
+#include "Engine/Core/DevConsole.hpp"
 
 LogSystem	*g_logSystem	= nullptr;
 File		*g_logFile		= nullptr;
 
+void LogBenchmarkProducer( uint messageCount, uint threadIndex )
+{
+	for( uint i = 0; i < messageCount; i++ )
+		g_logSystem->LogTaggedPrintf( "log_benchmark", RGBA_GRAY_COLOR, "Benchmark message %u from producer thread %u", i, threadIndex );
+}
+
+void LogBenchmark( Command &cmd )
+{
+	if( g_logSystem == nullptr || g_logSystem->IsRunning() == false )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "log_benchmark: LogSystem isn't running!" );
+		return;
+	}
+
+	std::string countStr			= cmd.GetNextString();
+	uint		messagesPerThread	= ( countStr != "" ) ? (uint) atoi( countStr.c_str() ) : 100000U;
+	uint const	threadCounts[]		= { 1U, 4U, 8U };
+
+	// Benchmark messages still go through the queue, but don't end up in the log file
+	g_logSystem->HideTag( "log_benchmark" );
+
+	ConsolePrintf( "log_benchmark: %u messages per producer thread", messagesPerThread );
+	for( uint t = 0; t < ARRAY_LENGTH( threadCounts ); t++ )
+	{
+		uint const	threadCount		= threadCounts[t];
+		uint		droppedBefore	= g_logSystem->GetDroppedMessageCount();
+		uint		spilledBefore	= g_logSystem->GetSpilledMessageCount();
+
+		std::vector< std::thread* > producers;
+		double startTime = GetCurrentTimeSeconds();
+		{
+			for( uint i = 0; i < threadCount; i++ )
+				producers.push_back( new std::thread( LogBenchmarkProducer, messagesPerThread, i ) );
+
+			for( uint i = 0; i < threadCount; i++ )
+			{
+				producers[i]->join();
+				delete producers[i];
+			}
+		}
+		double	elapsedSeconds	= GetCurrentTimeSeconds() - startTime;
+		double	totalMessages	= (double)messagesPerThread * (double)threadCount;
+
+		ConsolePrintf( "  %u thread(s): %.3f ms, %.0f messages/sec ( dropped %u, spilled %u )", threadCount, elapsedSeconds * 1000.0, totalMessages / elapsedSeconds, g_logSystem->GetDroppedMessageCount() - droppedBefore, g_logSystem->GetSpilledMessageCount() - spilledBefore );
+
+		// Let the logger catch up, before the next run
+		LogSystem::ForceFlush();
+	}
+
+	g_logSystem->ShowTag( "log_benchmark" );
+}
+
+void LogBatch( Command &cmd )
+{
+	std::string batchSizeStr	= cmd.GetNextString();
+	std::string intervalStr		= cmd.GetNextString();
+
+	if( batchSizeStr != "" )
+	{
+		uint batchSize	= (uint) atoi( batchSizeStr.c_str() );
+		uint intervalMS	= ( intervalStr != "" ) ? (uint) atoi( intervalStr.c_str() ) : g_logSystem->GetWakeIntervalMS();
+		g_logSystem->SetWakeUpPolicy( batchSize, intervalMS );
+	}
+
+	ConsolePrintf( "Logger wakes up on %u messages, or every %u ms", g_logSystem->GetWakeBatchSize(), g_logSystem->GetWakeIntervalMS() );
+}
+
+void LogStats( Command &cmd )
+{
+	UNUSED( cmd );
+
+	LogSystemStats	stats			= g_logSystem->GetStats();
+	double			runningSeconds	= GetCurrentTimeSeconds() - stats.startSeconds;
+	double			flushes			= ( stats.flushes > 0U ) ? (double) stats.flushes : 1.0;
+	double			messages		= ( stats.processedMessages > 0U ) ? (double) stats.processedMessages : 1.0;
+
+	ConsolePrintf( "Logger stats, over %.2f seconds", runningSeconds );
+	ConsolePrintf( "  Processed   : %llu messages, %.1f messages/sec", stats.processedMessages, (double) stats.processedMessages / runningSeconds );
+	ConsolePrintf( "  Batches     : %llu, %.1f messages per batch, %.3f ms per batch", stats.flushes, (double) stats.processedMessages / flushes, stats.totalFlushSeconds * 1000.0 / flushes );
+	ConsolePrintf( "  Wake ups    : %llu on batch size, %llu on interval", stats.wakeUpsOnBatchSize, stats.wakeUpsOnInterval );
+	ConsolePrintf( "  Latency     : %.3f ms average, %.3f ms max", stats.totalLatencySeconds * 1000.0 / messages, stats.maxLatencySeconds * 1000.0 );
+	ConsolePrintf( "  Overflow    : %u dropped, %u spilled", g_logSystem->GetDroppedMessageCount(), g_logSystem->GetSpilledMessageCount() );
+}
+
 void WriteToFile( LogData const *logData, void *filePointer )
 {
 	File *fp = (File*) filePointer;
@@ -28,6 +114,16 @@ void WriteToFile( LogData const *logData, void *filePointer )
 	fp->Write( logStr );
 }
 
+void WriteToTextFile( LogData const *logData, void *filePointer )
+{
+	File *fp = (File*) filePointer;
+
+	std::string logStr;
+	LogSystem::GetAsStringFromLogData( logStr, logData );
+
+	fp->Write( logStr );
+}
+
 void WriteToIDE( LogData const *logData, void* )
 {
 	// Get log message as string
@@ -64,29 +160,56 @@ LogSystem* LogSystem::GetInstance()
 	return g_logSystem;
 }
 
-void LogSystem::LoggerStartup( char const *fileRootName /*= DEFAULT_LOG_NAME */ )
+void LogSystem::LoggerStartup( char const *fileRootName /*= DEFAULT_LOG_NAME */, eLogFileFormat fileFormat /* = LOG_FILE_FORMAT_HTML */ )
 {
-	m_isRunning = true;
+	m_isRunning				= true;
+	m_stats					= LogSystemStats();
+	m_stats.startSeconds	= GetCurrentTimeSeconds();
+	m_logFilePath			= fileRootName;
+	m_logFileFormat			= fileFormat;
 	
-	// Get ready the log file
-	g_logFile			= new File();
-	bool fileGotOpened	= g_logFile->Open( fileRootName, FILE_OPEN_MODE_TRUNCATE );
-
-	// Hook it if got opened successfully
-	if( fileGotOpened )
+	if( fileFormat == LOG_FILE_FORMAT_BINARY )
 	{
-		// Write HTML heading tags
-		std::string htmlUptoBodyStr = Stringf( "<html>\n<head>\n<title> %s </title>\n</head>\n\n<body>\n", fileRootName );
-		g_logFile->Write( htmlUptoBodyStr );
-
-		// Set it as a Hook
-		LogHook( WriteToFile, g_logFile );
+		// Binary log isn't a hook, it needs the packed arguments
+		m_binaryLogWriter = new BinaryLogWriter();
+		if( m_binaryLogWriter->Open( fileRootName ) )
+		{
+			m_deferFormatting = true;
+		}
+		else
+		{
+			delete m_binaryLogWriter;
+			m_binaryLogWriter = nullptr;
+			GUARANTEE_RECOVERABLE( false, "LogSystem: Can't open default binary log file!" );
+		}
 	}
 	else
 	{
-		delete g_logFile;
-		g_logFile = nullptr;
-		GUARANTEE_RECOVERABLE( false, "LogSystem: Can't open default log file!" );
+		// Get ready the log file
+		g_logFile			= new File();
+		bool fileGotOpened	= g_logFile->Open( fileRootName, FILE_OPEN_MODE_TRUNCATE );
+
+		// Hook it if got opened successfully
+		if( fileGotOpened )
+		{
+			if( fileFormat == LOG_FILE_FORMAT_HTML )
+			{
+				// Write HTML heading tags
+				std::string htmlUptoBodyStr = Stringf( "<html>\n<head>\n<title> %s </title>\n</head>\n\n<body>\n", fileRootName );
+				g_logFile->Write( htmlUptoBodyStr );
+
+				// Set it as a Hook
+				LogHook( WriteToFile, g_logFile );
+			}
+			else
+				LogHook( WriteToTextFile, g_logFile );
+		}
+		else
+		{
+			delete g_logFile;
+			g_logFile = nullptr;
+			GUARANTEE_RECOVERABLE( false, "LogSystem: Can't open default log file!" );
+		}
 	}
 
 	// Hook IDE output tab
@@ -97,11 +220,16 @@ void LogSystem::LoggerStartup( char const *fileRootName /*= DEFAULT_LOG_NAME */
 	{
 		m_loggerThread = new std::thread( [](){ g_logSystem->LogThread( nullptr ); } );
 	}
+
+	CommandRegister( "log_benchmark", LogBenchmark );
+	CommandRegister( "log_batch", LogBatch );
+	CommandRegister( "log_stats", LogStats );
 }
 
 void LogSystem::LoggerShutdown()
 {
 	m_isRunning = false;
+	m_wakeCondition.notify_all();
 
 	// Join the logging thread
 	if( m_loggerThread != nullptr )
@@ -112,24 +240,43 @@ void LogSystem::LoggerShutdown()
 		m_loggerThread = nullptr;
 	}
 
+	// Whatever got logged after the thread stopped
+	FlushMessages();
+
 	// Close the log file
+	bool logFileWasOpen = ( g_logFile != nullptr ) || ( m_binaryLogWriter != nullptr );
 	if( g_logFile != nullptr )
 	{
 		// Write end of the HTML header tags
-		std::string htmlEndTagStr = Stringf( "</body>\n</html>" );
-		g_logFile->Write( htmlEndTagStr );
+		if( m_logFileFormat == LOG_FILE_FORMAT_HTML )
+		{
+			std::string htmlEndTagStr = Stringf( "</body>\n</html>" );
+			g_logFile->Write( htmlEndTagStr );
+		}
 
 		// Close the file
 		g_logFile->Close();
 		delete g_logFile;
 		g_logFile = nullptr;
+	}
+
+	if( m_binaryLogWriter != nullptr )
+	{
+		m_binaryLogWriter->Close();
+		delete m_binaryLogWriter;
+		m_binaryLogWriter = nullptr;
+		m_deferFormatting = false;
+	}
 
+	if( logFileWasOpen )
+	{
 		// Make a duplicate_timestamped file as a copy
+		char const	*extensions[ NUM_LOG_FILE_FORMATS ] = { "html", "txt", "nlog" };
 		std::string timestamp			= GetCurrentTimestamp();
-		std::string logHistoryFileName	= Stringf( "log_%s.html", timestamp.c_str() );
+		std::string logHistoryFileName	= Stringf( "log_%s.%s", timestamp.c_str(), extensions[ m_logFileFormat ] );
 		std::string fullFilePath		= Stringf( "Log/%s", logHistoryFileName.c_str() );
 
-		bool success = File::Copy( DEFAULT_LOG_FILE_PATH, fullFilePath.c_str() );
+		bool success = File::Copy( m_logFilePath, fullFilePath.c_str() );
 		GUARANTEE_RECOVERABLE( success, "LogSystem: Failed to copy log file in history folder!" );
 	}
 }
@@ -168,12 +315,62 @@ void LogSystem::LogUnhook( log_cb cb, void *userArg /* = nullptr */ )
 
 void LogSystem::LogTaggedPrintv( char const *tag, Rgba const &color, char const *format, va_list args )
 {
-	std::string tagStr	= Stringf( tag );
-	std::string textStr = Stringv( format, args );
+	eLogOverflowPolicy policy = m_overflowPolicy.load( std::memory_order_relaxed );
+
+	// Claim a record in the ring
+	LogData *record = m_messageRing.TryBeginEnqueue();
+	if( record == nullptr && policy == LOG_OVERFLOW_BLOCK )
+	{
+		// Only worth waiting if there is a logger thread, and it isn't us
+		bool someoneWillDrain = IsRunning() && ( m_loggerThread != nullptr ) && ( m_loggerThread->get_id() != std::this_thread::get_id() );
 
-	// Add data to the message queue
-	LogData *newData = new LogData( tagStr, textStr, GetCurrentRawTime(), color );
-	m_messageQueue.Enqueue( newData );
+		if( someoneWillDrain )
+			m_wakeCondition.notify_one();
+
+		while( record == nullptr && someoneWillDrain )
+		{
+			std::this_thread::yield();
+			record = m_messageRing.TryBeginEnqueue();
+		}
+
+		// Nobody to wait for, don't lose the message
+		if( record == nullptr )
+			policy = LOG_OVERFLOW_SPILL;
+	}
+
+	// Format it in place
+	if( record != nullptr )
+	{
+		if( m_deferFormatting )
+			record->SetDeferred( tag, color, GetCurrentRawTime(), format, args );
+		else
+			record->Set( tag, color, GetCurrentRawTime(), format, args );
+		record->queuedSeconds = GetCurrentTimeSeconds();
+
+		// Count it before publishing, so the pending count never goes below what is in the ring
+		NotifyMessageQueued();
+		m_messageRing.EndEnqueue( record );
+		return;
+	}
+
+	// Ring is full
+	if( policy == LOG_OVERFLOW_SPILL )
+	{
+		LogData *spilledRecord = new LogData();
+		if( m_deferFormatting )
+			spilledRecord->SetDeferred( tag, color, GetCurrentRawTime(), format, args );
+		else
+			spilledRecord->Set( tag, color, GetCurrentRawTime(), format, args );
+		spilledRecord->queuedSeconds = GetCurrentTimeSeconds();
+
+		NotifyMessageQueued();
+		m_spillQueue.Enqueue( spilledRecord );
+		m_spilledMessageCount++;
+	}
+	else
+	{
+		m_droppedMessageCount++;
+	}
 }
 
 void LogSystem::LogTaggedPrintf( char const *tag, Rgba const &color, char const *format, ... )
@@ -225,13 +422,21 @@ void LogSystem::ForceFlush()
 	g_logSystem->FlushMessages();
 
 	// Make sure everything is written to file
-	g_logFile->Flush();
+	if( g_logFile != nullptr )
+		g_logFile->Flush();
+
+	if( g_logSystem->m_binaryLogWriter != nullptr )
+	{
+		g_logSystem->m_flushLock.Enter();
+		g_logSystem->m_binaryLogWriter->Flush();
+		g_logSystem->m_flushLock.Leave();
+	}
 }
 
 void LogSystem::GetAsStringFromLogData( std::string &out_logMessage, LogData const *logData )
 {
 	std::string timeStamp = GetTimeAsString( logData->time );
-	out_logMessage = Stringf( "%s %s: %s\n", timeStamp.c_str(), logData->tag.c_str(), logData->text.c_str() );
+	out_logMessage = Stringf( "%s %s: %s\n", timeStamp.c_str(), logData->tag, logData->text );
 }
 
 void LogSystem::GetAsHTMLTagFromLogData( std::string &out_logMessage, LogData const *logData )
@@ -301,30 +506,136 @@ bool LogSystem::TagIsNotHidden( std::string const &tagName )
 	return (isWhiteList) ? (tagIsInList) : (!tagIsInList);
 }
 
+void LogSystem::SetWakeUpPolicy( uint batchSize, uint intervalMS )
+{
+	// A batch bigger than the ring never fills up, so only the interval would wake the logger
+	batchSize			= ( batchSize < LOG_RING_BUFFER_CAPACITY ) ? batchSize : LOG_RING_BUFFER_CAPACITY;
+	m_wakeBatchSize		= ( batchSize > 0U ) ? batchSize : 1U;
+	m_wakeIntervalMS	= ( intervalMS > 0U ) ? intervalMS : 1U;
+
+	// Let the logger thread pick up the new policy
+	m_wakeCondition.notify_one();
+}
+
+LogSystemStats LogSystem::GetStats() const
+{
+	// Logger thread updates them while it flushes
+	m_flushLock.Enter();
+	LogSystemStats stats = m_stats;
+	m_flushLock.Leave();
+
+	return stats;
+}
+
 void LogSystem::LogThread( void * )
 {
-	while ( IsRunning() ) {
-		FlushMessages(); 
-		std::this_thread::sleep_for( std::chrono::milliseconds(10) ); // Better yet, you can use a signal or semaphore that signaled when a message is logged; 
+	while ( IsRunning() ) 
+	{
+		// Sleep till a batch is ready, or the interval runs out
+		bool batchIsReady = false;
+		{
+			std::unique_lock< std::mutex > wakeLock( m_wakeLock );
+			batchIsReady = m_wakeCondition.wait_for( wakeLock, std::chrono::milliseconds( m_wakeIntervalMS.load() ), [this]() 
+			{ 
+				return ( IsRunning() == false ) || ( m_pendingMessageCount.load( std::memory_order_relaxed ) >= m_wakeBatchSize.load( std::memory_order_relaxed ) );
+			} );
+		}
+
+		m_flushLock.Enter();
+		if( batchIsReady )
+			m_stats.wakeUpsOnBatchSize++;
+		else
+			m_stats.wakeUpsOnInterval++;
+		m_flushLock.Leave();
+
+		if( m_pendingMessageCount.load( std::memory_order_relaxed ) > 0U )
+			FlushMessages(); 
 	}
 }
 
+void LogSystem::NotifyMessageQueued()
+{
+	// Wake the logger thread once per batch; if the notification gets missed, the interval picks it up
+	uint pendingCount = m_pendingMessageCount.fetch_add( 1, std::memory_order_relaxed ) + 1U;
+	if( pendingCount == m_wakeBatchSize.load( std::memory_order_relaxed ) )
+		m_wakeCondition.notify_one();
+}
+
 void LogSystem::FlushMessages()
 {
-	LogData *log = nullptr;
+	// The ring buffer takes a single consumer
+	m_flushLock.Enter();
 
-	while ( m_messageQueue.Dequeue(&log) ) 
+	double	flushStartSeconds	= GetCurrentTimeSeconds();
+	uint	processedCount		= 0U;
+
+	// Records are read in place, then handed back to the producers
+	for( LogData *log = m_messageRing.TryBeginDequeue(); log != nullptr; log = m_messageRing.TryBeginDequeue() )
 	{
-		for ( uint idx = 0; idx < m_hooks.GetSize(); idx++ )
-		{
-			LogHookData hook = m_hooks.GetAtIndex( idx );
+		double latencySeconds			= GetCurrentTimeSeconds() - log->queuedSeconds;
+		m_stats.totalLatencySeconds	   += latencySeconds;
+		m_stats.maxLatencySeconds		= ( latencySeconds > m_stats.maxLatencySeconds ) ? latencySeconds : m_stats.maxLatencySeconds;
+
+		ProcessMessage( log );
+		m_messageRing.EndDequeue( log );
+		processedCount++;
+	}
+
+	// Whatever overflowed the ring
+	LogData *spilledLog = nullptr;
+	while ( m_spillQueue.Dequeue( &spilledLog ) ) 
+	{
+		double latencySeconds			= GetCurrentTimeSeconds() - spilledLog->queuedSeconds;
+		m_stats.totalLatencySeconds	   += latencySeconds;
+		m_stats.maxLatencySeconds		= ( latencySeconds > m_stats.maxLatencySeconds ) ? latencySeconds : m_stats.maxLatencySeconds;
+
+		ProcessMessage( spilledLog );
+		processedCount++;
 
-			// call only if tag is not filtered out
-			if( TagIsNotHidden( log->tag ) )
-				hook.callback( log, hook.userArgument ); 
-		}
-		
 		// free up the log;
-		delete log; 
+		delete spilledLog; 
+	}
+
+	if( processedCount > 0U )
+	{
+		m_pendingMessageCount.fetch_sub( processedCount, std::memory_order_relaxed );
+
+		m_stats.processedMessages	+= processedCount;
+		m_stats.flushes				+= 1U;
+		m_stats.totalFlushSeconds	+= GetCurrentTimeSeconds() - flushStartSeconds;
+	}
+
+	m_flushLock.Leave();
+}
+
+void LogSystem::ProcessMessage( LogData const *log )
+{
+	// call only if tag is not filtered out
+	if( TagIsNotHidden( log->tag ) == false )
+		return;
+
+	// Binary log takes the record as it is
+	if( m_binaryLogWriter != nullptr )
+		m_binaryLogWriter->WriteMessage( *log );
+
+	uint hookCount = m_hooks.GetSize();
+	if( hookCount == 0 )
+		return;
+
+	// Hooks want the text, format it only now
+	if( log->isDeferred )
+	{
+		strncpy_s( m_deferredScratch.tag, LOG_MAX_TAG_LENGTH, log->tag, _TRUNCATE );
+		LogFormatPackedArguments( log->text, log->packedArgs, log->packedArgsSize, m_deferredScratch.text, LOG_MAX_TEXT_LENGTH );
+		m_deferredScratch.color	= log->color;
+		m_deferredScratch.time	= log->time;
+
+		log = &m_deferredScratch;
+	}
+
+	for ( uint idx = 0; idx < hookCount; idx++ )
+	{
+		LogHookData hook = m_hooks.GetAtIndex( idx );
+		hook.callback( log, hook.userArgument ); 
 	}
 }
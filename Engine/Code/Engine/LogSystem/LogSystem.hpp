@@ -1,33 +1,99 @@
 #pragma once
 #include <string>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
 #include "Engine/Core/Rgba.hpp"
 #include "Engine/LogSystem/SpinLock.hpp"
+#include "Engine/LogSystem/BinaryLog.hpp"
+#include "Engine/LogSystem/LogFormat.hpp"
+#include "Engine/LogSystem/MPSCRingBuffer.hpp"
 #include "Engine/LogSystem/ThreadSafeQueue.hpp"
 #include "Engine/LogSystem/ThreadSafeVector.hpp"
 
 #define DEFAULT_LOG_FILE_PATH ("Log/log.html")
 #define DEFAULT_LOG_HISTORY_FOLDER ("Log/History/")
+#define DEFAULT_BINARY_LOG_FILE_PATH ("Log/log.nlog")
+
+#define LOG_MAX_TAG_LENGTH			(32)
+#define LOG_MAX_TEXT_LENGTH			(480)
+#define LOG_MAX_PACKED_ARGS_SIZE	(256)
+#define LOG_RING_BUFFER_CAPACITY	(1024)		// Has to be a power of two
+
+#define LOG_DEFAULT_WAKE_BATCH_SIZE		(64)		// Logger thread wakes up when these many messages are waiting,
+#define LOG_DEFAULT_WAKE_INTERVAL_MS	(10)		//		or after this long, whichever comes first
 
 struct LogData;
 
 typedef void ( *log_cb ) ( LogData const *log, void *argument );
 
+// What a producer does when the ring buffer is full
+enum eLogOverflowPolicy
+{
+	LOG_OVERFLOW_DROP = 0,		// Lose the message, but count it
+	LOG_OVERFLOW_BLOCK,			// Wait for the logger thread to make some room
+	LOG_OVERFLOW_SPILL,			// Heap allocate it in to a locked spill queue
+	NUM_LOG_OVERFLOW_POLICIES
+};
+
+//------------------------------------------------------------------------------------------
+// Fixed size log record, so it can live inline in the ring buffer
+//	- Tag & text longer than the storage get truncated
+//	- A deferred record keeps the format string in text, and its arguments packed
+//
 struct LogData
 {
-	std::string tag;
-	std::string text;
+	char		tag[ LOG_MAX_TAG_LENGTH ];
+	char		text[ LOG_MAX_TEXT_LENGTH ];
 	Rgba		color;
 	time_t		time;
+	double		queuedSeconds	= 0.0;		// For the latency stats
+
+	bool		isDeferred		= false;
+	uint16_t	packedArgsSize	= 0U;
+	byte_t		packedArgs[ LOG_MAX_PACKED_ARGS_SIZE ];
 
-	LogData( std::string &inTag, std::string &inText, time_t const &entryTime, Rgba const &textColor = RGBA_BLACK_COLOR )
+	void Set( char const *inTag, Rgba const &textColor, time_t const &entryTime, char const *format, va_list args )
 	{
-		tag		= inTag;
-		text	= inText;
-		color	= textColor;
-		time	= entryTime;
+		strncpy_s( tag, LOG_MAX_TAG_LENGTH, inTag, _TRUNCATE );
+		vsnprintf_s( text, LOG_MAX_TEXT_LENGTH, _TRUNCATE, format, args );
+
+		color			= textColor;
+		time			= entryTime;
+		isDeferred		= false;
+		packedArgsSize	= 0U;
+	}
+
+	void SetDeferred( char const *inTag, Rgba const &textColor, time_t const &entryTime, char const *format, va_list args )
+	{
+		strncpy_s( tag, LOG_MAX_TAG_LENGTH, inTag, _TRUNCATE );
+		strncpy_s( text, LOG_MAX_TEXT_LENGTH, format, _TRUNCATE );
+
+		// Pack against the copy, so a truncated format string still lines up with its arguments
+		packedArgsSize	= (uint16_t) LogPackArguments( text, args, packedArgs, LOG_MAX_PACKED_ARGS_SIZE );
+		color			= textColor;
+		time			= entryTime;
+		isDeferred		= true;
 	}
 };
 
+// Written by the consuming thread only, under its flush lock
+struct LogSystemStats
+{
+	double		startSeconds			= 0.0;
+	uint64_t	processedMessages		= 0U;
+	uint64_t	flushes					= 0U;		// Non empty ones
+	uint64_t	wakeUpsOnBatchSize		= 0U;
+	uint64_t	wakeUpsOnInterval		= 0U;
+	double		totalLatencySeconds		= 0.0;		// LogTaggedPrintv() to the hooks
+	double		maxLatencySeconds		= 0.0;
+	double		totalFlushSeconds		= 0.0;
+};
+
 struct LogHookData
 {
 	log_cb	 callback;
@@ -55,10 +121,32 @@ public:
 	~LogSystem();
 
 private:
-	bool							 m_isRunning	= false;
+	std::atomic<bool>				 m_isRunning	{ false };
 	std::thread						*m_loggerThread	= nullptr;
 	ThreadSafeVector< LogHookData >	 m_hooks;
-	ThreadSafeQueue< LogData* >		 m_messageQueue;
+
+	// Message Queue - producers format straight in to the ring, overflow goes as per the policy
+	MPSCRingBuffer< LogData, LOG_RING_BUFFER_CAPACITY >	 m_messageRing;
+	ThreadSafeQueue< LogData* >							 m_spillQueue;
+	mutable SpinLock									 m_flushLock;		// ForceFlush() & the logger thread, both consume; guards m_stats too
+	std::atomic<eLogOverflowPolicy>						 m_overflowPolicy		{ LOG_OVERFLOW_SPILL };
+	std::atomic<uint>									 m_droppedMessageCount	{ 0 };
+	std::atomic<uint>									 m_spilledMessageCount	{ 0 };
+
+	// Logger thread sleeps on this till a batch is ready
+	std::mutex											 m_wakeLock;
+	std::condition_variable								 m_wakeCondition;
+	std::atomic<uint>									 m_pendingMessageCount	{ 0 };
+	std::atomic<uint>									 m_wakeBatchSize		{ LOG_DEFAULT_WAKE_BATCH_SIZE };
+	std::atomic<uint>									 m_wakeIntervalMS		{ LOG_DEFAULT_WAKE_INTERVAL_MS };
+	LogSystemStats										 m_stats;
+
+	// Log File
+	std::string											 m_logFilePath;
+	eLogFileFormat										 m_logFileFormat		= LOG_FILE_FORMAT_HTML;
+	bool												 m_deferFormatting		= false;		// Binary log packs the arguments, instead of formatting them
+	BinaryLogWriter										*m_binaryLogWriter		= nullptr;
+	LogData												 m_deferredScratch;						// Deferred records get formatted here, for the hooks
 
 	// Filter list ( Blacklist / Whitelist )
 	bool							 m_IsFilterListBlack = true;
@@ -69,7 +157,7 @@ public:
 
 public:
 	// Startup & Shutdown
-	void		LoggerStartup( char const *fileRootName = DEFAULT_LOG_FILE_PATH );
+	void		LoggerStartup( char const *fileRootName = DEFAULT_LOG_FILE_PATH, eLogFileFormat fileFormat = LOG_FILE_FORMAT_HTML );
 	void		LoggerShutdown();
 	bool inline IsRunning() { return m_isRunning; }
 
@@ -78,6 +166,18 @@ public:
 	void LogHook	( log_cb cb, void *userArg = nullptr ); 
 	void LogUnhook	( log_cb cb, void *userArg = nullptr );
 	
+	// Overflow
+	void				SetOverflowPolicy( eLogOverflowPolicy policy ) { m_overflowPolicy = policy; }
+	eLogOverflowPolicy	GetOverflowPolicy() const { return m_overflowPolicy; }
+	uint				GetDroppedMessageCount() const { return m_droppedMessageCount; }
+	uint				GetSpilledMessageCount() const { return m_spilledMessageCount; }
+
+	// Batching
+	void				SetWakeUpPolicy( uint batchSize, uint intervalMS );
+	uint				GetWakeBatchSize() const { return m_wakeBatchSize; }
+	uint				GetWakeIntervalMS() const { return m_wakeIntervalMS; }
+	LogSystemStats		GetStats() const;		// A consistent copy, takes the flush lock
+
 	// Logging Call
 	void LogTaggedPrintv( char const *tag, Rgba const &color, char const *format, va_list args ); 
 	void LogTaggedPrintf( char const *tag, Rgba const &color, char const *format, ... );
@@ -104,5 +204,7 @@ private:
 
 private:
 	void LogThread( void * );
+	void NotifyMessageQueued();
 	void FlushMessages();
+	void ProcessMessage( LogData const *log );
 };
\ No newline at end of file
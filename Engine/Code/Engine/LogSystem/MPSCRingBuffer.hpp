@@ -0,0 +1,118 @@
+#pragma once
+#include <atomic>
+#include "Engine/Core/EngineCommon.hpp"
+
+//------------------------------------------------------------------------------------------
+// Bounded, lock-free, Multi-Producer/Single-Consumer ring buffer
+//	- Every cell carries a sequence number which tells whose turn it is ( D. Vyukov's bounded queue )
+//	- Producers race on a single atomic counter to claim a cell, then write it in place
+//	- Single consumer reads cells in place and hands them back to producers
+//	- CAPACITY has to be a power of two
+//
+// Usage,
+//		T *slot = ring.TryBeginEnqueue();		// nullptr if full
+//		if( slot != nullptr ) { ...fill... ring.EndEnqueue( slot ); }
+//
+//		T *next = ring.TryBeginDequeue();		// consumer thread only
+//		if( next != nullptr ) { ...read... ring.EndDequeue( next ); }
+//
+template <typename T, uint CAPACITY>
+class MPSCRingBuffer
+{
+	static_assert( ( CAPACITY & (CAPACITY - 1) ) == 0, "MPSCRingBuffer: CAPACITY must be a power of two!" );
+
+private:
+	struct Cell
+	{
+		T						data;			// Keep it first: EndEnqueue() gets the cell back from data's address
+		std::atomic<size_t>		sequence;
+	};
+
+public:
+	MPSCRingBuffer()
+	{
+		m_cells = new Cell[ CAPACITY ];
+
+		for( size_t i = 0; i < CAPACITY; i++ )
+			m_cells[i].sequence.store( i, std::memory_order_relaxed );
+	}
+
+	~MPSCRingBuffer()
+	{
+		delete[] m_cells;
+		m_cells = nullptr;
+	}
+
+private:
+	Cell					*m_cells	= nullptr;
+
+	// Producers and the consumer are on separate cache lines, so they don't false share
+	char					m_paddingA[ 64 ];
+	std::atomic<size_t>		m_enqueuePosition	{ 0 };
+	char					m_paddingB[ 64 ];
+	size_t					m_dequeuePosition	= 0;		// Touched only by the consumer
+
+public:
+	// Producers
+	T* TryBeginEnqueue()
+	{
+		size_t position = m_enqueuePosition.load( std::memory_order_relaxed );
+
+		for( ;; )
+		{
+			Cell		*cell		= &m_cells[ position & (CAPACITY - 1) ];
+			size_t		 sequence	= cell->sequence.load( std::memory_order_acquire );
+			intptr_t	 difference	= (intptr_t)sequence - (intptr_t)position;
+
+			if( difference == 0 )
+			{
+				// Cell is free at this position, try to claim it
+				if( m_enqueuePosition.compare_exchange_weak( position, position + 1, std::memory_order_relaxed ) )
+					return &cell->data;
+			}
+			else if( difference < 0 )
+			{
+				// Consumer hasn't released this cell since the last lap => full
+				return nullptr;
+			}
+			else
+			{
+				// Another producer got here first
+				position = m_enqueuePosition.load( std::memory_order_relaxed );
+			}
+		}
+	}
+
+	void EndEnqueue( T *slot )
+	{
+		Cell	*cell		= reinterpret_cast< Cell* >( slot );
+		size_t	 sequence	= cell->sequence.load( std::memory_order_relaxed );
+
+		// Publish it for the consumer
+		cell->sequence.store( sequence + 1, std::memory_order_release );
+	}
+
+	// Consumer
+	T* TryBeginDequeue()
+	{
+		Cell	*cell		= &m_cells[ m_dequeuePosition & (CAPACITY - 1) ];
+		size_t	 sequence	= cell->sequence.load( std::memory_order_acquire );
+
+		// Empty, or the producer which claimed it is still writing
+		if( sequence != m_dequeuePosition + 1 )
+			return nullptr;
+
+		return &cell->data;
+	}
+
+	void EndDequeue( T *slot )
+	{
+		Cell *cell = reinterpret_cast< Cell* >( slot );
+
+		// Hand it back to the producers, for the next lap
+		cell->sequence.store( m_dequeuePosition + CAPACITY, std::memory_order_release );
+		m_dequeuePosition++;
+	}
+
+	uint GetCapacity() const { return CAPACITY; }
+};
@@ -0,0 +1,507 @@
+#pragma once
+#include "DynamicAABBTree.hpp"
+
+static inline void SetToUnion( AABB3 &out, AABB3 const &a, AABB3 const &b )
+{
+	// Fields one by one; AABB3 & Vector3 constructors aren't inline, and this runs for every level of every update
+	out.mins.x = ( a.mins.x < b.mins.x ) ? a.mins.x : b.mins.x;
+	out.mins.y = ( a.mins.y < b.mins.y ) ? a.mins.y : b.mins.y;
+	out.mins.z = ( a.mins.z < b.mins.z ) ? a.mins.z : b.mins.z;
+	out.maxs.x = ( a.maxs.x > b.maxs.x ) ? a.maxs.x : b.maxs.x;
+	out.maxs.y = ( a.maxs.y > b.maxs.y ) ? a.maxs.y : b.maxs.y;
+	out.maxs.z = ( a.maxs.z > b.maxs.z ) ? a.maxs.z : b.maxs.z;
+}
+
+static inline float GetSurfaceArea( AABB3 const &box )
+{
+	float x = box.maxs.x - box.mins.x;
+	float y = box.maxs.y - box.mins.y;
+	float z = box.maxs.z - box.mins.z;
+
+	return 2.f * ( x * y + y * z + z * x );
+}
+
+static inline float GetUnionSurfaceArea( AABB3 const &a, AABB3 const &b )
+{
+	float x = ( ( a.maxs.x > b.maxs.x ) ? a.maxs.x : b.maxs.x ) - ( ( a.mins.x < b.mins.x ) ? a.mins.x : b.mins.x );
+	float y = ( ( a.maxs.y > b.maxs.y ) ? a.maxs.y : b.maxs.y ) - ( ( a.mins.y < b.mins.y ) ? a.mins.y : b.mins.y );
+	float z = ( ( a.maxs.z > b.maxs.z ) ? a.maxs.z : b.maxs.z ) - ( ( a.mins.z < b.mins.z ) ? a.mins.z : b.mins.z );
+
+	return 2.f * ( x * y + y * z + z * x );
+}
+
+static inline bool DoesContain( AABB3 const &outer, AABB3 const &inner )
+{
+	return	outer.mins.x <= inner.mins.x && outer.mins.y <= inner.mins.y && outer.mins.z <= inner.mins.z &&
+			outer.maxs.x >= inner.maxs.x && outer.maxs.y >= inner.maxs.y && outer.maxs.z >= inner.maxs.z;
+}
+
+static inline bool DoOverlap( AABB3 const &a, AABB3 const &b )
+{
+	return	a.mins.x <= b.maxs.x && a.maxs.x >= b.mins.x &&
+			a.mins.y <= b.maxs.y && a.maxs.y >= b.mins.y &&
+			a.mins.z <= b.maxs.z && a.maxs.z >= b.mins.z;
+}
+
+static inline int GetMaxInt( int a, int b )
+{
+	return ( a > b ) ? a : b;
+}
+
+DynamicAABBTree::DynamicAABBTree( float fatMargin /* = DYNAMIC_AABB_TREE_FAT_MARGIN */ )
+	: m_fatMargin( fatMargin )
+{
+
+}
+
+int DynamicAABBTree::CreateProxy( AABB3 const &bounds, void *userData )
+{
+	Vector3	margin	= Vector3( m_fatMargin, m_fatMargin, m_fatMargin );
+	int		proxyID	= AllocateNode();
+
+	DynamicAABBTreeNode &leaf	= m_nodes[ proxyID ];
+	leaf.bounds					= AABB3( bounds.mins - margin, bounds.maxs + margin );
+	leaf.userData				= userData;
+	leaf.height					= 0;
+
+	InsertLeaf( proxyID );
+	m_proxyCount++;
+
+	return proxyID;
+}
+
+void DynamicAABBTree::DestroyProxy( int proxyID )
+{
+	GUARANTEE_RECOVERABLE( proxyID >= 0 && proxyID < (int)m_nodes.size() && m_nodes[ proxyID ].IsLeaf() && m_nodes[ proxyID ].height == 0, "DynamicAABBTree: Not a proxy!" );
+
+	RemoveLeaf( proxyID );
+	FreeNode( proxyID );
+	m_proxyCount--;
+}
+
+bool DynamicAABBTree::MoveProxy( int proxyID, AABB3 const &bounds, Vector3 const &displacement )
+{
+	if( DoesContain( m_nodes[ proxyID ].bounds, bounds ) )
+		return false;
+
+	RemoveLeaf( proxyID );
+
+	// Fat box also reaches where it's heading, so a steady mover doesn't need a reinsert every few frames
+	AABB3 &fatBounds	= m_nodes[ proxyID ].bounds;
+	fatBounds.mins.x	= bounds.mins.x - m_fatMargin;
+	fatBounds.mins.y	= bounds.mins.y - m_fatMargin;
+	fatBounds.mins.z	= bounds.mins.z - m_fatMargin;
+	fatBounds.maxs.x	= bounds.maxs.x + m_fatMargin;
+	fatBounds.maxs.y	= bounds.maxs.y + m_fatMargin;
+	fatBounds.maxs.z	= bounds.maxs.z + m_fatMargin;
+
+	float const predictX = displacement.x * DYNAMIC_AABB_TREE_DISPLACEMENT_MULTIPLIER;
+	float const predictY = displacement.y * DYNAMIC_AABB_TREE_DISPLACEMENT_MULTIPLIER;
+	float const predictZ = displacement.z * DYNAMIC_AABB_TREE_DISPLACEMENT_MULTIPLIER;
+	fatBounds.mins.x	+= ( predictX < 0.f ) ? predictX : 0.f;
+	fatBounds.mins.y	+= ( predictY < 0.f ) ? predictY : 0.f;
+	fatBounds.mins.z	+= ( predictZ < 0.f ) ? predictZ : 0.f;
+	fatBounds.maxs.x	+= ( predictX > 0.f ) ? predictX : 0.f;
+	fatBounds.maxs.y	+= ( predictY > 0.f ) ? predictY : 0.f;
+	fatBounds.maxs.z	+= ( predictZ > 0.f ) ? predictZ : 0.f;
+
+	InsertLeaf( proxyID );
+	return true;
+}
+
+void DynamicAABBTree::Clear()
+{
+	m_nodes.clear();
+	m_root			= DYNAMIC_AABB_TREE_NULL_NODE;
+	m_freeList		= DYNAMIC_AABB_TREE_NULL_NODE;
+	m_proxyCount	= 0U;
+}
+
+void DynamicAABBTree::QueryBox( AABB3 const &box, std::vector< void* > &outUserData ) const
+{
+	if( m_root == DYNAMIC_AABB_TREE_NULL_NODE )
+		return;
+
+	m_queryStack.clear();
+	m_queryStack.push_back( m_root );
+	while( m_queryStack.empty() == false )
+	{
+		DynamicAABBTreeNode const &node = m_nodes[ m_queryStack.back() ];
+		m_queryStack.pop_back();
+
+		if( DoOverlap( node.bounds, box ) == false )
+			continue;
+
+		if( node.IsLeaf() )
+			outUserData.push_back( node.userData );
+		else
+		{
+			m_queryStack.push_back( node.child1 );
+			m_queryStack.push_back( node.child2 );
+		}
+	}
+}
+
+void DynamicAABBTree::QuerySphere( Sphere const &sphere, std::vector< void* > &outUserData ) const
+{
+	if( m_root == DYNAMIC_AABB_TREE_NULL_NODE )
+		return;
+
+	float radiusSq = sphere.radius * sphere.radius;
+
+	m_queryStack.clear();
+	m_queryStack.push_back( m_root );
+	while( m_queryStack.empty() == false )
+	{
+		DynamicAABBTreeNode const &node = m_nodes[ m_queryStack.back() ];
+		m_queryStack.pop_back();
+
+		// Distance from the closest point of the box
+		Vector3 const	&c	= sphere.center;
+		float			 dx	= ( c.x < node.bounds.mins.x ) ? ( node.bounds.mins.x - c.x ) : ( ( c.x > node.bounds.maxs.x ) ? ( c.x - node.bounds.maxs.x ) : 0.f );
+		float			 dy	= ( c.y < node.bounds.mins.y ) ? ( node.bounds.mins.y - c.y ) : ( ( c.y > node.bounds.maxs.y ) ? ( c.y - node.bounds.maxs.y ) : 0.f );
+		float			 dz	= ( c.z < node.bounds.mins.z ) ? ( node.bounds.mins.z - c.z ) : ( ( c.z > node.bounds.maxs.z ) ? ( c.z - node.bounds.maxs.z ) : 0.f );
+		if( dx * dx + dy * dy + dz * dz > radiusSq )
+			continue;
+
+		if( node.IsLeaf() )
+			outUserData.push_back( node.userData );
+		else
+		{
+			m_queryStack.push_back( node.child1 );
+			m_queryStack.push_back( node.child2 );
+		}
+	}
+}
+
+void DynamicAABBTree::QueryRay( Vector3 const &start, Vector3 const &direction, float maxDistance, std::vector< void* > &outUserData ) const
+{
+	if( m_root == DYNAMIC_AABB_TREE_NULL_NODE )
+		return;
+
+	// Slabs; an axis the ray is parallel to just needs the start inside of it
+	float const directions[3]	= { direction.x, direction.y, direction.z };
+	float const invs[3]			= { ( direction.x != 0.f ) ? 1.f / direction.x : 0.f, ( direction.y != 0.f ) ? 1.f / direction.y : 0.f, ( direction.z != 0.f ) ? 1.f / direction.z : 0.f };
+	float const starts[3]		= { start.x, start.y, start.z };
+
+	m_queryStack.clear();
+	m_queryStack.push_back( m_root );
+	while( m_queryStack.empty() == false )
+	{
+		DynamicAABBTreeNode const &node = m_nodes[ m_queryStack.back() ];
+		m_queryStack.pop_back();
+
+		float tMin = 0.f;
+		float tMax = maxDistance;
+		bool  isHit = true;
+
+		float const mins[3]		= { node.bounds.mins.x, node.bounds.mins.y, node.bounds.mins.z };
+		float const maxs[3]		= { node.bounds.maxs.x, node.bounds.maxs.y, node.bounds.maxs.z };
+		for( uint axis = 0; axis < 3U && isHit; axis++ )
+		{
+			if( directions[ axis ] == 0.f )
+			{
+				isHit = ( starts[ axis ] >= mins[ axis ] ) && ( starts[ axis ] <= maxs[ axis ] );
+				continue;
+			}
+
+			float t1 = ( mins[ axis ] - starts[ axis ] ) * invs[ axis ];
+			float t2 = ( maxs[ axis ] - starts[ axis ] ) * invs[ axis ];
+			float tNear = ( t1 < t2 ) ? t1 : t2;
+			float tFar  = ( t1 < t2 ) ? t2 : t1;
+
+			tMin	= ( tNear > tMin ) ? tNear : tMin;
+			tMax	= ( tFar < tMax ) ? tFar : tMax;
+			isHit	= ( tMin <= tMax );
+		}
+
+		if( isHit == false )
+			continue;
+
+		if( node.IsLeaf() )
+			outUserData.push_back( node.userData );
+		else
+		{
+			m_queryStack.push_back( node.child1 );
+			m_queryStack.push_back( node.child2 );
+		}
+	}
+}
+
+void DynamicAABBTree::QueryPlanes( Plane3 const *planes, uint planeCount, std::vector< void* > &outUserData ) const
+{
+	if( m_root == DYNAMIC_AABB_TREE_NULL_NODE )
+		return;
+
+	m_queryStack.clear();
+	m_queryStack.push_back( m_root );
+	while( m_queryStack.empty() == false )
+	{
+		int							 nodeIdx	= m_queryStack.back();
+		DynamicAABBTreeNode const	&node		= m_nodes[ nodeIdx ];
+		m_queryStack.pop_back();
+
+		// Corner most along each normal decides outside; the opposite one, if it's crossing the plane
+		bool isOutside	= false;
+		bool isCrossing	= false;
+		for( uint i = 0; i < planeCount && isOutside == false; i++ )
+		{
+			Plane3 const	&plane		= planes[i];
+			bool			 posX		= plane.normal.x >= 0.f;
+			bool			 posY		= plane.normal.y >= 0.f;
+			bool			 posZ		= plane.normal.z >= 0.f;
+			float			 farthest	= ( posX ? node.bounds.maxs.x : node.bounds.mins.x ) * plane.normal.x
+										+ ( posY ? node.bounds.maxs.y : node.bounds.mins.y ) * plane.normal.y
+										+ ( posZ ? node.bounds.maxs.z : node.bounds.mins.z ) * plane.normal.z - plane.d;
+			float			 nearest	= ( posX ? node.bounds.mins.x : node.bounds.maxs.x ) * plane.normal.x
+										+ ( posY ? node.bounds.mins.y : node.bounds.maxs.y ) * plane.normal.y
+										+ ( posZ ? node.bounds.mins.z : node.bounds.maxs.z ) * plane.normal.z - plane.d;
+
+			isOutside	= ( farthest < 0.f );
+			isCrossing	= isCrossing || ( nearest < 0.f );
+		}
+
+		if( isOutside )
+			continue;
+
+		if( node.IsLeaf() )
+			outUserData.push_back( node.userData );
+		else if( isCrossing == false )
+			AddSubtree( nodeIdx, outUserData );
+		else
+		{
+			m_queryStack.push_back( node.child1 );
+			m_queryStack.push_back( node.child2 );
+		}
+	}
+}
+
+int DynamicAABBTree::AllocateNode()
+{
+	if( m_freeList == DYNAMIC_AABB_TREE_NULL_NODE )
+	{
+		m_nodes.push_back( DynamicAABBTreeNode() );
+		return (int)m_nodes.size() - 1;
+	}
+
+	int nodeIdx	= m_freeList;
+	m_freeList	= m_nodes[ nodeIdx ].parent;
+
+	m_nodes[ nodeIdx ] = DynamicAABBTreeNode();
+	return nodeIdx;
+}
+
+void DynamicAABBTree::FreeNode( int nodeIdx )
+{
+	DynamicAABBTreeNode &node = m_nodes[ nodeIdx ];
+	node.userData	= nullptr;
+	node.child1		= DYNAMIC_AABB_TREE_NULL_NODE;
+	node.child2		= DYNAMIC_AABB_TREE_NULL_NODE;
+	node.height		= -1;
+	node.parent		= m_freeList;
+
+	m_freeList = nodeIdx;
+}
+
+void DynamicAABBTree::InsertLeaf( int leafIdx )
+{
+	if( m_root == DYNAMIC_AABB_TREE_NULL_NODE )
+	{
+		m_root = leafIdx;
+		m_nodes[ leafIdx ].parent = DYNAMIC_AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	// Find the best sibling: the one which adds the least surface area, counting what its parents grow too
+	AABB3	leafBounds	= m_nodes[ leafIdx ].bounds;
+	int		nodeIdx		= m_root;
+	while( m_nodes[ nodeIdx ].IsLeaf() == false )
+	{
+		DynamicAABBTreeNode const &node = m_nodes[ nodeIdx ];
+
+		float area				= GetSurfaceArea( node.bounds );
+		float combinedArea		= GetUnionSurfaceArea( node.bounds, leafBounds );
+		float siblingCost		= 2.f * combinedArea;						// New parent, here
+		float inheritanceCost	= 2.f * ( combinedArea - area );			// Growth of this node, if it goes further down
+
+		float childCosts[2];
+		int   children[2] = { node.child1, node.child2 };
+		for( uint i = 0; i < 2U; i++ )
+		{
+			DynamicAABBTreeNode const	&child		= m_nodes[ children[i] ];
+			float						 unionArea	= GetUnionSurfaceArea( child.bounds, leafBounds );
+
+			childCosts[i] = child.IsLeaf() ? ( unionArea + inheritanceCost ) : ( unionArea - GetSurfaceArea( child.bounds ) + inheritanceCost );
+		}
+
+		if( siblingCost < childCosts[0] && siblingCost < childCosts[1] )
+			break;
+
+		nodeIdx = ( childCosts[0] < childCosts[1] ) ? children[0] : children[1];
+	}
+
+	// New parent of the sibling & the leaf
+	int siblingIdx		= nodeIdx;
+	int oldParentIdx	= m_nodes[ siblingIdx ].parent;
+	int newParentIdx	= AllocateNode();				// Might move the nodes, so no references are held across
+
+	DynamicAABBTreeNode &newParent	= m_nodes[ newParentIdx ];
+	newParent.parent				= oldParentIdx;
+	SetToUnion( newParent.bounds, leafBounds, m_nodes[ siblingIdx ].bounds );
+	newParent.height				= m_nodes[ siblingIdx ].height + 1;
+	newParent.child1				= siblingIdx;
+	newParent.child2				= leafIdx;
+
+	if( oldParentIdx != DYNAMIC_AABB_TREE_NULL_NODE )
+	{
+		DynamicAABBTreeNode &oldParent = m_nodes[ oldParentIdx ];
+		if( oldParent.child1 == siblingIdx )
+			oldParent.child1 = newParentIdx;
+		else
+			oldParent.child2 = newParentIdx;
+	}
+	else
+		m_root = newParentIdx;
+
+	m_nodes[ siblingIdx ].parent	= newParentIdx;
+	m_nodes[ leafIdx ].parent		= newParentIdx;
+
+	// Fix the boxes & heights on the way up, balancing as it goes
+	nodeIdx = newParentIdx;
+	while( nodeIdx != DYNAMIC_AABB_TREE_NULL_NODE )
+	{
+		nodeIdx = Balance( nodeIdx );
+		UpdateFromChildren( nodeIdx );
+
+		nodeIdx = m_nodes[ nodeIdx ].parent;
+	}
+}
+
+void DynamicAABBTree::RemoveLeaf( int leafIdx )
+{
+	if( leafIdx == m_root )
+	{
+		m_root = DYNAMIC_AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	// Sibling takes the place of the parent
+	int parentIdx		= m_nodes[ leafIdx ].parent;
+	int grandParentIdx	= m_nodes[ parentIdx ].parent;
+	int siblingIdx		= ( m_nodes[ parentIdx ].child1 == leafIdx ) ? m_nodes[ parentIdx ].child2 : m_nodes[ parentIdx ].child1;
+
+	FreeNode( parentIdx );
+	m_nodes[ siblingIdx ].parent = grandParentIdx;
+
+	if( grandParentIdx == DYNAMIC_AABB_TREE_NULL_NODE )
+	{
+		m_root = siblingIdx;
+		return;
+	}
+
+	DynamicAABBTreeNode &grandParent = m_nodes[ grandParentIdx ];
+	if( grandParent.child1 == parentIdx )
+		grandParent.child1 = siblingIdx;
+	else
+		grandParent.child2 = siblingIdx;
+
+	int nodeIdx = grandParentIdx;
+	while( nodeIdx != DYNAMIC_AABB_TREE_NULL_NODE )
+	{
+		nodeIdx = Balance( nodeIdx );
+		UpdateFromChildren( nodeIdx );
+
+		nodeIdx = m_nodes[ nodeIdx ].parent;
+	}
+}
+
+int DynamicAABBTree::Balance( int idxA )
+{
+	//        A
+	//      /   \
+	//     B     C
+	//    / \   / \
+	//   D   E F   G
+	// If one child is more than a level taller, it rotates up & A takes its shorter child
+	DynamicAABBTreeNode &a = m_nodes[ idxA ];
+	if( a.IsLeaf() || a.height < 2 )
+		return idxA;
+
+	int idxB = a.child1;
+	int idxC = a.child2;
+	DynamicAABBTreeNode &b = m_nodes[ idxB ];
+	DynamicAABBTreeNode &c = m_nodes[ idxC ];
+
+	int balance = c.height - b.height;
+	if( balance > 1 || balance < -1 )
+	{
+		// Taller one goes up
+		int					 idxUp		= ( balance > 1 ) ? idxC : idxB;
+		int					 idxStay	= ( balance > 1 ) ? idxB : idxC;
+		DynamicAABBTreeNode	&up			= m_nodes[ idxUp ];
+		DynamicAABBTreeNode	&stay		= m_nodes[ idxStay ];
+		int					 idxF		= up.child1;
+		int					 idxG		= up.child2;
+		DynamicAABBTreeNode	&f			= m_nodes[ idxF ];
+		DynamicAABBTreeNode	&g			= m_nodes[ idxG ];
+
+		up.child1	= idxA;
+		up.parent	= a.parent;
+		a.parent	= idxUp;
+
+		if( up.parent != DYNAMIC_AABB_TREE_NULL_NODE )
+		{
+			DynamicAABBTreeNode &upParent = m_nodes[ up.parent ];
+			if( upParent.child1 == idxA )
+				upParent.child1 = idxUp;
+			else
+				upParent.child2 = idxUp;
+		}
+		else
+			m_root = idxUp;
+
+		// The taller grandchild stays with the one going up, A takes the other in its place
+		int idxKeep = ( f.height > g.height ) ? idxF : idxG;
+		int idxGive = ( f.height > g.height ) ? idxG : idxF;
+
+		up.child2 = idxKeep;
+		if( balance > 1 )
+			a.child2 = idxGive;
+		else
+			a.child1 = idxGive;
+		m_nodes[ idxGive ].parent = idxA;
+
+		SetToUnion( a.bounds, stay.bounds, m_nodes[ idxGive ].bounds );
+		a.height	= 1 + GetMaxInt( stay.height, m_nodes[ idxGive ].height );
+		SetToUnion( up.bounds, a.bounds, m_nodes[ idxKeep ].bounds );
+		up.height	= 1 + GetMaxInt( a.height, m_nodes[ idxKeep ].height );
+
+		return idxUp;
+	}
+
+	return idxA;
+}
+
+void DynamicAABBTree::UpdateFromChildren( int nodeIdx )
+{
+	DynamicAABBTreeNode			&node	= m_nodes[ nodeIdx ];
+	DynamicAABBTreeNode const	&child1	= m_nodes[ node.child1 ];
+	DynamicAABBTreeNode const	&child2	= m_nodes[ node.child2 ];
+
+	node.height	= 1 + GetMaxInt( child1.height, child2.height );
+	SetToUnion( node.bounds, child1.bounds, child2.bounds );
+}
+
+void DynamicAABBTree::AddSubtree( int nodeIdx, std::vector< void* > &outUserData ) const
+{
+	// Balanced, so the recursion is only as deep as the tree
+	DynamicAABBTreeNode const &node = m_nodes[ nodeIdx ];
+	if( node.IsLeaf() )
+	{
+		outUserData.push_back( node.userData );
+		return;
+	}
+
+	AddSubtree( node.child1, outUserData );
+	AddSubtree( node.child2, outUserData );
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/Sphere.hpp"
+#include "Engine/Math/Plane3.hpp"
+
+#define DYNAMIC_AABB_TREE_NULL_NODE					(-1)
+#define DYNAMIC_AABB_TREE_FAT_MARGIN				(0.5f)		// Leaves are this much bigger on each side, so small moves don't touch the tree
+#define DYNAMIC_AABB_TREE_DISPLACEMENT_MULTIPLIER	(4.f)		// Moving leaves also get as many frames of their motion added, ahead of them
+
+struct DynamicAABBTreeNode
+{
+	AABB3	bounds;												// Fat bounds, if a leaf
+	void	*userData	= nullptr;
+	int		 parent		= DYNAMIC_AABB_TREE_NULL_NODE;			// Next free node, if it's in the free list
+	int		 child1		= DYNAMIC_AABB_TREE_NULL_NODE;
+	int		 child2		= DYNAMIC_AABB_TREE_NULL_NODE;
+	int		 height		= -1;									// Leaf is ZERO, free node is -1
+
+	inline bool IsLeaf() const { return child1 == DYNAMIC_AABB_TREE_NULL_NODE; }
+};
+
+//------------------------------------------------------------------------------------------
+// Bounding volume hierarchy of boxes, which gets updated as they move instead of being built again
+//	- Every object is a leaf ( proxy ); its ID stays the same till DestroyProxy(), even while the tree changes around it
+//	- A leaf keeps a fat box; MoveProxy() only reinserts it once the object's box gets out of that, stretched along its motion
+//	- Inserts go down the branch which grows the surface area the least; rotations keep it balanced, so depth stays O( log n )
+//	- Queries skip whole branches whose box misses; a branch all inside the frustum gets taken without testing it further
+//	- Results are the fat boxes which pass, so they are conservative; a query isn't safe to do from many threads at once
+//
+class DynamicAABBTree
+{
+public:
+	 DynamicAABBTree( float fatMargin = DYNAMIC_AABB_TREE_FAT_MARGIN );
+	~DynamicAABBTree() { }
+
+private:
+	std::vector< DynamicAABBTreeNode >	m_nodes;
+	int									m_root			= DYNAMIC_AABB_TREE_NULL_NODE;
+	int									m_freeList		= DYNAMIC_AABB_TREE_NULL_NODE;
+	uint								m_proxyCount	= 0U;
+	float								m_fatMargin		= DYNAMIC_AABB_TREE_FAT_MARGIN;
+	mutable std::vector< int >			m_queryStack;			// Kept, so a query doesn't allocate
+
+public:
+	int		CreateProxy	( AABB3 const &bounds, void *userData );
+	void	DestroyProxy( int proxyID );
+	bool	MoveProxy	( int proxyID, AABB3 const &bounds, Vector3 const &displacement = Vector3::ZERO );	// False if it still fit in its fat box, so nothing changed
+	void	Clear();
+
+	// Each appends the user data of the leaves it finds
+	void	QueryBox	( AABB3 const &box, std::vector< void* > &outUserData ) const;
+	void	QuerySphere	( Sphere const &sphere, std::vector< void* > &outUserData ) const;
+	void	QueryRay	( Vector3 const &start, Vector3 const &direction, float maxDistance, std::vector< void* > &outUserData ) const;	// Distance in lengths of the direction
+	void	QueryPlanes	( Plane3 const *planes, uint planeCount, std::vector< void* > &outUserData ) const;		// Inside of all; front sides of the planes, like a frustum's
+
+	inline void*		GetUserData	( int proxyID ) const				{ return m_nodes[ proxyID ].userData; }
+	inline void			SetUserData	( int proxyID, void *userData )		{ m_nodes[ proxyID ].userData = userData; }
+	inline AABB3 const&	GetFatBounds( int proxyID ) const				{ return m_nodes[ proxyID ].bounds; }
+	inline uint			GetProxyCount() const							{ return m_proxyCount; }
+	inline int			GetHeight() const								{ return ( m_root != DYNAMIC_AABB_TREE_NULL_NODE ) ? m_nodes[ m_root ].height : 0; }
+
+private:
+	int		AllocateNode();
+	void	FreeNode	( int nodeIdx );
+	void	InsertLeaf	( int leafIdx );
+	void	RemoveLeaf	( int leafIdx );
+	int		Balance		( int nodeIdx );								// Returns the node which took its place
+	void	UpdateFromChildren( int nodeIdx );
+	void	AddSubtree	( int nodeIdx, std::vector< void* > &outUserData ) const;
+};
@@ -135,6 +135,42 @@ bool CheckRandomChance( float chanceForSuccess ) {
 	return false;
 }
 
+uint GetSeededRandomUInt( uint &inOutState ) {
+	// Zero would stay zero forever
+	uint x = (inOutState != 0U) ? inOutState : 0x9E3779B9U;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	inOutState = x;
+
+	return x;
+}
+
+int GetSeededRandomIntInRange( uint &inOutState, int minInclusive, int maxInclusive ) {
+	uint range = (uint)(maxInclusive - minInclusive) + 1U;
+	if( range == 0U ) {
+		return (int)GetSeededRandomUInt( inOutState );
+	}
+
+	return minInclusive + (int)( GetSeededRandomUInt( inOutState ) % range );
+}
+
+float GetSeededRandomFloatInRange( uint &inOutState, float minInclusive, float maxInclusive ) {
+	// Top 24 bits as [0, 1]
+	float zeroToOne = (float)( GetSeededRandomUInt( inOutState ) >> 8 ) * ( 1.f / 16777215.f );
+	return minInclusive + ( (maxInclusive - minInclusive) * zeroToOne );
+}
+
+bool CheckSeededRandomChance( uint &inOutState, float chanceForSuccess ) {
+	if( chanceForSuccess <= 0.f ) {
+		return false;
+	}
+
+	// Top 24 bits as [0, 1)
+	float testFloat = (float)( GetSeededRandomUInt( inOutState ) >> 8 ) * ( 1.f / 16777216.f );
+	return testFloat < chanceForSuccess;
+}
+
 int ClampInt( int inValue, int min, int max ) {
 	if(inValue < min) {
 		inValue = min;
@@ -29,6 +29,12 @@ float	GetRandomFloatZeroToOne();
 float	GetRandomFloatAsPlusOrMinusOne();
 bool	CheckRandomChance( float chanceForSuccess );								// If 0.27 passed, returns true 27% of the time
 
+// Seeded ( xorshift32 ), so a sequence can be replayed; the state is the seed & advances with every call
+uint	GetSeededRandomUInt( uint &inOutState );
+int		GetSeededRandomIntInRange( uint &inOutState, int minInclusive, int maxInclusive );
+float	GetSeededRandomFloatInRange( uint &inOutState, float minInclusive, float maxInclusive );
+bool	CheckSeededRandomChance( uint &inOutState, float chanceForSuccess );
+
 int		ClampInt( int inValue, int min, int max );
 float	ClampFloat01(float number);													// Clamps the number in range  [ 0.0f , 1.0f ]
 float	ClampFloat(float inValue, float minInclusive, float maxInclusive);			// Clamps the inValue in range [ minInclusive, maxInclusive ]
@@ -1,6 +1,8 @@
 #pragma once
 #include "Transform.hpp"
 
+uint64_t Transform::s_lastChangeStamp = 0U;
+
 Transform::Transform( Vector3 const &position, Vector3 const &rotation, Vector3 const &scale )
 	: m_position( position )
 	, m_rotation( Quaternion::FromEuler(rotation) )
@@ -66,24 +68,25 @@ Matrix44 Transform::GetTransformMatrix() const
 void Transform::SetPosition( Vector3 const &position )
 {
 	m_position	= position;
-	m_isDirty	= true;
+	MarkChanged();
 }
 
 void Transform::SetRotation( Vector3 const &rotation )
 {
 	m_rotation	= Quaternion::FromEuler( rotation );
-	m_isDirty	= true;
+	MarkChanged();
 }
 
 void Transform::SetQuaternion( Quaternion const &quaternion )
 {
 	m_rotation = quaternion;
+	MarkChanged();
 }
 
 void Transform::SetScale( Vector3 const &scale )
 {
 	m_scale		= scale;
-	m_isDirty	= true;
+	MarkChanged();
 }
 
 void Transform::SetFromMatrix( Matrix44 model )
@@ -93,12 +96,13 @@ void Transform::SetFromMatrix( Matrix44 model )
 	model.NormalizeIJKColumns();
 	m_rotation	= Quaternion::FromMatrix( model );
 	
-	m_isDirty	= true;
+	MarkChanged();
 }
 
 void Transform::SetParentAs( Transform const *parent )
 {
 	m_parent = parent;
+	MarkChanged();
 }
 
 void Transform::AddChild( Transform *child )
@@ -115,6 +119,19 @@ void Transform::RemoveChild( Transform *childToRemove )
 	}
 }
 
+uint64_t Transform::GetWorldChangeStamp() const
+{
+	// Stamps only go up, so the latest of the chain changes whenever any of it does
+	uint64_t parentStamp = ( m_parent != nullptr ) ? m_parent->GetWorldChangeStamp() : 0U;
+	return ( parentStamp > m_changeStamp ) ? parentStamp : m_changeStamp;
+}
+
+void Transform::MarkChanged()
+{
+	m_isDirty		= true;
+	m_changeStamp	= ++s_lastChangeStamp;
+}
+
 void Transform::RecalculateTheMatrix() const
 {
 	// Set current Transform Matrix to Identity
@@ -11,6 +11,8 @@ private:
 	std::vector< Transform* >	 m_children;
 
 private:
+	static uint64_t		 s_lastChangeStamp;
+	uint64_t			 m_changeStamp		= 0U;								// Set from s_lastChangeStamp on every change; never goes down
 	mutable bool		 m_isDirty			=	false;
 	mutable Matrix44	 m_transformMatrix;									// Initializes as Identity Matrix
 	Vector3				 m_position			= Vector3::ZERO;
@@ -31,6 +33,7 @@ public:
 	Quaternion	GetQuaternion() const;
 	Vector3		GetScale	 () const;										// Gets local scale
 	Matrix44	GetTransformMatrix() const;
+	uint64_t	GetWorldChangeStamp() const;								// Latest change of this or a parent; if it's still the same, so is the world matrix
 
 	void		SetPosition		( Vector3 const &position );
 	void		SetRotation		( Vector3 const &rotation );				// rotation = Vec3(Pitch, Yaw, Roll); but the order the rotation is applied is: Roll_Z -> Pitch_X -> Yaw_Y
@@ -43,6 +46,7 @@ public:
 	void		RemoveChild	( Transform *childToRemove );
 
 private:
+	void		MarkChanged();
 	void		RecalculateTheMatrix() const;
 	Matrix44	GetParentTransform() const;
 };
\ No newline at end of file
@@ -0,0 +1,293 @@
+#pragma once
+#include "BitPacker.hpp"
+#include <math.h>
+#include "Engine/Math/MathUtil.hpp"
+
+static float const SMALLEST_THREE_LIMIT = 0.70710678f;		// 1 / sqrt(2); none but the largest component of a unit quaternion can go past it
+
+QuantizedFloatRange::QuantizedFloatRange( float minInclusive, float maxInclusive, float precision )
+	: min( minInclusive )
+	, max( maxInclusive )
+{
+	double steps = ( precision > 0.f && maxInclusive > minInclusive ) ? ceil( ((double)maxInclusive - (double)minInclusive) / (double)precision ) : 0.0;
+	stepCount	 = ( steps < 4294967295.0 ) ? (uint)steps : 0xffffffffU;
+	bitCount	 = ( stepCount > 0U ) ? (uint)BytePacker::GetTotalBitsRequiredToRepresent( stepCount ) : 0U;
+}
+
+QuantizedFloatRange QuantizedFloatRange::MakeFromBitCount( float minInclusive, float maxInclusive, uint bitCount )
+{
+	GUARANTEE_RECOVERABLE( bitCount >= 1U && bitCount <= BITPACKER_QUANTIZED_MAX_BITS, "QuantizedFloatRange: bitCount should be in [1, 31]!" );
+	bitCount = ( bitCount < 1U ) ? 1U : bitCount;
+	bitCount = ( bitCount > BITPACKER_QUANTIZED_MAX_BITS ) ? BITPACKER_QUANTIZED_MAX_BITS : bitCount;
+
+	// Steps straight from the bits; going through a float precision could round up to one more bit
+	QuantizedFloatRange range;
+	range.min		= minInclusive;
+	range.max		= maxInclusive;
+	range.stepCount	= ( maxInclusive > minInclusive ) ? ( (1U << bitCount) - 1U ) : 0U;
+	range.bitCount	= ( range.stepCount > 0U ) ? bitCount : 0U;
+
+	return range;
+}
+
+uint QuantizedFloatRange::Quantize( float value ) const
+{
+	if( stepCount == 0U )
+		return 0U;
+
+	double fraction = ( (double)ClampFloat( value, min, max ) - (double)min ) / ( (double)max - (double)min );
+	return (uint)( fraction * (double)stepCount + 0.5 );
+}
+
+float QuantizedFloatRange::Dequantize( uint quantized ) const
+{
+	if( stepCount == 0U )
+		return min;
+
+	quantized = ( quantized < stepCount ) ? quantized : stepCount;
+	return (float)( (double)min + ( (double)max - (double)min ) * (double)quantized / (double)stepCount );
+}
+
+BitWriter::BitWriter( BytePacker &packer )
+	: m_packer( packer )
+{
+
+}
+
+BitWriter::~BitWriter()
+{
+	Flush();
+}
+
+bool BitWriter::WriteBits( uint32_t value, uint bitCount )
+{
+	if( m_hasFailed || bitCount > 32U )
+	{
+		m_hasFailed = true;
+		return false;
+	}
+
+	if( bitCount < 32U )
+		value &= ( 1U << bitCount ) - 1U;
+
+	m_scratch			|= (uint64_t)value << m_scratchBitCount;
+	m_scratchBitCount	+= bitCount;
+	m_writtenBitCount	+= bitCount;
+
+	// Four bytes at a time in to the packer
+	if( m_scratchBitCount >= 32U )
+		return WriteScratchBytes( 4U );
+
+	return true;
+}
+
+bool BitWriter::WriteBool( bool value )
+{
+	return WriteBits( value ? 1U : 0U, 1U );
+}
+
+bool BitWriter::WriteBoundedInt( int value, int minInclusive, int maxInclusive )
+{
+	uint32_t range		= (uint32_t)( (int64_t)maxInclusive - (int64_t)minInclusive );
+	uint	 bitCount	= ( maxInclusive > minInclusive ) ? (uint)BytePacker::GetTotalBitsRequiredToRepresent( range ) : 0U;
+	int		 clamped	= ( value < minInclusive ) ? minInclusive : ( (value > maxInclusive) ? maxInclusive : value );
+
+	return WriteBits( (uint32_t)( (int64_t)clamped - (int64_t)minInclusive ), bitCount );
+}
+
+bool BitWriter::WriteQuantizedFloat( float value, QuantizedFloatRange const &range )
+{
+	return WriteBits( range.Quantize( value ), range.bitCount );
+}
+
+bool BitWriter::WriteQuantizedVector2( Vector2 const &value, QuantizedFloatRange const &range )
+{
+	WriteBits( range.Quantize( value.x ), range.bitCount );
+	return WriteBits( range.Quantize( value.y ), range.bitCount );
+}
+
+bool BitWriter::WriteQuantizedVector3( Vector3 const &value, QuantizedFloatRange const &range )
+{
+	WriteBits( range.Quantize( value.x ), range.bitCount );
+	WriteBits( range.Quantize( value.y ), range.bitCount );
+	return WriteBits( range.Quantize( value.z ), range.bitCount );
+}
+
+bool BitWriter::WriteQuantizedQuaternion( Quaternion const &value, uint bitsPerComponent /* = BITPACKER_QUATERNION_DEFAULT_BITS */ )
+{
+	// Smallest three: index of the largest component, then the other three; the reader gets the largest back from the unit length
+	float components[4] = { value.r, value.i.x, value.i.y, value.i.z };
+
+	uint largestIdx = 0U;
+	for( uint c = 1U; c < 4U; c++ )
+	{
+		if( fabsf( components[c] ) > fabsf( components[ largestIdx ] ) )
+			largestIdx = c;
+	}
+
+	// q & -q are the same rotation; flip it, so the largest one is positive & doesn't need a sign bit
+	float sign = ( components[ largestIdx ] < 0.f ) ? -1.f : 1.f;
+
+	if( bitsPerComponent < 1U || bitsPerComponent > BITPACKER_QUANTIZED_MAX_BITS )
+	{
+		m_hasFailed = true;
+		return false;
+	}
+	QuantizedFloatRange componentRange = QuantizedFloatRange::MakeFromBitCount( -SMALLEST_THREE_LIMIT, SMALLEST_THREE_LIMIT, bitsPerComponent );
+
+	WriteBits( largestIdx, 2U );
+	for( uint c = 0U; c < 4U; c++ )
+	{
+		if( c != largestIdx )
+			WriteBits( componentRange.Quantize( components[c] * sign ), componentRange.bitCount );
+	}
+
+	return m_hasFailed == false;
+}
+
+bool BitWriter::Flush()
+{
+	if( m_scratchBitCount > 0U && m_hasFailed == false )
+		WriteScratchBytes( ( m_scratchBitCount + 7U ) / 8U );
+
+	// Next write starts on a byte boundary
+	m_scratch			= 0U;
+	m_scratchBitCount	= 0U;
+
+	return m_hasFailed == false;
+}
+
+bool BitWriter::WriteScratchBytes( uint byteCount )
+{
+	byte_t bytes[4];
+	for( uint b = 0U; b < byteCount; b++ )
+		bytes[b] = (byte_t)( m_scratch >> (8U * b) );
+
+	if( m_packer.WriteBytes( byteCount, bytes, false ) == false )
+	{
+		m_hasFailed = true;
+		return false;
+	}
+
+	uint bitsWritten	= 8U * byteCount;
+	m_scratch			= m_scratch >> bitsWritten;
+	m_scratchBitCount	= ( m_scratchBitCount > bitsWritten ) ? (m_scratchBitCount - bitsWritten) : 0U;
+
+	return true;
+}
+
+BitReader::BitReader( BytePacker const &packer )
+	: m_packer( packer )
+{
+
+}
+
+bool BitReader::ReadBits( uint32_t &outValue, uint bitCount )
+{
+	outValue = 0U;
+	if( m_hasFailed || bitCount > 32U )
+	{
+		m_hasFailed = true;
+		return false;
+	}
+
+	// Just the bytes we need, so the packer's readHead never goes past the stream
+	if( m_scratchBitCount < bitCount )
+	{
+		byte_t	bytes[4];
+		size_t	bytesNeeded	= ( bitCount - m_scratchBitCount + 7U ) / 8U;
+		size_t	bytesRead	= m_packer.ReadBytes( bytes, bytesNeeded, false );
+		if( bytesRead != bytesNeeded )
+		{
+			m_hasFailed = true;
+			return false;
+		}
+
+		for( size_t b = 0U; b < bytesRead; b++ )
+		{
+			m_scratch			|= (uint64_t)bytes[b] << m_scratchBitCount;
+			m_scratchBitCount	+= 8U;
+		}
+	}
+
+	outValue			 = (uint32_t)( m_scratch & ( (1ULL << bitCount) - 1ULL ) );
+	m_scratch			 = m_scratch >> bitCount;
+	m_scratchBitCount	-= bitCount;
+	m_readBitCount		+= bitCount;
+
+	return true;
+}
+
+bool BitReader::ReadBool( bool &outValue )
+{
+	uint32_t bit	= 0U;
+	bool	 success	= ReadBits( bit, 1U );
+	outValue		= ( bit != 0U );
+
+	return success;
+}
+
+bool BitReader::ReadBoundedInt( int &outValue, int minInclusive, int maxInclusive )
+{
+	uint32_t range		= (uint32_t)( (int64_t)maxInclusive - (int64_t)minInclusive );
+	uint	 bitCount	= ( maxInclusive > minInclusive ) ? (uint)BytePacker::GetTotalBitsRequiredToRepresent( range ) : 0U;
+
+	uint32_t offset		= 0U;
+	bool	 success	= ReadBits( offset, bitCount );
+	offset				= ( offset < range ) ? offset : range;
+	outValue			= (int)( (int64_t)minInclusive + (int64_t)offset );
+
+	return success;
+}
+
+bool BitReader::ReadQuantizedFloat( float &outValue, QuantizedFloatRange const &range )
+{
+	uint32_t quantized	= 0U;
+	bool	 success	= ReadBits( quantized, range.bitCount );
+	outValue			= range.Dequantize( quantized );
+
+	return success;
+}
+
+bool BitReader::ReadQuantizedVector2( Vector2 &outValue, QuantizedFloatRange const &range )
+{
+	ReadQuantizedFloat( outValue.x, range );
+	return ReadQuantizedFloat( outValue.y, range );
+}
+
+bool BitReader::ReadQuantizedVector3( Vector3 &outValue, QuantizedFloatRange const &range )
+{
+	ReadQuantizedFloat( outValue.x, range );
+	ReadQuantizedFloat( outValue.y, range );
+	return ReadQuantizedFloat( outValue.z, range );
+}
+
+bool BitReader::ReadQuantizedQuaternion( Quaternion &outValue, uint bitsPerComponent /* = BITPACKER_QUATERNION_DEFAULT_BITS */ )
+{
+	if( bitsPerComponent < 1U || bitsPerComponent > BITPACKER_QUANTIZED_MAX_BITS )
+	{
+		m_hasFailed = true;
+		return false;
+	}
+	QuantizedFloatRange componentRange = QuantizedFloatRange::MakeFromBitCount( -SMALLEST_THREE_LIMIT, SMALLEST_THREE_LIMIT, bitsPerComponent );
+
+	uint32_t largestIdx = 0U;
+	ReadBits( largestIdx, 2U );
+
+	float components[4];
+	float sumOfSquares = 0.f;
+	for( uint c = 0U; c < 4U; c++ )
+	{
+		if( c == largestIdx )
+			continue;
+
+		ReadQuantizedFloat( components[c], componentRange );
+		sumOfSquares += components[c] * components[c];
+	}
+	components[ largestIdx ] = sqrtf( (sumOfSquares < 1.f) ? (1.f - sumOfSquares) : 0.f );
+
+	outValue.r = components[0];
+	outValue.i = Vector3( components[1], components[2], components[3] );
+
+	return m_hasFailed == false;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Math/Vector2.hpp"
+#include "Engine/Math/Vector3.hpp"
+#include "Engine/Math/Quaternion.hpp"
+#include "Engine/Network/BytePacker.hpp"
+
+//------------------------------------------------------------------------------------------
+// Bit streams on top of a BytePacker ( e.g. a NetworkMessage )
+//	- BitWriter appends after whatever is written in the packer; BitReader reads from its readHead
+//	- Bits go lowest first, a byte at a time, so the stream is the same on every platform
+//	- The stream ends on a byte boundary: Flush() after the last write; the reader never takes a byte more than it needs, so
+//	  the packer's readHead ends up right after the stream
+//	- Once a write fails the writer stays failed; drop the message, part of the stream might be in the packer already
+//
+#define BITPACKER_QUATERNION_DEFAULT_BITS (10U)			// Per component of the smallest three; under 0.2 degrees off
+#define BITPACKER_QUANTIZED_MAX_BITS		(31U)
+
+// Maps [min, max] on to steps of precision; make them once, they're used for both writing & reading
+struct QuantizedFloatRange
+{
+public:
+	QuantizedFloatRange() { }
+	QuantizedFloatRange( float minInclusive, float maxInclusive, float precision );
+
+	static QuantizedFloatRange MakeFromBitCount( float minInclusive, float maxInclusive, uint bitCount );	// All of [0, 2^bitCount - 1] as steps; bitCount in [1, 31]
+
+public:
+	float	min			= 0.f;
+	float	max			= 0.f;
+	uint	stepCount	= 0U;							// Values get written as [0, stepCount]
+	uint	bitCount	= 0U;							// Up to 32
+
+public:
+	uint	Quantize	( float value )		 const;		// Clamps in to the range
+	float	Dequantize	( uint quantized )	 const;
+};
+
+class BitWriter
+{
+public:
+	 BitWriter( BytePacker &packer );
+	~BitWriter();										// Flushes
+
+private:
+	BytePacker	&m_packer;
+	uint64_t	 m_scratch			= 0U;				// Bits which aren't in the packer yet; fewer than 32 between writes
+	uint		 m_scratchBitCount	= 0U;
+	uint		 m_writtenBitCount	= 0U;
+	bool		 m_hasFailed		= false;
+
+public:
+	bool	WriteBits				( uint32_t value, uint bitCount );						// bitCount up to 32; returns false if the packer is full
+	bool	WriteBool				( bool value );											// 1 bit
+	bool	WriteBoundedInt			( int value, int minInclusive, int maxInclusive );		// Just the bits (max - min) needs; clamps in to the range
+	bool	WriteQuantizedFloat		( float value,			QuantizedFloatRange const &range );
+	bool	WriteQuantizedVector2	( Vector2 const &value,	QuantizedFloatRange const &range );
+	bool	WriteQuantizedVector3	( Vector3 const &value,	QuantizedFloatRange const &range );
+	bool	WriteQuantizedQuaternion( Quaternion const &value, uint bitsPerComponent = BITPACKER_QUATERNION_DEFAULT_BITS );	// Smallest three; expects a unit quaternion; bitsPerComponent in [1, 31]
+	bool	Flush();																		// Writes the last partial byte, padded with zeros
+
+	inline uint	GetWrittenBitCount()	const { return m_writtenBitCount; }
+	inline bool	HasFailed()				const { return m_hasFailed; }
+
+private:
+	bool	WriteScratchBytes( uint byteCount );
+};
+
+class BitReader
+{
+public:
+	BitReader( BytePacker const &packer );
+
+private:
+	BytePacker const	&m_packer;
+	uint64_t			 m_scratch			= 0U;		// Bits read from the packer, not handed out yet; less than a byte between reads
+	uint				 m_scratchBitCount	= 0U;
+	uint				 m_readBitCount		= 0U;
+	bool				 m_hasFailed		= false;
+
+public:
+	bool	ReadBits				( uint32_t &outValue, uint bitCount );					// Returns false if the stream is short; outValue is zero, in that case
+	bool	ReadBool				( bool &outValue );
+	bool	ReadBoundedInt			( int &outValue, int minInclusive, int maxInclusive );
+	bool	ReadQuantizedFloat		( float &outValue,		QuantizedFloatRange const &range );
+	bool	ReadQuantizedVector2	( Vector2 &outValue,	QuantizedFloatRange const &range );
+	bool	ReadQuantizedVector3	( Vector3 &outValue,	QuantizedFloatRange const &range );
+	bool	ReadQuantizedQuaternion	( Quaternion &outValue, uint bitsPerComponent = BITPACKER_QUATERNION_DEFAULT_BITS );
+
+	inline uint	GetReadBitCount()	const { return m_readBitCount; }
+	inline bool	HasFailed()			const { return m_hasFailed; }
+};
@@ -1,7 +1,12 @@
 #pragma once
+#include <string.h>
+#include <type_traits>
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Input/Command.hpp"
 #include "Engine/Network/Endianness.hpp"
 
+#define BYTEPACKER_MAX_SIZE_BYTES (10U)		// LEB128 of a 64 bit number: ceil( 64 / 7 )
+
 enum eBytePackerOptionBit : uint
 {
 	// a byte packer allocated its own memory and 
@@ -25,8 +30,9 @@ public:
 	~BytePacker(); 
 
 private:
-	eEndianness			 m_endianness	= LITTLE_ENDIAN;
-	eBytePackerOptions	 m_settings		= 0U;							// Doesn't owns the memory, and can't grow the buffer
+	eEndianness			 m_endianness			= LITTLE_ENDIAN;
+	bool				 m_isPlatformEndianness	= true;					// m_endianness == GetPlatformEndianness(); so writes & reads don't have to ask every time
+	eBytePackerOptions	 m_settings				= 0U;					// Doesn't owns the memory, and can't grow the buffer
 
 protected:
 	void				*m_buffer		= nullptr;
@@ -43,21 +49,29 @@ public:
 	
 	// Write in buffer
 	bool		WriteBytes	( size_t byteCount, void const *data, bool changeEndiannessToSettings = true );		// Returns false if buffer can't hold the new data in it.. It doesn't write in buffer on failed attempt.
-	size_t		WriteSize	( size_t size );							// Writes a size_t in buffer in a compresses way, returns how many bytes it used to represent passed size_t variable.
-	bool		WriteString	( char const *str );						// Returns false if the string is too long to hold by buffer.. It doesn't write anything, in that case.
+	size_t		WriteSize		( size_t size );						// Writes a size_t in buffer in a compresses way ( LEB128 ), returns how many bytes it used to represent passed size_t variable. Zero on failure
+	size_t		WriteSignedSize	( int64_t value );						// Zig-zag, then LEB128; small negative numbers stay small
+	bool		WriteString		( char const *str );					// Returns false if the string is too long to hold by buffer.. It doesn't write anything, in that case.
+	bool		WriteString		( char const *str, size_t stringLength );	// When the length is known already, e.g. from a std::string
+
+	// Typed; plain numbers & enums only. Skips the byte order swap when it is the platform's
+	template <typename T> bool	Write( T const &value );				// Returns false if the buffer can't hold it; writes nothing, in that case
+	template <typename T> bool	Read ( T &outValue ) const;				// Returns false if there aren't sizeof(T) bytes left; reads nothing, in that case
 
 	// Read from the buffer
 	size_t				ReadBytes	( void *outData, size_t maxByteCount, bool changeEndiannessToMachine = true ) const;		// Returns how many actual bytes got read
-	size_t				ReadSize	( size_t *outSize ) const;					// Returns how many bytes got read to fetch the size_t, fills outSize
+	size_t				ReadSize		( size_t *outSize ) const;				// Returns how many bytes got read to fetch the size_t, fills outSize. Zero on failure, without moving the readHead
+	size_t				ReadSignedSize	( int64_t *outValue ) const;			// Counterpart of WriteSignedSize()
 	size_t				ReadString	( char *outStr, size_t maxByteSize ) const;	// Note: maxByteSize should be enough to contain the null terminator as well
 	inline void const*	GetBuffer() const { return m_buffer; }					// Access buffer without changing readHead!
+	inline void*		GetWritableBuffer() { return m_buffer; }				// To fill it up from outside ( e.g. a socket ), follow it with SetWrittenByteCountDummy()
 
 	// Move the Read head
 	bool		MoveReadheadBy( double bytes ) const;					// Returns true on success, false on failure
 
 	// Set buffer variables
 	bool		SetWrittenByteCountDummy( size_t byteCount );			// Changes the writeHead, DO NOT USE TO MOVE IT BACKWORDS unless you're resetting it
-	void		ResetWrite();											// Resets witeHead & readHead
+	void		ResetWrite();											// Resets witeHead & readHead; keeps the buffer
 	void		ResetRead() const;										// Resets just readHead
 
 	// Get buffer variables
@@ -66,8 +80,52 @@ public:
 	size_t		GetReadableByteCount() const;							// How much more data can I read?
 
 private:
+	bool		MakeRoomToWrite						( size_t byteCount );							// Grows the buffer if it has to & can; returns false if the bytes won't fit
+	size_t		WriteVarint							( uint64_t number );
+	size_t		ReadVarint							( uint64_t *outNumber ) const;
 	void		ReAllocateBufferOfSizeAndCopy		( size_t newBufferSize );
 	size_t		GetNewBufferSizeToStoreDataOfSize	( size_t minimumRequiredBufferSize ) const;		// Gives size of new buffer in stages: 8kb, 16kb, 32kb, 64kb, 128kb, etc..
-	size_t		GetTotalBitsRequiredToRepresent		( size_t number ) const;						// Doesn't count the continue flag of the BytePacker..
-	size_t		GetTotalBytesRequiredToWriteSize	( size_t number ) const;						// Does account for continue bits in each byte
+
+public:
+	static size_t	GetTotalBitsRequiredToRepresent		( uint64_t number );						// Doesn't count the continue flag of the BytePacker; zero takes one bit
+	static size_t	GetTotalBytesRequiredToWriteSize	( uint64_t number );						// Does account for continue bits in each byte
 };
+
+template <typename T>
+bool BytePacker::Write( T const &value )
+{
+	static_assert( std::is_arithmetic<T>::value || std::is_enum<T>::value, "BytePacker::Write<T>() is for numbers; use WriteBytes() for the rest!" );
+
+	if( MakeRoomToWrite( sizeof(T) ) == false )
+		return false;
+
+	byte_t *writeTo = (byte_t *)m_buffer + m_writeHead;
+	memcpy( writeTo, &value, sizeof(T) );
+
+	if( m_isPlatformEndianness == false )
+		ChangeEndiannessTo( sizeof(T), writeTo, m_endianness );
+
+	m_writeHead += sizeof(T);
+	return true;
+}
+
+template <typename T>
+bool BytePacker::Read( T &outValue ) const
+{
+	static_assert( std::is_arithmetic<T>::value || std::is_enum<T>::value, "BytePacker::Read<T>() is for numbers; use ReadBytes() for the rest!" );
+
+	if( m_writeHead - m_readHead < sizeof(T) )
+		return false;
+
+	memcpy( &outValue, (byte_t const *)m_buffer + m_readHead, sizeof(T) );
+
+	if( m_isPlatformEndianness == false )
+		ChangeEndiannessFrom( sizeof(T), &outValue, m_endianness );
+
+	m_readHead += sizeof(T);
+	return true;
+}
+
+
+// Console Commands
+void BytePackerBenchmark( Command &cmd );			// bytepacker_benchmark [valueCount]
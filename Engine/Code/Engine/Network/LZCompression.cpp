@@ -0,0 +1,216 @@
+#pragma once
+#include "LZCompression.hpp"
+#include <string.h>
+#include "Engine/Core/Clock.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Math/MathUtil.hpp"
+
+static inline uint32_t ReadLZUInt32( byte_t const *bytes )
+{
+	uint32_t value;
+	memcpy( &value, bytes, sizeof( uint32_t ) );
+	return value;
+}
+
+static inline uint32_t GetLZHash( uint32_t fourBytes )
+{
+	// Knuth's multiplicative hash, top bits
+	return ( fourBytes * 2654435761U ) >> ( 32U - LZ_HASH_BITS );
+}
+
+static void WriteLZLength( std::vector< byte_t > &out, size_t lengthAfterNibble )
+{
+	while( lengthAfterNibble >= 255U )
+	{
+		out.push_back( 255U );
+		lengthAfterNibble -= 255U;
+	}
+	out.push_back( (byte_t)lengthAfterNibble );
+}
+
+static void WriteLZSequence( std::vector< byte_t > &out, byte_t const *literals, size_t literalCount, size_t offset, size_t matchLength )
+{
+	// Token
+	size_t	matchNibble	= ( matchLength >= LZ_MIN_MATCH_LENGTH ) ? matchLength - LZ_MIN_MATCH_LENGTH : 0U;
+	byte_t	token		= (byte_t)( ( ( literalCount < 15U ) ? literalCount : 15U ) << 4 );
+	token			   |= (byte_t)(   ( matchNibble  < 15U ) ? matchNibble  : 15U );
+	out.push_back( token );
+
+	// Literals
+	if( literalCount >= 15U )
+		WriteLZLength( out, literalCount - 15U );
+	out.insert( out.end(), literals, literals + literalCount );
+
+	// Last sequence has no match
+	if( matchLength == 0U )
+		return;
+
+	out.push_back( (byte_t)( offset & 0xff ) );
+	out.push_back( (byte_t)( offset >> 8 ) );
+
+	if( matchNibble >= 15U )
+		WriteLZLength( out, matchNibble - 15U );
+}
+
+size_t LZGetMaxCompressedByteCount( size_t sourceByteCount )
+{
+	// One literal run: token, its length bytes & the literals
+	return 1U + ( sourceByteCount / 255U ) + 1U + sourceByteCount;
+}
+
+size_t LZCompress( void const *source, size_t sourceByteCount, std::vector< byte_t > &outCompressed )
+{
+	byte_t const *src = (byte_t const *)source;
+
+	outCompressed.clear();
+	outCompressed.reserve( sourceByteCount / 2U + 16U );
+
+	// Positions + 1, ZERO => empty
+	std::vector< uint32_t > hashTable( (size_t)1U << LZ_HASH_BITS, 0U );
+
+	size_t anchor	= 0U;				// First byte not written yet
+	size_t position	= 0U;
+	size_t matchEnd	= ( sourceByteCount > LZ_LAST_LITERAL_COUNT ) ? sourceByteCount - LZ_LAST_LITERAL_COUNT : 0U;
+	while( position + LZ_MIN_MATCH_LENGTH <= matchEnd )
+	{
+		uint32_t	fourBytes	= ReadLZUInt32( src + position );
+		uint32_t	&slot		= hashTable[ GetLZHash( fourBytes ) ];
+		size_t		candidate	= (size_t)slot;
+		slot					= (uint32_t)( position + 1U );
+
+		if( candidate == 0U || position - ( candidate - 1U ) > LZ_MAX_OFFSET || ReadLZUInt32( src + candidate - 1U ) != fourBytes )
+		{
+			position++;
+			continue;
+		}
+		candidate--;
+
+		// Extend it as far as it goes, stopping before the last literals
+		size_t matchLength = LZ_MIN_MATCH_LENGTH;
+		while( position + matchLength < matchEnd && src[ candidate + matchLength ] == src[ position + matchLength ] )
+			matchLength++;
+
+		WriteLZSequence( outCompressed, src + anchor, position - anchor, position - candidate, matchLength );
+
+		position	+= matchLength;
+		anchor		 = position;
+	}
+
+	// What's left
+	WriteLZSequence( outCompressed, src + anchor, sourceByteCount - anchor, 0U, 0U );
+	return outCompressed.size();
+}
+
+static bool ReadLZLength( byte_t const *&in, byte_t const *inEnd, size_t &inOutLength )
+{
+	byte_t piece = 255U;
+	while( piece == 255U )
+	{
+		if( in >= inEnd )
+			return false;
+
+		piece			= *in++;
+		inOutLength	   += piece;
+	}
+
+	return true;
+}
+
+bool LZDecompress( void const *compressed, size_t compressedByteCount, void *destination, size_t destinationByteCount )
+{
+	byte_t const	*in		= (byte_t const *)compressed;
+	byte_t const	*inEnd	= in + compressedByteCount;
+	byte_t			*out	= (byte_t *)destination;
+	byte_t			*outEnd	= out + destinationByteCount;
+
+	while( in < inEnd )
+	{
+		byte_t token = *in++;
+
+		// Literals
+		size_t literalCount = token >> 4;
+		if( literalCount == 15U && ReadLZLength( in, inEnd, literalCount ) == false )
+			return false;
+		if( literalCount > (size_t)( inEnd - in ) || literalCount > (size_t)( outEnd - out ) )
+			return false;
+
+		memcpy( out, in, literalCount );
+		in	+= literalCount;
+		out	+= literalCount;
+
+		// The last sequence
+		if( in == inEnd )
+			break;
+
+		// Match
+		if( inEnd - in < 2 )
+			return false;
+
+		size_t offset = (size_t)in[0] | ( (size_t)in[1] << 8 );
+		in += 2;
+		if( offset == 0U || offset > (size_t)( out - (byte_t *)destination ) )
+			return false;
+
+		size_t matchLength = token & 0x0f;
+		if( matchLength == 15U && ReadLZLength( in, inEnd, matchLength ) == false )
+			return false;
+		matchLength += LZ_MIN_MATCH_LENGTH;
+		if( matchLength > (size_t)( outEnd - out ) )
+			return false;
+
+		// A byte at a time, the match may overlap what it is writing
+		byte_t const *match = out - offset;
+		for( size_t i = 0U; i < matchLength; i++ )
+			out[i] = match[i];
+		out += matchLength;
+	}
+
+	return ( out == outEnd );
+}
+
+void LZBenchmark( Command &cmd )
+{
+	std::string megabytesStr	= cmd.GetNextString();
+	uint		megabytes		= ( megabytesStr != "" ) ? (uint) atoi( megabytesStr.c_str() ) : 4U;
+	if( megabytes == 0U || megabytes > 256U )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "lz_benchmark: megabytes has to be in [1, 256]!" );
+		return;
+	}
+
+	// Something like level data: runs of tiles, repeated records & some noise
+	size_t					byteCount = (size_t)megabytes * 1024U * 1024U;
+	std::vector< byte_t >	source( byteCount );
+	uint					randomState = 1U;
+	for( size_t i = 0U; i < byteCount; )
+	{
+		int kind = GetSeededRandomIntInRange( randomState, 0, 2 );
+		size_t runLength = (size_t)GetSeededRandomIntInRange( randomState, 4, 64 );
+		for( size_t r = 0U; r < runLength && i < byteCount; r++, i++ )
+		{
+			if( kind == 0 )
+				source[i] = (byte_t)( runLength & 0xff );											// Run
+			else if( kind == 1 )
+				source[i] = ( i >= 256U ) ? source[ i - 256U ] : (byte_t)r;							// Repeat
+			else
+				source[i] = (byte_t)GetSeededRandomUInt( randomState );								// Noise
+		}
+	}
+
+	std::vector< byte_t >	compressed;
+	std::vector< byte_t >	decompressed( byteCount );
+
+	uint64_t startHPC			= Clock::GetCurrentHPC();
+	size_t	 compressedCount	= LZCompress( source.data(), byteCount, compressed );
+	double	 compressSeconds	= Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+
+	startHPC					= Clock::GetCurrentHPC();
+	bool	 isDecompressed	= LZDecompress( compressed.data(), compressedCount, decompressed.data(), byteCount );
+	double	 decompressSeconds	= Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+
+	bool	 matches			= isDecompressed && ( memcmp( source.data(), decompressed.data(), byteCount ) == 0 );
+	double	 megabytesCount		= (double)byteCount / ( 1024.0 * 1024.0 );
+	ConsolePrintf( "lz_benchmark: %u MB to %.2f MB ( %.1f%% )", megabytes, (double)compressedCount / ( 1024.0 * 1024.0 ), 100.0 * (double)compressedCount / (double)byteCount );
+	ConsolePrintf( "  compress %.1f MB/s, decompress %.1f MB/s", megabytesCount / compressSeconds, megabytesCount / decompressSeconds );
+	ConsolePrintf( matches ? RGBA_GREEN_COLOR : RGBA_RED_COLOR, "  round trip %s", matches ? "matches" : "DOESN'T MATCH!" );
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <vector>
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Input/Command.hpp"
+
+//------------------------------------------------------------------------------------------
+// LZ77 byte compression, in the sequence format of LZ4 blocks
+//	- Sequence: token ( high nibble: literal count, low nibble: match length - 4; 15 => more bytes follow, 255 a piece ),
+//	  the literals, a 2 byte little endian offset back in to the output & the match length's extra bytes
+//	- The last sequence is just literals; the last LZ_LAST_LITERAL_COUNT bytes are always literals
+//	- One hash table lookup per position, no chains: fast & greedy, not the smallest output
+//	- The decompressor checks every length & offset against both buffers; a bad stream fails, it never reads or writes out of them
+//
+#define LZ_MIN_MATCH_LENGTH		(4U)
+#define LZ_MAX_OFFSET			(0xffffU)
+#define LZ_LAST_LITERAL_COUNT	(5U)
+#define LZ_HASH_BITS			(13U)
+
+size_t	LZCompress	( void const *source, size_t sourceByteCount, std::vector< byte_t > &outCompressed );						// Replaces outCompressed; returns its size
+size_t	LZGetMaxCompressedByteCount( size_t sourceByteCount );																// If nothing matches
+bool	LZDecompress( void const *compressed, size_t compressedByteCount, void *destination, size_t destinationByteCount );	// False unless it comes out to exactly destinationByteCount
+
+
+// Console Commands
+void LZBenchmark( Command &cmd );				// lz_benchmark [megabytes=4]
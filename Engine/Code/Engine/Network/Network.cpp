@@ -6,8 +6,13 @@
 #include "Engine/Core/DevConsole.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Internal/WindowsCommon.hpp"
+#include "Engine/Network/BytePacker.hpp"
+#include "Engine/Network/LZCompression.hpp"
 #include "Engine/Network/NetworkAddress.hpp"
 #include "Engine/Network/TCPSocket.hpp"
+#include "Engine/NetworkSession/LoopbackNetwork.hpp"
+#include "Engine/NetworkSession/NetworkSession.hpp"
+#include "Engine/NetworkSession/NetworkSoakBenchmark.hpp"
 
 #pragma comment(lib, "ws2_32.lib" )	// WinSock libraries
 
@@ -24,6 +29,14 @@ bool Network::Startup()
 
 	// Console Commands
 	CommandRegister( "networkMyIP", NetworkMyIP );
+	CommandRegister( "net_benchmark", NetworkSessionBenchmark );
+	CommandRegister( "net_reliable_stress", NetworkReliableStress );
+	CommandRegister( "net_inorder_stress", NetworkInOrderStress );
+	CommandRegister( "bytepacker_benchmark", BytePackerBenchmark );
+	CommandRegister( "net_snapshot_benchmark", NetworkSnapshotBenchmark );
+	CommandRegister( "net_loopback_join", NetworkLoopbackJoin );
+	CommandRegister( "net_soak", NetworkSoakBenchmark );
+	CommandRegister( "lz_benchmark", LZBenchmark );
 
 	GUARANTEE_RECOVERABLE( error == 0, "Error: Network starup, failed!" );
 	return ( error == 0 );
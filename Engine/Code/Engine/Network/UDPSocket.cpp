@@ -1,6 +1,10 @@
 #pragma once
 #include "UDPSocket.hpp"
 
+#if defined(__linux__)
+#include <sys/socket.h>		// recvmmsg, sendmmsg
+#endif
+
 bool UDPSocket::Bind( NetworkAddress &address, uint16_t portRange /*= 0U */ )
 {
 	// Create the socket 
@@ -41,16 +45,19 @@ bool UDPSocket::Bind( NetworkAddress &address, uint16_t portRange /*= 0U */ )
 
 size_t UDPSocket::SendTo( NetworkAddress const &address, void const *data, size_t const byteCount )
 {
-	sockaddr_storage sock_addr;
-	int addr_len;
-	NetworkAddress::GetSocketAddressForHost( (sockaddr*)&sock_addr, &addr_len, address.IPToString().c_str(), address.PortToString().c_str() );
+	// Straight from the IPv4 address; no host name look up per packet
+	sockaddr	sock_addr;
+	size_t		addr_len;
+	if( address.ToSocketAddress( &sock_addr, &addr_len ) == false )
+		return 0U;
 
 	SOCKET sock = (SOCKET) m_handle;
+	m_sendSyscallCount++;
 	int sent = ::sendto(	sock,								// socket we're sending from
 							(char const *)data,					// data we want to send
 							(int)byteCount,						// bytes to send
 							0,									// unused flags
-							(sockaddr*)&sock_addr,addr_len );	// address we're sending to
+							&sock_addr, (int)addr_len );		// address we're sending to
 
 	if( sent > 0 )
 	{
@@ -74,6 +81,7 @@ size_t UDPSocket::ReceiveFrom( NetworkAddress *outAddress, void *buffer, size_t
 	int addr_len = sizeof( sockaddr_storage );
 	SOCKET sock = m_handle;
 
+	m_receiveSyscallCount++;
 	int recvd = ::recvfrom( sock,									// what socket am I receiving on
 							(char*) buffer,
 							(int) maxReadSize,						// max I can read
@@ -93,3 +101,121 @@ size_t UDPSocket::ReceiveFrom( NetworkAddress *outAddress, void *buffer, size_t
 		return 0;
 	}
 }
+
+uint UDPSocket::ReceiveBatch( UDPDatagram *datagrams, uint maxCount )
+{
+	if( IsClosed() || maxCount == 0U )
+		return 0U;
+
+	if( maxCount > UDP_MAX_BATCH_SIZE )
+		maxCount = UDP_MAX_BATCH_SIZE;
+
+#if defined(__linux__)
+	mmsghdr				messages	[ UDP_MAX_BATCH_SIZE ];
+	iovec				ioVectors	[ UDP_MAX_BATCH_SIZE ];
+	sockaddr_storage	fromAddrs	[ UDP_MAX_BATCH_SIZE ];
+	memset( messages, 0, sizeof(mmsghdr) * maxCount );
+
+	for( uint i = 0; i < maxCount; i++ )
+	{
+		ioVectors[i].iov_base				= datagrams[i].buffer;
+		ioVectors[i].iov_len				= datagrams[i].bufferSize;
+
+		messages[i].msg_hdr.msg_name		= &fromAddrs[i];
+		messages[i].msg_hdr.msg_namelen		= sizeof( sockaddr_storage );
+		messages[i].msg_hdr.msg_iov			= &ioVectors[i];
+		messages[i].msg_hdr.msg_iovlen		= 1;
+	}
+
+	// Whatever is waiting, up to maxCount datagrams, in one call
+	m_receiveSyscallCount++;
+	int receivedCount = ::recvmmsg( (int)m_handle, messages, maxCount, MSG_DONTWAIT, nullptr );
+	if( receivedCount <= 0 )
+		return 0U;
+
+	for( int i = 0; i < receivedCount; i++ )
+	{
+		datagrams[i].address	= NetworkAddress( (sockaddr*) &fromAddrs[i] );
+		datagrams[i].byteCount	= messages[i].msg_len;
+	}
+
+	return (uint)receivedCount;
+#else
+	// Fallback: one recvfrom per datagram
+	uint receivedCount = 0U;
+	while( receivedCount < maxCount )
+	{
+		UDPDatagram &datagram	= datagrams[ receivedCount ];
+		datagram.byteCount		= ReceiveFrom( &datagram.address, datagram.buffer, datagram.bufferSize );
+
+		if( datagram.byteCount == 0U )
+			break;
+
+		receivedCount++;
+	}
+
+	return receivedCount;
+#endif
+}
+
+uint UDPSocket::SendBatch( UDPDatagram const *datagrams, uint count )
+{
+	if( IsClosed() )
+		return 0U;
+
+#if defined(__linux__)
+	uint sentCount		= 0U;
+	uint attemptedCount	= 0U;
+	while( attemptedCount < count )
+	{
+		uint batchCount = count - attemptedCount;
+		if( batchCount > UDP_MAX_BATCH_SIZE )
+			batchCount = UDP_MAX_BATCH_SIZE;
+
+		mmsghdr		messages	[ UDP_MAX_BATCH_SIZE ];
+		iovec		ioVectors	[ UDP_MAX_BATCH_SIZE ];
+		sockaddr	toAddrs		[ UDP_MAX_BATCH_SIZE ];
+		memset( messages, 0, sizeof(mmsghdr) * batchCount );
+
+		for( uint i = 0; i < batchCount; i++ )
+		{
+			UDPDatagram const &datagram = datagrams[ attemptedCount + i ];
+
+			size_t addrLength = 0U;
+			datagram.address.ToSocketAddress( &toAddrs[i], &addrLength );
+
+			ioVectors[i].iov_base				= datagram.buffer;
+			ioVectors[i].iov_len				= datagram.byteCount;
+
+			messages[i].msg_hdr.msg_name		= &toAddrs[i];
+			messages[i].msg_hdr.msg_namelen		= (socklen_t) addrLength;
+			messages[i].msg_hdr.msg_iov			= &ioVectors[i];
+			messages[i].msg_hdr.msg_iovlen		= 1;
+		}
+
+		m_sendSyscallCount++;
+		int sent = ::sendmmsg( (int)m_handle, messages, batchCount, 0 );
+
+		// It stops at the first datagram which fails; drop that one, like SendTo() would, and carry on
+		if( sent <= 0 )
+			attemptedCount++;
+		else
+		{
+			sentCount		+= (uint)sent;
+			attemptedCount	+= (uint)sent;
+		}
+	}
+
+	return sentCount;
+#else
+	// Fallback: one sendto per datagram
+	uint sentCount = 0U;
+	for( uint i = 0; i < count; i++ )
+	{
+		if( SendTo( datagrams[i].address, datagrams[i].buffer, datagrams[i].byteCount ) > 0U )
+			sentCount++;
+	}
+
+	return sentCount;
+#endif
+}
\ No newline at end of file
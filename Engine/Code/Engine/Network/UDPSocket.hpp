@@ -3,6 +3,18 @@
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Network/Socket.hpp"
 
+#define UDP_MAX_BATCH_SIZE (64U)
+
+// One datagram of a batched send or receive
+struct UDPDatagram
+{
+public:
+	NetworkAddress	 address;						// Receiving: filled with the sender's;  Sending: where it goes
+	void			*buffer		= nullptr;
+	size_t			 bufferSize	= 0U;				// Receiving: max bytes that fit in the buffer
+	size_t			 byteCount	= 0U;				// Receiving: filled with bytes received; Sending: bytes to send
+};
+
 class UDPSocket : public Socket
 {
 public:
@@ -10,6 +22,18 @@ public:
 
 	size_t SendTo( NetworkAddress const &address, void const *data, size_t const byteCount );
 	size_t ReceiveFrom( NetworkAddress *outAddress, void *buffer, size_t const maxReadSize );
+
+	// Batched; one recvmmsg/sendmmsg per UDP_MAX_BATCH_SIZE datagrams on Linux, falls back to one recvfrom/sendto per datagram elsewhere
+	uint	ReceiveBatch( UDPDatagram *datagrams, uint maxCount );		// Returns how many got received; stops when nothing is left to read
+	uint	SendBatch	( UDPDatagram const *datagrams, uint count );	// Returns how many got sent
+
+private:
+	uint	m_receiveSyscallCount	= 0U;								// Since constructed; for the stats
+	uint	m_sendSyscallCount		= 0U;
+
+public:
+	inline uint GetReceiveSyscallCount()	const { return m_receiveSyscallCount; }
+	inline uint GetSendSyscallCount()		const { return m_sendSyscallCount; }
 };
 
 // IPv4 Header Size: 20B
@@ -0,0 +1,317 @@
+#pragma once
+#include "LoopbackNetwork.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Math/MathUtil.hpp"
+#include "Engine/NetworkSession/NetworkSession.hpp"
+
+LoopbackNetwork::LoopbackNetwork( uint seed /* = 1U */, Clock const *referenceClock /* = nullptr */ )
+	: m_referenceClock( (referenceClock != nullptr) ? referenceClock : GetMasterClock() )
+	, m_randomState( seed )
+	, m_datagramPool( 64U )
+{
+
+}
+
+LoopbackNetwork::~LoopbackNetwork()
+{
+	GUARANTEE_RECOVERABLE( m_boundTransports.empty(), "LoopbackNetwork: destroyed before its transports got closed!" );
+
+	// So their arrivals go back to the pool before it goes away
+	while( m_boundTransports.empty() == false )
+		m_boundTransports.begin()->second->Close();
+}
+
+void LoopbackNetwork::SetConditions( LoopbackNetworkConditions const &conditions )
+{
+	m_conditions = conditions;
+	m_conditions.lossFraction		= ClampFloat01( conditions.lossFraction );
+	m_conditions.reorderFraction	= ClampFloat01( conditions.reorderFraction );
+}
+
+void LoopbackNetwork::SetSeed( uint seed )
+{
+	m_randomState = seed;
+}
+
+void LoopbackNetwork::ResetStats()
+{
+	m_sentCount				= 0U;
+	m_deliveredCount		= 0U;
+	m_lostCount				= 0U;
+	m_unreachableCount		= 0U;
+	m_reorderedCount		= 0U;
+	m_sentByteCount			= 0U;
+	m_deliveredByteCount	= 0U;
+}
+
+bool LoopbackNetwork::BindTransport( LoopbackNetworkTransport &transport, NetworkAddress &inOutAddress, uint16_t portRange )
+{
+	// Same as UDPSocket::Bind(), the first free one of [port, port + portRange]
+	for( int remainingPorts = portRange; remainingPorts >= 0; remainingPorts-- )
+	{
+		uint64_t addressKey = GetAddressKey( inOutAddress );
+		if( m_boundTransports.find( addressKey ) == m_boundTransports.end() )
+		{
+			m_boundTransports[ addressKey ] = &transport;
+			return true;
+		}
+
+		// Check so that the port won't overflow
+		if( inOutAddress.port == 0xffff )
+			break;
+		else
+			inOutAddress.port++;
+	}
+
+	return false;
+}
+
+void LoopbackNetwork::UnbindTransport( LoopbackNetworkTransport &transport )
+{
+	m_boundTransports.erase( GetAddressKey( transport.m_address ) );
+
+	while( transport.m_arrivals.empty() == false )
+	{
+		ReleaseDatagram( transport.m_arrivals.top() );
+		transport.m_arrivals.pop();
+	}
+	transport.m_lastArrivalHPCOfRoute.clear();
+}
+
+void LoopbackNetwork::SendDatagram( LoopbackNetworkTransport &fromTransport, UDPDatagram const &datagram )
+{
+	m_sentCount++;
+	m_sentByteCount += datagram.byteCount;
+
+	std::map< uint64_t, LoopbackNetworkTransport* >::iterator receiver = m_boundTransports.find( GetAddressKey( datagram.address ) );
+	if( receiver == m_boundTransports.end() || datagram.byteCount > PACKET_MTU )
+	{
+		m_unreachableCount++;
+		return;
+	}
+
+	if( CheckSeededRandomChance( m_randomState, m_conditions.lossFraction ) )
+	{
+		m_lostCount++;
+		return;
+	}
+
+	uint latency_ms = m_conditions.latency_ms;
+	if( m_conditions.jitter_ms > 0U )
+		latency_ms += (uint) GetSeededRandomIntInRange( m_randomState, 0, (int)m_conditions.jitter_ms );
+
+	LoopbackNetworkTransport	&receiverTransport	= *receiver->second;
+	uint64_t					 arrivalHPC			= GetCurrentHPC() + Clock::GetHPCFromMilliSeconds( latency_ms );
+	uint64_t					&lastArrivalOfRoute	= receiverTransport.m_lastArrivalHPCOfRoute[ GetAddressKey( fromTransport.m_address ) ];
+
+	if( CheckSeededRandomChance( m_randomState, m_conditions.reorderFraction ) )
+	{
+		// Held back; doesn't hold back the route, so the later ones pass it
+		arrivalHPC += Clock::GetHPCFromMilliSeconds( m_conditions.reorderDelay_ms );
+		m_reorderedCount++;
+	}
+	else
+	{
+		// Jitter alone doesn't reorder a route
+		arrivalHPC			= (arrivalHPC > lastArrivalOfRoute) ? arrivalHPC : lastArrivalOfRoute;
+		lastArrivalOfRoute	= arrivalHPC;
+	}
+
+	LoopbackDatagram *inFlight = m_datagramPool.Acquire();
+	memcpy( inFlight->data, datagram.buffer, datagram.byteCount );
+	inFlight->byteCount		= datagram.byteCount;
+	inFlight->sender		= fromTransport.m_address;
+	inFlight->arrivalHPC	= arrivalHPC;
+	inFlight->sequence		= m_nextSequence++;
+
+	receiverTransport.m_arrivals.push( inFlight );
+}
+
+void LoopbackNetwork::ReleaseDatagram( LoopbackDatagram *datagram )
+{
+	m_datagramPool.Release( datagram );
+}
+
+uint64_t LoopbackNetwork::GetAddressKey( NetworkAddress const &address )
+{
+	return ( (uint64_t)address.addressIPv4 << 16 ) | (uint64_t)address.port;
+}
+
+LoopbackNetworkTransport::LoopbackNetworkTransport( LoopbackNetwork &network )
+	: m_network( network )
+{
+
+}
+
+LoopbackNetworkTransport::~LoopbackNetworkTransport()
+{
+	Close();
+}
+
+bool LoopbackNetworkTransport::Bind( NetworkAddress const &address, uint16_t portRange )
+{
+	Close();
+
+	NetworkAddress bindAddress = address;
+	if( m_network.BindTransport( *this, bindAddress, portRange ) == false )
+		return false;
+
+	m_address = bindAddress;
+	m_isBound = true;
+	return true;
+}
+
+void LoopbackNetworkTransport::Close()
+{
+	if( m_isBound == false )
+		return;
+
+	m_network.UnbindTransport( *this );
+	m_isBound = false;
+}
+
+uint LoopbackNetworkTransport::ReceiveBatch( UDPDatagram *datagrams, uint maxCount )
+{
+	if( m_isBound == false )
+		return 0U;
+
+	m_receiveCallCount++;
+
+	uint64_t	currentHPC		= m_network.GetCurrentHPC();
+	uint		receivedCount	= 0U;
+	while( receivedCount < maxCount && m_arrivals.empty() == false && m_arrivals.top()->arrivalHPC <= currentHPC )
+	{
+		LoopbackDatagram *arrived = m_arrivals.top();
+		m_arrivals.pop();
+
+		// Like a datagram socket: whatever doesn't fit in the buffer is gone
+		UDPDatagram &datagram	= datagrams[ receivedCount ];
+		datagram.byteCount		= (arrived->byteCount < datagram.bufferSize) ? arrived->byteCount : datagram.bufferSize;
+		datagram.address		= arrived->sender;
+		memcpy( datagram.buffer, arrived->data, datagram.byteCount );
+
+		m_network.ReleaseDatagram( arrived );
+		m_network.m_deliveredCount++;
+		m_network.m_deliveredByteCount += datagram.byteCount;
+		receivedCount++;
+	}
+
+	return receivedCount;
+}
+
+uint LoopbackNetworkTransport::SendBatch( UDPDatagram const *datagrams, uint count )
+{
+	if( m_isBound == false )
+		return 0U;
+
+	m_sendCallCount++;
+
+	for( uint i = 0; i < count; i++ )
+		m_network.SendDatagram( *this, datagrams[i] );
+
+	// Like UDP, a lost one still went out
+	return count;
+}
+
+void NetworkLoopbackJoin( Command &cmd )
+{
+	std::string countStr	= cmd.GetNextString();
+	std::string lossStr		= cmd.GetNextString();
+	std::string latencyStr	= cmd.GetNextString();
+	std::string jitterStr	= cmd.GetNextString();
+	std::string reorderStr	= cmd.GetNextString();
+	std::string seedStr		= cmd.GetNextString();
+	uint clientCount		= ( countStr	!= "" ) ? (uint) atoi( countStr.c_str() )	: 200U;
+	uint lossPercent		= ( lossStr		!= "" ) ? (uint) atoi( lossStr.c_str() )	: 5U;
+	uint latency_ms			= ( latencyStr	!= "" ) ? (uint) atoi( latencyStr.c_str() )	: 50U;
+	uint jitter_ms			= ( jitterStr	!= "" ) ? (uint) atoi( jitterStr.c_str() )	: 20U;
+	uint reorderPercent		= ( reorderStr	!= "" ) ? (uint) atoi( reorderStr.c_str() )	: 2U;
+	uint seed				= ( seedStr		!= "" ) ? (uint) atoi( seedStr.c_str() )	: 1U;
+	if( clientCount == 0U || clientCount >= MAX_SESSION_CONNECTIONS || lossPercent >= 100U || reorderPercent > 100U )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "net_loopback_join: clientCount has to be in [1, %u], loss less than 100%% & reorder at most 100%%!", MAX_SESSION_CONNECTIONS - 1U );
+		return;
+	}
+
+	LoopbackNetworkConditions conditions;
+	conditions.lossFraction		= (float)lossPercent * 0.01f;
+	conditions.latency_ms		= latency_ms;
+	conditions.jitter_ms		= jitter_ms;
+	conditions.reorderFraction	= (float)reorderPercent * 0.01f;
+
+	// Own clock for the whole run, so the master clock isn't advanced under the game
+	Clock simulationClock;
+	LoopbackNetwork network( seed, &simulationClock );
+	network.SetConditions( conditions );
+
+	// Host & clients each have their own session; only the network is shared
+	NetworkSession host( nullptr, &simulationClock );
+	host.UseTransport( new LoopbackNetworkTransport( network ) );
+	host.Host( "host", GAME_PORT, 0U );
+	if( host.IsRunning() == false )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "net_loopback_join: Couldn't host!" );
+		return;
+	}
+
+	NetworkAddress const	hostAddress = host.GetTransport()->GetAddress();
+	std::vector< NetworkSession* > clients;
+	std::vector< uint >			   readyFrames( clientCount, 0U );
+	for( uint i = 0U; i < clientCount; i++ )
+	{
+		NetworkSession *client = new NetworkSession( nullptr, &simulationClock );
+		client->SetSimulationSeed( seed + i + 1U );
+		client->UseTransport( new LoopbackNetworkTransport( network ) );
+		client->Join( Stringf( "client%u", i ).c_str(), hostAddress );
+		clients.push_back( client );
+	}
+
+	// Fixed frames on the simulation clock, so the same seed plays out the same
+	double const	frameSeconds	= 1.0 / 60.0;
+	uint const		maxFrameCount	= 60U * 30U;
+	uint			readyCount		= 0U;
+	uint			frameCount		= 0U;
+	uint64_t		startHPC		= Clock::GetCurrentHPC();
+	while( readyCount < clientCount && frameCount < maxFrameCount )
+	{
+		simulationClock.AdvanceClock( Clock::GetHPCFromSeconds( frameSeconds ) );
+		frameCount++;
+
+		host.Update();
+		for( uint i = 0U; i < clientCount; i++ )
+		{
+			clients[i]->Update();
+
+			if( readyFrames[i] == 0U && clients[i]->m_state == NET_SESSION_READY )
+			{
+				readyFrames[i] = frameCount;
+				readyCount++;
+			}
+		}
+	}
+	double elapsedSeconds = Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+
+	// Fingerprint of the run; same arguments => same fingerprint
+	uint fingerprint = 2166136261U;
+	auto hashValue	 = [ &fingerprint ]( uint value )
+	{
+		fingerprint = ( fingerprint ^ value ) * 16777619U;
+	};
+	for( uint i = 0U; i < clientCount; i++ )
+	{
+		hashValue( readyFrames[i] );
+		hashValue( clients[i]->GetMyConnectionIndex() );
+	}
+	hashValue( network.GetSentCount() );
+	hashValue( network.GetLostCount() );
+	hashValue( network.GetReorderedCount() );
+
+	ConsolePrintf( "net_loopback_join: %u clients, %u%% loss, %u+%ums latency, %u%% reordered, seed %u", clientCount, lossPercent, latency_ms, jitter_ms, reorderPercent, seed );
+	ConsolePrintf( ( readyCount == clientCount ) ? RGBA_GREEN_COLOR : RGBA_RED_COLOR, "  %u joined in %.2f simulated seconds ( %u frames ), %.3f s of wall time", readyCount, (double)frameCount * frameSeconds, frameCount, elapsedSeconds );
+	ConsolePrintf( "  packets: %u sent, %u delivered, %u lost, %u reordered, %u unreachable; fingerprint %08x",
+				   network.GetSentCount(), network.GetDeliveredCount(), network.GetLostCount(), network.GetReorderedCount(), network.GetUnreachableCount(), fingerprint );
+
+	// Clients first; the host would hang up on them anyway
+	for( uint i = 0U; i < clientCount; i++ )
+		delete clients[i];
+}
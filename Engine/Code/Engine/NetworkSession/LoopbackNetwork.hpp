@@ -0,0 +1,145 @@
+#pragma once
+#include <map>
+#include <queue>
+#include <vector>
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Clock.hpp"
+#include "Engine/Input/Command.hpp"
+#include "Engine/NetworkSession/NetworkTransport.hpp"
+#include "Engine/NetworkSession/NetworkObjectPool.hpp"
+
+//------------------------------------------------------------------------------------------
+// An in-process network; every LoopbackNetworkTransport of it can send to the others, no sockets involved
+//	- So one process can run a host & hundreds of clients, each with its own NetworkSession
+//	- Loss, latency, jitter & reordering get applied on send, from one seeded random sequence, and arrival times are on the
+//	  reference clock ( the master clock, by default ); give it a private Clock, shared with the sessions, & the same seed gives the same run
+//	- Jitter keeps the order of a route ( sender => receiver ); only the reordered packets let the later ones pass them
+//	- The network has to outlive its transports
+//
+class LoopbackNetworkTransport;
+
+struct LoopbackNetworkConditions
+{
+public:
+	float	lossFraction	= 0.f;						// Chance a packet never arrives
+	uint	latency_ms		= 0U;						// One way
+	uint	jitter_ms		= 0U;						// Up to this much more latency, per packet
+	float	reorderFraction	= 0.f;						// Chance a packet gets held back for reorderDelay_ms more
+	uint	reorderDelay_ms	= 20U;
+};
+
+// A packet in flight
+struct LoopbackDatagram
+{
+public:
+	byte_t			data[ PACKET_MTU ];
+	size_t			byteCount		= 0U;
+	NetworkAddress	sender;
+	uint64_t		arrivalHPC		= 0U;				// On the network's reference clock
+	uint64_t		sequence		= 0U;				// Order of sending; breaks the ties of arrivalHPC
+};
+
+struct CompareLoopbackDatagramArrival
+{
+	bool operator () ( LoopbackDatagram const *lhs, LoopbackDatagram const *rhs ) const
+	{
+		if( lhs->arrivalHPC != rhs->arrivalHPC )
+			return lhs->arrivalHPC > rhs->arrivalHPC;
+
+		return lhs->sequence > rhs->sequence;
+	}
+};
+
+typedef std::priority_queue< LoopbackDatagram*, std::vector< LoopbackDatagram* >, CompareLoopbackDatagramArrival > LoopbackDatagramQueue;
+
+class LoopbackNetwork
+{
+	friend class LoopbackNetworkTransport;
+
+public:
+	 LoopbackNetwork( uint seed = 1U, Clock const *referenceClock = nullptr );		// nullptr => master clock
+	~LoopbackNetwork();
+
+	LoopbackNetwork( LoopbackNetwork const &copy ) = delete;
+	LoopbackNetwork& operator = ( LoopbackNetwork const &copy ) = delete;
+
+private:
+	Clock const									*m_referenceClock	= nullptr;
+	uint										 m_randomState		= 1U;
+	LoopbackNetworkConditions					 m_conditions;
+
+	std::map< uint64_t, LoopbackNetworkTransport* >	m_boundTransports;							// Key: GetAddressKey()
+	NetworkObjectPool< LoopbackDatagram >		 m_datagramPool;
+	uint64_t									 m_nextSequence		= 0U;
+
+	// Stats
+	uint										 m_sentCount		= 0U;
+	uint										 m_deliveredCount	= 0U;						// Handed to a receiver
+	uint										 m_lostCount		= 0U;						// By the loss simulation
+	uint										 m_unreachableCount	= 0U;						// Nothing bound at that address, or too big
+	uint										 m_reorderedCount	= 0U;
+	uint64_t									 m_sentByteCount		= 0U;
+	uint64_t									 m_deliveredByteCount	= 0U;
+
+public:
+	void								SetConditions( LoopbackNetworkConditions const &conditions );
+	void								SetSeed( uint seed );								// Restarts the random sequence
+	void								ResetStats();
+
+	inline LoopbackNetworkConditions const&	GetConditions()			const { return m_conditions; }
+	inline uint							GetBoundTransportCount()	const { return (uint) m_boundTransports.size(); }
+	inline uint							GetInFlightCount()			const { return m_datagramPool.GetAcquiredCount(); }
+	inline uint							GetSentCount()				const { return m_sentCount; }
+	inline uint							GetDeliveredCount()			const { return m_deliveredCount; }
+	inline uint							GetLostCount()				const { return m_lostCount; }
+	inline uint							GetUnreachableCount()		const { return m_unreachableCount; }
+	inline uint							GetReorderedCount()			const { return m_reorderedCount; }
+	inline uint64_t						GetSentByteCount()			const { return m_sentByteCount; }
+	inline uint64_t						GetDeliveredByteCount()		const { return m_deliveredByteCount; }
+
+private:
+	bool								BindTransport	( LoopbackNetworkTransport &transport, NetworkAddress &inOutAddress, uint16_t portRange );
+	void								UnbindTransport	( LoopbackNetworkTransport &transport );
+	void								SendDatagram	( LoopbackNetworkTransport &fromTransport, UDPDatagram const &datagram );
+	void								ReleaseDatagram	( LoopbackDatagram *datagram );
+
+	inline uint64_t						GetCurrentHPC() const { return m_referenceClock->total.hpc; }
+
+	static uint64_t						GetAddressKey( NetworkAddress const &address );
+};
+
+class LoopbackNetworkTransport : public NetworkTransport
+{
+	friend class LoopbackNetwork;
+
+public:
+	 LoopbackNetworkTransport( LoopbackNetwork &network );
+	~LoopbackNetworkTransport();
+
+private:
+	LoopbackNetwork					&m_network;
+	NetworkAddress					 m_address;
+	bool							 m_isBound				= false;
+
+	LoopbackDatagramQueue			 m_arrivals;											// Sent to me; earliest arrival on top
+	std::map< uint64_t, uint64_t >	 m_lastArrivalHPCOfRoute;								// Sender's address key => arrivalHPC of its last in-order packet
+
+	uint							 m_receiveCallCount		= 0U;							// Stand in for the syscalls
+	uint							 m_sendCallCount		= 0U;
+
+public:
+	bool					Bind( NetworkAddress const &address, uint16_t portRange );		// Any address goes, it only has to be free on this network
+	void					Close();														// Whatever was in flight to me is dropped
+	bool					IsBound() const { return m_isBound; }
+	NetworkAddress const&	GetAddress() const { return m_address; }
+
+	uint					ReceiveBatch( UDPDatagram *datagrams, uint maxCount );			// Only the ones which have arrived by now
+	uint					SendBatch	( UDPDatagram const *datagrams, uint count );
+
+	uint					GetReceiveSyscallCount() const { return m_receiveCallCount; }
+	uint					GetSendSyscallCount() const { return m_sendCallCount; }
+};
+
+
+// Console Commands
+void NetworkLoopbackJoin( Command &cmd );				// net_loopback_join [clientCount] [lossPercent] [latency_ms] [jitter_ms] [reorderPercent] [seed]
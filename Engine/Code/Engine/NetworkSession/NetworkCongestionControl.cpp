@@ -0,0 +1,119 @@
+#pragma once
+#include "NetworkCongestionControl.hpp"
+#include "Engine/Core/Clock.hpp"
+
+NetworkCongestionControl::NetworkCongestionControl()
+{
+
+}
+
+NetworkCongestionControl::~NetworkCongestionControl()
+{
+
+}
+
+void NetworkCongestionControl::OnPacketSent()
+{
+	m_inFlightCount++;
+}
+
+void NetworkCongestionControl::OnPacketAcked( float rttSeconds, bool wasCountedAsLost, uint64_t nowHPC )
+{
+	// RTT
+	if( m_hasRTTSample == false )
+	{
+		m_hasRTTSample			= true;
+		m_smoothedRTT			= rttSeconds;
+		m_rttVariation			= rttSeconds * 0.5f;
+		m_windowMinRTT			= rttSeconds;
+		m_previousWindowMinRTT	= rttSeconds;
+		m_windowStartHPC		= nowHPC;
+	}
+	else
+	{
+		float deviation	= ( rttSeconds > m_smoothedRTT ) ? rttSeconds - m_smoothedRTT : m_smoothedRTT - rttSeconds;
+		m_rttVariation	= ( 0.75f * m_rttVariation ) + ( 0.25f * deviation );
+		m_smoothedRTT	= ( 0.875f * m_smoothedRTT ) + ( 0.125f * rttSeconds );
+
+		// Window over => the previous one gets forgotten
+		if( nowHPC - m_windowStartHPC >= Clock::GetHPCFromSeconds( MIN_RTT_WINDOW ) )
+		{
+			m_previousWindowMinRTT	= m_windowMinRTT;
+			m_windowMinRTT			= rttSeconds;
+			m_windowStartHPC		= nowHPC;
+		}
+		else
+			m_windowMinRTT = ( rttSeconds < m_windowMinRTT ) ? rttSeconds : m_windowMinRTT;
+	}
+	m_minRTT = ( m_windowMinRTT < m_previousWindowMinRTT ) ? m_windowMinRTT : m_previousWindowMinRTT;
+
+	m_ackedCount++;
+	m_lossFraction *= 0.95f;
+
+	// It left the flight when it counted as lost; the cut it caused stays
+	if( wasCountedAsLost )
+	{
+		m_lateAckCount++;
+		return;
+	}
+
+	if( m_inFlightCount > 0U )
+		m_inFlightCount--;
+
+	// Queue building up => hold
+	bool isDelayed = rttSeconds > ( 2.f * m_minRTT ) + 0.02f;
+	if( isDelayed )
+		return;
+
+	// Grow
+	if( IsInSlowStart() )
+		m_packetBudget += 1.f;
+	else
+		m_packetBudget += 1.f / m_packetBudget;
+
+	m_packetBudget = ( m_packetBudget < MAX_PACKET_BUDGET ) ? m_packetBudget : MAX_PACKET_BUDGET;
+}
+
+void NetworkCongestionControl::OnPacketLost( uint64_t sentTimeHPC, uint64_t nowHPC )
+{
+	m_lostCount++;
+	m_lossFraction = ( 0.95f * m_lossFraction ) + 0.05f;
+
+	if( m_inFlightCount > 0U )
+		m_inFlightCount--;
+
+	// Already cut for this one
+	if( sentTimeHPC < m_recoveryStartHPC )
+		return;
+
+	m_slowStartThreshold	= m_packetBudget * 0.7f;
+	m_slowStartThreshold	= ( m_slowStartThreshold > MIN_PACKET_BUDGET ) ? m_slowStartThreshold : MIN_PACKET_BUDGET;
+	m_packetBudget			= m_slowStartThreshold;
+	m_recoveryStartHPC		= nowHPC;
+	m_budgetCutCount++;
+}
+
+float NetworkCongestionControl::GetSendFrequency( float maxFrequencyHz ) const
+{
+	if( m_hasRTTSample == false || maxFrequencyHz <= MIN_SEND_FREQUENCY )
+		return maxFrequencyHz;
+
+	float smoothedRTT	= ( m_smoothedRTT > 0.001f ) ? m_smoothedRTT : 0.001f;
+	float frequency		= m_packetBudget / smoothedRTT;
+
+	frequency = ( frequency > MIN_SEND_FREQUENCY ) ? frequency : MIN_SEND_FREQUENCY;
+	frequency = ( frequency < maxFrequencyHz )	  ? frequency : maxFrequencyHz;
+	return frequency;
+}
+
+double NetworkCongestionControl::GetRetransmitTimeout() const
+{
+	if( m_hasRTTSample == false )
+		return INITIAL_RETRANSMIT_TIMEOUT;
+
+	double timeout = (double)m_smoothedRTT + ( 4.0 * (double)m_rttVariation );
+
+	timeout = ( timeout > MIN_RETRANSMIT_TIMEOUT ) ? timeout : MIN_RETRANSMIT_TIMEOUT;
+	timeout = ( timeout < MAX_RETRANSMIT_TIMEOUT ) ? timeout : MAX_RETRANSMIT_TIMEOUT;
+	return timeout;
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+
+//------------------------------------------------------------------------------------------
+// Send rate & packet budget of one NetworkConnection, from the feedback of its own packets
+//	- Packet budget: how many tracked packets may be in flight ( sent, neither acked nor lost ); AIMD, like TCP's window
+//		- Slow start: +1 per ack, until the threshold; then +1/budget per ack
+//		- A loss cuts it to 0.7 of itself, not below MIN_PACKET_BUDGET; once per RTT, losses of packets sent before the cut don't cut it again
+//		- RTT well above the lowest recent one means a queue is building up, the budget holds instead of growing
+//		- Lowest RTT is of the last one to two MIN_RTT_WINDOWs, so it follows a route which got slower instead of holding forever
+//	- Send rate: the budget spread over one smoothed RTT, so a budget isn't spent in a burst
+//	- Retransmit timeout: smoothed RTT + 4 * RTT variation, like RFC 6298; also when an unacked packet counts as lost
+//	- Packets which are just acks aren't tracked, so they're not in here; they keep flowing when the budget is spent
+//
+class NetworkCongestionControl
+{
+public:
+	 NetworkCongestionControl();
+	~NetworkCongestionControl();
+
+public:
+	static constexpr float	INITIAL_PACKET_BUDGET	= 8.f;
+	static constexpr float	MIN_PACKET_BUDGET		= 4.f;
+	static constexpr float	MAX_PACKET_BUDGET		= (float)( MAX_TRACKED_PACKETS / 2 );	// Half the trackers: the rest cover the ones still waiting to count as lost
+	static constexpr float	MIN_SEND_FREQUENCY		= 5.f;									// Hz; heartbeats & acks need to keep going
+	static constexpr double	MIN_RETRANSMIT_TIMEOUT	= 0.05;
+	static constexpr double	MAX_RETRANSMIT_TIMEOUT	= 2.0;
+	static constexpr double	INITIAL_RETRANSMIT_TIMEOUT	= 0.1;							// Until the first RTT sample
+	static constexpr uint16_t	LOSS_ACK_THRESHOLD	= 3U;									// Unacked, while this many later packets got acked => lost
+	static constexpr double	MIN_RTT_WINDOW			= 10.0;									// Seconds
+
+private:
+	// Budget
+	float		m_packetBudget			= INITIAL_PACKET_BUDGET;
+	float		m_slowStartThreshold	= MAX_PACKET_BUDGET;
+	uint		m_inFlightCount			= 0U;
+	uint64_t	m_recoveryStartHPC		= 0U;			// Losses of the packets sent before this are part of the last cut
+
+	// RTT, in seconds
+	bool		m_hasRTTSample			= false;
+	float		m_smoothedRTT			= 0.f;
+	float		m_rttVariation			= 0.f;
+	float		m_minRTT				= 0.f;			// Lower of the two windows'
+	float		m_windowMinRTT			= 0.f;			// Of the current window
+	float		m_previousWindowMinRTT	= 0.f;
+	uint64_t	m_windowStartHPC		= 0U;
+
+	// Loss, smoothed over the outcomes of the packets
+	float		m_lossFraction			= 0.f;
+
+	// Stats
+	uint		m_ackedCount			= 0U;
+	uint		m_lostCount				= 0U;
+	uint		m_lateAckCount			= 0U;			// Acked after counting as lost
+	uint		m_budgetCutCount		= 0U;
+	uint		m_blockedCount			= 0U;			// Flushes which had something to send & no budget left
+
+public:
+	// Feedback
+	void		OnPacketSent	();
+	void		OnPacketAcked	( float rttSeconds, bool wasCountedAsLost, uint64_t nowHPC );
+	void		OnPacketLost	( uint64_t sentTimeHPC, uint64_t nowHPC );			// Times on the connection's reference clock
+	void		OnBlocked		()		{ m_blockedCount++; }
+
+	// Pacing
+	bool		CanSendPacket() const	{ return m_inFlightCount < (uint)m_packetBudget; }
+	float		GetSendFrequency( float maxFrequencyHz ) const;				// In [ MIN_SEND_FREQUENCY, maxFrequencyHz ]
+	double		GetRetransmitTimeout() const;								// Seconds
+
+	// Stats
+	inline float	GetPacketBudget()		const { return m_packetBudget; }
+	inline uint		GetInFlightCount()		const { return m_inFlightCount; }
+	inline bool		IsInSlowStart()			const { return m_packetBudget < m_slowStartThreshold; }
+	inline float	GetSmoothedRTT()		const { return m_smoothedRTT; }
+	inline float	GetRTTVariation()		const { return m_rttVariation; }
+	inline float	GetMinRTT()				const { return m_minRTT; }
+	inline float	GetLossFraction()		const { return m_lossFraction; }
+	inline uint		GetAckedCount()			const { return m_ackedCount; }
+	inline uint		GetLostCount()			const { return m_lostCount; }
+	inline uint		GetLateAckCount()		const { return m_lateAckCount; }
+	inline uint		GetBudgetCutCount()		const { return m_budgetCutCount; }
+	inline uint		GetBlockedCount()		const { return m_blockedCount; }
+};
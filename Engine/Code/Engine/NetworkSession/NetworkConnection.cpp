@@ -1,4 +1,5 @@
 #pragma once
+#include <algorithm>
 #include <bitset>
 #include "NetworkConnection.hpp"
 #include "Engine/Core/Clock.hpp"
@@ -35,10 +36,15 @@ bool NetworkConnectionInfo::operator==( NetworkConnectionInfo const &b ) const
 NetworkConnection::NetworkConnection( int idx, NetworkAddress const &addr, std::string networkID, NetworkSession &parentSession )
 	: m_info( idx, networkID, addr )
 	, m_parentSession( parentSession )
-	, m_sendRateTimer( GetMasterClock() )
-	, m_heartbeatTimer( GetMasterClock() )
-	, m_confirmReliablesTimer( GetMasterClock() )
+	, m_sendRateTimer( parentSession.GetReferenceClock() )
+	, m_heartbeatTimer( parentSession.GetReferenceClock() )
+	, m_confirmReliablesTimer( parentSession.GetReferenceClock() )
 {
+	uint64_t nowHPC			= GetReferenceClock()->total.hpc;
+	m_lastSendTimeHPC		= nowHPC;
+	m_lastReceivedTimeHPC	= nowHPC;
+	m_byteBudgetRefillHPC	= nowHPC;
+
 	SetSendFrequencyTo( m_sendFrequency );
 	UpdateHeartbeatTimer();
 
@@ -53,7 +59,42 @@ NetworkConnection::NetworkConnection( NetworkConnectionInfo const &info, Network
 
 NetworkConnection::~NetworkConnection()
 {
+	// Hand every queued message back to the session's pool
+	for( uint i = 0; i < m_outgoingUnreliables.size(); i++ )
+		m_parentSession.ReleaseMessage( m_outgoingUnreliables[i] );
+
+	for( uint i = 0; i < m_outgoingReliables.size(); i++ )
+		m_parentSession.ReleaseMessage( m_outgoingReliables[i] );
+
+	for( uint i = 0; i < m_unconfirmedSentReliables.size(); i++ )
+		m_parentSession.ReleaseMessage( m_unconfirmedSentReliables[i] );
+
+	for( uint i = 0; i < m_outgoingFragments.size(); i++ )
+		m_parentSession.ReleaseMessage( m_outgoingFragments[i] );
+
+	for( uint c = 0; c < MAX_NETWORK_MESSAGE_CHANNELS; c++ )
+	{
+		NetworkMessage *pendingMessage = m_messageChannels[c].TakeAnyPendingMessage();
+		while ( pendingMessage != nullptr )
+		{
+			ReleaseReceivedMessage( pendingMessage );
+			pendingMessage = m_messageChannels[c].TakeAnyPendingMessage();
+		}
+	}
+
+	// Blobs, half way through
+	for( uint i = 0; i < m_outgoingBlobs.size(); i++ )
+		delete m_outgoingBlobs[i];
+	m_outgoingBlobs.clear();
 
+	for( std::map< uint16_t, NetworkIncomingBlob* >::iterator it = m_incomingBlobs.begin(); it != m_incomingBlobs.end(); it++ )
+		delete it->second;
+	m_incomingBlobs.clear();
+}
+
+Clock const* NetworkConnection::GetReferenceClock() const
+{
+	return m_parentSession.GetReferenceClock();
 }
 
 bool NetworkConnection::operator==( NetworkConnection const &b ) const
@@ -88,11 +129,12 @@ void NetworkConnection::UpdateStateTo( eNetworkConnectionState newState, bool br
 
 void NetworkConnection::OnReceivePacket( NetworkPacketHeader receivedPacketHeader )
 {
-	// We need to send back updated acks, asap
-	m_immediatlyRespondForAck = true;
+	// We need to send back updated acks, asap; not for a packet which was just acks, or we'd be answering each other forever
+	if( receivedPacketHeader.ack != INVALID_PACKET_ACK )
+		m_immediatlyRespondForAck = true;
 
 	// Last Received Time
-	m_lastReceivedTimeHPC = Clock::GetCurrentHPC();
+	m_lastReceivedTimeHPC = GetReferenceClock()->total.hpc;
 	
 	// Update Bit Field - Received Acks
 	uint16_t receivedAck = receivedPacketHeader.ack;
@@ -100,27 +142,30 @@ void NetworkConnection::OnReceivePacket( NetworkPacketHeader receivedPacketHeade
 	{
 		if( m_highestReceivedAck != INVALID_PACKET_ACK )
 		{
-			if( receivedAck > m_highestReceivedAck )
+			if( CycleLess( m_highestReceivedAck, receivedAck ) )
 			{
 				// Shift one bit, and mark myself as received
-				m_receivedAcksBitfield <<= 1;
-				m_receivedAcksBitfield |= 0x0001;
+				// Shift the remaining difference; acks skip INVALID_PACKET_ACK when they wrap
+				uint16_t d = receivedAck - m_highestReceivedAck;
+				if( receivedAck < m_highestReceivedAck )
+					d--;
 
-				// Shift the remaining difference
-				int d = (receivedAck - m_highestReceivedAck) - 1;
-				m_receivedAcksBitfield <<= d;
+				if( d > 16U )
+					m_receivedAcksBitfield = 0U;
+				else
+					m_receivedAcksBitfield = (uint16_t)( ( (m_receivedAcksBitfield << 1) | 0x0001 ) << (d - 1U) );
 
 				m_highestReceivedAck = receivedAck;
 			}
-			else
+			else if( receivedAck != m_highestReceivedAck )
 			{
 				// Mark bit for the receivedPacket's ack
-				int s = (m_highestReceivedAck - receivedAck) - 1;
+				uint16_t d = m_highestReceivedAck - receivedAck;
+				if( receivedAck > m_highestReceivedAck )
+					d--;
 
-				uint16_t maskBit = 0x0001;
-				maskBit <<= s;
-
-				m_receivedAcksBitfield |= maskBit;
+				if( d <= 16U )
+					m_receivedAcksBitfield |= (uint16_t)( 0x0001 << (d - 1U) );
 			}
 		}
 		else
@@ -170,17 +215,62 @@ void NetworkConnection::ConfirmPacketReceived( uint16_t ack )
 	if( ack == tracker.ack )
 	{
 		// Calculate RTT
-		uint64_t rttHPC			= Clock::GetCurrentHPC() - tracker.sentTimeHPC;
+		uint64_t nowHPC			= GetReferenceClock()->total.hpc;
+		uint64_t rttHPC			= nowHPC - tracker.sentTimeHPC;
 		double	 secondsThisRTT	= Clock::GetSecondsFromHPC( rttHPC );
 		m_rtt = (0.9f * m_rtt) + (0.1f * (float)secondsThisRTT);
 
+		m_lastRTT = (float)secondsThisRTT;
+		m_rttSampleCount++;
+
+		m_congestionControl.OnPacketAcked( (float)secondsThisRTT, tracker.isCountedAsLost, nowHPC );
+		if( m_highestConfirmedAck == INVALID_PACKET_ACK || CycleGreater( ack, m_highestConfirmedAck ) )
+			m_highestConfirmedAck = ack;
+
 		UpdateHigestConfirmedReliableID( tracker );
 
+		// Snapshot acks
+		if( tracker.snapshotID != INVALID_SNAPSHOT_ID )
+		{
+			if( m_highestAckedSnapshotID == INVALID_SNAPSHOT_ID || CycleGreater( tracker.snapshotID, m_highestAckedSnapshotID ) )
+				m_highestAckedSnapshotID = tracker.snapshotID;
+		}
+
 		// Invalidate
 		tracker.Invalidate();
 	}
 }
 
+void NetworkConnection::DetectLostPackets()
+{
+	// Oldest first; stops at the first one which may still get acked
+	uint64_t const	timeoutHPC	= Clock::GetHPCFromSeconds( m_congestionControl.GetRetransmitTimeout() );
+	uint64_t const	nowHPC		= GetReferenceClock()->total.hpc;
+	uint16_t const	nextAck		= ( m_nextSentAck == INVALID_PACKET_ACK ) ? 0U : m_nextSentAck;
+	while( m_oldestInFlightAck != nextAck )
+	{
+		PacketTracker &tracker = m_packetTrackers[ m_oldestInFlightAck % MAX_TRACKED_PACKETS ];
+
+		// Not acked or given up on, yet
+		if( tracker.ack == m_oldestInFlightAck && tracker.isCountedAsLost == false )
+		{
+			bool isTimedOut		= ( nowHPC - tracker.sentTimeHPC ) > timeoutHPC;
+			bool isAckedPast	= ( m_highestConfirmedAck != INVALID_PACKET_ACK ) && CycleGreater( m_highestConfirmedAck, m_oldestInFlightAck )
+								&& (uint16_t)( m_highestConfirmedAck - m_oldestInFlightAck ) >= NetworkCongestionControl::LOSS_ACK_THRESHOLD;
+			if( isTimedOut == false && isAckedPast == false )
+				break;
+
+			tracker.isCountedAsLost = true;
+			m_congestionControl.OnPacketLost( tracker.sentTimeHPC, nowHPC );
+		}
+
+		// Acks skip INVALID_PACKET_ACK when they wrap
+		m_oldestInFlightAck++;
+		if( m_oldestInFlightAck == INVALID_PACKET_ACK )
+			m_oldestInFlightAck++;
+	}
+}
+
 void NetworkConnection::ProcessReceivedMessage( NetworkMessage &receivedMessage, NetworkSender sender )
 {
 	if( receivedMessage.IsReliable() == false )
@@ -194,63 +284,164 @@ void NetworkConnection::ProcessReceivedMessage( NetworkMessage &receivedMessage,
 		else
 			MarkReliableReceived( reliableID );										// if not, mark as received
 
-		// If order doesn't matter
-		if( receivedMessage.IsInOrder() == false )
-			receivedMessage.GetDefinition()->callback( receivedMessage, sender );	// Do the callback, immediately
-		else
+		DeliverReliable( receivedMessage, sender, false );
+	}
+}
+
+bool NetworkConnection::ProcessReceivedFragment( NetworkMessage const &fragment, NetworkSender &sender )
+{
+	NetworkFragmentHeader fragmentHeader;
+	if( fragmentHeader.Read( fragment ) == false || fragmentHeader.IsValid() == false )
+	{
+		GUARANTEE_RECOVERABLE( false, "Error: Received a bad fragment header!" );
+		return false;
+	}
+
+	// Has to be a reliable the session knows, & not a fragment itself
+	NetworkMessageDefinition const *blobDefinition = m_parentSession.GetRegisteredMessageDefination( (int)fragmentHeader.definitionIndex );
+	if( blobDefinition == nullptr || blobDefinition->IsReliable() == false || fragmentHeader.definitionIndex == NET_MESSAGE_FRAGMENT )
+	{
+		GUARANTEE_RECOVERABLE( false, "Error: Received a fragment of an unknown message!" );
+		return false;
+	}
+
+	// First fragment of it to arrive sizes the blob
+	std::map< uint16_t, NetworkIncomingBlob* >::iterator blobIt = m_incomingBlobs.find( fragmentHeader.blobID );
+	if( blobIt == m_incomingBlobs.end() )
+	{
+		// Sender keeps no more than this many fragments in flight, so no more blobs than that are half way through
+		if( m_incomingBlobs.size() >= MAX_FRAGMENTS_IN_FLIGHT )
 		{
-			// Order matters! 
-			// Add to message to the right channel
-			uint channelId = receivedMessage.GetChannel();
-			NetworkMessageChannel &channel = m_messageChannels[ channelId ];
-			channel.m_pendingMessagesToProcess.push( NetworkMessageAndSender( new NetworkMessage(receivedMessage), new NetworkSender(sender) ) );
-
-			// And then process all the message which are in order..
-			bool listIsNotEmpty = channel.m_pendingMessagesToProcess.size() > 0;
-			while ( listIsNotEmpty )
-			{
-				NetworkMessageAndSender const &top = channel.m_pendingMessagesToProcess.top();
-				
-				bool expectedIDMatches = (channel.GetExpectedSequenceID() == top.message->m_header.sequenceID);
-				if( expectedIDMatches == false )
-					break;															// Expecting some other ID to get processed before this one! Just break.
-				else
-				{
-					// Increment for next time loop
-					channel.IncrementExpectedSequenceID();
+			GUARANTEE_RECOVERABLE( false, "Error: Too many incoming blobs at once!" );
+			return false;
+		}
 
-					// Process the message (i.e. do the callback)
-					top.message->GetDefinition()->callback( *top.message, *top.sender );
+		blobIt = m_incomingBlobs.insert( std::make_pair( fragmentHeader.blobID, new NetworkIncomingBlob( fragmentHeader ) ) ).first;
+	}
 
-					delete top.message;
-					delete top.sender;
+	NetworkIncomingBlob *incomingBlob = blobIt->second;
+	if( incomingBlob->AddFragment( fragmentHeader, fragment ) == false )
+	{
+		GUARANTEE_RECOVERABLE( false, "Error: Fragment doesn't fit its blob!" );
+		return false;
+	}
 
-					// Remove the message from top
-					channel.m_pendingMessagesToProcess.pop();
+	if( incomingBlob->IsComplete() == false )
+		return true;
 
-					listIsNotEmpty = channel.m_pendingMessagesToProcess.size() > 0;
-				}
-			}
+	// Last one is in: back to the original message
+	NetworkMessage *reassembledMessage = new NetworkMessage();
+	bool isReassembled = incomingBlob->Reassemble( *reassembledMessage );
+
+	delete incomingBlob;
+	m_incomingBlobs.erase( blobIt );
+
+	if( isReassembled == false )
+	{
+		GUARANTEE_RECOVERABLE( false, "Error: Couldn't reassemble the blob!" );
+		delete reassembledMessage;
+		return false;
+	}
+
+	reassembledMessage->SetDefinition( blobDefinition );
+	reassembledMessage->m_header.sequenceID = fragmentHeader.sequenceID;
+	m_receivedBlobsCount++;
+
+	DeliverReliable( *reassembledMessage, sender, true );
+	return true;
+}
+
+void NetworkConnection::DeliverReliable( NetworkMessage &receivedMessage, NetworkSender &sender, bool isReassembled )
+{
+	// If order doesn't matter
+	if( receivedMessage.IsInOrder() == false )
+	{
+		receivedMessage.GetDefinition()->callback( receivedMessage, sender );		// Do the callback, immediately
+		if( isReassembled )
+			delete &receivedMessage;
+
+		return;
+	}
+
+	// Order matters! 
+	uint channelId = receivedMessage.GetChannel();
+	NetworkMessageChannel &channel = m_messageChannels[ channelId ];
+	uint16_t sequenceID = receivedMessage.m_header.sequenceID;
+
+	if( sequenceID != channel.GetExpectedSequenceID() )
+	{
+		// Early; it waits in the channel, in a pooled copy, since the packet's buffer gets reused
+		if( channel.CanBufferSequenceID( sequenceID ) == false )
+		{
+			GUARANTEE_RECOVERABLE( false, "Error: In-order message is out of the channel's window!" );
+			if( isReassembled )
+				delete &receivedMessage;
+
+			return;
 		}
+
+		// A reassembled one is mine already, it waits as it is
+		NetworkMessage *bufferedMessage = &receivedMessage;
+		if( isReassembled )
+			m_reassembledMessages.push_back( bufferedMessage );
+		else
+		{
+			bufferedMessage = m_parentSession.AcquireMessage();
+			bufferedMessage->CopyFrom( receivedMessage );
+		}
+
+		channel.BufferPendingMessage( NetworkMessageAndSender( bufferedMessage, sender ) );
+		return;
+	}
+
+	// The one we're expecting: straight from the packet
+	channel.IncrementExpectedSequenceID();
+	receivedMessage.GetDefinition()->callback( receivedMessage, sender );
+	if( isReassembled )
+		delete &receivedMessage;
+
+	// And then process all the messages it was holding up
+	NetworkMessageAndSender pending;
+	while( channel.PopNextPendingMessage( pending ) )
+	{
+		NetworkSender pendingSender( m_parentSession, pending.senderAddress, pending.senderConnection );
+		pending.message->GetDefinition()->callback( *pending.message, pendingSender );
+
+		ReleaseReceivedMessage( pending.message );
 	}
 }
 
-bool NetworkConnection::CanSendReliableID( uint16_t reliableID )
+void NetworkConnection::ReleaseReceivedMessage( NetworkMessage *message )
+{
+	NetworkMessages::iterator reassembledIt = std::find( m_reassembledMessages.begin(), m_reassembledMessages.end(), message );
+	if( reassembledIt == m_reassembledMessages.end() )
+	{
+		m_parentSession.ReleaseMessage( message );
+		return;
+	}
+
+	m_reassembledMessages.erase( reassembledIt );
+	delete message;
+}
+
+bool NetworkConnection::CanSendReliableID( uint16_t reliableID ) const
 {
 	// No unconfirmed messages
 	if( m_unconfirmedSentReliables.size() == 0 )
 		return true;
 
-	uint16_t oldestUnconfirmedReliableID = 0xffff;
+	uint16_t oldestUnconfirmedReliableID = m_unconfirmedSentReliables[0]->m_header.reliableID;
 	for each (NetworkMessage* unconfirmedMsg in m_unconfirmedSentReliables)
 	{
 		uint16_t unconfirmedID = unconfirmedMsg->m_header.reliableID;
 
-		if( unconfirmedID < oldestUnconfirmedReliableID )
+		if( CycleLess( unconfirmedID, oldestUnconfirmedReliableID ) )
 			oldestUnconfirmedReliableID = unconfirmedID;
 	}
 
-	if( reliableID < oldestUnconfirmedReliableID + RELIABLE_MESSAGES_WINDOW )
+	// Wrap-around safe; the receiver's window depends on it
+	uint16_t distanceFromOldest = reliableID - oldestUnconfirmedReliableID;
+	if( distanceFromOldest < RELIABLE_MESSAGES_WINDOW )
 		return true;
 	else
 		return false;
@@ -258,7 +449,21 @@ bool NetworkConnection::CanSendReliableID( uint16_t reliableID )
 
 bool NetworkConnection::HasNewMessagesToSend() const
 {
-	return (m_outgoingReliables.size() > 0) || (m_outgoingUnreliables.size() > 0);
+	// Queued reliables count only if the window lets one go; otherwise we'd send a packet with nothing in it
+	bool canSendReliable = (m_outgoingReliables.size() > 0) && CanSendReliableID( m_nextReliableIDToSend );
+
+	return canSendReliable || (m_outgoingUnreliables.size() > 0);
+}
+
+bool NetworkConnection::HasSnapshotQueued() const
+{
+	for( size_t i = 0; i < m_outgoingUnreliables.size(); i++ )
+	{
+		if( m_outgoingUnreliables[i]->m_snapshotID != INVALID_SNAPSHOT_ID )
+			return true;
+	}
+
+	return false;
 }
 
 void NetworkConnection::Send( NetworkMessage &msg )
@@ -266,9 +471,20 @@ void NetworkConnection::Send( NetworkMessage &msg )
 	// Update the index of this messageToSend
 	NetworkMessageDefinition const *msgDef = m_parentSession.GetRegisteredMessageDefination( msg.m_name );
 	msg.SetDefinition( msgDef );
+
+	// Too big for a packet: reliables go in fragments, unreliables can't
+	if( NetworkPacket::GetPackedMessageSize( msg ) > PACKET_MTU - NETWORK_PACKET_HEADER_SIZE )
+	{
+		GUARANTEE_RECOVERABLE( msg.IsReliable(), "Error: Unreliable message is too big for a packet, dropping it!" );
+		if( msg.IsReliable() )
+			QueueBlob( msg );
+
+		return;
+	}
 	
-	// Push to the outgoing messages
-	NetworkMessage *msgToSend = new NetworkMessage( msg );
+	// Push to the outgoing messages; a pooled copy, so the caller can reuse msg
+	NetworkMessage *msgToSend = m_parentSession.AcquireMessage();
+	msgToSend->CopyFrom( msg );
 	
 	// Assign sequence ID, if it is in-order traffic
 	if( msgToSend->IsInOrder() )
@@ -280,6 +496,10 @@ void NetworkConnection::Send( NetworkMessage &msg )
 		channel.IncrementNextSendSequenceID();
 	}
 
+	// Waits with its own weight, to begin with
+	msgToSend->m_queuedHPC				= GetReferenceClock()->total.hpc;
+	msgToSend->m_accumulatedPriority	= msgDef->GetPriorityWeight();
+
 	if( msgToSend->IsReliable() )
 		m_outgoingReliables.push_back( msgToSend );
 	else
@@ -288,32 +508,57 @@ void NetworkConnection::Send( NetworkMessage &msg )
 
 void NetworkConnection::FlushMessages( bool ignoreSendRate /* = false */ )
 {
+	DetectLostPackets();
+
 	// If it hasn't been time to send, return
 	if( (m_sendRateTimer.CheckAndReset() != true) && (ignoreSendRate == false) )
 		return;
 
+	// Next one, at the pace the congestion control allows now
+	m_sendRateTimer.SetTimer( 1.0 / GetCurrentSendFrequency() );
+
+	RefillByteBudget();
+	DropStaleUnreliables();
+	QueueBlobFragments();
+
 	// If we need a heartbeat to be sent
 	if( m_heartbeatTimer.CheckAndReset() == true )
 	{
 		m_immediatlyRespondForAck = false;
 
-		NetworkMessage heartbeat( "heartbeat" );
-		uint netTime_ms = GetMasterClock()->total.ms;
-		heartbeat.WriteBytes( sizeof(uint), &netTime_ms );
-		Send( heartbeat );
+		NetworkMessage *heartbeat = m_parentSession.AcquireMessage();
+		heartbeat->m_name = "heartbeat";
+
+		uint netTime_ms = GetReferenceClock()->total.ms;
+		heartbeat->WriteBytes( sizeof(uint), &netTime_ms );
+		Send( *heartbeat );
+
+		m_parentSession.ReleaseMessage( heartbeat );
 	}
 	
+	// Out of packet budget: whatever is queued waits, the resend timer too; acks still go
+	bool canSendPacket = m_congestionControl.CanSendPacket() || ignoreSendRate;
+	if( canSendPacket == false && HasNewMessagesToSend() )
+		m_congestionControl.OnBlocked();
+
+	// Out of bytes, only the criticals go
+	bool hasNewMessagesToSend = HasNewMessagesToSend() && ( m_byteBudgetRate == 0U || m_byteBudget > 0.f || HasCriticalMessageQueued() );
+
 	// To return, if there's nothing to send
-	bool shouldResendUnconfirmedReliables = ShouldResendUnconfirmedReliables();
-	if( HasNewMessagesToSend() == false && shouldResendUnconfirmedReliables == false )
+	bool shouldResendUnconfirmedReliables = canSendPacket && ShouldResendUnconfirmedReliables();
+	if( canSendPacket == false || ( hasNewMessagesToSend == false && shouldResendUnconfirmedReliables == false ) )
 	{
+		// Blobs still go; their packets carry the acks too
+		if( canSendPacket )
+			FlushFragments();
+
 		// But if we gotta inform the connection about last received packet, do it!
 		if( m_immediatlyRespondForAck == true )
 		{
 			m_immediatlyRespondForAck = false;
 
 			// Prepare the packet header
-			NetworkPacket packetJustForAck;
+			NetworkPacket &packetJustForAck	= *m_parentSession.AcquirePacket();
 			NetworkPacketHeader &theHeader	= packetJustForAck.m_header;
 			theHeader.messageCount			= 0x00;
 			theHeader.connectionIndex		= GetIndexInSession();
@@ -322,35 +567,19 @@ void NetworkConnection::FlushMessages( bool ignoreSendRate /* = false */ )
 			theHeader.receivedAcksHistory	= m_receivedAcksBitfield;
 
 			// Send it
-			m_parentSession.SendPacket( packetJustForAck );
+			m_parentSession.SendPacket( &packetJustForAck );
 
 			// Update Analytics
-			m_lastSendTimeHPC = Clock::GetCurrentHPC();
+			m_lastSendTimeHPC = GetReferenceClock()->total.hpc;
 		}
 
 		return;
 	}
 
 	// Populate messages into thisPacket & its header
-	NetworkPacket		 thisPacket;
-	NetworkPacketHeader &thisHeader	= thisPacket.m_header;
-	thisHeader.messageCount			= 0x00;
-	thisHeader.connectionIndex		= GetIndexInSession();
-
-	// Ack
-	uint16_t ackToSend = GetNextAckToSend();
-	IncrementSentAck();
-	thisHeader.ack					= ackToSend;
-	thisHeader.highestReceivedAck	= m_highestReceivedAck;
-	thisHeader.receivedAcksHistory	= m_receivedAcksBitfield;
-
-	// If about to wrap around, calculate the loss
-	if( (ackToSend % MAX_TRACKED_PACKETS) == 0 )
-		m_loss = CalculateLoss();
-
-	// Track the packet
+	PacketTracker	*packetTracker	= nullptr;
+	NetworkPacket	&thisPacket		= AcquireTrackedPacket( packetTracker );
 	int reliableMessagesInThisPacker = 0;
-	PacketTracker *packetTracker = AddTrackedPacket( thisPacket.m_header.ack );
 
 
 	// Unconfirmed Reliable Messages
@@ -363,90 +592,210 @@ void NetworkConnection::FlushMessages( bool ignoreSendRate /* = false */ )
 			if( reliableMessagesInThisPacker >= MAX_RELIABLES_PER_PACKET )
 				break;
 
+			// Fragments get resent in their own packets
+			if( m_unconfirmedSentReliables[ucrID]->m_header.networkMessageDefinitionIndex == NET_MESSAGE_FRAGMENT )
+				continue;
+
 			bool writeSuccessfull = thisPacket.WriteMessage( *m_unconfirmedSentReliables[ucrID] );
 			if( writeSuccessfull )
 			{
+				SpendByteBudget( NetworkPacket::GetPackedMessageSize( *m_unconfirmedSentReliables[ucrID] ) );
 				reliableMessagesInThisPacker++;
+				m_resentReliablesCount++;
 				bool reliableIDAdded = packetTracker->AddNewReliableID( m_unconfirmedSentReliables[ucrID]->m_header.reliableID );
 				GUARANTEE_RECOVERABLE( reliableIDAdded, "Error: Couldn't add new reliable ID to PacketTracker!!" );
 			}
 			else
 			{
-				GUARANTEE_RECOVERABLE( false, "Error: Ancountered a message which might be too large to fit in current packet?!" );
-				continue;		// This message might be too big to fit?
+				// No room left for it in this packet, e.g. behind a few fragments; a smaller one may still fit
+				size_t packedSize = NetworkPacket::GetPackedMessageSize( *m_unconfirmedSentReliables[ucrID] );
+				GUARANTEE_RECOVERABLE( packedSize <= PACKET_MTU - NETWORK_PACKET_HEADER_SIZE, "Error: Ancountered a message which is too large to fit in a packet?!" );
+				continue;
 			}
 		}
 	}
 	
 
-	// Reliable Messages
+	// New Messages
 	// ...
-	while( m_outgoingReliables.size() > 0 && reliableMessagesInThisPacker < MAX_RELIABLES_PER_PACKET )
+	// Reliables & unreliables together, highest accumulated priority first; the ones left out wait for the next packet
+	SortByPriority( m_outgoingReliables );
+	SortByPriority( m_outgoingUnreliables );
+
+	bool	isChannelHeldBack[ MAX_NETWORK_MESSAGE_CHANNELS ] = { false };		// One of its in-order messages got left out, so the rest wait too
+	bool	hasBlobInChannel [ MAX_NETWORK_MESSAGE_CHANNELS ] = { false };		// In-order messages after a blob wait for all of its fragments to get confirmed
+	uint16_t blobSequenceIDs [ MAX_NETWORK_MESSAGE_CHANNELS ] = { 0U };
+	for( size_t i = 0; i < m_outgoingBlobs.size(); i++ )
 	{
-		// Give outgoing message proper reliable ID
-		uint16_t reliableIDToSend = GetNextReliableIDToSend();
+		NetworkOutgoingBlob const &blob = *m_outgoingBlobs[i];
+		if( blob.isInOrder && hasBlobInChannel[ blob.channel ] == false )
+		{
+			hasBlobInChannel[ blob.channel ]	= true;
+			blobSequenceIDs[ blob.channel ]		= blob.header.sequenceID;
+		}
+	}
 
-		if( CanSendReliableID( reliableIDToSend ) == false )
-			break;
+	bool	canSendReliables	= true;												// False once out of reliable IDs or reliables per packet
+	size_t	reliableIdx			= 0U;
+	size_t	unreliableIdx		= 0U;
+	size_t	keptReliables		= 0U;												// Left out ones move to the front, in the same order
+	size_t	keptUnreliables		= 0U;
+	while( reliableIdx < m_outgoingReliables.size() || unreliableIdx < m_outgoingUnreliables.size() )
+	{
+		bool pickReliable = ( reliableIdx < m_outgoingReliables.size() );
+		if( pickReliable && unreliableIdx < m_outgoingUnreliables.size() )
+		{
+			NetworkMessage const &reliable		= *m_outgoingReliables[ reliableIdx ];
+			NetworkMessage const &unreliable	= *m_outgoingUnreliables[ unreliableIdx ];
+			if( reliable.IsCritical() != unreliable.IsCritical() )
+				pickReliable = reliable.IsCritical();
+			else
+				pickReliable = reliable.m_accumulatedPriority >= unreliable.m_accumulatedPriority;
+		}
 
-		m_outgoingReliables.front()->m_header.reliableID = reliableIDToSend;
+		NetworkMessage	*msgToSend		= pickReliable ? m_outgoingReliables[ reliableIdx++ ] : m_outgoingUnreliables[ unreliableIdx++ ];
+		size_t			 packedSize		= NetworkPacket::GetPackedMessageSize( *msgToSend );
+		bool			 isWritten		= false;
 
-		bool writeSuccessfull = thisPacket.WriteMessage( *m_outgoingReliables.front() );
-		if( writeSuccessfull )
+		if( pickReliable )
 		{
-			reliableMessagesInThisPacker++;
-			bool added = packetTracker->AddNewReliableID( reliableIDToSend );
-			GUARANTEE_RECOVERABLE( added, "Error: Couldn't add new reliable ID to PacketTracker?!" );
-			ConsolePrintf( RGBA_KHAKI_COLOR, "Sending message with ReliableID %d, added = %s", reliableIDToSend, added ? "YES" : "NO" );
+			// Give outgoing message proper reliable ID, if it can have one
+			uint16_t reliableIDToSend	= GetNextReliableIDToSend();
+			canSendReliables			= canSendReliables && ( reliableMessagesInThisPacker < MAX_RELIABLES_PER_PACKET ) && CanSendReliableID( reliableIDToSend );
+
+			uint channel	= msgToSend->GetChannel();
+			bool isHeldBack	= ( canSendReliables == false ) || ( msgToSend->IsInOrder() && isChannelHeldBack[ channel ] )
+							|| ( msgToSend->IsInOrder() && hasBlobInChannel[ channel ] && CycleLess( blobSequenceIDs[ channel ], msgToSend->m_header.sequenceID ) );
+			if( isHeldBack == false && HasByteBudgetFor( *msgToSend, packedSize ) )
+			{
+				msgToSend->m_header.reliableID = reliableIDToSend;
+				isWritten = thisPacket.WriteMessage( *msgToSend );
+			}
 
-			// Move the message to sent-reliables queue
-			std::swap( m_outgoingReliables.front(), m_outgoingReliables.back() );
-			m_unconfirmedSentReliables.push_back( m_outgoingReliables.back() );
-			m_outgoingReliables.pop_back();
+			if( isWritten )
+			{
+				reliableMessagesInThisPacker++;
+				bool added = packetTracker->AddNewReliableID( reliableIDToSend );
+				GUARANTEE_RECOVERABLE( added, "Error: Couldn't add new reliable ID to PacketTracker?!" );
 
-			IncrementReliableIDToSend();
+				// Move the message to sent-reliables queue
+				m_unconfirmedSentReliables.push_back( msgToSend );
+				IncrementReliableIDToSend();
+			}
+			else
+			{
+				if( msgToSend->IsInOrder() )
+					isChannelHeldBack[ msgToSend->GetChannel() ] = true;
+
+				m_outgoingReliables[ keptReliables++ ] = msgToSend;
+			}
 		}
 		else
 		{
-			GUARANTEE_RECOVERABLE( false, "Error: Ancountered a message which might be too large to fit in current packet?!" );
-			break;
-		}
-	}
-	
+			if( HasByteBudgetFor( *msgToSend, packedSize ) )
+				isWritten = thisPacket.WriteMessage( *msgToSend );
 
-	// Unreliable Messages
-	// ...
-	while ( m_outgoingUnreliables.size() > 0 )
-	{
-		bool writeSuccessfull = thisPacket.WriteMessage( *m_outgoingUnreliables.front() );
-		if( writeSuccessfull )
-		{
-			// Delete the message from queue
-			std::swap( m_outgoingUnreliables.front(), m_outgoingUnreliables.back() );
-			delete m_outgoingUnreliables.back();
-			m_outgoingUnreliables.back() = nullptr;
+			if( isWritten )
+			{
+				// Remember the snapshot, for when this packet gets confirmed
+				if( msgToSend->m_snapshotID != INVALID_SNAPSHOT_ID )
+					packetTracker->snapshotID = msgToSend->m_snapshotID;
 
-			m_outgoingUnreliables.pop_back();
+				m_parentSession.ReleaseMessage( msgToSend );
+			}
+			else
+				m_outgoingUnreliables[ keptUnreliables++ ] = msgToSend;
 		}
+
+		if( isWritten )
+			SpendByteBudget( packedSize );
 		else
 		{
-			// That would mean that package can't store more messages
-			// Unreliable messages => we don't care about leftover messages
-			EmptyTheOutgoingUnreliables();
-			break;
+			// Weighs more next time
+			GUARANTEE_RECOVERABLE( packedSize <= PACKET_MTU - NETWORK_PACKET_HEADER_SIZE, "Error: Ancountered a message which is too large to fit in a packet?!" );
+
+			msgToSend->m_accumulatedPriority += msgToSend->GetDefinition()->GetPriorityWeight();
+			m_deferredMessagesCount++;
 		}
 	}
+	m_outgoingReliables.resize( keptReliables );
+	m_outgoingUnreliables.resize( keptUnreliables );
 
 	// Send it
-	m_parentSession.SendPacket( thisPacket );
+	m_parentSession.SendPacket( &thisPacket );
+	m_immediatlyRespondForAck = false;
 
 	// Update Analytics
-	m_lastSendTimeHPC = Clock::GetCurrentHPC();
+	m_lastSendTimeHPC = GetReferenceClock()->total.hpc;
+
+	// Then the blobs, with whatever is left of the packet budget
+	FlushFragments();
+}
+
+void NetworkConnection::FlushFragments()
+{
+	uint64_t const nowHPC		= GetReferenceClock()->total.hpc;
+	uint64_t const resendHPC	= Clock::GetHPCFromSeconds( m_congestionControl.GetRetransmitTimeout() );
+
+	for( uint packetCount = 0U; packetCount < MAX_FRAGMENT_PACKETS_PER_FLUSH && m_congestionControl.CanSendPacket(); packetCount++ )
+	{
+		// An unconfirmed one which waited a retransmit timeout first, a new one otherwise
+		NetworkMessage	*fragment	= nullptr;
+		bool			 isResend	= false;
+		for( size_t i = 0; i < m_unconfirmedSentReliables.size() && fragment == nullptr; i++ )
+		{
+			NetworkMessage *unconfirmed = m_unconfirmedSentReliables[i];
+			if( unconfirmed->m_header.networkMessageDefinitionIndex == NET_MESSAGE_FRAGMENT && nowHPC - unconfirmed->m_lastSentHPC > resendHPC )
+			{
+				fragment = unconfirmed;
+				isResend = true;
+			}
+		}
+
+		// New ones stay in the older half of the reliable window, so a lost fragment can't hold the other reliables back
+		uint16_t const windowHeadroom = RELIABLE_MESSAGES_WINDOW - MAX_FRAGMENTS_IN_FLIGHT;
+		if( fragment == nullptr && m_outgoingFragments.size() > 0U && CanSendReliableID( GetNextReliableIDToSend() + windowHeadroom ) )
+			fragment = m_outgoingFragments.front();
+
+		if( fragment == nullptr )
+			return;
+
+		size_t packedSize = NetworkPacket::GetPackedMessageSize( *fragment );
+		if( HasByteBudgetFor( *fragment, packedSize ) == false )
+			return;
+
+		// A new one takes its reliable ID now
+		if( isResend == false )
+		{
+			m_outgoingFragments.erase( m_outgoingFragments.begin() );
+
+			fragment->m_header.reliableID = GetNextReliableIDToSend();
+			IncrementReliableIDToSend();
+			m_unconfirmedSentReliables.push_back( fragment );
+		}
+		else
+			m_resentReliablesCount++;
+
+		PacketTracker	*packetTracker	= nullptr;
+		NetworkPacket	&fragmentPacket	= AcquireTrackedPacket( packetTracker );
+		bool isWritten = fragmentPacket.WriteMessage( *fragment );
+		GUARANTEE_RECOVERABLE( isWritten, "Error: Couldn't write a fragment in to an empty packet?!" );
+
+		bool added = packetTracker->AddNewReliableID( fragment->m_header.reliableID );
+		GUARANTEE_RECOVERABLE( added, "Error: Couldn't add new reliable ID to PacketTracker?!" );
+
+		fragment->m_lastSentHPC = nowHPC;
+		SpendByteBudget( packedSize );
+
+		m_parentSession.SendPacket( &fragmentPacket );
+		m_immediatlyRespondForAck	= false;
+		m_lastSendTimeHPC			= nowHPC;
+	}
 }
 
 uint16_t NetworkConnection::GetLowestReliableIDToConfirm() const
 {
-	return (m_highestConfirmedReliableID - RELIABLE_MESSAGES_WINDOW);
+	return (m_highestReceivedReliableID - RELIABLE_MESSAGES_WINDOW + 1U);
 }
 
 uint16_t NetworkConnection::GetHighestConfirmedReliableID() const
@@ -456,19 +805,15 @@ uint16_t NetworkConnection::GetHighestConfirmedReliableID() const
 
 bool NetworkConnection::HasReceivedReliableID( uint16_t reliableID ) const
 {
+	// Older than the window
 	if( CycleLess( reliableID, GetLowestReliableIDToConfirm() ) )
 		return true;
-	else
-	{
-		// If in the received list
-		for( uint i = 0; i < m_receivedReliableIDs.size(); i++ )
-		{
-			if( m_receivedReliableIDs[i] == reliableID )
-				return true;
-		}
 
+	// Newer than the window
+	if( CycleLess( m_highestReceivedReliableID, reliableID ) )
 		return false;
-	}
+
+	return m_receivedReliableIDs.test( reliableID % RELIABLE_MESSAGES_WINDOW );
 }
 
 uint NetworkConnection::GetUnconfirmedSendReliablesCount() const
@@ -482,7 +827,11 @@ uint8_t NetworkConnection::GetCurrentSendFrequency() const
 	uint8_t parentFrequency	= m_parentSession.GetSimulatedSendFrequency();
 	uint8_t minFrequency	= ( m_sendFrequency < parentFrequency ) ? m_sendFrequency : parentFrequency;
 
-	return minFrequency;
+	// Then what the link takes
+	float	pacedFrequency	= m_congestionControl.GetSendFrequency( (float)minFrequency );
+	uint8_t	frequency		= (uint8_t)( pacedFrequency + 0.5f );
+
+	return ( frequency > 0U ) ? frequency : 1U;
 }
 
 void NetworkConnection::SetSendFrequencyTo( uint8_t frequencyHz )
@@ -559,11 +908,40 @@ PacketTracker* NetworkConnection::AddTrackedPacket( uint16_t ack )
 	int index = ack % MAX_TRACKED_PACKETS;
 	PacketTracker &tracker = m_packetTrackers[ index ];
 
-	tracker.TrackForAck( ack );
+	// Never heard back about the one we're overwriting
+	uint64_t nowHPC = GetReferenceClock()->total.hpc;
+	if( tracker.IsValid() && tracker.isCountedAsLost == false )
+		m_congestionControl.OnPacketLost( tracker.sentTimeHPC, nowHPC );
+
+	tracker.TrackForAck( ack, nowHPC );
+	m_congestionControl.OnPacketSent();
 
 	return &m_packetTrackers[ index ];
 }
 
+NetworkPacket& NetworkConnection::AcquireTrackedPacket( PacketTracker* &outTracker )
+{
+	NetworkPacket		&packet	= *m_parentSession.AcquirePacket();
+	NetworkPacketHeader &header	= packet.m_header;
+	header.messageCount			= 0x00;
+	header.connectionIndex		= GetIndexInSession();
+
+	// Ack
+	uint16_t ackToSend = GetNextAckToSend();
+	IncrementSentAck();
+	header.ack					= ackToSend;
+	header.highestReceivedAck	= m_highestReceivedAck;
+	header.receivedAcksHistory	= m_receivedAcksBitfield;
+
+	// If about to wrap around, calculate the loss
+	if( (ackToSend % MAX_TRACKED_PACKETS) == 0 )
+		m_loss = CalculateLoss();
+
+	// Track the packet
+	outTracker = AddTrackedPacket( ackToSend );
+	return packet;
+}
+
 bool NetworkConnection::IsActivePacketTracker( uint16_t ack )
 {
 	// Packet Tracker
@@ -576,16 +954,132 @@ bool NetworkConnection::IsActivePacketTracker( uint16_t ack )
 		return true;
 }
 
-void NetworkConnection::EmptyTheOutgoingUnreliables()
+void NetworkConnection::DropStaleUnreliables()
+{
+	uint64_t const staleHPC	= Clock::GetHPCFromSeconds( MAX_UNRELIABLE_DEFER_SECONDS );
+	uint64_t const nowHPC	= GetReferenceClock()->total.hpc;
+
+	size_t keptCount = 0U;
+	for( size_t i = 0; i < m_outgoingUnreliables.size(); i++ )
+	{
+		NetworkMessage *unreliable = m_outgoingUnreliables[i];
+		if( nowHPC - unreliable->m_queuedHPC > staleHPC )
+		{
+			m_parentSession.ReleaseMessage( unreliable );
+			m_droppedUnreliablesCount++;
+		}
+		else
+			m_outgoingUnreliables[ keptCount++ ] = unreliable;
+	}
+
+	m_outgoingUnreliables.resize( keptCount );
+}
+
+void NetworkConnection::SetByteBudgetRate( uint bytesPerSecond )
+{
+	m_byteBudgetRate	= bytesPerSecond;
+	m_byteBudget		= 0.f;
+}
+
+void NetworkConnection::RefillByteBudget()
+{
+	uint64_t nowHPC			= GetReferenceClock()->total.hpc;
+	double	 elapsedSeconds	= Clock::GetSecondsFromHPC( nowHPC - m_byteBudgetRefillHPC );
+	m_byteBudgetRefillHPC	= nowHPC;
+
+	if( m_byteBudgetRate == 0U )
+		return;
+
+	// Saves up to one packet's worth, so a slow send rate doesn't leave bytes behind
+	m_byteBudget += (float)( elapsedSeconds * (double)m_byteBudgetRate );
+	m_byteBudget  = ( m_byteBudget < (float)PACKET_MTU ) ? m_byteBudget : (float)PACKET_MTU;
+}
+
+bool NetworkConnection::HasByteBudgetFor( NetworkMessage const &msg, size_t packedSize ) const
+{
+	if( m_byteBudgetRate == 0U || msg.IsCritical() )
+		return true;
+
+	return (float)packedSize <= m_byteBudget;
+}
+
+void NetworkConnection::SpendByteBudget( size_t packedSize )
+{
+	if( m_byteBudgetRate == 0U )
+		return;
+
+	m_byteBudget -= (float)packedSize;
+}
+
+bool NetworkConnection::HasCriticalMessageQueued() const
 {
-	while ( m_outgoingUnreliables.size() > 0 )
+	for( size_t i = 0; i < m_outgoingReliables.size(); i++ )
 	{
-		// fast delete
-		std::swap( m_outgoingUnreliables.front(), m_outgoingUnreliables.back() );
-		delete m_outgoingUnreliables.back();
-		m_outgoingUnreliables.back() = nullptr;
+		if( m_outgoingReliables[i]->IsCritical() )
+			return true;
+	}
 
-		m_outgoingUnreliables.pop_back();
+	for( size_t i = 0; i < m_outgoingUnreliables.size(); i++ )
+	{
+		if( m_outgoingUnreliables[i]->IsCritical() )
+			return true;
+	}
+
+	return false;
+}
+
+static bool IsAheadInPriority( NetworkMessage const *lhs, NetworkMessage const *rhs )
+{
+	if( lhs->IsCritical() != rhs->IsCritical() )
+		return lhs->IsCritical();
+
+	return lhs->m_accumulatedPriority > rhs->m_accumulatedPriority;
+}
+
+void NetworkConnection::SortByPriority( NetworkMessages &messages ) const
+{
+	if( messages.size() < 2U )
+		return;
+
+	// Stable, so the older one goes first on a tie
+	std::stable_sort( messages.begin(), messages.end(), IsAheadInPriority );
+
+	// In-order messages of a channel take the slots their channel got, in the order of their sequence IDs
+	for( uint channel = 0U; channel < MAX_NETWORK_MESSAGE_CHANNELS; channel++ )
+	{
+		NetworkMessage *previous = nullptr;
+		bool isInOrder = true;
+		for( size_t i = 0; i < messages.size() && isInOrder; i++ )
+		{
+			if( messages[i]->IsInOrder() == false || messages[i]->GetChannel() != channel )
+				continue;
+
+			isInOrder	= ( previous == nullptr ) || CycleLess( previous->m_header.sequenceID, messages[i]->m_header.sequenceID );
+			previous	= messages[i];
+		}
+
+		if( isInOrder )
+			continue;
+
+		// Insertion sort over just this channel's slots; few & mostly in order
+		for( size_t i = 0; i < messages.size(); i++ )
+		{
+			if( messages[i]->IsInOrder() == false || messages[i]->GetChannel() != channel )
+				continue;
+
+			size_t slot = i;
+			for( size_t j = i; j-- > 0U; )
+			{
+				if( messages[j]->IsInOrder() == false || messages[j]->GetChannel() != channel )
+					continue;
+
+				if( CycleLess( messages[j]->m_header.sequenceID, messages[slot]->m_header.sequenceID ) )
+					break;
+
+				std::swap( messages[j], messages[slot] );
+				slot = j;
+			}
+		}
 	}
 }
 
@@ -602,7 +1096,12 @@ void NetworkConnection::IncrementReliableIDToSend()
 bool NetworkConnection::ShouldResendUnconfirmedReliables()
 {
 	bool timeToResendReliables	= m_confirmReliablesTimer.CheckAndReset();
-	bool hasReliablesToResend	= (m_unconfirmedSentReliables.size() > 0);
+	uint unconfirmedFragments	= m_fragmentsInFlight - (uint)m_outgoingFragments.size();
+	bool hasReliablesToResend	= (m_unconfirmedSentReliables.size() > unconfirmedFragments);		// Fragments have their own, see FlushFragments()
+
+	// Waits about an RTT, plus how much it varies
+	if( timeToResendReliables )
+		m_confirmReliablesTimer.SetTimer( m_congestionControl.GetRetransmitTimeout() );
 
 	return (timeToResendReliables == true) && (hasReliablesToResend == true);
 }
@@ -624,9 +1123,12 @@ void NetworkConnection::UpdateHigestConfirmedReliableID( PacketTracker &tracker
 			bool isReceivedReliableID = (m_unconfirmedSentReliables[ucI]->m_header.reliableID == receivedReliableID );
 			if( isReceivedReliableID )
 			{
+				if( m_unconfirmedSentReliables[ucI]->m_header.networkMessageDefinitionIndex == NET_MESSAGE_FRAGMENT )
+					OnFragmentConfirmed( *m_unconfirmedSentReliables[ucI] );
+
 				// Fast delete
 				std::swap( m_unconfirmedSentReliables[ucI], m_unconfirmedSentReliables.back() );
-				delete m_unconfirmedSentReliables.back();
+				m_parentSession.ReleaseMessage( m_unconfirmedSentReliables.back() );
 				m_unconfirmedSentReliables.back() = nullptr;
 
 				m_unconfirmedSentReliables.pop_back();
@@ -635,33 +1137,104 @@ void NetworkConnection::UpdateHigestConfirmedReliableID( PacketTracker &tracker
 	}
 }
 
-void NetworkConnection::MarkReliableReceived( uint16_t reliableID )
+void NetworkConnection::QueueBlob( NetworkMessage &msg )
+{
+	if( msg.GetWrittenByteCount() > MAX_NETWORK_BLOB_BYTE_COUNT )
+	{
+		GUARANTEE_RECOVERABLE( false, "Error: Message is bigger than MAX_NETWORK_BLOB_BYTE_COUNT, dropping it!" );
+		return;
+	}
+
+	// Takes its place in the channel now; the fragments carry the sequence ID
+	if( msg.IsInOrder() )
+	{
+		NetworkMessageChannel &channel = m_messageChannels[ msg.GetChannel() ];
+
+		msg.m_header.sequenceID = channel.GetNextSequenceIDToSend();
+		channel.IncrementNextSendSequenceID();
+	}
+
+	NetworkOutgoingBlob *blob = new NetworkOutgoingBlob( msg, m_nextBlobIDToSend++, msg.GetDefinition()->IsCompressed() );
+	m_outgoingBlobs.push_back( blob );
+
+	m_sentBlobsCount++;
+	m_sentBlobMessageBytes	+= blob->header.messageByteCount;
+	m_sentBlobBytes			+= blob->header.blobByteCount;
+}
+
+void NetworkConnection::QueueBlobFragments()
 {
-	// If Greater than the current highest, set the highest
-	if( CycleGreater( reliableID, m_highestConfirmedReliableID ) )
+	NetworkMessageDefinition const *fragmentDefinition = m_parentSession.GetRegisteredMessageDefination( (int)NET_MESSAGE_FRAGMENT );
+	// Oldest blob first; an in-order one waits for the one before it in its channel, so the receiver's channel window holds
+	bool isChannelBusy[ MAX_NETWORK_MESSAGE_CHANNELS ] = { false };
+	for( size_t i = 0; i < m_outgoingBlobs.size() && m_fragmentsInFlight < MAX_FRAGMENTS_IN_FLIGHT; i++ )
 	{
-		// Put it into received list
-		m_receivedReliableIDs.push_back( reliableID );
+		NetworkOutgoingBlob &blob = *m_outgoingBlobs[i];
+		if( blob.isInOrder )
+		{
+			bool hasStarted = ( blob.header.fragmentIndex > 0U );
+			if( isChannelBusy[ blob.channel ] && hasStarted == false )
+				continue;
 
-		// Update the received messages' window
-		uint16_t lowestRIDToConfirm = GetLowestReliableIDToConfirm();
-		for( uint r = 0; r < m_receivedReliableIDs.size(); r++ )
+			isChannelBusy[ blob.channel ] = true;
+		}
+
+		while( blob.HasFragmentsToQueue() && m_fragmentsInFlight < MAX_FRAGMENTS_IN_FLIGHT )
 		{
-			// Lower than the lowest ID we care about?
-			if( CycleLess( m_receivedReliableIDs[r], lowestRIDToConfirm ) )
-			{
-				// Get rid of it
-				std::swap( m_receivedReliableIDs[r], m_receivedReliableIDs.back() );
-				m_receivedReliableIDs.pop_back();
-			}
+			NetworkMessage *fragment = m_parentSession.AcquireMessage();
+			fragment->SetDefinition( fragmentDefinition );
+			blob.WriteNextFragment( *fragment );
+			m_outgoingFragments.push_back( fragment );
+
+			m_fragmentsInFlight++;
 		}
 	}
-	else
+}
+
+void NetworkConnection::OnFragmentConfirmed( NetworkMessage const &fragment )
+{
+	m_fragmentsInFlight--;
+
+	uint16_t blobID = 0U;
+	fragment.ResetRead();
+	fragment.ReadBytes( &blobID, sizeof( blobID ) );
+
+	for( size_t i = 0; i < m_outgoingBlobs.size(); i++ )
+	{
+		NetworkOutgoingBlob *blob = m_outgoingBlobs[i];
+		if( blob->header.blobID != blobID )
+			continue;
+
+		// All of it got through; the channel can move on
+		blob->confirmedFragmentCount++;
+		if( blob->IsConfirmed() )
+		{
+			delete blob;
+			m_outgoingBlobs.erase( m_outgoingBlobs.begin() + i );
+		}
+
+		return;
+	}
+}
+
+void NetworkConnection::MarkReliableReceived( uint16_t reliableID )
+{
+	// Newer than the highest: slide the window up, clearing the slots of the IDs it moves over
+	if( CycleLess( m_highestReceivedReliableID, reliableID ) )
 	{
-		// Less than the highest
-		// Add it to received list
-		m_receivedReliableIDs.push_back( reliableID );
+		uint16_t distanceFromHighest = reliableID - m_highestReceivedReliableID;
+		if( distanceFromHighest >= RELIABLE_MESSAGES_WINDOW )
+			m_receivedReliableIDs.reset();
+		else
+		{
+			for( uint16_t id = m_highestReceivedReliableID + 1U; id != reliableID; id++ )
+				m_receivedReliableIDs.reset( id % RELIABLE_MESSAGES_WINDOW );
+		}
+
+		m_highestReceivedReliableID = reliableID;
 	}
+
+	m_receivedReliableIDs.set( reliableID % RELIABLE_MESSAGES_WINDOW );
 }
 
 /*
@@ -1,9 +1,13 @@
 #pragma once#
+#include <bitset>
+#include <map>
 #include <string>
 #include <vector>
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/Stopwatch.hpp"
 #include "Engine/Network/NetworkAddress.hpp"
+#include "Engine/NetworkSession/NetworkCongestionControl.hpp"
+#include "Engine/NetworkSession/NetworkFragment.hpp"
 #include "Engine/NetworkSession/NetworkMessage.hpp"
 #include "Engine/NetworkSession/NetworkMessageChannel.hpp"
 #include "Engine/NetworkSession/NetworkPacket.hpp"
@@ -73,16 +77,29 @@ public:
 	// Packet Tracking
 	uint16_t			 m_nextSentAck					= INVALID_PACKET_ACK;		// Sending		- Updated during a flush
 	uint16_t			 m_highestReceivedAck			= INVALID_PACKET_ACK;		// Receiving	- Updated during process packet
+	uint16_t			 m_highestConfirmedAck			= INVALID_PACKET_ACK;		// Sending		- Highest of my packets they've acked
+	uint16_t			 m_oldestInFlightAck			= 0U;						// Sending		- Packets from here to m_nextSentAck may still be in flight
 	uint16_t			 m_receivedAcksBitfield			= 0U;
 	uint16_t			 m_nextReliableIDToSend			= 0x0000;
 	uint16_t			 m_highestConfirmedReliableID	= 0xffff;
+	uint16_t			 m_highestReceivedReliableID	= 0xffff;					// Receiving	- Updated when a reliable gets processed
+	uint16_t			 m_highestAckedSnapshotID		= INVALID_SNAPSHOT_ID;		// Sending		- Updated when a packet carrying a snapshot gets confirmed
 
 public:
-	uint64_t			 m_lastSendTimeHPC				= Clock::GetCurrentHPC();	// Analytics
-	uint64_t			 m_lastReceivedTimeHPC			= Clock::GetCurrentHPC();
+	uint64_t			 m_lastSendTimeHPC				= 0U;						// Analytics; on the session's reference clock
+	uint64_t			 m_lastReceivedTimeHPC			= 0U;
 
 	float				 m_loss	= 0.f;												// [0, 1] Loss rate we perceive to this connection
 	float				 m_rtt	= 0.f;												// IN SECONDS; Latency perceived on this connection
+	float				 m_lastRTT			= 0.f;									// IN SECONDS; Of the last confirmed packet, not smoothed
+	uint				 m_rttSampleCount	= 0U;									// Confirmed packets so far; tells when m_lastRTT is a new one
+	uint				 m_resentReliablesCount	= 0U;								// Reliables written in to a packet again, since created
+	uint				 m_deferredMessagesCount	= 0U;							// Times a queued message got left out of a packet, for priority or the byte budget
+	uint				 m_droppedUnreliablesCount	= 0U;							// Deferred for longer than MAX_UNRELIABLE_DEFER_SECONDS
+	uint				 m_sentBlobsCount			= 0U;							// Messages which went in fragments
+	uint				 m_receivedBlobsCount		= 0U;
+	uint64_t			 m_sentBlobMessageBytes		= 0U;							// Before & after the compression
+	uint64_t			 m_sentBlobBytes			= 0U;
 
 private:
 	// Outgoing-and-Sent Messages
@@ -92,12 +109,26 @@ private:
 	NetworkMessages		 m_outgoingReliables;
 	NetworkMessages		 m_unconfirmedSentReliables;
 
+	// Messages too big for a packet; see NetworkFragment.hpp
+	std::vector< NetworkOutgoingBlob* >			m_outgoingBlobs;					// Oldest first, until all of its fragments are confirmed
+	std::map< uint16_t, NetworkIncomingBlob* >	m_incomingBlobs;					// Blob ID => the fragments so far
+	NetworkMessages		 m_outgoingFragments;										// Of the blobs; they go in packets of their own, see FlushFragments()
+	NetworkMessages		 m_reassembledMessages;										// Waiting in a channel; not from the session's pool
+	uint16_t			 m_nextBlobIDToSend			= 0U;
+	uint				 m_fragmentsInFlight		= 0U;							// Queued or unconfirmed
+
+	// Byte budget; criticals & resends go over it, the next flushes pay it back
+	uint				 m_byteBudgetRate			= 0U;							// Bytes per second; ZERO => just the packet's size
+	float				 m_byteBudget				= 0.f;							// Bytes this flush can use; up to PACKET_MTU saved up
+	uint64_t			 m_byteBudgetRefillHPC		= 0U;
+
 	// Network Channels
 	NetworkMessageChannel m_messageChannels[ MAX_NETWORK_MESSAGE_CHANNELS ];
 
 	// Tracking the packets
 	PacketTracker		  m_packetTrackers[ MAX_TRACKED_PACKETS ];
-	std::vector<uint16_t> m_receivedReliableIDs;
+	NetworkCongestionControl m_congestionControl;								// Paces my packets, from their acks & losses
+	std::bitset< RELIABLE_MESSAGES_WINDOW > m_receivedReliableIDs;				// Bit is reliableID % RELIABLE_MESSAGES_WINDOW; for [ GetLowestReliableIDToConfirm(), m_highestReceivedReliableID ]
 
 private:
 	// Timers
@@ -121,19 +152,29 @@ public:
 	// Receiving End
 	void	OnReceivePacket( NetworkPacketHeader receivedPacketHeader );		// It is there for tracking the messages & packets, it doesn't process em!
 	void	ProcessReceivedMessage( NetworkMessage &receivedMessage, NetworkSender sender );
+	bool	ProcessReceivedFragment( NetworkMessage const &fragment, NetworkSender &sender );	// Delivers the message once its last fragment is in
 
 	// Sending End
-	bool	HasNewMessagesToSend() const;				// New reliables or unreliable, not the unconfirmed ones
-	void	Send( NetworkMessage &msg );				// Queues the messages to send
+	bool	HasNewMessagesToSend() const;				// New reliables the window lets go or unreliable, not the unconfirmed ones
+	void	Send( NetworkMessage &msg );				// Queues the messages to send; reliables too big for a packet go in fragments
 	void	FlushMessages( bool ignoreSendRate = false );							// Sends the queued messages
+	bool	HasSnapshotQueued() const;					// If an unreliable which carries a snapshot is waiting for the flush
 
 	// Current State - Messages
-	uint16_t GetLowestReliableIDToConfirm() const;
+	uint16_t GetLowestReliableIDToConfirm() const;		// Received reliables older than this are all received; the sender never gets a window ahead of its oldest unconfirmed one
 	uint16_t GetHighestConfirmedReliableID() const;
 	bool	 HasReceivedReliableID( uint16_t reliableID ) const;
+	inline uint16_t GetHighestAckedSnapshotID() const { return m_highestAckedSnapshotID; }
 
 	uint	GetUnconfirmedSendReliablesCount() const;
-	uint8_t	GetCurrentSendFrequency() const;			// Minimum of ( My sendFrequency, Parent's sendFrequency )
+	inline uint	GetQueuedReliablesCount() const { return (uint)m_outgoingReliables.size(); }		// Waiting for a reliable ID
+	inline uint	GetOutgoingBlobsCount() const	{ return (uint)m_outgoingBlobs.size(); }			// Not all confirmed yet
+	inline uint	GetIncomingBlobsCount() const	{ return (uint)m_incomingBlobs.size(); }			// Some fragments in, not all
+	void	SetByteBudgetRate( uint bytesPerSecond );	// ZERO => no budget, every packet gets filled
+	inline uint		GetByteBudgetRate() const	{ return m_byteBudgetRate; }
+	inline float	GetByteBudget() const		{ return m_byteBudget; }
+	uint8_t	GetCurrentSendFrequency() const;			// Minimum of ( My sendFrequency, Parent's sendFrequency ), paced down by the congestion control
+	inline NetworkCongestionControl const& GetCongestionControl() const { return m_congestionControl; }
 	void	SetSendFrequencyTo( uint8_t frequencyHz );	// Sets it to the min( passedFrequency, parentsFrequency )
 	void	UpdateHeartbeatTimer();						// Sets the heartbeat timer according to parentSession
 
@@ -148,9 +189,12 @@ public:
 	inline bool		IsReady()		 const { return  m_state == NET_CONNECTION_READY; }
 
 private:
+	Clock const*	GetReferenceClock() const;								// Of the parent session
+
 	// Tracking Messages-or-Packet
 	void			ConfirmPacketReceived( uint16_t ack );
-	bool			CanSendReliableID( uint16_t reliableID );
+	void			DetectLostPackets();									// Tells the congestion control about the packets which won't be acked anymore
+	bool			CanSendReliableID( uint16_t reliableID ) const;
 
 	// Acks
 	uint16_t		GetNextAckToSend();
@@ -158,8 +202,16 @@ private:
 	float			CalculateLoss() const;									// Goes through the packetTrackers & calculates loss according to how many packets are still being tracked
 
 	PacketTracker*	AddTrackedPacket( uint16_t ack );
+	NetworkPacket&	AcquireTrackedPacket( PacketTracker* &outTracker );		// Header, next ack & its tracker filled in; for packets with messages in them
 	bool			IsActivePacketTracker( uint16_t ack );
-	void			EmptyTheOutgoingUnreliables();
+	void			DropStaleUnreliables();
+
+	// Priority & Byte Budget
+	void			RefillByteBudget();
+	bool			HasByteBudgetFor( NetworkMessage const &msg, size_t packedSize ) const;
+	void			SpendByteBudget( size_t packedSize );
+	bool			HasCriticalMessageQueued() const;
+	void			SortByPriority( NetworkMessages &messages ) const;		// Highest accumulated priority first; in-order messages keep their order within a channel
 
 	// Reliable ID
 	uint16_t		GetNextReliableIDToSend();
@@ -167,4 +219,12 @@ private:
 	bool			ShouldResendUnconfirmedReliables();						// "Checks-and-Resets" the timer. Returns true if it is time to resend unconfirmed reliables (if there are any)   [ "USE IT JUST ONCE!!" ]
 	void			UpdateHigestConfirmedReliableID( PacketTracker &tracker );		// Removes the confirmed messages from m_unconfirmedSentReliables
 	void			MarkReliableReceived( uint16_t reliableID );
+	void			DeliverReliable( NetworkMessage &receivedMessage, NetworkSender &sender, bool isReassembled );	// New to us; straight to the callback or through its channel
+	void			ReleaseReceivedMessage( NetworkMessage *message );		// Back to the pool, or deleted if reassembled
+
+	// Blobs
+	void			QueueBlob( NetworkMessage &msg );
+	void			QueueBlobFragments();									// Up to MAX_FRAGMENTS_IN_FLIGHT
+	void			FlushFragments();										// After the regular packet, a fragment per packet, while the packet budget lasts
+	void			OnFragmentConfirmed( NetworkMessage const &fragment );
 };
@@ -0,0 +1,141 @@
+#pragma once
+#include "NetworkFragment.hpp"
+#include "Engine/Network/LZCompression.hpp"
+
+// STRUCT - NETWORK FRAGMENT HEADER
+bool NetworkFragmentHeader::Write( NetworkMessage &msg ) const
+{
+	bool written = true;
+	written = written && msg.WriteBytes( sizeof( blobID ),				&blobID );
+	written = written && msg.WriteBytes( sizeof( definitionIndex ),		&definitionIndex );
+	written = written && msg.WriteBytes( sizeof( isCompressed ),		&isCompressed );
+	written = written && msg.WriteBytes( sizeof( sequenceID ),			&sequenceID );
+	written = written && msg.WriteBytes( sizeof( fragmentIndex ),		&fragmentIndex );
+	written = written && msg.WriteBytes( sizeof( fragmentCount ),		&fragmentCount );
+	written = written && msg.WriteBytes( sizeof( blobByteCount ),		&blobByteCount );
+	written = written && msg.WriteBytes( sizeof( messageByteCount ),	&messageByteCount );
+
+	return written;
+}
+
+bool NetworkFragmentHeader::Read( NetworkMessage const &msg )
+{
+	size_t readBytes = 0U;
+	readBytes += msg.ReadBytes( &blobID,			sizeof( blobID ) );
+	readBytes += msg.ReadBytes( &definitionIndex,	sizeof( definitionIndex ) );
+	readBytes += msg.ReadBytes( &isCompressed,		sizeof( isCompressed ) );
+	readBytes += msg.ReadBytes( &sequenceID,		sizeof( sequenceID ) );
+	readBytes += msg.ReadBytes( &fragmentIndex,		sizeof( fragmentIndex ) );
+	readBytes += msg.ReadBytes( &fragmentCount,		sizeof( fragmentCount ) );
+	readBytes += msg.ReadBytes( &blobByteCount,		sizeof( blobByteCount ) );
+	readBytes += msg.ReadBytes( &messageByteCount,	sizeof( messageByteCount ) );
+
+	return readBytes == BYTE_COUNT;
+}
+
+bool NetworkFragmentHeader::IsValid() const
+{
+	if( blobByteCount == 0U || blobByteCount > MAX_NETWORK_BLOB_BYTE_COUNT || messageByteCount > MAX_NETWORK_BLOB_BYTE_COUNT )
+		return false;
+
+	if( isCompressed == 0U && blobByteCount != messageByteCount )
+		return false;
+
+	uint32_t expectedFragmentCount = ( blobByteCount + NETWORK_FRAGMENT_BYTE_COUNT - 1U ) / NETWORK_FRAGMENT_BYTE_COUNT;
+	return ( fragmentCount == expectedFragmentCount ) && ( fragmentIndex < fragmentCount );
+}
+
+bool NetworkFragmentHeader::IsSameBlob( NetworkFragmentHeader const &other ) const
+{
+	return ( blobID == other.blobID ) && ( definitionIndex == other.definitionIndex ) && ( isCompressed == other.isCompressed ) && ( sequenceID == other.sequenceID )
+		&& ( fragmentCount == other.fragmentCount ) && ( blobByteCount == other.blobByteCount ) && ( messageByteCount == other.messageByteCount );
+}
+
+
+// STRUCT - NETWORK OUTGOING BLOB
+NetworkOutgoingBlob::NetworkOutgoingBlob( NetworkMessage const &msg, uint16_t blobID, bool compress )
+	: channel( msg.GetChannel() )
+	, isInOrder( msg.IsInOrder() )
+{
+	size_t messageByteCount = msg.GetWrittenByteCount();
+
+	// Compressed, only if it is smaller
+	if( compress )
+		LZCompress( msg.GetBuffer(), messageByteCount, bytes );
+
+	header.isCompressed = ( compress && bytes.size() < messageByteCount ) ? 1U : 0U;
+	if( header.isCompressed == 0U )
+	{
+		byte_t const *messageBytes = (byte_t const *)msg.GetBuffer();
+		bytes.assign( messageBytes, messageBytes + messageByteCount );
+	}
+
+	header.blobID			= blobID;
+	header.definitionIndex	= msg.m_header.networkMessageDefinitionIndex;
+	header.sequenceID		= msg.m_header.sequenceID;
+	header.fragmentIndex	= 0U;
+	header.blobByteCount	= (uint32_t)bytes.size();
+	header.messageByteCount	= (uint32_t)messageByteCount;
+	header.fragmentCount	= ( header.blobByteCount + NETWORK_FRAGMENT_BYTE_COUNT - 1U ) / NETWORK_FRAGMENT_BYTE_COUNT;
+}
+
+void NetworkOutgoingBlob::WriteNextFragment( NetworkMessage &outFragment )
+{
+	uint32_t fragmentByteCount = header.GetFragmentByteCount( header.fragmentIndex );
+
+	header.Write( outFragment );
+	outFragment.WriteBytes( fragmentByteCount, &bytes[ header.fragmentIndex * NETWORK_FRAGMENT_BYTE_COUNT ], false );
+
+	header.fragmentIndex++;
+}
+
+
+// STRUCT - NETWORK INCOMING BLOB
+NetworkIncomingBlob::NetworkIncomingBlob( NetworkFragmentHeader const &firstHeader )
+	: header( firstHeader )
+{
+
+}
+
+bool NetworkIncomingBlob::AddFragment( NetworkFragmentHeader const &fragmentHeader, NetworkMessage const &fragment )
+{
+	if( header.IsSameBlob( fragmentHeader ) == false )
+		return false;
+
+	// Already have it; reliables don't come twice, but a bad sender might
+	uint32_t index = fragmentHeader.fragmentIndex;
+	if( receivedFragments.find( index ) != receivedFragments.end() )
+		return false;
+
+	uint32_t fragmentByteCount = header.GetFragmentByteCount( index );
+	if( fragment.GetReadableByteCount() != fragmentByteCount )
+		return false;
+
+	std::vector< byte_t > &fragmentBytes = receivedFragments[ index ];
+	fragmentBytes.resize( fragmentByteCount );
+	fragment.ReadBytes( fragmentBytes.data(), fragmentByteCount, false );
+
+	return true;
+}
+
+bool NetworkIncomingBlob::Reassemble( NetworkMessage &outMessage ) const
+{
+	if( IsComplete() == false )
+		return false;
+
+	// All of it is here now, stitch the fragments back in order
+	std::vector< byte_t > bytes;
+	bytes.reserve( header.blobByteCount );
+	for( std::map< uint32_t, std::vector< byte_t > >::const_iterator it = receivedFragments.begin(); it != receivedFragments.end(); it++ )
+		bytes.insert( bytes.end(), it->second.begin(), it->second.end() );
+
+	outMessage.ResetWrite();
+	if( header.isCompressed == 0U )
+		return outMessage.WriteBytes( bytes.size(), bytes.data(), false );
+
+	std::vector< byte_t > messageBytes( header.messageByteCount );
+	if( LZDecompress( bytes.data(), bytes.size(), messageBytes.data(), messageBytes.size() ) == false )
+		return false;
+
+	return outMessage.WriteBytes( messageBytes.size(), messageBytes.data(), false );
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <map>
+#include <vector>
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/NetworkSession/NetworkMessage.hpp"
+
+//------------------------------------------------------------------------------------------
+// Reliable messages too big for a packet go as a blob: their bytes, LZ compressed if the definition asks for it,
+// cut in to NETWORK_FRAGMENT_BYTE_COUNT pieces, each in a "fragment" message
+//	- Fragments are plain reliables, so acks & duplicates are handled like any other; but they go in packets of their own,
+//	  after the regular one, with whatever is left of the packet budget & resent on their own timeout
+//	- Only MAX_FRAGMENTS_IN_FLIGHT at a time, in the older half of the reliable window, so the rest of the traffic keeps
+//	  its share of the window even when a fragment gets lost
+//	- Every fragment carries the whole header; they can arrive in any order & the first one to arrive sizes the blob
+//	- Receiver keeps just the fragments which arrived, so a peer can't make it allocate a whole blob with a single fragment
+//	- The reassembled message gets delivered like the original would: its definition, & its channel's sequence ID if in-order
+//
+struct NetworkFragmentHeader
+{
+public:
+	static constexpr size_t BYTE_COUNT = 22U;		// As written, in front of the fragment's bytes
+
+	uint16_t	blobID				= 0U;
+	uint8_t		definitionIndex		= 0xff;			// Of the original message
+	uint8_t		isCompressed		= 0U;
+	uint16_t	sequenceID			= 0U;			// Of the original message, if in-order
+	uint32_t	fragmentIndex		= 0U;
+	uint32_t	fragmentCount		= 0U;
+	uint32_t	blobByteCount		= 0U;			// What got cut in to fragments
+	uint32_t	messageByteCount	= 0U;			// Of the original message; same as blobByteCount, if not compressed
+
+public:
+	bool	Write( NetworkMessage &msg ) const;
+	bool	Read ( NetworkMessage const &msg );		// Reads the fragment's bytes after it
+	bool	IsValid() const;						// Sizes & counts add up, within MAX_NETWORK_BLOB_BYTE_COUNT
+	bool	IsSameBlob( NetworkFragmentHeader const &other ) const;
+
+	inline uint32_t	GetFragmentByteCount( uint32_t index ) const { return ( index + 1U < fragmentCount ) ? NETWORK_FRAGMENT_BYTE_COUNT : blobByteCount - ( index * NETWORK_FRAGMENT_BYTE_COUNT ); }
+};
+
+struct NetworkOutgoingBlob
+{
+public:
+	NetworkFragmentHeader	header;								// fragmentIndex is of the next one to queue
+	std::vector< byte_t >	bytes;
+	uint					channel					= 0U;
+	bool					isInOrder				= false;
+	uint					confirmedFragmentCount	= 0U;
+
+public:
+	NetworkOutgoingBlob( NetworkMessage const &msg, uint16_t blobID, bool compress );
+
+	inline bool	HasFragmentsToQueue() const	{ return header.fragmentIndex < header.fragmentCount; }
+	inline bool	IsConfirmed() const			{ return confirmedFragmentCount >= header.fragmentCount; }
+	void		WriteNextFragment( NetworkMessage &outFragment );				// Then moves on to the next one
+};
+
+struct NetworkIncomingBlob
+{
+public:
+	NetworkFragmentHeader							header;
+	std::map< uint32_t, std::vector< byte_t > >		receivedFragments;		// Fragment index => its bytes
+
+public:
+	NetworkIncomingBlob( NetworkFragmentHeader const &firstHeader );
+
+	bool		AddFragment( NetworkFragmentHeader const &fragmentHeader, NetworkMessage const &fragment );	// Read the header off the fragment first
+	inline bool	IsComplete() const			{ return receivedFragments.size() == header.fragmentCount; }
+	bool		Reassemble( NetworkMessage &outMessage ) const;												// Just the payload; definition & header are up to the caller
+};
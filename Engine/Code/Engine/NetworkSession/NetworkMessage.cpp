@@ -57,6 +57,11 @@ bool NetworkMessageDefinition::IsInOrder() const
 	return (optionsFlag & NET_MESSAGE_OPTION_IN_ORDER) == NET_MESSAGE_OPTION_IN_ORDER;
 }
 
+bool NetworkMessageDefinition::IsCompressed() const
+{
+	return (optionsFlag & NET_MESSAGE_OPTION_COMPRESS) == NET_MESSAGE_OPTION_COMPRESS;
+}
+
 // CLASS - NETWORK MESSAGE
 NetworkMessage::NetworkMessage( eEndianness endianness /*= LITTLE_ENDIAN */ )
 	: BytePacker( endianness )
@@ -65,7 +70,14 @@ NetworkMessage::NetworkMessage( eEndianness endianness /*= LITTLE_ENDIAN */ )
 }
 
 NetworkMessage::NetworkMessage( const char *name, eEndianness endianness /* = LITTLE_ENDIAN */ )
-	: BytePacker( PACKET_MTU - NETWORK_PACKET_HEADER_SIZE - 2U - NETWORK_RELIABLE_MESSAGE_HEADER_SIZE, endianness )
+	: BytePacker( endianness )
+	, m_name( name )
+{
+
+}
+
+NetworkMessage::NetworkMessage( const char *name, size_t maxByteCount, eEndianness endianness /* = LITTLE_ENDIAN */ )
+	: BytePacker( maxByteCount, endianness )
 	, m_name( name )
 {
 
@@ -78,33 +90,27 @@ NetworkMessage::~NetworkMessage()
 
 bool NetworkMessage::Write( int number )
 {
-	return WriteBytes( sizeof(int), &number );
+	return BytePacker::Write( number );
 }
 
 bool NetworkMessage::Write( float number )
 {
-	return WriteBytes( sizeof(float), &number );
+	return BytePacker::Write( number );
 }
 
 bool NetworkMessage::Write( std::string const &string )
 {
-	return WriteString( string.c_str() );
+	return WriteString( string.c_str(), string.size() );
 }
 
 bool NetworkMessage::Read( int &outNumber ) const
 {
-	size_t expectedBytes = sizeof( int );
-	size_t bytesRead	 = ReadBytes( &outNumber, expectedBytes );
-
-	return (expectedBytes == bytesRead);
+	return BytePacker::Read( outNumber );
 }
 
 bool NetworkMessage::Read( float &outNumber ) const
 {
-	size_t expectedBytes = sizeof( float );
-	size_t bytesRead	 = ReadBytes( &outNumber, expectedBytes );
-
-	return (expectedBytes == bytesRead);
+	return BytePacker::Read( outNumber );
 }
 
 size_t NetworkMessage::Read( char *outString, size_t maxSize ) const
@@ -112,6 +118,34 @@ size_t NetworkMessage::Read( char *outString, size_t maxSize ) const
 	return ReadString( outString, maxSize );
 }
 
+void NetworkMessage::Reset()
+{
+	ResetWrite();
+
+	m_name.clear();
+	m_lastSentHPC	= 0U;
+	m_header		= NetworkMessageHeader();
+	m_snapshotID	= INVALID_SNAPSHOT_ID;
+	m_queuedHPC		= 0U;
+	m_accumulatedPriority = 0.f;
+	m_definition	= nullptr;
+}
+
+void NetworkMessage::CopyFrom( NetworkMessage const &source )
+{
+	ResetWrite();
+	SetEndianness( source.GetEndianness() );
+	WriteBytes( source.GetWrittenByteCount(), source.GetBuffer(), false );
+
+	m_name			= source.m_name;
+	m_lastSentHPC	= source.m_lastSentHPC;
+	m_header		= source.m_header;
+	m_snapshotID	= source.m_snapshotID;
+	m_queuedHPC		= source.m_queuedHPC;
+	m_accumulatedPriority = source.m_accumulatedPriority;
+	m_definition	= source.m_definition;
+}
+
 NetworkMessageDefinition const* NetworkMessage::GetDefinition() const
 {
 	return m_definition;
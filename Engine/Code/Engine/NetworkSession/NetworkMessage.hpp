@@ -16,12 +16,23 @@ enum eNetworkMessageOptions : uint
 	NET_MESSAGE_OPTION_CONNECTIONLESS		= BIT_FLAG(0),
 	NET_MESSAGE_OPTION_RELIABLE				= BIT_FLAG(1),
 	NET_MESSAGE_OPTION_IN_ORDER				= BIT_FLAG(2),
+	NET_MESSAGE_OPTION_COMPRESS				= BIT_FLAG(3),		// LZ compress it, when it is too big for a packet & goes in fragments
 
 	// Convenience
 	NET_MESSAGE_OPTION_REQUIRES_CONNECTION	= 0U,
 	NET_MESSAGE_OPTION_RELIABLE_IN_ORDER	= NET_MESSAGE_OPTION_RELIABLE | NET_MESSAGE_OPTION_IN_ORDER,
 };
 
+// Which queued messages go in to a packet first; one left out gains its weight again every flush, so nothing starves
+enum eNetworkMessagePriority : uint8_t
+{
+	NET_MESSAGE_PRIORITY_LOW = 0,			// Chatter; deferred first
+	NET_MESSAGE_PRIORITY_NORMAL,
+	NET_MESSAGE_PRIORITY_HIGH,
+	NET_MESSAGE_PRIORITY_CRITICAL,			// Ahead of everything & not held back by the byte budget
+	NUM_NET_MESSAGE_PRIORITIES
+};
+
 enum eNetworkCoreMessages : uint8_t
 {
 	NET_MESSAGE_PING = 0,
@@ -34,6 +45,8 @@ enum eNetworkCoreMessages : uint8_t
 	NET_MESSAGE_JOIN_FINISHED,				// reliable in-order
 	NET_MESSAGE_UPDATE_CONNECTION_STATE,	// reliable in-order
 	NET_MESSAGE_HANGUP,						// reliable in-order
+	NET_MESSAGE_SNAPSHOT,					// unreliable
+	NET_MESSAGE_FRAGMENT,					// reliable; a piece of a message too big for a packet
 
 	NUM_CORE_NET_SESSION_MESSAGES
 };
@@ -67,6 +80,7 @@ public:
 	std::string				name		= "NAME NOT ASSIGNED!";
 	networkMessage_cb		callback	= nullptr;
 	eNetworkMessageOptions	optionsFlag	= NET_MESSAGE_OPTION_REQUIRES_CONNECTION;
+	eNetworkMessagePriority	priority	= NET_MESSAGE_PRIORITY_NORMAL;
 
 public:
 	NetworkMessageDefinition() { }
@@ -79,13 +93,21 @@ public:
 	bool RequiresConnection() const;
 	bool IsReliable() const;
 	bool IsInOrder() const;
+	bool IsCompressed() const;
+
+	inline bool  IsCritical() const			{ return priority == NET_MESSAGE_PRIORITY_CRITICAL; }
+	inline float GetPriorityWeight() const	{ return (float)( 1U << priority ); }		// 1, 2, 4, 8
 };
 
+// Largest payload which fits in a packet; NetworkConnection::Send() cuts a bigger reliable in to fragments
+#define NETWORK_MESSAGE_MAX_UNFRAGMENTED_BYTE_COUNT		( PACKET_MTU - NETWORK_PACKET_HEADER_SIZE - 2U - NETWORK_RELIABLE_MESSAGE_HEADER_SIZE )
+
 class NetworkMessage : public BytePacker
 {
 public:
 	 NetworkMessage( eEndianness endianness = LITTLE_ENDIAN );
-	 NetworkMessage( const char *name, eEndianness endianness = LITTLE_ENDIAN );
+	 NetworkMessage( const char *name, eEndianness endianness = LITTLE_ENDIAN );							// Grows, up to MAX_NETWORK_BLOB_BYTE_COUNT if reliable
+	 NetworkMessage( const char *name, size_t maxByteCount, eEndianness endianness = LITTLE_ENDIAN );	// Can't grow; writes past maxByteCount fail
 	~NetworkMessage();
 
 public:
@@ -100,6 +122,9 @@ public:
 	std::string						 m_name			= "NAME NOT ASSIGNED!";
 	uint64_t						 m_lastSentHPC	= 0U;
 	NetworkMessageHeader			 m_header;					// NetworkConnection fills the header when it adds to outgoing queue..
+	uint16_t						 m_snapshotID	= INVALID_SNAPSHOT_ID;	// Not sent; the PacketTracker of the packet carrying it remembers it, for the snapshot acks
+	uint64_t						 m_queuedHPC	= 0U;					// Not sent; when NetworkConnection queued it
+	float							 m_accumulatedPriority = 0.f;			// Not sent; its weight, once more for every flush which left it out
 
 private:
 	NetworkMessageDefinition const	*m_definition	= nullptr;	// *NetworkSession fills the header & definition when it receives the Packet
@@ -113,6 +138,10 @@ public:
 	bool	Read( float &outNumber ) const;
 	size_t	Read( char *outString, size_t maxSize ) const;
 
+public:
+	void Reset();												// Empty, without a definition; for reusing a pooled message
+	void CopyFrom( NetworkMessage const &source );				// Like the copy constructor, but reuses my buffer
+
 public:
 	NetworkMessageDefinition const* GetDefinition() const;
 	void SetDefinition( NetworkMessageDefinition const *def );	// Sets message definition and updates the member variables: m_name, m_header
@@ -121,4 +150,5 @@ public:
 	inline bool IsInOrder() const	{ return m_definition->IsInOrder(); }
 
 	inline uint GetChannel() const	{ return m_definition->channel; }
+	inline bool IsCritical() const	{ return m_definition->IsCritical(); }
 };
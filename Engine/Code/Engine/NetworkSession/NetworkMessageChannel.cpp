@@ -8,12 +8,54 @@ NetworkMessageChannel::NetworkMessageChannel()
 
 NetworkMessageChannel::~NetworkMessageChannel()
 {
-	while ( m_pendingMessagesToProcess.size() > 0 )
+	// Pending messages belong to the session's pool, NetworkConnection releases them
+}
+
+bool NetworkMessageChannel::CanBufferSequenceID( uint16_t sequenceID ) const
+{
+	uint16_t distanceFromExpected = sequenceID - m_nextExpectedSequenceID;
+	if( distanceFromExpected == 0U || distanceFromExpected >= RELIABLE_MESSAGES_WINDOW )
+		return false;
+
+	return ( m_pendingMessages[ sequenceID % RELIABLE_MESSAGES_WINDOW ].message == nullptr );
+}
+
+void NetworkMessageChannel::BufferPendingMessage( NetworkMessageAndSender const &pending )
+{
+	m_pendingMessages[ pending.message->m_header.sequenceID % RELIABLE_MESSAGES_WINDOW ] = pending;
+	m_pendingCount++;
+}
+
+bool NetworkMessageChannel::PopNextPendingMessage( NetworkMessageAndSender &outPending )
+{
+	if( m_pendingCount == 0U )
+		return false;
+
+	NetworkMessageAndSender &slot = m_pendingMessages[ m_nextExpectedSequenceID % RELIABLE_MESSAGES_WINDOW ];
+	if( slot.message == nullptr )
+		return false;
+
+	outPending		= slot;
+	slot.message	= nullptr;
+	m_pendingCount--;
+
+	IncrementExpectedSequenceID();
+	return true;
+}
+
+NetworkMessage* NetworkMessageChannel::TakeAnyPendingMessage()
+{
+	for( uint i = 0; i < RELIABLE_MESSAGES_WINDOW && m_pendingCount > 0U; i++ )
 	{
-		delete m_pendingMessagesToProcess.top().message;
-		delete m_pendingMessagesToProcess.top().sender;
+		if( m_pendingMessages[i].message == nullptr )
+			continue;
+
+		NetworkMessage *message = m_pendingMessages[i].message;
+		m_pendingMessages[i].message = nullptr;
+		m_pendingCount--;
 
-		m_pendingMessagesToProcess.pop();
+		return message;
 	}
-}
 
+	return nullptr;
+}
@@ -1,33 +1,30 @@
 #pragma once
-#include <queue>
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/NetworkSession/NetworkMessage.hpp"
 
+// Message comes from the session's pool; sender is kept by value, NetworkSender gets rebuilt from it for the callback
 struct NetworkMessageAndSender
 {
 public:
-	NetworkMessage	*message	= nullptr;
-	NetworkSender	*sender		= nullptr;
+	NetworkMessage		*message			= nullptr;
+	NetworkAddress		 senderAddress;
+	NetworkConnection	*senderConnection	= nullptr;
 
 public:
 	NetworkMessageAndSender() { }
-	NetworkMessageAndSender( NetworkMessage *newMessage, NetworkSender *newSender )
+	NetworkMessageAndSender( NetworkMessage *newMessage, NetworkSender const &newSender )
 		: message( newMessage )
-		, sender( newSender ) { }
+		, senderAddress( newSender.address )
+		, senderConnection( newSender.connection ) { }
 };
 
-// Puts the lowest sequenceID having message on the top
-struct CustomCompareForInorderMessagesAndSender
-{
-	bool operator () ( NetworkMessageAndSender const &lhs, NetworkMessageAndSender const &rhl )
-	{
-		return lhs.message->m_header.sequenceID > rhl.message->m_header.sequenceID;
-	}
-};
-
-typedef std::priority_queue< NetworkMessageAndSender, std::vector<NetworkMessageAndSender>, CustomCompareForInorderMessagesAndSender > InOrderNetworkMessages;
-
 
+//------------------------------------------------------------------------------------------
+// In-order messages which arrived before the one we're expecting wait in a ring, slot is sequenceID % RELIABLE_MESSAGES_WINDOW
+//	- Reliables go out in order & the sender stays within RELIABLE_MESSAGES_WINDOW of its oldest unconfirmed one,
+//	  so nothing waiting can be a window or more ahead of the expected ID
+//	- Buffering & taking the next one are O(1); the ring never reallocates
+//
 class NetworkMessageChannel
 {
 public:
@@ -38,8 +35,8 @@ private:
 	uint16_t				m_nextSentSequenceID		= 0U;
 	uint16_t				m_nextExpectedSequenceID	= 0U;
 
-public:
-	InOrderNetworkMessages	m_pendingMessagesToProcess;
+	NetworkMessageAndSender	m_pendingMessages[ RELIABLE_MESSAGES_WINDOW ];
+	uint					m_pendingCount				= 0U;
 
 public:
 	inline uint16_t	GetNextSequenceIDToSend() const { return m_nextSentSequenceID; }
@@ -47,4 +44,12 @@ public:
 
 	inline uint16_t GetExpectedSequenceID() const	{ return m_nextExpectedSequenceID; }
 	inline void		IncrementExpectedSequenceID() 	{ m_nextExpectedSequenceID++; }
+
+	// Receiving end
+	bool			CanBufferSequenceID( uint16_t sequenceID ) const;					// Ahead of the expected one, within the window & its slot is free
+	void			BufferPendingMessage( NetworkMessageAndSender const &pending );		// Check CanBufferSequenceID() first
+	bool			PopNextPendingMessage( NetworkMessageAndSender &outPending );		// If the expected one is waiting: hands it over & increments the expected ID
+
+	inline uint		GetPendingMessageCount() const	{ return m_pendingCount; }
+	NetworkMessage*	TakeAnyPendingMessage();											// nullptr if none; for releasing them all, when closing the connection
 };
@@ -0,0 +1,72 @@
+#pragma once
+#include <vector>
+#include "Engine/Core/EngineCommon.hpp"
+
+//------------------------------------------------------------------------------------------
+// Free list of T, allocated a block of objects at a time
+//	- Released objects go back on the free list, they're only deleted with the pool
+//	- Once the pool is as big as the traffic needs, Acquire() & Release() don't touch the heap
+//	- Objects come back the way they were released; resetting them is up to the owner
+//
+template <typename T>
+class NetworkObjectPool
+{
+public:
+	 NetworkObjectPool( uint objectsPerBlock = 32U )
+		: m_objectsPerBlock( (objectsPerBlock > 0U) ? objectsPerBlock : 1U ) { }
+	~NetworkObjectPool()
+	{
+		for( size_t i = 0; i < m_blocks.size(); i++ )
+			delete[] m_blocks[i];
+	}
+
+	NetworkObjectPool( NetworkObjectPool const &copy ) = delete;
+	NetworkObjectPool& operator = ( NetworkObjectPool const &copy ) = delete;
+
+private:
+	uint				m_objectsPerBlock	= 32U;
+	std::vector< T* >	m_blocks;
+	std::vector< T* >	m_freeObjects;
+
+public:
+	T* Acquire()
+	{
+		if( m_freeObjects.empty() )
+			AllocateBlock();
+
+		T *object = m_freeObjects.back();
+		m_freeObjects.pop_back();
+
+		return object;
+	}
+
+	void Release( T *object )
+	{
+		if( object == nullptr )
+			return;
+
+		m_freeObjects.push_back( object );		// Never grows, it has room for every object of the pool
+	}
+
+	void Reserve( uint objectCount )
+	{
+		while( GetCapacity() < objectCount )
+			AllocateBlock();
+	}
+
+	inline uint GetCapacity()		const { return (uint)m_blocks.size() * m_objectsPerBlock; }
+	inline uint GetFreeCount()		const { return (uint)m_freeObjects.size(); }
+	inline uint GetAcquiredCount()	const { return GetCapacity() - GetFreeCount(); }
+
+private:
+	void AllocateBlock()
+	{
+		T *block = new T[ m_objectsPerBlock ];
+		m_blocks.push_back( block );
+		m_freeObjects.reserve( GetCapacity() );
+
+		// Backwards, so the block gets handed out front to back
+		for( uint i = m_objectsPerBlock; i > 0U; i-- )
+			m_freeObjects.push_back( &block[ i - 1U ] );
+	}
+};
\ No newline at end of file
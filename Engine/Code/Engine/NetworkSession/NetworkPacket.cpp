@@ -31,18 +31,20 @@ bool PacketTracker::AddNewReliableID( uint16_t reliableID )
 	return true;
 }
 
-void PacketTracker::TrackForAck( uint16_t inAck )
+void PacketTracker::TrackForAck( uint16_t inAck, uint64_t inSentTimeHPC )
 {
 	Invalidate();
 
 	ack			= inAck;
-	sentTimeHPC	= Clock::GetCurrentHPC();
+	sentTimeHPC	= inSentTimeHPC;
 }
 
 void PacketTracker::Invalidate()
 {
 	ack = INVALID_PACKET_ACK;
 	reliablesCount = 0;
+	snapshotID = INVALID_SNAPSHOT_ID;
+	isCountedAsLost = false;
 }
 
 bool PacketTracker::IsValid() const
@@ -85,7 +87,8 @@ NetworkPacket::~NetworkPacket()
 void NetworkPacket::WriteHeader( NetworkPacketHeader const &header )
 {
 	// Write header according to individual data variables
-	BytePacker networkHeaderBP( NETWORK_PACKET_HEADER_SIZE, LITTLE_ENDIAN );
+	byte_t		headerBuffer[ NETWORK_PACKET_HEADER_SIZE ];
+	BytePacker	networkHeaderBP( NETWORK_PACKET_HEADER_SIZE, headerBuffer, LITTLE_ENDIAN );
 	networkHeaderBP.WriteBytes( sizeof( header.connectionIndex ),		&header.connectionIndex );
 	networkHeaderBP.WriteBytes( sizeof( header.ack ),					&header.ack );
 	networkHeaderBP.WriteBytes( sizeof( header.highestReceivedAck ),	&header.highestReceivedAck );
@@ -122,48 +125,28 @@ bool NetworkPacket::WriteMessage( NetworkMessage const &msg )
 	if( bytesWritten == 0U )
 		WriteHeader( m_header );															// Write the header
 
-	BytePacker messagePacker( LITTLE_ENDIAN );
-
-	// Set message header size according based on its nature
-	size_t messageHeaderSize;
-	if( msg.IsReliable() == false )
-		messageHeaderSize = NETWORK_UNRELIABLE_MESSAGE_HEADER_SIZE;
-	else
-	{
-		// Reliable message
-		messageHeaderSize = NETWORK_RELIABLE_MESSAGE_HEADER_SIZE;
-		
-		// In order
-		if( msg.IsInOrder() )
-			messageHeaderSize = NETWORK_RELIABLE_INORDER_MESSAGE_HEADER_SIZE;
-	}
-
 	size_t messageBytes			 = msg.GetWrittenByteCount();
-	size_t messagePlusHeaderSize = messageHeaderSize + messageBytes;
-	uint16_t bytesCountToWrite	 = ((uint16_t)messagePlusHeaderSize);
-
-	// Write bytes-to-read
-	messagePacker.WriteBytes( 2U, &bytesCountToWrite );
+	size_t needTotalBytes		 = GetPackedMessageSize( msg );
+	uint16_t bytesCountToWrite	 = ((uint16_t)( needTotalBytes - 2U ));
 
-	// Write message header - all the variables, one by one
-	messagePacker.WriteBytes( sizeof(msg.m_header.networkMessageDefinitionIndex), &msg.m_header.networkMessageDefinitionIndex );
-	if( msg.IsReliable() )
-		messagePacker.WriteBytes( sizeof(msg.m_header.reliableID), &msg.m_header.reliableID );
-	if( msg.IsInOrder() )
-		messagePacker.WriteBytes( sizeof(msg.m_header.sequenceID), &msg.m_header.sequenceID );
-
-	// Write message
-	messagePacker.WriteBytes( messageBytes, msg.GetBuffer(), false );						// false because it is already in LITTLE_ENDIANESS
-
-	// See if the length of messagePacker's buffer is not too big!
+	// See if the whole packed message fits, before writing any of it
 	size_t writableBytes	= GetWritableByteCount();
-	size_t needTotalBytes	= messagePacker.GetWrittenByteCount();
 	if( writableBytes < needTotalBytes )
 		return false;
 	else
 	{
+		// Write bytes-to-read
+		WriteBytes( 2U, &bytesCountToWrite );
+
+		// Write message header - all the variables, one by one
+		WriteBytes( sizeof(msg.m_header.networkMessageDefinitionIndex), &msg.m_header.networkMessageDefinitionIndex );
+		if( msg.IsReliable() )
+			WriteBytes( sizeof(msg.m_header.reliableID), &msg.m_header.reliableID );
+		if( msg.IsInOrder() )
+			WriteBytes( sizeof(msg.m_header.sequenceID), &msg.m_header.sequenceID );
+
 		// Write Message
-		bool writeSuccess = WriteBytes( needTotalBytes, messagePacker.GetBuffer(), false );	// false because it is already in LITTLE_ENDIANESS
+		bool writeSuccess = WriteBytes( messageBytes, msg.GetBuffer(), false );			// false because it is already in LITTLE_ENDIANESS
 		GUARANTEE_RECOVERABLE( writeSuccess, "Error: Couldn't write to Network Packet!" );
 		
 		// Update header for new unreliable message count
@@ -174,6 +157,26 @@ bool NetworkPacket::WriteMessage( NetworkMessage const &msg )
 	}
 }
 
+size_t NetworkPacket::GetPackedMessageSize( NetworkMessage const &msg )
+{
+	// Set message header size according based on its nature
+	size_t messageHeaderSize;
+	if( msg.IsReliable() == false )
+		messageHeaderSize = NETWORK_UNRELIABLE_MESSAGE_HEADER_SIZE;
+	else
+	{
+		// Reliable message
+		messageHeaderSize = NETWORK_RELIABLE_MESSAGE_HEADER_SIZE;
+		
+		// In order
+		if( msg.IsInOrder() )
+			messageHeaderSize = NETWORK_RELIABLE_INORDER_MESSAGE_HEADER_SIZE;
+	}
+
+	// 2 bytes for the size, then the header & the message
+	return 2U + messageHeaderSize + msg.GetWrittenByteCount();
+}
+
 bool NetworkPacket::ReadMessage( NetworkMessage &outMessage, NetworkSession const &session ) const
 {
 	// Get Length of Message & Header
@@ -213,15 +216,15 @@ bool NetworkPacket::ReadMessage( NetworkMessage &outMessage, NetworkSession cons
 		}
 	}
 
-	// Get Message
+	// Get Message; copied straight from my buffer in to the out message
 	uint16_t messageLength		= messageAndHeaderLength - (uint16_t)messageHeaderSize;
-	void	*messageBuffer		= malloc( messageLength );
-	size_t	 readMessageBytes	= ReadBytes( messageBuffer, messageLength, false );						// false because we want to read it as LITTLE_ENDIAN
+	size_t	 unreadBytes		= m_writeHead - m_readHead;
+	size_t	 readMessageBytes	= ( messageLength < unreadBytes ) ? messageLength : unreadBytes;
 	
 	// Out Message
 	outMessage.ResetWrite();
-	bool writeSuccess			= outMessage.WriteBytes( readMessageBytes, messageBuffer, false );		// false because we want to write it as LITTLE_ENDIAN
-	free( messageBuffer );
+	bool writeSuccess			= outMessage.WriteBytes( readMessageBytes, (byte_t const *)m_buffer + m_readHead, false );	// false because we want to write it as LITTLE_ENDIAN
+	m_readHead				   += readMessageBytes;
 	if( writeSuccess == false )
 		return false;
 
@@ -278,6 +281,12 @@ bool NetworkPacket::IsValid() const
 	return (bytesLeftInBuffer == 0U);
 }
 
+void NetworkPacket::Reset()
+{
+	ResetWrite();
+	m_header = NetworkPacketHeader();
+}
+
 bool NetworkPacket::HasMessages() const
 {
 	return m_header.messageCount > 0U;
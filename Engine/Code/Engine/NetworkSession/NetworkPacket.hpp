@@ -12,19 +12,22 @@ struct PacketTracker
 {
 public:
 	uint16_t ack			= INVALID_PACKET_ACK;
-	uint64_t sentTimeHPC	= Clock::GetCurrentHPC();
+	uint64_t sentTimeHPC	= 0U;					// On the connection's reference clock
 
 	int		 reliablesCount = 0;
 	uint16_t sentReliables[ MAX_RELIABLES_PER_PACKET ];
 
+	uint16_t snapshotID		= INVALID_SNAPSHOT_ID;	// Of the snapshot this packet carried, if any
+	bool	 isCountedAsLost = false;				// Still tracked, so a late ack confirms its reliables; the congestion control let it go
+
 public:
 	PacketTracker();
-	PacketTracker( uint16_t inAck );		// Sets sentTimeHPC as current time
+	PacketTracker( uint16_t inAck );
 	PacketTracker( uint16_t inAck, uint64_t inSentTimeHPC );
 
 public:
 	bool AddNewReliableID( uint16_t reliableID );
-	void TrackForAck( uint16_t inAck );
+	void TrackForAck( uint16_t inAck, uint64_t inSentTimeHPC );
 
 	void Invalidate();
 	bool IsValid() const;
@@ -79,6 +82,9 @@ public:
 	bool WriteMessage( NetworkMessage const &msg );											// Writes the message and updates the header
 	bool ReadMessage ( NetworkMessage &outMessage, NetworkSession const &session ) const;	// Fills the m_header for you!
 
+	static size_t GetPackedMessageSize( NetworkMessage const &msg );						// Bytes WriteMessage() takes for it
+
 	bool IsValid() const;									// Read Head doesn't get affected after this operation
 	bool HasMessages() const;								// If it has at least one message
+	void Reset();											// Empty, with a default header; for reusing a pooled packet
 };
@@ -3,7 +3,9 @@
 #include <bitset>
 #include "Engine/Core/Clock.hpp"
 #include "Engine/Core/StringUtils.hpp"
+#include "Engine/Math/MathUtil.hpp"
 #include "Engine/NetworkSession/NetworkPacket.hpp"
+#include "Engine/NetworkSession/LoopbackNetwork.hpp"
 #include "Engine/DebugRenderer/DebugRenderer.hpp"
 
 bool OnPing( NetworkMessage const &msg, NetworkSender &from )
@@ -105,6 +107,23 @@ bool OnHangup( NetworkMessage const &msg, NetworkSender &from )
 	return from.session.ProcessUpdateConnectionState( NET_CONNECTION_DISCONNECTED, from.address );
 }
 
+bool OnFragment( NetworkMessage const &msg, NetworkSender &from )
+{
+	if( from.connection == nullptr )
+		return false;
+
+	return from.connection->ProcessReceivedFragment( msg, from );
+}
+
+bool OnSnapshot( NetworkMessage const &msg, NetworkSender &from )
+{
+	// Only the host sends the world
+	if( from.connection == nullptr || from.connection->IsHost() == false )
+		return false;
+
+	return from.session.GetSnapshotReplicator().ProcessSnapshotMessage( msg );
+}
+
 std::string ToString( eNetworkSessionState inEnum )
 {
 	std::string str = "";
@@ -143,27 +162,38 @@ std::string ToString( eNetworkSessionState inEnum )
 	return str;
 }
 
-NetworkSession::NetworkSession( Renderer *currentRenderer /* = nullptr */ )
-	: m_theRenderer( currentRenderer )
+NetworkSession::NetworkSession( Renderer *currentRenderer /* = nullptr */, Clock const *referenceClock /* = nullptr */ )
+	: m_referenceClock( (referenceClock != nullptr) ? referenceClock : GetMasterClock() )
+	, m_theRenderer( currentRenderer )
+	, m_packetPool( NETWORK_PACKET_POOL_BLOCK_SIZE )
+	, m_messagePool( NETWORK_MESSAGE_POOL_BLOCK_SIZE )
+	, m_snapshotReplicator( *this )
 {
 	SetBoundConnectionsToNull();
 
-	// For UI
-	m_uiCamera = new Camera();
+	// For UI; a headless session ( no renderer ) never renders
+	if( currentRenderer != nullptr )
+	{
+		m_uiCamera = new Camera();
 
-	// Setting up the Camera
-	m_uiCamera->SetColorTarget( Renderer::GetDefaultColorTarget() );
-	m_uiCamera->SetDepthStencilTarget( Renderer::GetDefaultDepthTarget() );
-	m_uiCamera->SetProjectionOrtho( 2.f, -1.f, 1.f );			// Make an NDC
+		// Setting up the Camera
+		m_uiCamera->SetColorTarget( Renderer::GetDefaultColorTarget() );
+		m_uiCamera->SetDepthStencilTarget( Renderer::GetDefaultDepthTarget() );
+		m_uiCamera->SetProjectionOrtho( 2.f, -1.f, 1.f );			// Make an NDC
 
-	if( currentRenderer != nullptr )
 		m_fonts = currentRenderer->CreateOrGetBitmapFont("SquirrelFixedFont");
+	}
 	
 	RegisterCoreMessages();
 
 	// Timers
+	m_joinRequestTimer.SetClock( m_referenceClock );
+	m_joinTimeoutTimer.SetClock( m_referenceClock );
 	m_joinRequestTimer.SetTimer( m_joinTimerSeconds );
 	m_joinTimeoutTimer.SetTimer( m_joinTimeoutSeconds );
+
+	// Net Simulation
+	m_simulationRandomState = (uint) Clock::GetCurrentHPC();
 }
 
 NetworkSession::~NetworkSession()
@@ -184,13 +214,19 @@ NetworkSession::~NetworkSession()
 		m_registeredMessages[i] = nullptr;
 	}
 
-	// Delete my UDP Socket
-	delete m_mySocket;
-	m_mySocket = nullptr;
+	// Delete my Transport
+	delete m_transport;
+	m_transport = nullptr;
 }
 
 void NetworkSession::Update()
 {
+	// For the stats
+	uint receiveSyscallsBefore	= (m_transport != nullptr) ? m_transport->GetReceiveSyscallCount() : 0U;
+	uint sendSyscallsBefore		= (m_transport != nullptr) ? m_transport->GetSendSyscallCount()	   : 0U;
+	m_receivedPacketsThisFrame	= 0U;
+	m_sentPacketsThisFrame		= 0U;
+
 	UpdateNetClock();
 	ProcessIncoming();
 
@@ -223,6 +259,14 @@ void NetworkSession::Update()
 	CheckForConnectionTimeout();
 	RemoveDisconnectedConnections();
 	ProcessOutgoing();
+
+	// A new transport starts counting from zero
+	uint receiveSyscallsAfter	= (m_transport != nullptr) ? m_transport->GetReceiveSyscallCount() : 0U;
+	uint sendSyscallsAfter		= (m_transport != nullptr) ? m_transport->GetSendSyscallCount()	   : 0U;
+	m_receiveSyscallsLastFrame	= (receiveSyscallsAfter >= receiveSyscallsBefore) ? receiveSyscallsAfter - receiveSyscallsBefore : receiveSyscallsAfter;
+	m_sendSyscallsLastFrame		= (sendSyscallsAfter	>= sendSyscallsBefore)	  ? sendSyscallsAfter	 - sendSyscallsBefore	 : sendSyscallsAfter;
+	m_receivedPacketsLastFrame	= m_receivedPacketsThisFrame;
+	m_sentPacketsLastFrame		= m_sentPacketsThisFrame;
 }
 
 void NetworkSession::Render() const
@@ -247,8 +291,9 @@ void NetworkSession::Render() const
 	std::string lossPercentageStr	= Stringf( "%.2f%%", m_simulatedLossFraction * 100.f );
 	std::string simLagRangeStr		= Stringf( "%dms - %dms", m_simulatedMinLatency_ms, m_simulatedMaxLatency_ms );
 	std::string heartbeatHzStr		= Stringf( "%.2fhz", m_heartbeatFrequency );
+	std::string syscallsStr			= Stringf( "%u/frame (recv: %u for %u packets, send: %u for %u packets)", m_receiveSyscallsLastFrame + m_sendSyscallsLastFrame, m_receiveSyscallsLastFrame, m_receivedPacketsLastFrame, m_sendSyscallsLastFrame, m_sentPacketsLastFrame );
 	AABB2		srllBox				= backgroundBox.GetBoundsFromPercentage( Vector2( 0.01f, 0.6f ), Vector2( 1.f, 0.9f ) );
-	std::string srllStr				= Stringf( "%-8s: %s (%s: %s)\n%-8s: %s\n%-8s: %s", "rate", sendRateStr.c_str(), "heartbeat", heartbeatHzStr.c_str(), "sim_lag", simLagRangeStr.c_str(), "sim_loss", lossPercentageStr.c_str() );
+	std::string srllStr				= Stringf( "%-8s: %s (%s: %s)\n%-8s: %s\n%-8s: %s\n%-8s: %s", "rate", sendRateStr.c_str(), "heartbeat", heartbeatHzStr.c_str(), "sim_lag", simLagRangeStr.c_str(), "sim_loss", lossPercentageStr.c_str(), "syscalls", syscallsStr.c_str() );
 	m_theRenderer->DrawTextInBox2D( srllStr.c_str(), Vector2( 0.f, 1.f ), srllBox, m_uiBodyFontSize, RGBA_KHAKI_COLOR, m_fonts, TEXT_DRAW_SHRINK_TO_FIT );
 
 	// My Socket Address
@@ -259,7 +304,7 @@ void NetworkSession::Render() const
 	std::string clockStr			= std::to_string( (double)GetNetTimeMilliseconds() * 0.001f );
 	std::string netClockStr			= "[ NetClock  " + clockStr + "s ]";
 	std::string hostClientStr		= std::string( m_myConnection->IsHost() ? "Host" : "Client" ) + " as \"" + m_myConnection->GetNetworkID() + "\"";
-	std::string socketAddrStr		= m_mySocket->m_address.AddressToString() + " (" + hostClientStr + ")" + " | " + netClockStr;
+	std::string socketAddrStr		= m_transport->GetAddress().AddressToString() + " (" + hostClientStr + ")" + " | " + netClockStr;
 	m_theRenderer->DrawTextInBox2D( myAddressTitle.c_str(), Vector2( 0.f, 0.5f ), myAddressTitleBox, m_uiBodyFontSize, RGBA_WHITE_COLOR, m_fonts, TEXT_DRAW_SHRINK_TO_FIT );
 	m_theRenderer->DrawTextInBox2D( socketAddrStr.c_str(),  Vector2( 0.f, 0.5f ), myAddressBox,      m_uiBodyFontSize, RGBA_KHAKI_COLOR, m_fonts, TEXT_DRAW_SHRINK_TO_FIT );
 
@@ -271,7 +316,7 @@ void NetworkSession::Render() const
 	// Title Column of Table: All Connections
 	AABB2		allConnectionsBox	= backgroundBox.GetBoundsFromPercentage    ( Vector2( 0.01f, 0.0f ), Vector2( 1.f, 0.4f ) );
 	AABB2		columnTitlesBox		= allConnectionsBox.GetBoundsFromPercentage( Vector2( 0.00f, 0.9f ), Vector2( 1.f, 1.0f ) );
-	std::string	columnTitleStr		= Stringf( "%-2s  %-3s  %-12s  %-21s  %-12s  %-7s  %-7s  %-7s  %-7s  %-7s  %-7s  %-16s  %-7s", "--", "idx", "state", "address", "simsndrt(hz)", "rtt(s)", "loss(%)", "lrcv(s)", "lsnt(s)", "nsntack", "hrcvack", "rcvbits", "ucnfrmR" );
+	std::string	columnTitleStr		= Stringf( "%-2s  %-3s  %-12s  %-21s  %-12s  %-7s  %-7s  %-7s  %-7s  %-7s  %-7s  %-16s  %-7s  %-11s  %-7s", "--", "idx", "state", "address", "simsndrt(hz)", "rtt(s)", "loss(%)", "lrcv(s)", "lsnt(s)", "nsntack", "hrcvack", "rcvbits", "ucnfrmR", "pkts(fl/bg)", "rto(s)" );
 	m_theRenderer->DrawTextInBox2D( columnTitleStr.c_str(), Vector2( 0.f, 0.5f ), columnTitlesBox, m_uiBodyFontSize, RGBA_KHAKI_COLOR, m_fonts, TEXT_DRAW_OVERRUN );
 
 	// Each Connections
@@ -310,13 +355,12 @@ void NetworkSession::Render() const
 		std::string lossPercentStr = Stringf( "%.2f", m_boundConnections[i]->m_loss * 100.f );
 
 		// lrcv(s)
-		TODO( "Make sure we're not using GetMasterClock()->GetCurrentHPC()! GetCurrentHPC() is a static function, you meant to use GetMasterClock().total.hpc..!" );
-		uint64_t lastReceivedDeltaHPC = Clock::GetCurrentHPC() - m_boundConnections[i]->m_lastReceivedTimeHPC; 
+		uint64_t lastReceivedDeltaHPC = m_referenceClock->total.hpc - m_boundConnections[i]->m_lastReceivedTimeHPC; 
 		double	 lastReceivedDeltaSec = Clock::GetSecondsFromHPC( lastReceivedDeltaHPC );
 		std::string lrcvStr = Stringf( "%.3f", lastReceivedDeltaSec);
 
 		// lsnt(s)
-		uint64_t lastSentDeltaHPC = Clock::GetCurrentHPC() - m_boundConnections[i]->m_lastSendTimeHPC;
+		uint64_t lastSentDeltaHPC = m_referenceClock->total.hpc - m_boundConnections[i]->m_lastSendTimeHPC;
 		double	 lastSentDeltaSec = Clock::GetSecondsFromHPC( lastSentDeltaHPC );
 		std::string lsntStr = Stringf( "%.3f", lastSentDeltaSec);
 
@@ -333,12 +377,19 @@ void NetworkSession::Render() const
 		// ucnfrmR
 		std::string ncnfrm_relStr = Stringf( "%d", m_boundConnections[i]->GetUnconfirmedSendReliablesCount() );
 
+		// pkts(fl/bg)
+		NetworkCongestionControl const &congestion = m_boundConnections[i]->GetCongestionControl();
+		std::string packetBudgetStr = Stringf( "%u/%.1f%s", congestion.GetInFlightCount(), congestion.GetPacketBudget(), congestion.IsInSlowStart() ? "+" : "" );
+
+		// rto(s)
+		std::string rtoStr = Stringf( "%.3f", congestion.GetRetransmitTimeout() );
+
 		// Calculate the AABB
 		Vector2	mins = Vector2( columnTitlesBox.mins.x, columnTitlesBox.mins.y - ( ++numOfConnectionDisplayed * (m_uiBodyFontSize * 1.1f) ) );
 		AABB2 connectionDetailBox = AABB2( mins, mins + connectionDetailBoxSize );
 
 		// Draw the string
-		std::string	connectionRowStr = Stringf( "%-2s  %-3s  %-12s  %-21s  %-12s  %-7s  %-7s  %-7s  %-7s  %-7s  %-7s  %-16s  %-7s", connectionLebelStr.c_str(), idxStr.c_str(), connectionStateStr.c_str(), connectionAddrStr.c_str(), simsndrt.c_str(),rttStr.c_str(), lossPercentStr.c_str(), lrcvStr.c_str(), lsntStr.c_str(), sntackSrt.c_str(), rcvackStr.c_str(), rcvbitsStr.c_str(), ncnfrm_relStr.c_str() );
+		std::string	connectionRowStr = Stringf( "%-2s  %-3s  %-12s  %-21s  %-12s  %-7s  %-7s  %-7s  %-7s  %-7s  %-7s  %-16s  %-7s  %-11s  %-7s", connectionLebelStr.c_str(), idxStr.c_str(), connectionStateStr.c_str(), connectionAddrStr.c_str(), simsndrt.c_str(),rttStr.c_str(), lossPercentStr.c_str(), lrcvStr.c_str(), lsntStr.c_str(), sntackSrt.c_str(), rcvackStr.c_str(), rcvbitsStr.c_str(), ncnfrm_relStr.c_str(), packetBudgetStr.c_str(), rtoStr.c_str() );
 		m_theRenderer->DrawTextInBox2D( connectionRowStr.c_str(), Vector2( 0.f, 0.5f ), connectionDetailBox, m_uiBodyFontSize, RGBA_WHITE_COLOR, m_fonts, TEXT_DRAW_OVERRUN );
 	}
 }
@@ -349,7 +400,7 @@ void NetworkSession::UpdateNetClock()
 		return;
 
 	// Client only..
-	uint deltaTime_ms = GetMasterClock()->frame.ms;
+	uint deltaTime_ms = m_referenceClock->frame.ms;
 	m_desiredClientTime_ms += deltaTime_ms;
 
 	float scale = 1.f;
@@ -435,6 +486,8 @@ void NetworkSession::SendHangupToAllConnections()
 		m_boundConnections[i]->Send( hangupMsg );
 		m_boundConnections[i]->FlushMessages( true );
 	}
+
+	SendQueuedPackets();
 }
 
 bool NetworkSession::BindPort( uint16_t port, uint16_t range )
@@ -442,28 +495,35 @@ bool NetworkSession::BindPort( uint16_t port, uint16_t range )
 	NetworkAddress localAddress = NetworkAddress::GetLocal();
 	localAddress.port = port;
 
-	// If socket already exists, delete the old one
-	if( m_mySocket != nullptr )
+	// If already bound, send what's left & close it
+	if( m_transport != nullptr && m_transport->IsBound() )
 	{
-		delete m_mySocket;
-		m_mySocket = nullptr;
+		SendQueuedPackets();
+		m_transport->Close();
 	}
 
-	// Create a new socket and try to bind
-	m_mySocket = new UDPSocket();
-	bool success = m_mySocket->Bind( localAddress, range );
+	// UDP, unless told otherwise
+	if( m_transport == nullptr )
+		m_transport = new UDPNetworkTransport();
+
+	// Stays unbound on failure
+	return m_transport->Bind( localAddress, range );
+}
 
-	// return true on success
-	if( success )
+void NetworkSession::UseTransport( NetworkTransport *transport )
+{
+	if( IsRunning() )
 	{
-		m_mySocket->EnableNonBlocking();
-		return true;
+		ConsolePrintf( RGBA_RED_COLOR, "Can't change the transport.. the session is already running!" );
+		delete transport;
+		return;
 	}
 
-	// on failure, return after deleting the socket
-	delete m_mySocket;
-	m_mySocket = nullptr;
-	return false;
+	if( transport == m_transport )
+		return;
+
+	delete m_transport;
+	m_transport = transport;
 }
 
 void NetworkSession::RegisterCoreMessages()
@@ -475,20 +535,28 @@ void NetworkSession::RegisterCoreMessages()
 	// Connection Management
 	RegisterNetworkMessage( NET_MESSAGE_JOIN_REQUEST,				"join_request",			OnJoinRequest,		NET_MESSAGE_OPTION_CONNECTIONLESS );
 	RegisterNetworkMessage( NET_MESSAGE_JOIN_DENY,					"join_deny",			OnJoinDeny,			NET_MESSAGE_OPTION_REQUIRES_CONNECTION );
-	RegisterNetworkMessage( NET_MESSAGE_JOIN_ACCEPT,				"join_accept",			OnAccept,			NET_MESSAGE_OPTION_RELIABLE_IN_ORDER );
-	RegisterNetworkMessage( NET_MESSAGE_JOIN_FINISHED,				"join_finished",		OnJoinFinished,		NET_MESSAGE_OPTION_RELIABLE_IN_ORDER );
-	RegisterNetworkMessage( NET_MESSAGE_UPDATE_CONNECTION_STATE,	"update_connection",	OnUpdateConnection,	NET_MESSAGE_OPTION_RELIABLE_IN_ORDER );
-	RegisterNetworkMessage( NET_MESSAGE_HANGUP,						"hangup",				OnHangup,			NET_MESSAGE_OPTION_REQUIRES_CONNECTION );
+	RegisterNetworkMessage( NET_MESSAGE_JOIN_ACCEPT,				"join_accept",			OnAccept,			NET_MESSAGE_OPTION_RELIABLE_IN_ORDER,	NET_MESSAGE_PRIORITY_CRITICAL );
+	RegisterNetworkMessage( NET_MESSAGE_JOIN_FINISHED,				"join_finished",		OnJoinFinished,		NET_MESSAGE_OPTION_RELIABLE_IN_ORDER,	NET_MESSAGE_PRIORITY_CRITICAL );
+	RegisterNetworkMessage( NET_MESSAGE_UPDATE_CONNECTION_STATE,	"update_connection",	OnUpdateConnection,	NET_MESSAGE_OPTION_RELIABLE_IN_ORDER,	NET_MESSAGE_PRIORITY_CRITICAL );
+	RegisterNetworkMessage( NET_MESSAGE_HANGUP,						"hangup",				OnHangup,			NET_MESSAGE_OPTION_REQUIRES_CONNECTION,	NET_MESSAGE_PRIORITY_CRITICAL );
+	RegisterNetworkMessage( NET_MESSAGE_SNAPSHOT,					"snapshot",				OnSnapshot,			NET_MESSAGE_OPTION_REQUIRES_CONNECTION,	NET_MESSAGE_PRIORITY_HIGH );
+	RegisterNetworkMessage( NET_MESSAGE_FRAGMENT,					"fragment",				OnFragment,			NET_MESSAGE_OPTION_RELIABLE,			NET_MESSAGE_PRIORITY_LOW );
 }
 
 void NetworkSession::ProcessIncoming()
 {
+	uint64_t startHPC = Clock::GetCurrentHPC();
+
 	ReceivePacket();
 	ProcessReceivedPackets();
+
+	m_processIncomingHPCLastCall = Clock::GetCurrentHPC() - startHPC;
 }
 
 void NetworkSession::ProcessOutgoing()
 {
+	uint64_t startHPC = Clock::GetCurrentHPC();
+
 	for( int i = 0; i < MAX_SESSION_CONNECTIONS; i++ )
 	{
 		// If nullptr, skip
@@ -497,6 +565,11 @@ void NetworkSession::ProcessOutgoing()
 
 		m_boundConnections[i]->FlushMessages();
 	}
+
+	// Everything flushed this frame, in as few syscalls as the platform allows
+	SendQueuedPackets();
+
+	m_processOutgoingHPCLastCall = Clock::GetCurrentHPC() - startHPC;
 }
 
 void NetworkSession::Host( char const *myID, uint16_t port, uint16_t portRange /*= DEFAULT_PORT_RANGE */ )
@@ -514,7 +587,7 @@ void NetworkSession::Host( char const *myID, uint16_t port, uint16_t portRange /
 		return;
 	}
 
-	NetworkConnection *myConnectionAsHost = new NetworkConnection( 0, m_mySocket->m_address, myID, *this );
+	NetworkConnection *myConnectionAsHost = new NetworkConnection( 0, m_transport->GetAddress(), myID, *this );
 	DeleteConnection( m_myConnection );	// Make sure the old my connection is deleted
 
 	// Convenience pointers
@@ -534,6 +607,8 @@ void NetworkSession::Host( char const *myID, uint16_t port, uint16_t portRange /
 
 void NetworkSession::Join( char const *myID, NetworkAddress const &hostAddress )
 {
+	m_snapshotReplicator.Reset();
+
 	bool portBound = BindPort( hostAddress.port, MAX_SESSION_CONNECTIONS );
 	if( portBound == false )
 	{
@@ -561,7 +636,7 @@ void NetworkSession::Join( char const *myID, NetworkAddress const &hostAddress )
 	host->Send( joinRequestMessage );
 
 	// Make a connection for yourself
-	NetworkConnection *myConnection = new NetworkConnection( INVALID_INDEX_IN_SESSION, m_mySocket->m_address, myID, *this );
+	NetworkConnection *myConnection = new NetworkConnection( INVALID_INDEX_IN_SESSION, m_transport->GetAddress(), myID, *this );
 	
 	DeleteConnection( m_myConnection );
 	m_myConnection = myConnection;
@@ -577,6 +652,7 @@ void NetworkSession::Join( char const *myID, NetworkAddress const &hostAddress )
 void NetworkSession::Disconnect()
 {
 	DeleteAllConnections();
+	m_snapshotReplicator.Reset();
 	UpdateStateTo( NET_SESSION_DISCONNECTED );
 }
 
@@ -610,6 +686,10 @@ bool NetworkSession::ProcessJoinRequest( char *networkID, NetworkAddress const &
 	}
 
 	// I'm a host & listening
+	// A resent request of someone who already got in; the last slot may have been theirs
+	if( ConnectionAlreadyExists( reqFromAddress ) == true )
+		return true;
+
 	// Error: Lobby is full
 	if( IsLobbyFull() == true )
 	{
@@ -622,9 +702,6 @@ bool NetworkSession::ProcessJoinRequest( char *networkID, NetworkAddress const &
 		return false;
 	}
 
-	if( ConnectionAlreadyExists( reqFromAddress ) == true )
-		return true;
-
 	// Bind as new connection
 	int idx = GetIndexForNewConnection();
 	NetworkConnection *newConnection = new NetworkConnection( idx, reqFromAddress, networkID, *this );
@@ -650,7 +727,7 @@ bool NetworkSession::ProcessJoinRequest( char *networkID, NetworkAddress const &
 
 	// Send: JOIN_FINISHED
 	NetworkMessage joinFinishedMessage( "join_finished", LITTLE_ENDIAN );
-	uint currentTime_ms = GetMasterClock()->total.ms;
+	uint currentTime_ms = m_referenceClock->total.ms;
 	joinFinishedMessage.WriteBytes( sizeof(uint), &currentTime_ms );
 
 	newConnection->Send( joinFinishedMessage );
@@ -779,18 +856,18 @@ bool NetworkSession::IsLobbyFull() const
 uint NetworkSession::GetNetTimeMilliseconds() const
 {
 	if( m_myConnection->IsHost() )
-		return GetMasterClock()->total.ms;
+		return m_referenceClock->total.ms;
 	else
 		return m_currentClientTime_ms;
 }
 
-void NetworkSession::SendPacket( NetworkPacket &packetToSend )
+void NetworkSession::SendPacket( NetworkPacket *packetToSend )
 {
-	uint8_t idx = packetToSend.m_header.connectionIndex;
-	packetToSend.m_header.connectionIndex = GetMyConnectionIndex();
-	packetToSend.WriteHeader( packetToSend.m_header );
+	uint8_t idx = packetToSend->m_header.connectionIndex;
+	packetToSend->m_header.connectionIndex = GetMyConnectionIndex();
+	packetToSend->WriteHeader( packetToSend->m_header );
 
-	m_mySocket->SendTo( m_boundConnections[idx]->GetAddress(), packetToSend.GetBuffer(), packetToSend.GetWrittenByteCount() );
+	m_outgoingPackets.push_back( OutgoingNetworkPacket( packetToSend, m_boundConnections[idx]->GetAddress() ) );
 }
 
 void NetworkSession::SendDirectMessageTo( NetworkMessage &messageToSend, NetworkAddress const &address )
@@ -799,11 +876,41 @@ void NetworkSession::SendDirectMessageTo( NetworkMessage &messageToSend, Network
 	NetworkMessageDefinition const *msgDef = GetRegisteredMessageDefination( messageToSend.m_name );
 	messageToSend.SetDefinition( msgDef );
 	
-	// Send the Packet
-	NetworkPacket packetToSend;
-	packetToSend.WriteMessage( messageToSend );
+	// Queue the Packet
+	NetworkPacket *packetToSend = AcquirePacket();
+	packetToSend->WriteMessage( messageToSend );
+
+	m_outgoingPackets.push_back( OutgoingNetworkPacket( packetToSend, address ) );
+}
+
+void NetworkSession::SendQueuedPackets()
+{
+	UDPDatagram datagrams[ UDP_MAX_BATCH_SIZE ];
+
+	uint queuedCount = (uint) m_outgoingPackets.size();
+	for( uint batchStart = 0U; batchStart < queuedCount && m_transport != nullptr; batchStart += UDP_MAX_BATCH_SIZE )
+	{
+		uint batchCount = queuedCount - batchStart;
+		if( batchCount > UDP_MAX_BATCH_SIZE )
+			batchCount = UDP_MAX_BATCH_SIZE;
+
+		for( uint i = 0; i < batchCount; i++ )
+		{
+			OutgoingNetworkPacket &outgoing = m_outgoingPackets[ batchStart + i ];
 
-	m_mySocket->SendTo( address, packetToSend.GetBuffer(), packetToSend.GetWrittenByteCount() );
+			datagrams[i].address	= outgoing.address;
+			datagrams[i].buffer		= outgoing.packet->GetWritableBuffer();
+			datagrams[i].byteCount	= outgoing.packet->GetWrittenByteCount();
+		}
+
+		m_sentPacketsThisFrame += m_transport->SendBatch( datagrams, batchCount );
+	}
+
+	// Back to the pool, sent or not
+	for( uint i = 0; i < queuedCount; i++ )
+		ReleasePacket( m_outgoingPackets[i].packet );
+
+	m_outgoingPackets.clear();
 }
 
 void NetworkSession::BroadcastMessage( NetworkMessage &messageToBroadcast, NetworkConnection const *excludeConnection /* = nullptr */ )
@@ -937,7 +1044,7 @@ void NetworkSession::CheckForConnectionTimeout()
 		if( m_boundConnections[i] == nullptr )
 			continue;
 
-		uint64_t currentHPC		 = Clock::GetCurrentHPC();
+		uint64_t currentHPC		 = m_referenceClock->total.hpc;
 		uint64_t lastReceivedHPC = m_boundConnections[i]->m_lastReceivedTimeHPC;
 		double	 idleTimeSeconds = Clock::GetSecondsFromHPC(currentHPC - lastReceivedHPC);
 
@@ -1000,7 +1107,7 @@ uint8_t NetworkSession::GetMyConnectionIndex() const
 			continue;
 
 		// If connection found..
-		if( m_boundConnections[i]->GetAddress() == m_mySocket->m_address )
+		if( m_boundConnections[i]->GetAddress() == m_transport->GetAddress() )
 		{
 			// If it is under max indices allowed
 			if( i < 0xff )
@@ -1051,9 +1158,10 @@ bool NetworkSession::IsRegistered( NetworkConnection const *connection ) const
 	return false;
 }
 
-void NetworkSession::RegisterNetworkMessage( uint8_t index, char const *messageName, networkMessage_cb cb, eNetworkMessageOptions netmessageOptionsFlag )
+void NetworkSession::RegisterNetworkMessage( uint8_t index, char const *messageName, networkMessage_cb cb, eNetworkMessageOptions netmessageOptionsFlag, eNetworkMessagePriority priority /* = NET_MESSAGE_PRIORITY_NORMAL */ )
 {
 	NetworkMessageDefinition *newDefinition = new NetworkMessageDefinition( (int)index, messageName, cb, netmessageOptionsFlag );
+	newDefinition->priority = priority;
 	
 	if( m_registeredMessages[ index ] != nullptr )
 	{
@@ -1064,8 +1172,14 @@ void NetworkSession::RegisterNetworkMessage( uint8_t index, char const *messageN
 	m_registeredMessages[ index ] = newDefinition;
 }
 
-bool NetworkSession::RegisterNetworkMessage( char const *messageName, networkMessage_cb cb, eNetworkMessageOptions netMessageOptionsFlag )
+bool NetworkSession::RegisterNetworkMessage( char const *messageName, networkMessage_cb cb, eNetworkMessageOptions netMessageOptionsFlag, uint channel /* = 0U */, eNetworkMessagePriority priority /* = NET_MESSAGE_PRIORITY_NORMAL */ )
 {
+	if( channel >= MAX_NETWORK_MESSAGE_CHANNELS )
+	{
+		GUARANTEE_RECOVERABLE( false, "Error: Network message channel is out of range!" );
+		return false;
+	}
+
 	for( uint8_t index = NUM_CORE_NET_SESSION_MESSAGES; index <= 0xff; index++ )
 	{
 		if( m_registeredMessages[ index ] != nullptr )
@@ -1073,6 +1187,8 @@ bool NetworkSession::RegisterNetworkMessage( char const *messageName, networkMes
 		else
 		{
 			NetworkMessageDefinition *newDefinition = new NetworkMessageDefinition( (int)index, messageName, cb, netMessageOptionsFlag );
+			newDefinition->channel	= channel;
+			newDefinition->priority	= priority;
 			m_registeredMessages[ index ] = newDefinition;
 
 			return true;
@@ -1142,34 +1258,52 @@ void NetworkSession::SetSimulationSendFrequency( uint8_t frequencyHz )
 	m_simulatedSendFrequency = frequencyHz;
 }
 
+void NetworkSession::SetSimulationSeed( uint seed )
+{
+	m_simulationRandomState = seed;
+}
+
 void NetworkSession::ReceivePacket()
 {
-	NetworkAddress sender;
-	size_t receivedBytes = 0U;
-	
+	if( m_transport == nullptr )
+		return;
+
+	UDPDatagram	datagrams[ NETWORK_RECEIVE_BATCH_SIZE ];
+	uint		receivedCount = 0U;
+
+	// A batch at a time, until the socket has nothing left
 	do 
 	{
-		void *buffer = malloc( PACKET_MTU );
+		// Receive straight in to pooled packets; the ones which didn't get used stay for the next batch
+		for( uint i = 0; i < NETWORK_RECEIVE_BATCH_SIZE; i++ )
+		{
+			if( m_receiveBatchPackets[i] == nullptr )
+				m_receiveBatchPackets[i] = AcquirePacket();
 
-		receivedBytes = m_mySocket->ReceiveFrom( &sender, buffer, PACKET_MTU );
-		
-		NetworkPacket *receivedPacket = new NetworkPacket();
-		receivedPacket->WriteBytes( receivedBytes, buffer, false );
-		bool discardThisPacket = CheckRandomChance( m_simulatedLossFraction );
+			datagrams[i].buffer		= m_receiveBatchPackets[i]->GetWritableBuffer();
+			datagrams[i].bufferSize	= PACKET_MTU;
+		}
 
-		// If it is not an empty packet & if we're not discarding
-		if( (receivedBytes > 0) && (discardThisPacket == false) )
-			QueuePacketForSimulation( receivedPacket, sender );
+		receivedCount = m_transport->ReceiveBatch( datagrams, NETWORK_RECEIVE_BATCH_SIZE );
+		m_receivedPacketsThisFrame += receivedCount;
 
-		// Free the temp buffer
-		free( buffer );
+		for( uint i = 0; i < receivedCount; i++ )
+		{
+			// If it is an empty packet or if we're discarding, it goes back in the batch
+			if( (datagrams[i].byteCount == 0U) || CheckSeededRandomChance( m_simulationRandomState, m_simulatedLossFraction ) )
+				continue;
 
-	} while ( receivedBytes > 0U );
+			m_receiveBatchPackets[i]->SetWrittenByteCountDummy( datagrams[i].byteCount );
+			QueuePacketForSimulation( m_receiveBatchPackets[i], datagrams[i].address );
+			m_receiveBatchPackets[i] = nullptr;
+		}
+
+	} while ( receivedCount == NETWORK_RECEIVE_BATCH_SIZE );
 }
 
 void NetworkSession::ProcessReceivedPackets()
 {
-	uint64_t currentHPC = Clock::GetCurrentHPC();
+	uint64_t currentHPC = m_referenceClock->total.hpc;
 
 	// Check all packets
 	while ( m_receivedPackets.size() > 0 )
@@ -1181,7 +1315,7 @@ void NetworkSession::ProcessReceivedPackets()
 			StampedNetworkPacket thisStampedPacket = m_receivedPackets.top();
 
 			// Process it
-			ProccessAndDeletePacket( thisStampedPacket.packet, thisStampedPacket.sender );
+			ProcessAndReleasePacket( thisStampedPacket.packet, thisStampedPacket.sender );
 
 			// Remove the top from queue
 			m_receivedPackets.pop();
@@ -1197,21 +1331,22 @@ void NetworkSession::QueuePacketForSimulation( NetworkPacket *newPacket, Network
 
 	// Calculate random latency
 	uint	range		= m_simulatedMaxLatency_ms - m_simulatedMinLatency_ms;
-	int		randomRange	= GetRandomIntInRange( 0, (int)range );
+	int		randomRange	= (range > 0U) ? GetSeededRandomIntInRange( m_simulationRandomState, 0, (int)range ) : 0;
 	uint	latency_ms	= m_simulatedMinLatency_ms + (uint)randomRange;
 
 	// Get timestamp out of it
 	uint64_t latency_HPC = Clock::GetHPCFromMilliSeconds( latency_ms );
-	uint64_t timestamp	 = Clock::GetCurrentHPC() + latency_HPC;
+	uint64_t timestamp	 = m_referenceClock->total.hpc + latency_HPC;
 
 	// Stamp with the latency
-	stampedPacket.timestampHPC = timestamp;
+	stampedPacket.timestampHPC	= timestamp;
+	stampedPacket.sequence		= m_nextReceivedSequence++;
 
 	// Add it to priority queue
 	m_receivedPackets.push( stampedPacket );
 }
 
-void NetworkSession::ProccessAndDeletePacket( NetworkPacket *&packet, NetworkAddress &sender )
+void NetworkSession::ProcessAndReleasePacket( NetworkPacket *&packet, NetworkAddress &sender )
 {
 	if( packet->IsValid() )
 	{
@@ -1228,7 +1363,7 @@ void NetworkSession::ProccessAndDeletePacket( NetworkPacket *&packet, NetworkAdd
 		}
 
 		// Process each messages
-		NetworkMessage receivedMessage;
+		NetworkMessage &receivedMessage = *AcquireMessage();
 		for( int i = 0; i < packet->m_header.messageCount; i++ )
 		{
 			bool messageReadSuccess = packet->ReadMessage( receivedMessage, *this );
@@ -1274,15 +1409,241 @@ void NetworkSession::ProccessAndDeletePacket( NetworkPacket *&packet, NetworkAdd
 			else
 				ConsolePrintf( "Received invalid messageDefinition Index: %d", receivedMessage.m_header.networkMessageDefinitionIndex );
 		}
+
+		ReleaseMessage( &receivedMessage );
 	}
 	else
 		ConsolePrintf( RGBA_KHAKI_COLOR, "Bad Packet Received from %s", sender.AddressToString().c_str() );
 
-	// Delete the packet
-	delete packet;
+	// Back to the pool
+	ReleasePacket( packet );
 	packet = nullptr;
 }
 
+NetworkPacket* NetworkSession::AcquirePacket()
+{
+	NetworkPacket *packet = m_packetPool.Acquire();
+	packet->Reset();
+
+	return packet;
+}
+
+void NetworkSession::ReleasePacket( NetworkPacket *packet )
+{
+	m_packetPool.Release( packet );
+}
+
+NetworkMessage* NetworkSession::AcquireMessage()
+{
+	NetworkMessage *message = m_messagePool.Acquire();
+	message->Reset();
+
+	return message;
+}
+
+void NetworkSession::ReleaseMessage( NetworkMessage *message )
+{
+	m_messagePool.Release( message );
+}
+
+static uint s_benchmarkMessagesReceived = 0U;
+
+bool OnNetworkBenchmark( NetworkMessage const &msg, NetworkSender &from )
+{
+	UNUSED( msg );
+	UNUSED( from );
+
+	s_benchmarkMessagesReceived++;
+	return true;
+}
+
+void NetworkSessionBenchmark( Command &cmd )
+{
+	std::string countStr			= cmd.GetNextString();
+	std::string perPacketStr		= cmd.GetNextString();
+	std::string perFrameStr			= cmd.GetNextString();
+	uint		messageCount		= ( countStr != "" )	 ? (uint) atoi( countStr.c_str() )	  : 100000U;
+	uint		messagesPerPacket	= ( perPacketStr != "" ) ? (uint) atoi( perPacketStr.c_str() ) : 32U;
+	uint		packetsPerFrame		= ( perFrameStr != "" )	 ? (uint) atoi( perFrameStr.c_str() )  : 8U;
+	if( messageCount == 0U || messagesPerPacket == 0U || packetsPerFrame == 0U )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "net_benchmark: message count, messages per packet & packets per frame can't be ZERO!" );
+		return;
+	}
+
+	// A session hosting by itself; my connection's address is the session's socket, so every flush loops back in to ProcessIncoming()
+	NetworkSession session;
+	session.RegisterNetworkMessage( "net_benchmark", OnNetworkBenchmark, NET_MESSAGE_OPTION_REQUIRES_CONNECTION );
+	session.Host( "benchmark", GAME_PORT, DEFAULT_PORT_RANGE );
+	if( session.IsRunning() == false )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "net_benchmark: Couldn't host the loopback session!" );
+		return;
+	}
+
+	NetworkConnection	*loopback = session.GetMyConnection();
+	NetworkMessage		 benchmarkMessage( "net_benchmark" );
+	benchmarkMessage.Write( 42 );
+
+	uint frameCount = 0U;
+	auto runMessages = [&]( uint count )
+	{
+		s_benchmarkMessagesReceived = 0U;
+		frameCount					= 0U;
+
+		// A frame flushes packetsPerFrame packets, sends them in a batch & receives them back
+		uint sentCount = 0U;
+		while( sentCount < count )
+		{
+			for( uint p = 0; p < packetsPerFrame && sentCount < count; p++ )
+			{
+				for( uint i = 0; i < messagesPerPacket && sentCount < count; i++, sentCount++ )
+					loopback->Send( benchmarkMessage );
+
+				loopback->FlushMessages( true );
+			}
+
+			session.SendQueuedPackets();
+			session.ProcessIncoming();
+			frameCount++;
+		}
+
+		// Whatever is still in the socket
+		uint64_t drainUntilHPC = Clock::GetCurrentHPC() + Clock::GetHPCFromMilliSeconds( 250U );
+		while( s_benchmarkMessagesReceived < count && Clock::GetCurrentHPC() < drainUntilHPC )
+			session.ProcessIncoming();
+	};
+
+	// Warm up, so the pools are as big as this traffic needs before we time it
+	runMessages( messagesPerPacket * 64U );
+
+	uint packetsBefore	= session.GetPooledPacketCount();
+	uint messagesBefore	= session.GetPooledMessageCount();
+
+	NetworkTransport const	*transport			= session.GetTransport();
+	uint					 receiveSyscalls	= transport->GetReceiveSyscallCount();
+	uint					 sendSyscalls		= transport->GetSendSyscallCount();
+
+	uint64_t startHPC = Clock::GetCurrentHPC();
+	runMessages( messageCount );
+	double elapsedSeconds = Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+
+	receiveSyscalls	= transport->GetReceiveSyscallCount() - receiveSyscalls;
+	sendSyscalls	= transport->GetSendSyscallCount()	  - sendSyscalls;
+
+	ConsolePrintf( "net_benchmark: %u messages, %u per packet, %u packets per frame: %.3f ms, %.0f messages/sec", messageCount, messagesPerPacket, packetsPerFrame, elapsedSeconds * 1000.0, (double)s_benchmarkMessagesReceived / elapsedSeconds );
+	ConsolePrintf( "  syscalls: %.2f per frame ( %u receive & %u send over %u frames )", (double)(receiveSyscalls + sendSyscalls) / (double)frameCount, receiveSyscalls, sendSyscalls, frameCount );
+	ConsolePrintf( "  received %u; pooled %u packets & %u messages ( +%u & +%u while timed )", s_benchmarkMessagesReceived, session.GetPooledPacketCount(), session.GetPooledMessageCount(), session.GetPooledPacketCount() - packetsBefore, session.GetPooledMessageCount() - messagesBefore );
+}
+
+static std::vector< byte_t >	s_reliableStressReceivedFlags;		// Per message index
+static uint						s_reliableStressReceived	= 0U;
+static uint						s_reliableStressDuplicates	= 0U;
+static uint						s_reliableStressOutOfOrder	= 0U;
+static int						s_reliableStressNextInOrder	= 0;
+
+bool OnReliableStress( NetworkMessage const &msg, NetworkSender &from )
+{
+	int messageIdx = -1;
+	if( msg.Read( messageIdx ) == false || messageIdx < 0 || messageIdx >= (int)s_reliableStressReceivedFlags.size() )
+		return false;
+
+	if( s_reliableStressReceivedFlags[ messageIdx ] > 0U )
+		s_reliableStressDuplicates++;
+	else
+		s_reliableStressReceived++;
+	s_reliableStressReceivedFlags[ messageIdx ] = 1U;
+
+	// Only in-order messages have to come in the order they were sent
+	if( msg.IsInOrder() )
+	{
+		if( messageIdx != s_reliableStressNextInOrder )
+			s_reliableStressOutOfOrder++;
+		s_reliableStressNextInOrder = messageIdx + 1;
+	}
+
+	UNUSED( from );
+	return true;
+}
+
+static void RunReliableStress( char const *commandName, eNetworkMessageOptions messageOptions, Command &cmd )
+{
+	std::string countStr		= cmd.GetNextString();
+	std::string lossStr			= cmd.GetNextString();
+	std::string latencyStr		= cmd.GetNextString();
+	uint		messageCount	= ( countStr != "" )	? (uint) atoi( countStr.c_str() )	: 20000U;
+	uint		lossPercent		= ( lossStr != "" )		? (uint) atoi( lossStr.c_str() )	: 10U;
+	uint		maxLatency_ms	= ( latencyStr != "" )	? (uint) atoi( latencyStr.c_str() )	: 20U;
+	if( messageCount == 0U || lossPercent >= 100U )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "%s: message count can't be ZERO & loss has to be less than 100%%!", commandName );
+		return;
+	}
+
+	// Loopback session, like net_benchmark; latency in [0, max] reorders the packets
+	NetworkSession session;
+	session.RegisterNetworkMessage( commandName, OnReliableStress, messageOptions );
+	session.Host( "stress", GAME_PORT, DEFAULT_PORT_RANGE );
+	if( session.IsRunning() == false )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "%s: Couldn't host the loopback session!", commandName );
+		return;
+	}
+	session.SetSimulationLoss( (float)lossPercent * 0.01f );
+	session.SetSimulationLatency( 0U, maxLatency_ms );
+
+	s_reliableStressReceivedFlags.assign( messageCount, 0U );
+	s_reliableStressReceived	= 0U;
+	s_reliableStressDuplicates	= 0U;
+	s_reliableStressOutOfOrder	= 0U;
+	s_reliableStressNextInOrder	= 0;
+
+	NetworkConnection	*loopback = session.GetMyConnection();
+	NetworkMessage		 stressMessage( commandName );
+
+	// Resends & acks run on the master clock, so every frame here ticks it
+	uint		sentCount		= 0U;
+	uint		frameCount		= 0U;
+	uint64_t	startHPC		= Clock::GetCurrentHPC();
+	uint64_t	giveUpHPC		= startHPC + Clock::GetHPCFromSeconds( 60.0 );
+	while( s_reliableStressReceived < messageCount && Clock::GetCurrentHPC() < giveUpHPC )
+	{
+		TickMasterClock();
+
+		// Keep a window's worth queued, so the queue & the pools stay small
+		while( sentCount < messageCount && loopback->GetQueuedReliablesCount() < RELIABLE_MESSAGES_WINDOW )
+		{
+			stressMessage.ResetWrite();
+			stressMessage.Write( (int)sentCount );
+			loopback->Send( stressMessage );
+			sentCount++;
+		}
+
+		loopback->FlushMessages( true );
+		session.SendQueuedPackets();
+		session.ProcessIncoming();
+		frameCount++;
+	}
+	double elapsedSeconds = Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+
+	bool isValid = ( s_reliableStressReceived == messageCount ) && ( s_reliableStressDuplicates == 0U ) && ( s_reliableStressOutOfOrder == 0U );
+	ConsolePrintf( "%s: %u messages, %u%% loss, 0-%ums latency: %.3f s over %u frames, %.0f messages/sec", commandName, messageCount, lossPercent, maxLatency_ms, elapsedSeconds, frameCount, (double)s_reliableStressReceived / elapsedSeconds );
+	ConsolePrintf( isValid ? RGBA_GREEN_COLOR : RGBA_RED_COLOR, "  received %u, missing %u, duplicates processed %u, out of order %u; pooled %u packets & %u messages",
+				   s_reliableStressReceived, messageCount - s_reliableStressReceived, s_reliableStressDuplicates, s_reliableStressOutOfOrder, session.GetPooledPacketCount(), session.GetPooledMessageCount() );
+
+	s_reliableStressReceivedFlags.clear();
+}
+
+void NetworkReliableStress( Command &cmd )
+{
+	RunReliableStress( "net_reliable_stress", NET_MESSAGE_OPTION_RELIABLE, cmd );
+}
+
+void NetworkInOrderStress( Command &cmd )
+{
+	RunReliableStress( "net_inorder_stress", NET_MESSAGE_OPTION_RELIABLE_IN_ORDER, cmd );
+}
+
 // NetworkConnection* NetworkSession::AddConnection( int idx, NetworkAddress &addr )
 // {
 // 		// If idx is not in range
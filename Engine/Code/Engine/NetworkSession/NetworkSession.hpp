@@ -2,10 +2,13 @@
 #include <queue>
 #include <vector>
 #include "Engine/Core/EngineCommon.hpp"
-#include "Engine/Network/UDPSocket.hpp"
+#include "Engine/Input/Command.hpp"
 #include "Engine/Network/NetworkAddress.hpp"
 #include "Engine/NetworkSession/NetworkMessage.hpp"
 #include "Engine/NetworkSession/NetworkConnection.hpp"
+#include "Engine/NetworkSession/NetworkObjectPool.hpp"
+#include "Engine/NetworkSession/NetworkSnapshot.hpp"
+#include "Engine/NetworkSession/NetworkTransport.hpp"
 
 
 //---------------------
@@ -24,7 +27,10 @@ typedef std::priority_queue< StampedNetworkPacket, std::vector<StampedNetworkPac
 //----------
 // Constants
 //
-constexpr uint16_t DEFAULT_PORT_RANGE = 10;
+constexpr uint16_t DEFAULT_PORT_RANGE					= 10;
+constexpr uint	   NETWORK_PACKET_POOL_BLOCK_SIZE		= 16;
+constexpr uint	   NETWORK_MESSAGE_POOL_BLOCK_SIZE		= 64;
+constexpr uint	   NETWORK_RECEIVE_BATCH_SIZE			= 32;		// Datagrams per ReceiveBatch(); up to UDP_MAX_BATCH_SIZE
 
 
 //------
@@ -65,12 +71,26 @@ public:
 	NetworkPacket	*packet;
 	NetworkAddress	 sender;
 	uint64_t		 timestampHPC;
+	uint64_t		 sequence;			// Order of receiving; packets due at the same time stay in it
 
 public:
 	StampedNetworkPacket( NetworkPacket *netPacket, NetworkAddress &senderAddr )
 		: sender( senderAddr )
 		, packet( netPacket )
-		, timestampHPC( 0U ) { }
+		, timestampHPC( 0U )
+		, sequence( 0U ) { }
+};
+
+struct OutgoingNetworkPacket
+{
+public:
+	NetworkPacket	*packet;
+	NetworkAddress	 address;
+
+public:
+	OutgoingNetworkPacket( NetworkPacket *netPacket, NetworkAddress const &toAddress )
+		: packet( netPacket )
+		, address( toAddress ) { }
 };
 
 // Puts the lowest timestamp having StampedPacket at the top
@@ -78,7 +98,10 @@ struct CustomCompareForStampedPacketQueue
 {
 	bool operator () ( StampedNetworkPacket &lhs, StampedNetworkPacket &rhs )
 	{
-		return lhs.timestampHPC > rhs.timestampHPC;
+		if( lhs.timestampHPC != rhs.timestampHPC )
+			return lhs.timestampHPC > rhs.timestampHPC;
+
+		return lhs.sequence > rhs.sequence;
 	}
 };
 
@@ -89,18 +112,19 @@ struct CustomCompareForStampedPacketQueue
 class NetworkSession
 {
 public:
-	 NetworkSession( Renderer *currentRenderer = nullptr );
+	 NetworkSession( Renderer *currentRenderer = nullptr, Clock const *referenceClock = nullptr );		// Master clock, if no reference clock is provided
 	~NetworkSession();
 
 private:
-	// My Socket
-	UDPSocket			*m_mySocket				= nullptr;
+	// My Socket; a UDPNetworkTransport, unless UseTransport() gave another one
+	NetworkTransport	*m_transport			= nullptr;
 
 	// Me & My Host
 	NetworkConnection	*m_myConnection			= nullptr;
 	NetworkConnection	*m_hostConnection		= nullptr;
 
-	// Timers
+	// Timers; on the reference clock, like every time of the session & its connections
+	Clock const			*m_referenceClock		= nullptr;
 	double const		 m_joinTimerSeconds		= 0.1;
 	Stopwatch			 m_joinRequestTimer;
 
@@ -160,13 +184,14 @@ private:
 	void ReceivePacket();
 	void ProcessReceivedPackets();
 	void QueuePacketForSimulation( NetworkPacket *newPacket, NetworkAddress &sender );	// Queues them with a random latency
-	void ProccessAndDeletePacket ( NetworkPacket *&packet, NetworkAddress &sender );	// Process the packet and deletes it
+	void ProcessAndReleasePacket ( NetworkPacket *&packet, NetworkAddress &sender );	// Process the packet and hands it back to the pool
 
 public:
 	// Sending
-	void SendPacket				( NetworkPacket &packetToSend );							// Replaces connectionIndex by sender's index
+	void SendPacket				( NetworkPacket *packetToSend );							// Takes the pooled packet & replaces connectionIndex by sender's index; goes out with the next SendQueuedPackets()
 	void SendDirectMessageTo	( NetworkMessage &messageToSend, NetworkAddress const &address );
 	void BroadcastMessage		( NetworkMessage &messageToBroadcast, NetworkConnection const *excludeConnection = nullptr );
+	void SendQueuedPackets		();															// All the queued packets, in batches of UDP_MAX_BATCH_SIZE; ProcessOutgoing() calls it every frame
 
 private:
 	void SendHangupToAllConnections();
@@ -176,6 +201,7 @@ private:
 	bool BindPort( uint16_t port, uint16_t range );
 
 public:
+	void UseTransport( NetworkTransport *transport );									// Before Host() or Join(); the session owns it from now on. nullptr => UDP
 	void Host( char const *myID, uint16_t port, uint16_t portRange = DEFAULT_PORT_RANGE );
 	void Join( char const *myID, NetworkAddress const &hostAddress );
 	void Disconnect();
@@ -221,25 +247,70 @@ public:
 	
 	inline NetworkConnection* const GetMyConnection()	const { return m_myConnection; }
 	inline NetworkConnection* const GetHostConnection()	const { return m_hostConnection; }
+	inline NetworkTransport const*	GetTransport()		const { return m_transport; }
+	inline Clock const*				GetReferenceClock()	const { return m_referenceClock; }
 
 	// Message Definitions
 	void					RegisterCoreMessages();
-	bool					RegisterNetworkMessage( char const *messageName, networkMessage_cb cb, eNetworkMessageOptions netMessageOptionsFlag );					// Returns true on success
-	void					RegisterNetworkMessage( uint8_t index, char const *messageName, networkMessage_cb cb, eNetworkMessageOptions netmessageOptionsFlag );	// Rewrite if a definition already exists at that index
+	bool					RegisterNetworkMessage( char const *messageName, networkMessage_cb cb, eNetworkMessageOptions netMessageOptionsFlag, uint channel = 0U, eNetworkMessagePriority priority = NET_MESSAGE_PRIORITY_NORMAL );	// Returns true on success; in-order messages of a channel wait only on each other
+	void					RegisterNetworkMessage( uint8_t index, char const *messageName, networkMessage_cb cb, eNetworkMessageOptions netmessageOptionsFlag, eNetworkMessagePriority priority = NET_MESSAGE_PRIORITY_NORMAL );	// Rewrite if a definition already exists at that index
 
 	NetworkMessageDefinition const* GetRegisteredMessageDefination( std::string const &definitionName ) const;															// Returns -1 if not found
 	NetworkMessageDefinition const* GetRegisteredMessageDefination( int defIndex ) const;
 
 private:
-	// Net Simulation
+	// Net Simulation; applied on receiving, latency is on the master clock
 	float			m_simulatedLossFraction	 = 0.f;
 	uint			m_simulatedMinLatency_ms = 0U;
 	uint			m_simulatedMaxLatency_ms = 0U;
 	uint8_t			m_simulatedSendFrequency = 20;
 	float			m_heartbeatFrequency	 = 2.f;
+	uint			m_simulationRandomState	 = 1U;							// Seeded from the HPC, unless SetSimulationSeed()
+	uint64_t		m_nextReceivedSequence	 = 0U;
 
 private:
-	StampedNetworkPacketPriorityQueue m_receivedPackets;				// Priority Queue
+	StampedNetworkPacketPriorityQueue		m_receivedPackets;				// Priority Queue
+	std::vector< OutgoingNetworkPacket >	m_outgoingPackets;				// Sent together, by SendQueuedPackets()
+	NetworkPacket*							m_receiveBatchPackets[ NETWORK_RECEIVE_BATCH_SIZE ] = { nullptr };	// Pooled; ReceivePacket() reads in to these
+
+	// Stats
+	uint		m_receiveSyscallsLastFrame	= 0U;
+	uint		m_sendSyscallsLastFrame		= 0U;
+	uint		m_receivedPacketsLastFrame	= 0U;
+	uint		m_sentPacketsLastFrame		= 0U;
+	uint		m_receivedPacketsThisFrame	= 0U;
+	uint		m_sentPacketsThisFrame		= 0U;
+	uint64_t	m_processIncomingHPCLastCall	= 0U;						// Wall clock spent in it; for the benchmarks
+	uint64_t	m_processOutgoingHPCLastCall	= 0U;
+
+public:
+	inline uint	GetReceiveSyscallsLastFrame()	const { return m_receiveSyscallsLastFrame; }
+	inline uint	GetSendSyscallsLastFrame()		const { return m_sendSyscallsLastFrame; }
+	inline uint	GetReceivedPacketsLastFrame()	const { return m_receivedPacketsLastFrame; }
+	inline uint	GetSentPacketsLastFrame()		const { return m_sentPacketsLastFrame; }
+	inline uint64_t	GetProcessIncomingHPCLastCall()	const { return m_processIncomingHPCLastCall; }
+	inline uint64_t	GetProcessOutgoingHPCLastCall()	const { return m_processOutgoingHPCLastCall; }
+
+private:
+	// Pools; packets & queued messages get reused from here, so steady traffic doesn't touch the heap
+	NetworkObjectPool< NetworkPacket >	m_packetPool;					// Every packet owns a PACKET_MTU buffer
+	NetworkObjectPool< NetworkMessage >	m_messagePool;
+
+public:
+	NetworkPacket*	AcquirePacket();									// Empty, with a default header
+	void			ReleasePacket( NetworkPacket *packet );
+	NetworkMessage*	AcquireMessage();									// Empty, without a definition
+	void			ReleaseMessage( NetworkMessage *message );
+
+	inline uint		GetPooledPacketCount()	const { return m_packetPool.GetCapacity(); }
+	inline uint		GetPooledMessageCount()	const { return m_messagePool.GetCapacity(); }
+
+private:
+	// Snapshots
+	NetworkSnapshotReplicator			m_snapshotReplicator;
+
+public:
+	inline NetworkSnapshotReplicator&	GetSnapshotReplicator() { return m_snapshotReplicator; }
 
 public:
 	inline float	GetHeartbeatFrequency()		const { return m_heartbeatFrequency; }
@@ -250,4 +321,11 @@ public:
 	void			SetSimulationLoss( float lossFraction );
 	void			SetSimulationLatency( uint minAddedLatency_ms, uint maxAddedLatency_ms = 0U );
 	void			SetSimulationSendFrequency( uint8_t frequencyHz );
+	void			SetSimulationSeed( uint seed );												// Same seed & same traffic => same packets lost & delayed
 };
+
+
+// Console Commands
+void NetworkSessionBenchmark( Command &cmd );			// net_benchmark [messageCount] [messagesPerPacket] [packetsPerFrame]
+void NetworkReliableStress( Command &cmd );				// net_reliable_stress [messageCount] [lossPercent] [maxLatency_ms]
+void NetworkInOrderStress( Command &cmd );				// net_inorder_stress [messageCount] [lossPercent] [maxLatency_ms]
\ No newline at end of file
@@ -0,0 +1,591 @@
+#pragma once
+#include "NetworkSnapshot.hpp"
+#include <algorithm>
+#include "Engine/Core/Clock.hpp"
+#include "Engine/Math/MathUtil.hpp"
+#include "Engine/Network/BitPacker.hpp"
+#include "Engine/NetworkSession/NetworkSession.hpp"
+
+#define SNAPSHOT_DELTA_CHUNK_SIZE		(32U)		// State bytes per change mask
+#define SNAPSHOT_DELTA_SMALL_GAP_BITS	(4U)
+
+static byte_t const s_zeroChunk[ SNAPSHOT_DELTA_CHUNK_SIZE ] = { 0 };
+
+//------------------------------------------------------------------------------------------
+// Delta stream helpers
+//
+static bool WriteEntityHeader( BitWriter &writer, int &previousID, uint16_t entityID, bool removed )
+{
+	uint gap = (uint)( (int)entityID - previousID - 1 );
+	previousID = (int)entityID;
+
+	writer.WriteBool( true );									// Another entity
+	if( gap < BIT_FLAG( SNAPSHOT_DELTA_SMALL_GAP_BITS ) )
+	{
+		writer.WriteBool( true );
+		writer.WriteBits( gap, SNAPSHOT_DELTA_SMALL_GAP_BITS );
+	}
+	else
+	{
+		writer.WriteBool( false );
+		writer.WriteBits( entityID, 16U );
+	}
+
+	return writer.WriteBool( removed );
+}
+
+// Against base; a chunk at a time: whether anything changed, which bytes did, then those bytes
+static bool WriteStateChanges( BitWriter &writer, byte_t const *base, byte_t const *state, uint stateSize )
+{
+	for( uint offset = 0U; offset < stateSize; offset += SNAPSHOT_DELTA_CHUNK_SIZE )
+	{
+		uint chunkSize = stateSize - offset;
+		chunkSize = ( chunkSize < SNAPSHOT_DELTA_CHUNK_SIZE ) ? chunkSize : SNAPSHOT_DELTA_CHUNK_SIZE;
+
+		byte_t const *baseChunk	= ( base != nullptr ) ? base + offset : s_zeroChunk;
+		byte_t const *chunk		= state + offset;
+
+		uint32_t changeMask = 0U;
+		for( uint i = 0U; i < chunkSize; i++ )
+			changeMask |= (uint32_t)( chunk[i] != baseChunk[i] ) << i;
+
+		writer.WriteBool( changeMask != 0U );
+		if( changeMask == 0U )
+			continue;
+
+		writer.WriteBits( changeMask, chunkSize );
+		for( uint i = 0U; i < chunkSize; i++ )
+		{
+			if( changeMask & BIT_FLAG(i) )
+				writer.WriteBits( chunk[i], 8U );
+		}
+	}
+
+	return ( writer.HasFailed() == false );
+}
+
+// state holds the base already
+static bool ReadStateChanges( BitReader &reader, byte_t *state, uint stateSize )
+{
+	for( uint offset = 0U; offset < stateSize; offset += SNAPSHOT_DELTA_CHUNK_SIZE )
+	{
+		uint chunkSize = stateSize - offset;
+		chunkSize = ( chunkSize < SNAPSHOT_DELTA_CHUNK_SIZE ) ? chunkSize : SNAPSHOT_DELTA_CHUNK_SIZE;
+
+		bool chunkChanged = false;
+		reader.ReadBool( chunkChanged );
+		if( chunkChanged == false )
+			continue;
+
+		uint32_t changeMask = 0U;
+		reader.ReadBits( changeMask, chunkSize );
+		for( uint i = 0U; i < chunkSize; i++ )
+		{
+			if( changeMask & BIT_FLAG(i) )
+			{
+				uint32_t value = 0U;
+				reader.ReadBits( value, 8U );
+				state[ offset + i ] = (byte_t)value;
+			}
+		}
+	}
+
+	return ( reader.HasFailed() == false );
+}
+
+//------------------------------------------------------------------------------------------
+// NetworkSnapshot
+//
+void NetworkSnapshot::Reset( uint stateSize )
+{
+	m_id		= INVALID_SNAPSHOT_ID;
+	m_stateSize	= stateSize;
+
+	m_entityIDs.clear();
+	m_states.clear();
+}
+
+void NetworkSnapshot::CopyFrom( NetworkSnapshot const &source )
+{
+	m_id		= source.m_id;
+	m_stateSize	= source.m_stateSize;
+
+	m_entityIDs	= source.m_entityIDs;		// Reuses the capacity
+	m_states	= source.m_states;
+}
+
+void NetworkSnapshot::Swap( NetworkSnapshot &other )
+{
+	std::swap( m_id,		other.m_id );
+	std::swap( m_stateSize,	other.m_stateSize );
+
+	m_entityIDs.swap( other.m_entityIDs );
+	m_states.swap( other.m_states );
+}
+
+byte_t* NetworkSnapshot::SetEntity( uint16_t entityID )
+{
+	if( m_entityIDs.empty() || m_entityIDs.back() < entityID )
+		return AppendEntity( entityID );
+
+	size_t idx = GetLowerBoundIndex( entityID );
+	if( m_entityIDs[idx] != entityID )
+	{
+		m_entityIDs.insert( m_entityIDs.begin() + idx, entityID );
+		m_states.insert( m_states.begin() + idx * m_stateSize, m_stateSize, (byte_t)0 );
+	}
+
+	return m_states.data() + idx * m_stateSize;
+}
+
+bool NetworkSnapshot::RemoveEntity( uint16_t entityID )
+{
+	size_t idx = GetLowerBoundIndex( entityID );
+	if( idx >= m_entityIDs.size() || m_entityIDs[idx] != entityID )
+		return false;
+
+	m_entityIDs.erase( m_entityIDs.begin() + idx );
+	m_states.erase( m_states.begin() + idx * m_stateSize, m_states.begin() + (idx + 1U) * m_stateSize );
+
+	return true;
+}
+
+byte_t const* NetworkSnapshot::GetEntity( uint16_t entityID ) const
+{
+	size_t idx = GetLowerBoundIndex( entityID );
+	if( idx >= m_entityIDs.size() || m_entityIDs[idx] != entityID )
+		return nullptr;
+
+	return m_states.data() + idx * m_stateSize;
+}
+
+byte_t* NetworkSnapshot::AppendEntity( uint16_t entityID )
+{
+	m_entityIDs.push_back( entityID );
+	m_states.resize( m_states.size() + m_stateSize, (byte_t)0 );
+
+	return m_states.data() + m_states.size() - m_stateSize;
+}
+
+size_t NetworkSnapshot::GetLowerBoundIndex( uint16_t entityID ) const
+{
+	return (size_t)( std::lower_bound( m_entityIDs.begin(), m_entityIDs.end(), entityID ) - m_entityIDs.begin() );
+}
+
+bool NetworkSnapshot::WriteDelta( NetworkSnapshot const *baseline, NetworkSnapshot const &current, BytePacker &out )
+{
+	uint stateSize = current.m_stateSize;
+	if( baseline != nullptr && baseline->m_stateSize != stateSize )
+	{
+		GUARANTEE_RECOVERABLE( false, "NetworkSnapshot: baseline has a different state size; writing the full snapshot!" );
+		baseline = nullptr;
+	}
+
+	if( out.WriteSize( stateSize ) == 0U )
+		return false;
+
+	BitWriter	writer( out );
+	int			previousID = -1;
+
+	// Walk both; they're sorted by ID
+	uint baseCount	= ( baseline != nullptr ) ? baseline->GetEntityCount() : 0U;
+	uint baseIdx	= 0U;
+	for( uint idx = 0U; idx < current.GetEntityCount(); idx++ )
+	{
+		uint16_t entityID = current.m_entityIDs[idx];
+
+		// Removed since the baseline
+		while( baseIdx < baseCount && baseline->m_entityIDs[baseIdx] < entityID )
+		{
+			WriteEntityHeader( writer, previousID, baseline->m_entityIDs[baseIdx], true );
+			baseIdx++;
+		}
+
+		byte_t const *state		= current.GetStateAt( idx );
+		byte_t const *baseState	= nullptr;
+		if( baseIdx < baseCount && baseline->m_entityIDs[baseIdx] == entityID )
+		{
+			baseState = baseline->GetStateAt( baseIdx );
+			baseIdx++;
+
+			if( memcmp( baseState, state, stateSize ) == 0 )
+				continue;
+		}
+
+		WriteEntityHeader( writer, previousID, entityID, false );
+		if( WriteStateChanges( writer, baseState, state, stateSize ) == false )
+			return false;
+	}
+
+	for( ; baseIdx < baseCount; baseIdx++ )
+		WriteEntityHeader( writer, previousID, baseline->m_entityIDs[baseIdx], true );
+
+	writer.WriteBool( false );									// No more entities
+	writer.Flush();
+
+	return ( writer.HasFailed() == false );
+}
+
+bool NetworkSnapshot::ReadDelta( NetworkSnapshot const *baseline, BytePacker const &in, NetworkSnapshot &out )
+{
+	size_t stateSize = 0U;
+	if( in.ReadSize( &stateSize ) == 0U )
+		return false;
+
+	if( stateSize > 0xffffU || ( baseline != nullptr && baseline->m_stateSize != stateSize ) )
+		return false;
+
+	uint16_t id = out.m_id;
+	out.Reset( (uint)stateSize );
+	out.m_id = id;
+	if( baseline != nullptr )
+	{
+		out.m_entityIDs.reserve( baseline->m_entityIDs.size() );
+		out.m_states.reserve( baseline->m_states.size() );
+	}
+
+	BitReader	reader( in );
+	int			previousID	= -1;
+	uint		baseCount	= ( baseline != nullptr ) ? baseline->GetEntityCount() : 0U;
+	uint		baseIdx		= 0U;
+
+	while( true )
+	{
+		bool anotherEntity = false;
+		if( reader.ReadBool( anotherEntity ) == false )
+			return false;
+		if( anotherEntity == false )
+			break;
+
+		// Entity ID
+		bool		isSmallGap	= false;
+		uint32_t	idOrGap		= 0U;
+		reader.ReadBool( isSmallGap );
+		reader.ReadBits( idOrGap, isSmallGap ? SNAPSHOT_DELTA_SMALL_GAP_BITS : 16U );
+
+		int entityID = isSmallGap ? ( previousID + 1 + (int)idOrGap ) : (int)idOrGap;
+		if( entityID <= previousID || entityID > 0xffff )
+			return false;
+		previousID = entityID;
+
+		bool removed = false;
+		if( reader.ReadBool( removed ) == false )
+			return false;
+
+		// Unchanged since the baseline
+		while( baseIdx < baseCount && baseline->m_entityIDs[baseIdx] < entityID )
+		{
+			memcpy( out.AppendEntity( baseline->m_entityIDs[baseIdx] ), baseline->GetStateAt( baseIdx ), stateSize );
+			baseIdx++;
+		}
+
+		byte_t const *baseState = nullptr;
+		if( baseIdx < baseCount && baseline->m_entityIDs[baseIdx] == entityID )
+		{
+			baseState = baseline->GetStateAt( baseIdx );
+			baseIdx++;
+		}
+
+		if( removed )
+		{
+			if( baseState == nullptr )
+				return false;									// Removing what the baseline doesn't have: it's not our baseline
+			continue;
+		}
+
+		byte_t *state = out.AppendEntity( (uint16_t)entityID );
+		if( baseState != nullptr )
+			memcpy( state, baseState, stateSize );
+
+		if( ReadStateChanges( reader, state, (uint)stateSize ) == false )
+			return false;
+	}
+
+	for( ; baseIdx < baseCount; baseIdx++ )
+		memcpy( out.AppendEntity( baseline->m_entityIDs[baseIdx] ), baseline->GetStateAt( baseIdx ), stateSize );
+
+	return ( reader.HasFailed() == false );
+}
+
+//------------------------------------------------------------------------------------------
+// NetworkSnapshotReplicator
+//
+NetworkSnapshotReplicator::NetworkSnapshotReplicator( NetworkSession &parentSession )
+	: m_parentSession( parentSession )
+{
+
+}
+
+void NetworkSnapshotReplicator::Reset()
+{
+	for( uint i = 0U; i < MAX_SNAPSHOT_HISTORY; i++ )
+	{
+		m_sentSnapshots[i].Reset( m_stateSize );
+		m_receivedSnapshots[i].Reset( m_stateSize );
+	}
+
+	m_latestSnapshotID		= INVALID_SNAPSHOT_ID;
+	m_latestReceivedID		= INVALID_SNAPSHOT_ID;
+	m_hasUnsentSnapshot		= false;
+
+	m_lastSentByteCount		= 0U;
+	m_lastSentClientCount	= 0U;
+	m_lastFullClientCount	= 0U;
+}
+
+void NetworkSnapshotReplicator::SetEntityStateSize( uint stateSize )
+{
+	m_stateSize = stateSize;
+	Reset();
+}
+
+NetworkSnapshot& NetworkSnapshotReplicator::BeginSnapshot()
+{
+	// No client took the last one; keep changing it, so the history only holds what got sent
+	if( m_hasUnsentSnapshot )
+		return m_sentSnapshots[ m_latestSnapshotID % MAX_SNAPSHOT_HISTORY ];
+
+	NetworkSnapshot &snapshot = m_sentSnapshots[ m_nextSnapshotID % MAX_SNAPSHOT_HISTORY ];
+
+	if( m_latestSnapshotID != INVALID_SNAPSHOT_ID )
+		snapshot.CopyFrom( m_sentSnapshots[ m_latestSnapshotID % MAX_SNAPSHOT_HISTORY ] );
+	else
+		snapshot.Reset( m_stateSize );
+
+	snapshot.m_id		= m_nextSnapshotID;
+	m_latestSnapshotID	= m_nextSnapshotID;
+	m_hasUnsentSnapshot	= true;
+
+	// Skip the invalid ID, when wrapping around
+	m_nextSnapshotID++;
+	if( m_nextSnapshotID == INVALID_SNAPSHOT_ID )
+		m_nextSnapshotID = 0U;
+
+	return snapshot;
+}
+
+void NetworkSnapshotReplicator::SendSnapshot()
+{
+	if( m_hasUnsentSnapshot == false )
+		return;
+
+	m_lastSentByteCount		= 0U;
+	m_lastSentClientCount	= 0U;
+	m_lastFullClientCount	= 0U;
+
+	NetworkSnapshot const &snapshot = m_sentSnapshots[ m_latestSnapshotID % MAX_SNAPSHOT_HISTORY ];
+	NetworkMessage snapshotMsg( "snapshot", NETWORK_MESSAGE_MAX_UNFRAGMENTED_BYTE_COUNT );		// Unreliable, has to fit in a packet
+	BytePacker		&snapshotPacker = snapshotMsg;			// NetworkMessage::Write( int ) hides the typed writes
+
+	for( int i = 0; i < MAX_SESSION_CONNECTIONS; i++ )
+	{
+		NetworkConnection *connection = m_parentSession.m_boundConnections[i];
+		if( connection == nullptr || connection->IsMe() || connection->IsReady() == false )
+			continue;
+
+		// Still hasn't flushed the last one; it gets this one next time
+		if( connection->HasSnapshotQueued() )
+			continue;
+
+		NetworkSnapshot const *baseline = GetBaselineFor( *connection );
+
+		snapshotMsg.ResetWrite();
+		snapshotMsg.m_snapshotID = snapshot.m_id;
+		snapshotPacker.Write( snapshot.m_id );
+		snapshotPacker.Write( ( baseline != nullptr ) ? baseline->m_id : (uint16_t)INVALID_SNAPSHOT_ID );
+
+		if( NetworkSnapshot::WriteDelta( baseline, snapshot, snapshotMsg ) == false )
+		{
+			ConsolePrintf( RGBA_RED_COLOR, "Snapshot %d for \"%s\" doesn't fit in a message!", snapshot.m_id, connection->GetNetworkID().c_str() );
+			continue;
+		}
+
+		connection->Send( snapshotMsg );
+		m_hasUnsentSnapshot = false;
+
+		m_lastSentByteCount += (uint)snapshotMsg.GetWrittenByteCount();
+		m_lastSentClientCount++;
+		if( baseline == nullptr )
+			m_lastFullClientCount++;
+	}
+}
+
+NetworkSnapshot const* NetworkSnapshotReplicator::GetLatestReceivedSnapshot() const
+{
+	if( m_latestReceivedID == INVALID_SNAPSHOT_ID )
+		return nullptr;
+
+	return &m_receivedSnapshots[ m_latestReceivedID % MAX_SNAPSHOT_HISTORY ];
+}
+
+bool NetworkSnapshotReplicator::ProcessSnapshotMessage( NetworkMessage const &msg )
+{
+	BytePacker const	&packer		= msg;
+	uint16_t			 snapshotID	= INVALID_SNAPSHOT_ID;
+	uint16_t			 baselineID	= INVALID_SNAPSHOT_ID;
+	if( packer.Read( snapshotID ) == false || packer.Read( baselineID ) == false || snapshotID == INVALID_SNAPSHOT_ID )
+		return false;
+
+	if( snapshotID == m_latestReceivedID )
+		return true;
+
+	// An older one which arrived late still gets decoded; its packet is acked, so the host might use it as a baseline
+	bool isLatest = ( m_latestReceivedID == INVALID_SNAPSHOT_ID ) || CycleGreater( snapshotID, m_latestReceivedID );
+	if( isLatest == false )
+	{
+		uint16_t age = m_latestReceivedID - snapshotID;
+		if( age >= MAX_SNAPSHOT_HISTORY )
+			return true;										// Its slot has a newer one
+	}
+
+	NetworkSnapshot const *baseline = nullptr;
+	if( baselineID != INVALID_SNAPSHOT_ID )
+	{
+		baseline = &m_receivedSnapshots[ baselineID % MAX_SNAPSHOT_HISTORY ];
+		if( baseline->m_id != baselineID )
+		{
+			ConsolePrintf( RGBA_RED_COLOR, "Dropping snapshot %d, don't have its baseline %d!", snapshotID, baselineID );
+			return true;
+		}
+	}
+
+	m_decodedSnapshot.m_id = snapshotID;
+	if( NetworkSnapshot::ReadDelta( baseline, msg, m_decodedSnapshot ) == false )
+		return false;
+
+	m_receivedSnapshots[ snapshotID % MAX_SNAPSHOT_HISTORY ].Swap( m_decodedSnapshot );
+	if( isLatest )
+		m_latestReceivedID = snapshotID;
+
+	return true;
+}
+
+NetworkSnapshot const* NetworkSnapshotReplicator::GetBaselineFor( NetworkConnection const &connection ) const
+{
+	uint16_t ackedID = connection.GetHighestAckedSnapshotID();
+	if( ackedID == INVALID_SNAPSHOT_ID )
+		return nullptr;
+
+	NetworkSnapshot const &baseline = m_sentSnapshots[ ackedID % MAX_SNAPSHOT_HISTORY ];
+	return ( baseline.m_id == ackedID ) ? &baseline : nullptr;
+}
+
+//------------------------------------------------------------------------------------------
+// Console Commands
+//
+static bool AreSnapshotsEqual( NetworkSnapshot const &a, NetworkSnapshot const &b )
+{
+	if( a.GetStateSize() != b.GetStateSize() || a.GetEntityCount() != b.GetEntityCount() )
+		return false;
+
+	for( uint i = 0U; i < a.GetEntityCount(); i++ )
+	{
+		if( a.GetEntityIDAt(i) != b.GetEntityIDAt(i) || memcmp( a.GetStateAt(i), b.GetStateAt(i), a.GetStateSize() ) != 0 )
+			return false;
+	}
+
+	return true;
+}
+
+void NetworkSnapshotBenchmark( Command &cmd )
+{
+	std::string countStr	= cmd.GetNextString();
+	std::string percentStr	= cmd.GetNextString();
+	std::string sizeStr		= cmd.GetNextString();
+	uint entityCount		= ( countStr	!= "" ) ? (uint) atoi( countStr.c_str() )	: 1000U;
+	uint changedPercent		= ( percentStr	!= "" ) ? (uint) atoi( percentStr.c_str() )	: 10U;
+	uint stateSize			= ( sizeStr		!= "" ) ? (uint) atoi( sizeStr.c_str() )	: 32U;
+	if( entityCount == 0U || entityCount > 0xc000U || stateSize == 0U || changedPercent > 100U )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "net_snapshot_benchmark: entityCount has to be in [1, %u], changedPercent in [0, 100] & stateSize more than ZERO!", 0xc000U );
+		return;
+	}
+
+	uint randomState = 1U;
+
+	// Baseline: every eighth ID unused, so the IDs have gaps
+	NetworkSnapshot baseline;
+	baseline.Reset( stateSize );
+	baseline.m_id = 0U;
+	for( uint i = 0U; i < entityCount; i++ )
+	{
+		byte_t *state = baseline.SetEntity( (uint16_t)( i + i / 7U ) );
+		for( uint b = 0U; b < stateSize; b++ )
+			state[b] = (byte_t) GetSeededRandomUInt( randomState );
+	}
+
+	// Current: changedPercent of them moved ( first 12 bytes, like a position ), one removed & one added
+	NetworkSnapshot current;
+	current.CopyFrom( baseline );
+	current.m_id = 1U;
+	for( uint i = 0U; i < entityCount; i++ )
+	{
+		if( GetSeededRandomUInt( randomState ) % 100U >= changedPercent )
+			continue;
+
+		byte_t *state = current.SetEntity( baseline.GetEntityIDAt(i) );
+		uint	 changedBytes = ( stateSize < 12U ) ? stateSize : 12U;
+		for( uint b = 0U; b < changedBytes; b++ )
+			state[b] = (byte_t) GetSeededRandomUInt( randomState );
+	}
+	current.RemoveEntity( baseline.GetEntityIDAt( entityCount / 2U ) );
+	memset( current.SetEntity( 0xfffe ), 0x7f, stateSize );
+
+	BytePacker		fullPacker	( LITTLE_ENDIAN );
+	BytePacker		deltaPacker	( LITTLE_ENDIAN );
+	NetworkSnapshot	decoded;
+
+	uint const	iterations	= 100U;
+	bool		isValid		= true;
+
+	// Once untimed, so growing the buffers isn't part of it
+	NetworkSnapshot::WriteDelta( nullptr, current, fullPacker );
+	NetworkSnapshot::WriteDelta( &baseline, current, deltaPacker );
+	NetworkSnapshot::ReadDelta( nullptr, fullPacker, decoded );
+	NetworkSnapshot::ReadDelta( &baseline, deltaPacker, decoded );
+
+	uint64_t startHPC = Clock::GetCurrentHPC();
+	for( uint i = 0U; i < iterations; i++ )
+	{
+		fullPacker.ResetWrite();
+		isValid = NetworkSnapshot::WriteDelta( nullptr, current, fullPacker ) && isValid;
+	}
+	double fullWriteSeconds = Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+
+	startHPC = Clock::GetCurrentHPC();
+	for( uint i = 0U; i < iterations; i++ )
+	{
+		fullPacker.ResetRead();
+		isValid = NetworkSnapshot::ReadDelta( nullptr, fullPacker, decoded ) && isValid;
+	}
+	double fullReadSeconds = Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+	isValid = AreSnapshotsEqual( decoded, current ) && isValid;
+
+	startHPC = Clock::GetCurrentHPC();
+	for( uint i = 0U; i < iterations; i++ )
+	{
+		deltaPacker.ResetWrite();
+		isValid = NetworkSnapshot::WriteDelta( &baseline, current, deltaPacker ) && isValid;
+	}
+	double deltaWriteSeconds = Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+
+	startHPC = Clock::GetCurrentHPC();
+	for( uint i = 0U; i < iterations; i++ )
+	{
+		deltaPacker.ResetRead();
+		isValid = NetworkSnapshot::ReadDelta( &baseline, deltaPacker, decoded ) && isValid;
+	}
+	double deltaReadSeconds = Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+	isValid = AreSnapshotsEqual( decoded, current ) && isValid;
+
+	double usPerIteration	= 1000000.0 / (double)iterations;
+	size_t rawByteCount		= (size_t)current.GetEntityCount() * ( sizeof(uint16_t) + stateSize );
+	size_t fullByteCount	= fullPacker.GetWrittenByteCount();
+	size_t deltaByteCount	= deltaPacker.GetWrittenByteCount();
+
+	ConsolePrintf( "net_snapshot_benchmark: %u entities of %u bytes, %u%% changed; raw %u bytes", current.GetEntityCount(), stateSize, changedPercent, (uint)rawByteCount );
+	ConsolePrintf( "  full   %7u bytes, write %8.2f us, read %8.2f us", (uint)fullByteCount,  fullWriteSeconds  * usPerIteration, fullReadSeconds  * usPerIteration );
+	ConsolePrintf( "  delta  %7u bytes, write %8.2f us, read %8.2f us; %.1f%% of full", (uint)deltaByteCount, deltaWriteSeconds * usPerIteration, deltaReadSeconds * usPerIteration,
+				   100.0 * (double)deltaByteCount / (double)fullByteCount );
+	ConsolePrintf( isValid ? RGBA_GREEN_COLOR : RGBA_RED_COLOR, "  decoded snapshots %s", isValid ? "match" : "DON'T MATCH!" );
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <vector>
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Input/Command.hpp"
+#include "Engine/Network/BytePacker.hpp"
+
+//------------------------------------------------------------------------------------------
+// Snapshot replication
+//	- A snapshot is the whole replicated world at one moment: entityID => stateSize bytes, packed however the game likes
+//	- The host sends each ready client the latest snapshot as a delta against the last one that client acked,
+//	  or all of it, if none of its acked snapshots are in the history anymore
+//	- Acks come from the packet acks: the PacketTracker of the packet which carried a snapshot remembers its ID,
+//	  and NetworkConnection keeps the highest one that got confirmed
+//	- Snapshots go unreliable; a lost one only means the next delta is against an older baseline
+//	- A delta has to fit in one NetworkMessage
+//
+// Delta stream ( BitWriter ), for each entity which got added, changed or removed, in entityID order:
+//	1 bit another-entity | 1 bit small-gap, then 4 bit gap from the previous entityID or the 16 bit entityID | 1 bit removed
+//	and unless removed, for every 32 bytes of state: 1 bit any-changed, then a bit per byte & 8 bits per changed byte
+//	New entities are compared against an all zero state
+//
+
+class NetworkSession;
+class NetworkConnection;
+class NetworkMessage;
+
+// The world at one moment; entities are sorted by ID
+class NetworkSnapshot
+{
+public:
+	 NetworkSnapshot() { }
+	~NetworkSnapshot() { }
+
+public:
+	uint16_t				m_id		= INVALID_SNAPSHOT_ID;
+
+private:
+	uint					m_stateSize	= 0U;
+	std::vector< uint16_t >	m_entityIDs;
+	std::vector< byte_t >	m_states;							// m_stateSize bytes per entity, in the order of m_entityIDs
+
+public:
+	void			Reset( uint stateSize );					// Empty; keeps the memory
+	void			CopyFrom( NetworkSnapshot const &source );	// Reuses my memory
+	void			Swap( NetworkSnapshot &other );
+
+	byte_t*			SetEntity	( uint16_t entityID );			// Adds it zeroed if it's new; returns its state to fill, valid until the next Set or Remove. Cheapest in increasing ID order
+	bool			RemoveEntity( uint16_t entityID );			// Returns false if it wasn't there
+	byte_t const*	GetEntity	( uint16_t entityID ) const;	// nullptr if it isn't in this snapshot
+
+	inline uint				GetStateSize()				const { return m_stateSize; }
+	inline uint				GetEntityCount()			const { return (uint) m_entityIDs.size(); }
+	inline uint16_t			GetEntityIDAt( uint idx )	const { return m_entityIDs[ idx ]; }
+	inline byte_t const*	GetStateAt( uint idx )		const { return m_states.data() + (size_t)idx * m_stateSize; }
+
+public:
+	static bool		WriteDelta	( NetworkSnapshot const *baseline, NetworkSnapshot const &current, BytePacker &out );	// nullptr baseline => every entity; returns false if out gets full
+	static bool		ReadDelta	( NetworkSnapshot const *baseline, BytePacker const &in, NetworkSnapshot &out );		// Returns false if the stream is short, broken or doesn't match the baseline
+
+private:
+	byte_t*			AppendEntity( uint16_t entityID );			// entityID has to be greater than all I have
+	size_t			GetLowerBoundIndex( uint16_t entityID ) const;
+};
+
+// Sends & receives the snapshots of a NetworkSession
+class NetworkSnapshotReplicator
+{
+public:
+	 NetworkSnapshotReplicator( NetworkSession &parentSession );
+	~NetworkSnapshotReplicator() { }
+
+private:
+	NetworkSession		&m_parentSession;
+
+	// Host
+	uint				 m_stateSize			= 0U;
+	NetworkSnapshot		 m_sentSnapshots[ MAX_SNAPSHOT_HISTORY ];			// Slot is ID % MAX_SNAPSHOT_HISTORY; these are the baselines
+	uint16_t			 m_nextSnapshotID		= 0U;
+	uint16_t			 m_latestSnapshotID		= INVALID_SNAPSHOT_ID;
+	bool				 m_hasUnsentSnapshot	= false;
+
+	// Client
+	NetworkSnapshot		 m_receivedSnapshots[ MAX_SNAPSHOT_HISTORY ];
+	NetworkSnapshot		 m_decodedSnapshot;									// Decoded in to, then swapped in to its slot
+	uint16_t			 m_latestReceivedID		= INVALID_SNAPSHOT_ID;
+
+	// Stats of the last SendSnapshot()
+	uint				 m_lastSentByteCount	= 0U;						// Summed over the clients
+	uint				 m_lastSentClientCount	= 0U;
+	uint				 m_lastFullClientCount	= 0U;						// Clients which got every entity, not a delta
+
+public:
+	void					Reset();										// Forgets the sent & received snapshots; the session does it when it disconnects or joins
+
+	// Host
+	void					SetEntityStateSize( uint stateSize );			// Before the first snapshot; clears the history
+	NetworkSnapshot&		BeginSnapshot();								// A copy of the last one; change what changed, then SendSnapshot(). The same one again, if no client took it
+	void					SendSnapshot();									// To every ready client, except those which still have one queued; call it every frame
+
+	// Client
+	NetworkSnapshot const*	GetLatestReceivedSnapshot() const;				// nullptr until the first one arrives
+	bool					ProcessSnapshotMessage( NetworkMessage const &msg );
+
+	inline uint				GetLastSentByteCount()		const { return m_lastSentByteCount; }
+	inline uint				GetLastSentClientCount()	const { return m_lastSentClientCount; }
+	inline uint				GetLastFullClientCount()	const { return m_lastFullClientCount; }
+	inline uint16_t			GetLatestSnapshotID()		const { return m_latestSnapshotID; }
+	inline uint16_t			GetLatestReceivedID()		const { return m_latestReceivedID; }
+
+private:
+	NetworkSnapshot const*	GetBaselineFor( NetworkConnection const &connection ) const;		// nullptr if it has no acked snapshot in the history
+};
+
+
+// Console Commands
+void NetworkSnapshotBenchmark( Command &cmd );			// net_snapshot_benchmark [entityCount] [changedPercent] [stateSize]
@@ -0,0 +1,466 @@
+#pragma once
+#include "NetworkSoakBenchmark.hpp"
+#include <algorithm>
+#include <vector>
+#include "Engine/Core/Clock.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/NetworkSession/NetworkSession.hpp"
+
+// What the callbacks fill in, for the run in progress
+// Streams: ( (clientIdx * 2 + direction) * streamsPerDirection ) + 0 for the reliables, + 1 + channel for the in-orders
+struct NetworkSoakRun
+{
+public:
+	uint									streamsPerDirection	= 0U;
+	uint									received[ NUM_NET_SOAK_TRAFFICS ] = { 0U };
+	uint									duplicateCount		= 0U;
+	uint									outOfOrderCount		= 0U;
+	std::vector< float >					latencies_ms[ NUM_NET_SOAK_TRAFFICS ];
+	std::vector< std::vector< byte_t > >	receivedReliables;							// Per stream, a flag per sequence
+	std::vector< int >						nextInOrderSequences;						// Per stream
+	uint									blobByteCount		= 0U;
+	uint									receivedBlobCount	= 0U;
+	uint									corruptBlobCount	= 0U;
+	std::vector< float >					blobLatencies_ms;
+	Clock									clock;										// Private to the run, so the master clock isn't touched
+};
+
+static NetworkSoakRun *s_soakRun = nullptr;
+
+static bool ReadSoakMessage( NetworkMessage const &msg, eNetworkSoakTraffic traffic, int &outStream, int &outSequence )
+{
+	float sentTime = 0.f;
+	if( s_soakRun == nullptr || msg.Read( outStream ) == false || msg.Read( outSequence ) == false || msg.Read( sentTime ) == false )
+		return false;
+
+	if( traffic != NET_SOAK_UNRELIABLE && ( outStream < 0 || outStream >= (int)s_soakRun->nextInOrderSequences.size() || outSequence < 0 ) )
+		return false;
+
+	float latency_ms = ( (float)s_soakRun->clock.total.seconds - sentTime ) * 1000.f;
+	s_soakRun->latencies_ms[ traffic ].push_back( latency_ms );
+	s_soakRun->received[ traffic ]++;
+
+	return true;
+}
+
+bool OnSoakUnreliable( NetworkMessage const &msg, NetworkSender &from )
+{
+	int stream		= -1;
+	int sequence	= -1;
+
+	UNUSED( from );
+	return ReadSoakMessage( msg, NET_SOAK_UNRELIABLE, stream, sequence );
+}
+
+bool OnSoakReliable( NetworkMessage const &msg, NetworkSender &from )
+{
+	int stream		= -1;
+	int sequence	= -1;
+	if( ReadSoakMessage( msg, NET_SOAK_RELIABLE, stream, sequence ) == false )
+		return false;
+
+	std::vector< byte_t > &receivedFlags = s_soakRun->receivedReliables[ stream ];
+	if( (size_t)sequence >= receivedFlags.size() )
+		receivedFlags.resize( (size_t)sequence + 1U, 0U );
+
+	if( receivedFlags[ sequence ] > 0U )
+		s_soakRun->duplicateCount++;
+	receivedFlags[ sequence ] = 1U;
+
+	UNUSED( from );
+	return true;
+}
+
+bool OnSoakInOrder( NetworkMessage const &msg, NetworkSender &from )
+{
+	int stream		= -1;
+	int sequence	= -1;
+	if( ReadSoakMessage( msg, NET_SOAK_IN_ORDER, stream, sequence ) == false )
+		return false;
+
+	int &nextSequence = s_soakRun->nextInOrderSequences[ stream ];
+	if( sequence != nextSequence )
+		s_soakRun->outOfOrderCount++;
+	nextSequence = sequence + 1;
+
+	UNUSED( from );
+	return true;
+}
+
+// Long runs of a letter & some noise, so it compresses about as well as level data would
+static inline byte_t GetSoakBlobByte( uint idx )
+{
+	return ( idx % 97U < 80U ) ? (byte_t)( 'a' + ( idx / 97U ) % 26U ) : (byte_t)( idx * 31U );
+}
+
+bool OnSoakBlob( NetworkMessage const &msg, NetworkSender &from )
+{
+	float sentTime = 0.f;
+	if( s_soakRun == nullptr || msg.Read( sentTime ) == false )
+		return false;
+
+	bool isIntact = ( msg.GetReadableByteCount() == s_soakRun->blobByteCount );
+	byte_t const *blobBytes = (byte_t const *)msg.GetBuffer() + sizeof( float );
+	for( uint i = 0U; i < s_soakRun->blobByteCount && isIntact; i++ )
+		isIntact = ( blobBytes[i] == GetSoakBlobByte( i ) );
+
+	s_soakRun->receivedBlobCount++;
+	s_soakRun->corruptBlobCount += isIntact ? 0U : 1U;
+	s_soakRun->blobLatencies_ms.push_back( ( (float)s_soakRun->clock.total.seconds - sentTime ) * 1000.f );
+
+	UNUSED( from );
+	return isIntact;
+}
+
+static NetworkSoakPercentiles GetSoakPercentiles( std::vector< float > &samples )
+{
+	NetworkSoakPercentiles percentiles;
+	if( samples.empty() )
+		return percentiles;
+
+	std::sort( samples.begin(), samples.end() );
+
+	size_t lastIdx = samples.size() - 1U;
+	percentiles.p50 = samples[ lastIdx * 50U / 100U ];
+	percentiles.p90 = samples[ lastIdx * 90U / 100U ];
+	percentiles.p99 = samples[ lastIdx * 99U / 100U ];
+	percentiles.max = samples[ lastIdx ];
+
+	return percentiles;
+}
+
+static void RegisterSoakMessages( NetworkSession &session, uint channelCount )
+{
+	// Same order in every session, so the indices match
+	session.RegisterNetworkMessage( "soak_unreliable", OnSoakUnreliable, NET_MESSAGE_OPTION_REQUIRES_CONNECTION, 0U, NET_MESSAGE_PRIORITY_LOW );
+	session.RegisterNetworkMessage( "soak_reliable", OnSoakReliable, NET_MESSAGE_OPTION_RELIABLE );
+
+	for( uint channel = 0U; channel < channelCount; channel++ )
+		session.RegisterNetworkMessage( Stringf( "soak_in_order_%u", channel ).c_str(), OnSoakInOrder, NET_MESSAGE_OPTION_RELIABLE_IN_ORDER, channel, NET_MESSAGE_PRIORITY_HIGH );
+
+	uint blobChannel = ( channelCount < MAX_NETWORK_MESSAGE_CHANNELS ) ? channelCount : 0U;
+	session.RegisterNetworkMessage( "soak_blob", OnSoakBlob, (eNetworkMessageOptions)( NET_MESSAGE_OPTION_RELIABLE_IN_ORDER | NET_MESSAGE_OPTION_COMPRESS ), blobChannel, NET_MESSAGE_PRIORITY_NORMAL );
+}
+
+static void SampleSoakRTT( NetworkConnection const *connection, uint &inOutLastSampleCount, std::vector< float > &rtt_ms )
+{
+	if( connection == nullptr || connection->m_rttSampleCount == inOutLastSampleCount )
+		return;
+
+	inOutLastSampleCount = connection->m_rttSampleCount;
+	rtt_ms.push_back( connection->m_lastRTT * 1000.f );
+}
+
+bool RunNetworkSoak( NetworkSoakSettings const &settings, NetworkSoakResults &outResults )
+{
+	outResults = NetworkSoakResults();
+
+	uint const clientCount		= settings.clientCount;
+	uint const channelCount		= ( settings.inOrderChannelCount < MAX_NETWORK_MESSAGE_CHANNELS ) ? settings.inOrderChannelCount : MAX_NETWORK_MESSAGE_CHANNELS;
+	uint const paddingByteCount	= ( settings.payloadByteCount > 12U ) ? settings.payloadByteCount - 12U : 0U;
+	if( clientCount == 0U || clientCount >= MAX_SESSION_CONNECTIONS || settings.frameSeconds <= 0.0 )
+		return false;
+
+	NetworkSoakRun run;
+	run.streamsPerDirection = 1U + channelCount;
+	uint const streamCount	= clientCount * 2U * run.streamsPerDirection;
+	run.receivedReliables.resize( streamCount );
+	run.nextInOrderSequences.assign( streamCount, 0 );
+	run.blobByteCount		= settings.blobByteCount;
+	s_soakRun = &run;
+
+	LoopbackNetwork network( settings.seed, &run.clock );
+	network.SetConditions( settings.conditions );
+
+	// Host & clients
+	NetworkSession host( nullptr, &run.clock );
+	RegisterSoakMessages( host, channelCount );
+	host.UseTransport( new LoopbackNetworkTransport( network ) );
+	host.Host( "soak_host", GAME_PORT, 0U );
+	if( host.IsRunning() == false )
+	{
+		s_soakRun = nullptr;
+		return false;
+	}
+
+	std::vector< NetworkSession* > clients;
+	for( uint i = 0U; i < clientCount; i++ )
+	{
+		NetworkSession *client = new NetworkSession( nullptr, &run.clock );
+		RegisterSoakMessages( *client, channelCount );
+		client->SetSimulationSeed( settings.seed + i + 1U );
+		client->UseTransport( new LoopbackNetworkTransport( network ) );
+		client->Join( Stringf( "soak%u", i ).c_str(), host.GetTransport()->GetAddress() );
+		clients.push_back( client );
+	}
+
+	// Everyone joins first
+	uint64_t	startHPC		= Clock::GetCurrentHPC();
+	uint const	maxJoinFrames	= (uint)( 30.0 / settings.frameSeconds );
+	uint		joinedCount		= 0U;
+	for( uint frame = 0U; frame < maxJoinFrames && joinedCount < clientCount; frame++ )
+	{
+		run.clock.AdvanceClock( Clock::GetHPCFromSeconds( settings.frameSeconds ) );
+
+		host.Update();
+		joinedCount = 0U;
+		for( uint i = 0U; i < clientCount; i++ )
+		{
+			clients[i]->Update();
+			joinedCount += ( clients[i]->m_state == NET_SESSION_READY ) ? 1U : 0U;
+		}
+	}
+	outResults.joinedClientCount = joinedCount;
+
+	for( uint i = 0U; i < clientCount && settings.byteBudgetPerSecond > 0U; i++ )
+	{
+		NetworkConnection *toHost	= clients[i]->GetHostConnection();
+		NetworkConnection *toClient	= host.GetConnection( clients[i]->GetMyConnectionIndex() );
+		if( toHost != nullptr )
+			toHost->SetByteBudgetRate( settings.byteBudgetPerSecond );
+		if( toClient != nullptr )
+			toClient->SetByteBudgetRate( settings.byteBudgetPerSecond );
+	}
+
+	// The blobs
+	if( settings.blobByteCount > 0U && joinedCount == clientCount )
+	{
+		NetworkMessage blobMessage( "soak_blob" );
+		blobMessage.Write( (float)run.clock.total.seconds );
+		for( uint b = 0U; b < settings.blobByteCount; b++ )
+		{
+			byte_t blobByte = GetSoakBlobByte( b );
+			blobMessage.WriteBytes( 1U, &blobByte, false );
+		}
+
+		for( uint i = 0U; i < clientCount; i++ )
+		{
+			NetworkConnection *toClient = host.GetConnection( clients[i]->GetMyConnectionIndex() );
+			if( toClient == nullptr )
+				continue;
+
+			toClient->Send( blobMessage );
+			outResults.sentBlobCount++;
+		}
+	}
+
+	// The traffic
+	NetworkMessage	unreliableMessage( "soak_unreliable" );
+	NetworkMessage	reliableMessage( "soak_reliable" );
+	NetworkMessage	*inOrderMessages[ MAX_NETWORK_MESSAGE_CHANNELS ] = { nullptr };
+	for( uint channel = 0U; channel < channelCount; channel++ )
+		inOrderMessages[ channel ] = new NetworkMessage( Stringf( "soak_in_order_%u", channel ).c_str() );
+
+	std::vector< byte_t >	padding( paddingByteCount + 1U, 0U );
+	std::vector< int >		nextSentSequences( streamCount, 0 );
+	auto sendSoakMessage = [&]( NetworkConnection *connection, NetworkMessage &msg, eNetworkSoakTraffic traffic, int stream )
+	{
+		int sequence = ( stream >= 0 ) ? nextSentSequences[ stream ]++ : 0;
+
+		msg.ResetWrite();
+		msg.Write( stream );
+		msg.Write( sequence );
+		msg.Write( (float)run.clock.total.seconds );
+		msg.WriteBytes( paddingByteCount, padding.data() );
+
+		connection->Send( msg );
+		outResults.sentMessages[ traffic ]++;
+	};
+	auto sendSoakMix = [&]( NetworkConnection *connection, uint clientIdx, uint direction )
+	{
+		if( connection == nullptr )
+			return;
+
+		int streamBase = (int)( ( clientIdx * 2U + direction ) * run.streamsPerDirection );
+		for( uint m = 0U; m < settings.unreliablesPerFrame; m++ )
+			sendSoakMessage( connection, unreliableMessage, NET_SOAK_UNRELIABLE, -1 );
+		for( uint m = 0U; m < settings.reliablesPerFrame; m++ )
+			sendSoakMessage( connection, reliableMessage, NET_SOAK_RELIABLE, streamBase );
+		for( uint channel = 0U; channel < channelCount; channel++ )
+		{
+			for( uint m = 0U; m < settings.inOrdersPerFrame; m++ )
+				sendSoakMessage( connection, *inOrderMessages[ channel ], NET_SOAK_IN_ORDER, streamBase + 1 + (int)channel );
+		}
+	};
+
+	uint const				sendFrameCount		= ( joinedCount == clientCount ) ? (uint)( settings.durationSeconds / settings.frameSeconds + 0.5 ) : 0U;
+	uint const				drainFrameCount		= (uint)( settings.drainSeconds / settings.frameSeconds + 0.5 );
+	std::vector< float >	hostIncoming_us;
+	std::vector< float >	hostOutgoing_us;
+	std::vector< float >	rtt_ms;
+	std::vector< uint >		lastRTTSampleCounts( clientCount * 2U, 0U );
+	double					clientIncomingTotal_us	= 0.0;
+	double					clientOutgoingTotal_us	= 0.0;
+	hostIncoming_us.reserve( sendFrameCount );
+	hostOutgoing_us.reserve( sendFrameCount );
+
+	uint frameCount = 0U;
+	while( sendFrameCount > 0U )
+	{
+		// After the sending frames, until every reliable is in
+		bool isSending = frameCount < sendFrameCount;
+		if( isSending == false )
+		{
+			bool allReliablesIn = ( run.received[ NET_SOAK_RELIABLE ] == outResults.sentMessages[ NET_SOAK_RELIABLE ] ) && ( run.received[ NET_SOAK_IN_ORDER ] == outResults.sentMessages[ NET_SOAK_IN_ORDER ] )
+								&& ( run.receivedBlobCount == outResults.sentBlobCount );
+			if( allReliablesIn || frameCount >= sendFrameCount + drainFrameCount )
+				break;
+		}
+
+		run.clock.AdvanceClock( Clock::GetHPCFromSeconds( settings.frameSeconds ) );
+		frameCount++;
+
+		if( isSending )
+		{
+			for( uint i = 0U; i < clientCount; i++ )
+			{
+				sendSoakMix( clients[i]->GetHostConnection(), i, 0U );
+				sendSoakMix( host.GetConnection( clients[i]->GetMyConnectionIndex() ), i, 1U );
+			}
+		}
+
+		host.Update();
+		hostIncoming_us.push_back( (float)( Clock::GetSecondsFromHPC( host.GetProcessIncomingHPCLastCall() ) * 1000000.0 ) );
+		hostOutgoing_us.push_back( (float)( Clock::GetSecondsFromHPC( host.GetProcessOutgoingHPCLastCall() ) * 1000000.0 ) );
+
+		for( uint i = 0U; i < clientCount; i++ )
+		{
+			clients[i]->Update();
+			clientIncomingTotal_us += Clock::GetSecondsFromHPC( clients[i]->GetProcessIncomingHPCLastCall() ) * 1000000.0;
+			clientOutgoingTotal_us += Clock::GetSecondsFromHPC( clients[i]->GetProcessOutgoingHPCLastCall() ) * 1000000.0;
+
+			SampleSoakRTT( clients[i]->GetHostConnection(), lastRTTSampleCounts[ i * 2U ], rtt_ms );
+			SampleSoakRTT( host.GetConnection( clients[i]->GetMyConnectionIndex() ), lastRTTSampleCounts[ i * 2U + 1U ], rtt_ms );
+		}
+	}
+	outResults.wallSeconds		= Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+	outResults.frameCount		= frameCount;
+	outResults.simulatedSeconds	= (double)frameCount * settings.frameSeconds;
+
+	// Results
+	for( uint traffic = 0U; traffic < NUM_NET_SOAK_TRAFFICS; traffic++ )
+	{
+		outResults.receivedMessages[ traffic ]		= run.received[ traffic ];
+		outResults.deliveryLatency_ms[ traffic ]	= GetSoakPercentiles( run.latencies_ms[ traffic ] );
+	}
+	outResults.duplicateCount	= run.duplicateCount;
+	outResults.outOfOrderCount	= run.outOfOrderCount;
+
+	outResults.receivedBlobCount		= run.receivedBlobCount;
+	outResults.corruptBlobCount			= run.corruptBlobCount;
+	outResults.blobDeliveryLatency_ms	= GetSoakPercentiles( run.blobLatencies_ms );
+
+	for( uint i = 0U; i < clientCount; i++ )
+	{
+		NetworkConnection const *toHost		= clients[i]->GetHostConnection();
+		NetworkConnection const *toClient	= host.GetConnection( clients[i]->GetMyConnectionIndex() );
+		outResults.resentReliableCount		+= ( toHost	  != nullptr ) ? toHost->m_resentReliablesCount		: 0U;
+		outResults.resentReliableCount		+= ( toClient != nullptr ) ? toClient->m_resentReliablesCount	: 0U;
+		outResults.deferredMessageCount		+= ( toHost	  != nullptr ) ? toHost->m_deferredMessagesCount	: 0U;
+		outResults.deferredMessageCount		+= ( toClient != nullptr ) ? toClient->m_deferredMessagesCount	: 0U;
+		outResults.droppedUnreliableCount	+= ( toHost	  != nullptr ) ? toHost->m_droppedUnreliablesCount	: 0U;
+		outResults.droppedUnreliableCount	+= ( toClient != nullptr ) ? toClient->m_droppedUnreliablesCount	: 0U;
+		outResults.blobMessageByteCount		+= ( toClient != nullptr ) ? toClient->m_sentBlobMessageBytes	: 0U;
+		outResults.blobByteCount			+= ( toClient != nullptr ) ? toClient->m_sentBlobBytes			: 0U;
+	}
+
+	outResults.sentPacketCount		= network.GetSentCount();
+	outResults.lostPacketCount		= network.GetLostCount();
+	outResults.sentByteCount		= network.GetSentByteCount();
+	outResults.deliveredByteCount	= network.GetDeliveredByteCount();
+	outResults.rtt_ms				= GetSoakPercentiles( rtt_ms );
+
+	outResults.hostProcessIncoming_us			= GetSoakPercentiles( hostIncoming_us );
+	outResults.hostProcessOutgoing_us			= GetSoakPercentiles( hostOutgoing_us );
+	outResults.clientProcessIncomingAverage_us	= ( frameCount > 0U ) ? clientIncomingTotal_us / ( (double)frameCount * clientCount ) : 0.0;
+	outResults.clientProcessOutgoingAverage_us	= ( frameCount > 0U ) ? clientOutgoingTotal_us / ( (double)frameCount * clientCount ) : 0.0;
+
+	// Clean up; clients first, the host would hang up on them anyway
+	for( uint i = 0U; i < clientCount; i++ )
+		delete clients[i];
+	for( uint channel = 0U; channel < channelCount; channel++ )
+		delete inOrderMessages[ channel ];
+
+	s_soakRun = nullptr;
+	return ( joinedCount == clientCount );
+}
+
+void NetworkSoakBenchmark( Command &cmd )
+{
+	NetworkSoakSettings settings;
+	settings.conditions.lossFraction	= 0.02f;
+	settings.conditions.latency_ms		= 40U;
+	settings.conditions.jitter_ms		= 20U;
+	settings.conditions.reorderFraction	= 0.01f;
+
+	std::string countStr		= cmd.GetNextString();
+	std::string secondsStr		= cmd.GetNextString();
+	std::string unreliablesStr	= cmd.GetNextString();
+	std::string reliablesStr	= cmd.GetNextString();
+	std::string inOrdersStr		= cmd.GetNextString();
+	std::string channelsStr		= cmd.GetNextString();
+	std::string lossStr			= cmd.GetNextString();
+	std::string latencyStr		= cmd.GetNextString();
+	std::string seedStr			= cmd.GetNextString();
+	std::string byteBudgetStr	= cmd.GetNextString();
+	std::string blobKBStr		= cmd.GetNextString();
+	settings.clientCount			= ( countStr		!= "" ) ? (uint) atoi( countStr.c_str() )		: settings.clientCount;
+	settings.durationSeconds		= ( secondsStr		!= "" ) ? atof( secondsStr.c_str() )			: settings.durationSeconds;
+	settings.unreliablesPerFrame	= ( unreliablesStr	!= "" ) ? (uint) atoi( unreliablesStr.c_str() )	: settings.unreliablesPerFrame;
+	settings.reliablesPerFrame		= ( reliablesStr	!= "" ) ? (uint) atoi( reliablesStr.c_str() )	: settings.reliablesPerFrame;
+	settings.inOrdersPerFrame		= ( inOrdersStr		!= "" ) ? (uint) atoi( inOrdersStr.c_str() )	: settings.inOrdersPerFrame;
+	settings.inOrderChannelCount	= ( channelsStr		!= "" ) ? (uint) atoi( channelsStr.c_str() )	: settings.inOrderChannelCount;
+	settings.conditions.lossFraction= ( lossStr			!= "" ) ? (float) atoi( lossStr.c_str() ) * 0.01f	: settings.conditions.lossFraction;
+	settings.conditions.latency_ms	= ( latencyStr		!= "" ) ? (uint) atoi( latencyStr.c_str() )		: settings.conditions.latency_ms;
+	settings.seed					= ( seedStr			!= "" ) ? (uint) atoi( seedStr.c_str() )		: settings.seed;
+	settings.byteBudgetPerSecond	= ( byteBudgetStr	!= "" ) ? (uint) atoi( byteBudgetStr.c_str() )	: settings.byteBudgetPerSecond;
+	settings.blobByteCount			= ( blobKBStr		!= "" ) ? (uint) atoi( blobKBStr.c_str() ) * 1024U	: settings.blobByteCount;
+	if( settings.clientCount == 0U || settings.clientCount >= MAX_SESSION_CONNECTIONS || settings.durationSeconds <= 0.0 || settings.inOrderChannelCount > MAX_NETWORK_MESSAGE_CHANNELS || settings.conditions.lossFraction >= 1.f )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "net_soak: clientCount has to be in [1, %u], seconds more than ZERO, channels at most %u & loss less than 100%%!", MAX_SESSION_CONNECTIONS - 1U, MAX_NETWORK_MESSAGE_CHANNELS );
+		return;
+	}
+
+	NetworkSoakResults results;
+	bool completed = RunNetworkSoak( settings, results );
+	if( results.joinedClientCount < settings.clientCount )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "net_soak: only %u of %u clients joined!", results.joinedClientCount, settings.clientCount );
+		return;
+	}
+
+	char const	*trafficNames[ NUM_NET_SOAK_TRAFFICS ] = { "unreliable", "reliable", "in-order" };
+	uint		 sentTotal		= 0U;
+	uint		 receivedTotal	= 0U;
+
+	ConsolePrintf( "net_soak: %u clients, %.1f s, per connection, direction & frame: %u unreliable, %u reliable, %u in-order x %u channels; %u%% loss, %u+%ums latency, seed %u",
+				   settings.clientCount, settings.durationSeconds, settings.unreliablesPerFrame, settings.reliablesPerFrame, settings.inOrdersPerFrame, settings.inOrderChannelCount,
+				   (uint)( settings.conditions.lossFraction * 100.f + 0.5f ), settings.conditions.latency_ms, settings.conditions.jitter_ms, settings.seed );
+	for( uint traffic = 0U; traffic < NUM_NET_SOAK_TRAFFICS; traffic++ )
+	{
+		NetworkSoakPercentiles const &latency = results.deliveryLatency_ms[ traffic ];
+		ConsolePrintf( "  %-10s: %8u sent, %8u received; latency ms p50 %6.1f, p90 %6.1f, p99 %6.1f, max %6.1f", trafficNames[ traffic ], results.sentMessages[ traffic ], results.receivedMessages[ traffic ], latency.p50, latency.p90, latency.p99, latency.max );
+
+		sentTotal		+= results.sentMessages[ traffic ];
+		receivedTotal	+= results.receivedMessages[ traffic ];
+	}
+
+	bool isValid = completed && ( results.duplicateCount == 0U ) && ( results.outOfOrderCount == 0U )
+				&& ( results.receivedMessages[ NET_SOAK_RELIABLE ] == results.sentMessages[ NET_SOAK_RELIABLE ] ) && ( results.receivedMessages[ NET_SOAK_IN_ORDER ] == results.sentMessages[ NET_SOAK_IN_ORDER ] )
+				&& ( results.receivedBlobCount == results.sentBlobCount ) && ( results.corruptBlobCount == 0U );
+	ConsolePrintf( isValid ? RGBA_GREEN_COLOR : RGBA_RED_COLOR, "  reliables: %u resent, %u duplicates processed, %u out of order", results.resentReliableCount, results.duplicateCount, results.outOfOrderCount );
+	if( results.sentBlobCount > 0U )
+	{
+		ConsolePrintf( isValid ? RGBA_GREEN_COLOR : RGBA_RED_COLOR, "  blobs: %u of %u KB sent, %u received, %u corrupt; compressed to %.1f%%; latency ms p50 %.1f, max %.1f",
+					   results.sentBlobCount, settings.blobByteCount / 1024U, results.receivedBlobCount, results.corruptBlobCount,
+					   ( results.blobMessageByteCount > 0U ) ? 100.0 * (double)results.blobByteCount / (double)results.blobMessageByteCount : 0.0, results.blobDeliveryLatency_ms.p50, results.blobDeliveryLatency_ms.max );
+	}
+	ConsolePrintf( "  priority: %u times a message got deferred, %u unreliables dropped after waiting too long; byte budget %u/s per connection", results.deferredMessageCount, results.droppedUnreliableCount, settings.byteBudgetPerSecond );
+	ConsolePrintf( "  throughput: %.0f messages/s & %.1f KB/s simulated; %.0f messages/s of wall time ( %.3f s for %u frames )",
+				   (double)receivedTotal / results.simulatedSeconds, (double)results.sentByteCount / ( 1024.0 * results.simulatedSeconds ), (double)receivedTotal / results.wallSeconds, results.wallSeconds, results.frameCount );
+	ConsolePrintf( "  packets: %u sent, %u lost, %llu bytes sent, %llu delivered; rtt ms p50 %.1f, p90 %.1f, p99 %.1f, max %.1f",
+				   results.sentPacketCount, results.lostPacketCount, results.sentByteCount, results.deliveredByteCount, results.rtt_ms.p50, results.rtt_ms.p90, results.rtt_ms.p99, results.rtt_ms.max );
+	ConsolePrintf( "  cpu us per call: host ProcessIncoming p50 %.1f, p99 %.1f, max %.1f; ProcessOutgoing p50 %.1f, p99 %.1f, max %.1f; client average %.2f & %.2f",
+				   results.hostProcessIncoming_us.p50, results.hostProcessIncoming_us.p99, results.hostProcessIncoming_us.max, results.hostProcessOutgoing_us.p50, results.hostProcessOutgoing_us.p99, results.hostProcessOutgoing_us.max,
+				   results.clientProcessIncomingAverage_us, results.clientProcessOutgoingAverage_us );
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Input/Command.hpp"
+#include "Engine/NetworkSession/LoopbackNetwork.hpp"
+
+//------------------------------------------------------------------------------------------
+// Soak benchmark for the packet path: a host & clientCount clients, each its own headless NetworkSession ( no renderer ),
+// all on one LoopbackNetwork
+//	- Every frame, the message mix goes both ways on every connection: host => each client & each client => host
+//	- Runs durationSeconds of simulated time in fixed frames, then more frames without new messages until every reliable
+//	  got through, for up to drainSeconds
+//	- Unreliables are low priority, reliables normal & in-order ones high
+//	- With blobByteCount, the host also sends every client one compressed, in-order message that big on the channel after
+//	  the in-order ones, once they've joined; it goes in fragments & the callback checks every byte of it
+//	- Timings are wall clock; everything else follows from the seed
+//	- RunNetworkSoak() needs nothing but the master clock, so a headless program can call it as well as net_soak can
+//
+enum eNetworkSoakTraffic : uint8_t
+{
+	NET_SOAK_UNRELIABLE = 0,
+	NET_SOAK_RELIABLE,
+	NET_SOAK_IN_ORDER,
+	NUM_NET_SOAK_TRAFFICS
+};
+
+struct NetworkSoakSettings
+{
+public:
+	uint						clientCount			= 32U;
+	double						durationSeconds		= 10.0;				// Simulated
+	double						drainSeconds		= 10.0;
+	double						frameSeconds		= 1.0 / 60.0;
+	uint						unreliablesPerFrame	= 2U;				// Per connection & direction
+	uint						reliablesPerFrame	= 1U;
+	uint						inOrdersPerFrame	= 1U;				// Per channel
+	uint						inOrderChannelCount	= 2U;				// Up to MAX_NETWORK_MESSAGE_CHANNELS
+	uint						payloadByteCount	= 16U;				// At least 12: stream, sequence & send time
+	uint						byteBudgetPerSecond	= 0U;				// Of every connection, once joined; ZERO => none
+	uint						blobByteCount		= 0U;				// ZERO => none
+	uint						seed				= 1U;
+	LoopbackNetworkConditions	conditions;
+};
+
+struct NetworkSoakPercentiles
+{
+public:
+	float	p50		= 0.f;
+	float	p90		= 0.f;
+	float	p99		= 0.f;
+	float	max		= 0.f;
+};
+
+struct NetworkSoakResults
+{
+public:
+	uint					joinedClientCount						= 0U;
+	uint					frameCount								= 0U;		// Including the drain
+	double					simulatedSeconds						= 0.0;
+	double					wallSeconds								= 0.0;
+
+	// Messages
+	uint					sentMessages	[ NUM_NET_SOAK_TRAFFICS ]	= { 0U };
+	uint					receivedMessages[ NUM_NET_SOAK_TRAFFICS ]	= { 0U };
+	NetworkSoakPercentiles	deliveryLatency_ms[ NUM_NET_SOAK_TRAFFICS ];		// Send() to the callback, simulated
+	uint					duplicateCount							= 0U;		// Reliables processed twice
+	uint					outOfOrderCount							= 0U;		// In-order messages which came before an earlier one of their channel
+	uint					resentReliableCount						= 0U;
+	uint					deferredMessageCount					= 0U;		// Left out of a packet, for priority or the byte budget
+	uint					droppedUnreliableCount					= 0U;		// Deferred for too long
+
+	// Blobs
+	uint					sentBlobCount							= 0U;
+	uint					receivedBlobCount						= 0U;
+	uint					corruptBlobCount						= 0U;		// Wrong size or bytes
+	uint64_t				blobMessageByteCount					= 0U;		// Before & after the compression
+	uint64_t				blobByteCount							= 0U;
+	NetworkSoakPercentiles	blobDeliveryLatency_ms;
+
+	// Packets
+	uint					sentPacketCount							= 0U;
+	uint					lostPacketCount							= 0U;
+	uint64_t				sentByteCount							= 0U;
+	uint64_t				deliveredByteCount						= 0U;
+	NetworkSoakPercentiles	rtt_ms;												// Of every confirmed packet of every connection
+
+	// CPU, wall clock per call
+	NetworkSoakPercentiles	hostProcessIncoming_us;
+	NetworkSoakPercentiles	hostProcessOutgoing_us;
+	double					clientProcessIncomingAverage_us			= 0.0;
+	double					clientProcessOutgoingAverage_us			= 0.0;
+};
+
+bool RunNetworkSoak( NetworkSoakSettings const &settings, NetworkSoakResults &outResults );		// Returns false if it couldn't host, or not every client joined
+
+
+// Console Commands
+void NetworkSoakBenchmark( Command &cmd );				// net_soak [clientCount] [seconds] [unreliables] [reliables] [inOrders] [channels] [lossPercent] [latency_ms] [seed] [byteBudgetPerSecond] [blobKB]
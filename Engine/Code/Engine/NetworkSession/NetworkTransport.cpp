@@ -0,0 +1,65 @@
+#pragma once
+#include "NetworkTransport.hpp"
+
+UDPNetworkTransport::~UDPNetworkTransport()
+{
+	Close();
+}
+
+bool UDPNetworkTransport::Bind( NetworkAddress const &address, uint16_t portRange )
+{
+	Close();
+
+	NetworkAddress bindAddress	= address;
+	UDPSocket	  *newSocket	= new UDPSocket();
+	if( newSocket->Bind( bindAddress, portRange ) == false )
+	{
+		delete newSocket;
+		return false;
+	}
+
+	newSocket->EnableNonBlocking();
+
+	m_socket	= newSocket;
+	m_address	= newSocket->m_address;
+	return true;
+}
+
+void UDPNetworkTransport::Close()
+{
+	if( m_socket == nullptr )
+		return;
+
+	// Keep the counts going, a new socket starts from zero
+	m_receiveSyscallCount	+= m_socket->GetReceiveSyscallCount();
+	m_sendSyscallCount		+= m_socket->GetSendSyscallCount();
+
+	delete m_socket;
+	m_socket = nullptr;
+}
+
+uint UDPNetworkTransport::ReceiveBatch( UDPDatagram *datagrams, uint maxCount )
+{
+	if( m_socket == nullptr )
+		return 0U;
+
+	return m_socket->ReceiveBatch( datagrams, maxCount );
+}
+
+uint UDPNetworkTransport::SendBatch( UDPDatagram const *datagrams, uint count )
+{
+	if( m_socket == nullptr )
+		return 0U;
+
+	return m_socket->SendBatch( datagrams, count );
+}
+
+uint UDPNetworkTransport::GetReceiveSyscallCount() const
+{
+	return m_receiveSyscallCount + ( (m_socket != nullptr) ? m_socket->GetReceiveSyscallCount() : 0U );
+}
+
+uint UDPNetworkTransport::GetSendSyscallCount() const
+{
+	return m_sendSyscallCount + ( (m_socket != nullptr) ? m_socket->GetSendSyscallCount() : 0U );
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Network/NetworkAddress.hpp"
+#include "Engine/Network/UDPSocket.hpp"
+
+//------------------------------------------------------------------------------------------
+// Where a NetworkSession's packets go in & out
+//	- Datagram semantics, like UDP: a send can get lost, nothing is guaranteed to arrive
+//	- Non-blocking: ReceiveBatch() returns whatever is there & zero if nothing is
+//	- The session binds it on Host() & Join(); a transport can get bound again after Close()
+//
+class NetworkTransport
+{
+public:
+	virtual ~NetworkTransport() { }
+
+public:
+	virtual bool					Bind( NetworkAddress const &address, uint16_t portRange ) = 0;	// Tries the ports [port, port + portRange]; returns false if none is free
+	virtual void					Close() = 0;
+	virtual bool					IsBound() const = 0;
+	virtual NetworkAddress const&	GetAddress() const = 0;											// The bound one
+
+	virtual uint					ReceiveBatch( UDPDatagram *datagrams, uint maxCount ) = 0;		// Returns how many got received
+	virtual uint					SendBatch	( UDPDatagram const *datagrams, uint count ) = 0;	// Returns how many went out
+
+	// Stats, since constructed
+	virtual uint					GetReceiveSyscallCount() const = 0;
+	virtual uint					GetSendSyscallCount() const = 0;
+};
+
+// The default; a non-blocking UDPSocket
+class UDPNetworkTransport : public NetworkTransport
+{
+public:
+	 UDPNetworkTransport() { }
+	~UDPNetworkTransport();
+
+private:
+	UDPSocket		*m_socket				= nullptr;
+	NetworkAddress	 m_address;
+	uint			 m_receiveSyscallCount	= 0U;						// Of the sockets closed so far
+	uint			 m_sendSyscallCount		= 0U;
+
+public:
+	bool					Bind( NetworkAddress const &address, uint16_t portRange );
+	void					Close();
+	bool					IsBound() const { return m_socket != nullptr; }
+	NetworkAddress const&	GetAddress() const { return m_address; }
+
+	uint					ReceiveBatch( UDPDatagram *datagrams, uint maxCount );
+	uint					SendBatch	( UDPDatagram const *datagrams, uint count );
+
+	uint					GetReceiveSyscallCount() const;
+	uint					GetSendSyscallCount() const;
+};
@@ -17,35 +17,35 @@ ProfileReportEntry::~ProfileReportEntry()
 	}
 }
 
-void ProfileReportEntry::PopulateTree( ProfileMeasurement* node )
+void ProfileReportEntry::PopulateTree( ProfileFrame const &frame, ProfileMeasurement const* node )
 {
 	// We can set totalHPC & callCount for this root
 	CalculateInitialData( node );
 
-	for each (ProfileMeasurement* child in node->children)
+	for( ProfileMeasurement const* child = frame.GetFirstChild( *node ); child != nullptr; child = frame.GetNextSibling( *child ) )
 	{
 		ProfileReportEntry *entry = GetOrCreateChild( child->id );
-		entry->PopulateTree( child );
+		entry->PopulateTree( frame, child );
 	}
 
 	// Calculate selfTime & percentages
-	CalculateRemainingData( node );
+	CalculateRemainingData( frame, node );
 }
 
-void ProfileReportEntry::PopulateFlat( ProfileMeasurement* node, ProfileReportEntry* root /* = nullptr */ )
+void ProfileReportEntry::PopulateFlat( ProfileFrame const &frame, ProfileMeasurement const* node, ProfileReportEntry* root /* = nullptr */ )
 {
 	CalculateInitialData( node );
 
 	if( root == nullptr )
 		root = this;
 
-	for each (ProfileMeasurement* child in node->children)
+	for( ProfileMeasurement const* child = frame.GetFirstChild( *node ); child != nullptr; child = frame.GetNextSibling( *child ) )
 	{
 		ProfileReportEntry *childEntry = root->GetOrCreateChild( child->id );
-		childEntry->PopulateFlat( child, root );
+		childEntry->PopulateFlat( frame, child, root );
 	}
 
-	CalculateRemainingData( node );
+	CalculateRemainingData( frame, node );
 }
 
 ProfileReportEntry* ProfileReportEntry::GetOrCreateChild( std::string const &childID )
@@ -62,46 +62,35 @@ ProfileReportEntry* ProfileReportEntry::GetOrCreateChild( std::string const &chi
 	return newChild;
 }
 
-void ProfileReportEntry::CalculateInitialData( ProfileMeasurement* node )
+void ProfileReportEntry::CalculateInitialData( ProfileMeasurement const* node )
 {
 	m_callCount++;
 	m_totalHPC += node->GetElapsedHPC();
 }
 
-void ProfileReportEntry::CalculateRemainingData( ProfileMeasurement* node )
+void ProfileReportEntry::CalculateRemainingData( ProfileFrame const &frame, ProfileMeasurement const* node )
 {
 	// Self time
-	m_selfHPC = m_totalHPC - ChildrensTotalHPC( node );
+	m_selfHPC = m_totalHPC - ChildrensTotalHPC( frame, node );
 
 	// Get total time of the root (or frame)
-	uint64_t totalFrameTime = GetFramesTotalHPC( node );
+	uint64_t totalFrameTime = frame.GetElapsedHPC();
 
 	// Calculate percentage
 	m_percentTotalTime	= (double) ( (long double)m_totalHPC / (long double)totalFrameTime ) * 100.0;
 	m_percentSelfTime	= (double) ( (long double)m_selfHPC  / (long double)totalFrameTime ) * 100.0;
 }
 
-uint64_t ProfileReportEntry::ChildrensTotalHPC( ProfileMeasurement* root )
+uint64_t ProfileReportEntry::ChildrensTotalHPC( ProfileFrame const &frame, ProfileMeasurement const* root )
 {
 	uint64_t cTotalHPC = 0;
 
-	for each (ProfileMeasurement* child in root->children)
+	for( ProfileMeasurement const* child = frame.GetFirstChild( *root ); child != nullptr; child = frame.GetNextSibling( *child ) )
 		cTotalHPC += child->GetElapsedHPC();
 
 	return cTotalHPC;
 }
 
-uint64_t ProfileReportEntry::GetFramesTotalHPC( ProfileMeasurement* child )
-{
-	ProfileMeasurement* possibleParent = child;
-
-	// Traverse up to the top of the tree
-	while ( possibleParent->parent != nullptr )
-		possibleParent = possibleParent->parent;
-
-	return possibleParent->GetElapsedHPC();
-}
-
 void ProfileReportEntry::GetProfileReportAsStringsVector( std::vector<std::string> &outStrings, uint herairchyLevel )
 {
 	// If hierarchy level ZERO => We need to provide headers, too!
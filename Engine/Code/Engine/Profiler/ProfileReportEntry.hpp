@@ -26,14 +26,13 @@ public:
 	ProfileReportEntryList	 m_children;
 
 public:
-	void				PopulateTree( ProfileMeasurement* node );
-	void				PopulateFlat( ProfileMeasurement* node, ProfileReportEntry* root = nullptr );
+	void				PopulateTree( ProfileFrame const &frame, ProfileMeasurement const* node );
+	void				PopulateFlat( ProfileFrame const &frame, ProfileMeasurement const* node, ProfileReportEntry* root = nullptr );
 	ProfileReportEntry* GetOrCreateChild( std::string const &childID );
-	void				CalculateInitialData( ProfileMeasurement* node );		// Sets totalHPC & callCount
-	void				CalculateRemainingData( ProfileMeasurement* node );
+	void				CalculateInitialData( ProfileMeasurement const* node );		// Sets totalHPC & callCount
+	void				CalculateRemainingData( ProfileFrame const &frame, ProfileMeasurement const* node );
 	void				GetProfileReportAsStringsVector( std::vector<std::string> &outStrings, uint herairchyLevel );
 
 private:
-	uint64_t			ChildrensTotalHPC( ProfileMeasurement* root );
-	uint64_t			GetFramesTotalHPC( ProfileMeasurement* child );
+	uint64_t			ChildrensTotalHPC( ProfileFrame const &frame, ProfileMeasurement const* root );
 };
\ No newline at end of file
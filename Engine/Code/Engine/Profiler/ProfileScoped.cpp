@@ -2,7 +2,7 @@
 #include "ProfileScoped.hpp"
 #include "Engine/Profiler/Profiler.hpp"
 
-ProfileScoped::ProfileScoped( std::string const &id )
+ProfileScoped::ProfileScoped( char const *id )
 {
 	Profiler::GetInstance()->Push( id );
 }
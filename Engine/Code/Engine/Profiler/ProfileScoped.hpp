@@ -8,6 +8,6 @@
 class ProfileScoped
 {
 public:
-	 ProfileScoped( std::string const &id );
+	 ProfileScoped( char const *id );
 	~ProfileScoped();
 };
\ No newline at end of file
@@ -1,10 +1,13 @@
 #pragma once
 #include "Profiler.hpp"
+#include <string.h>
 
 #include "Engine/Internal/WindowsCommon.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Math/MathUtil.hpp"
 #include "Engine/Input/Command.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Profiler/ProfilerTraceExporter.hpp"
 #include "Game/EngineBuildPreferences.hpp"
 
 void PauseTheProfiler( Command &command )
@@ -19,6 +22,15 @@ void ResumeTheProfiler( Command &command )
 	Profiler::GetInstance()->Resume();
 }
 
+void ExportProfilerTrace( Command &command )
+{
+	std::string filePath = command.GetNextString();
+	if( filePath == "" )
+		filePath = DEFAULT_PROFILER_TRACE_FILE_PATH;
+
+	Profiler::GetInstance()->StartTraceExport( filePath );
+}
+
 Profiler*	Profiler::s_instance				= nullptr;
 double		Profiler::s_secondsPerClockCycle	= 0;
 
@@ -37,88 +49,185 @@ Profiler::~Profiler() { }
 void Profiler::Startup() { s_secondsPerClockCycle = Profiler::CalculateSecondsPerClockCycle(); }
 void Profiler::Shutdown() { }
 
-void Profiler::Push( std::string const &id ) { UNUSED(id); }
+void Profiler::Push( char const *id ) { UNUSED(id); }
 void Profiler::Pop() { }
+void Profiler::AddToCounter( char const *id, uint64_t value ) { UNUSED(id); UNUSED(value); }
 void Profiler::MarkFrame() { }
 void Profiler::Pause() { }
 void Profiler::Resume() { }
+void Profiler::SetCurrentThreadName( char const *threadName ) { UNUSED(threadName); }
+void Profiler::StartTraceExport( std::string const &filePath ) { UNUSED(filePath); ConsolePrintf( RGBA_RED_COLOR, "Profiler is disabled, nothing to export!" ); }
+void Profiler::UpdateTraceExport() { }
+
+ProfileFrame const* Profiler::GetPreviousFrame( uint skip_count ) { UNUSED(skip_count); return nullptr; }
+ProfileFrame const* Profiler::GetPreviousFrameForThread( uint threadIndex, uint skip_count ) { UNUSED(threadIndex); UNUSED(skip_count); return nullptr; }
+uint64_t Profiler::GetCommittedFrameCount( uint threadIndex ) const { UNUSED(threadIndex); return 0U; }
+bool Profiler::CopyCommittedFrame( uint threadIndex, uint64_t commitIndex, ProfileFrame &out_frame ) const { UNUSED(threadIndex); UNUSED(commitIndex); UNUSED(out_frame); return false; }
+uint Profiler::GetThreadCount() const { return 0U; }
+char const* Profiler::GetThreadName( uint threadIndex ) const { UNUSED(threadIndex); return nullptr; }
 
 #else // Enable PROFILER 
+
+// Each thread caches its own context, so Push/Pop never touch shared state
+static thread_local ProfilerThreadContext *t_profilerContext = nullptr;
+
 Profiler::Profiler()
 {
-	m_activeNode = nullptr;
+	m_threadContexts = new ProfilerThreadContext[ PROFILER_MAX_THREADS ];
 }
 
 Profiler::~Profiler()
 {
-	for( int i = 0; i < MAX_HISTORY_COUNT; i++ )
-	{
-		if( m_measurementHistory[i] == nullptr )
-			continue;
+	delete m_traceExporter;
+	m_traceExporter = nullptr;
 
-		delete m_measurementHistory[i];
-		m_measurementHistory[i] = nullptr;
+	for( int i = 0; i < PROFILER_MAX_THREADS; i++ )
+	{
+		delete[] m_threadContexts[i].frames;
+		m_threadContexts[i].frames = nullptr;
 	}
+
+	delete[] m_threadContexts;
+	m_threadContexts = nullptr;
 }
 
 void Profiler::Startup()
 {
 	s_secondsPerClockCycle = Profiler::CalculateSecondsPerClockCycle();
 
-	GetInstance();
+	// Thread which starts the profiler gets the first context
+	GetInstance()->SetCurrentThreadName( "Main" );
 
 	// Command Register
 	CommandRegister( "profiler_pause",	PauseTheProfiler );
 	CommandRegister( "profiler_resume", ResumeTheProfiler );
+	CommandRegister( "profiler_export", ExportProfilerTrace );
 }
 
 void Profiler::Shutdown()
 {
 	if( s_instance != nullptr )
+	{
 		delete s_instance;
+		s_instance = nullptr;
+	}
 }
 
-void Profiler::Push( std::string const &id )
+void Profiler::Push( char const *id )
 {
-	if( m_paused )
+	ProfilerThreadContext *context = GetOrCreateThreadContext();
+	if( context == nullptr )
 		return;
 
-	// Start a new measurement
-	ProfileMeasurement *measure = CreateMeasurement( id );
-
-	if( m_activeNode == nullptr )
+	// Already ignoring the parent scope, or paused
+	if( context->skippedDepth > 0 || m_paused.load( std::memory_order_relaxed ) )
 	{
-		m_activeNode = measure;
+		context->skippedDepth++;
+		return;
 	}
-	else
+
+	// Threads other than the one calling MarkFrame() get a frame per top level scope, committed by its Pop()
+	if( context->activeFrame == nullptr )
+		BeginFrame( *context, context->name, true );
+
+	// Arena is full
+	ProfileFrame &frame = *context->activeFrame;
+	if( frame.m_measurementCount >= PROFILER_MAX_MEASUREMENTS_PER_FRAME )
 	{
-		measure->parent = m_activeNode;
-		m_activeNode->AddChild( measure );
-		m_activeNode = measure;
+		frame.m_droppedCount++;
+		context->skippedDepth++;
+		return;
 	}
+
+	// Link the new measurement as the last child of the active one
+	uint16_t			 newIndex		= (uint16_t) frame.m_measurementCount++;
+	ProfileMeasurement	&measure		= frame.m_measurements[ newIndex ];
+	ProfileMeasurement	&parent			= frame.m_measurements[ context->activeIndex ];
+
+	measure.id					= id;
+	measure.parentIndex			= context->activeIndex;
+	measure.firstChildIndex		= INVALID_PROFILE_MEASUREMENT_INDEX;
+	measure.lastChildIndex		= INVALID_PROFILE_MEASUREMENT_INDEX;
+	measure.nextSiblingIndex	= INVALID_PROFILE_MEASUREMENT_INDEX;
+
+	if( parent.lastChildIndex == INVALID_PROFILE_MEASUREMENT_INDEX )
+		parent.firstChildIndex = newIndex;
+	else
+		frame.m_measurements[ parent.lastChildIndex ].nextSiblingIndex = newIndex;
+	parent.lastChildIndex = newIndex;
+
+	context->activeIndex = newIndex;
+
+	// Start the clock last, so the bookkeeping above isn't measured
+	measure.startHPC = GetPerformanceCounter();
 }
 
 void Profiler::Pop()
 {
-	if( m_paused )
+	uint64_t endHPC = GetPerformanceCounter();
+
+	ProfilerThreadContext *context = t_profilerContext;
+	if( context == nullptr || context->frames == nullptr )
+		return;
+
+	if( context->skippedDepth > 0 )
+	{
+		context->skippedDepth--;
 		return;
+	}
 
 	// Someone called pop without push
-	GUARANTEE_OR_DIE( m_activeNode != nullptr, "Profiler: There's an extra Pop() somewhere!!" );
+	GUARANTEE_OR_DIE( context->activeFrame != nullptr && context->activeIndex != 0, "Profiler: There's an extra Pop() somewhere!!" );
+
+	ProfileMeasurement &measure	= context->activeFrame->m_measurements[ context->activeIndex ];
+	measure.endHPC				= endHPC;
+	context->activeIndex		= measure.parentIndex;
+
+	// Outermost scope of a worker is done, publish it right away rather than at its next Push()
+	if( context->activeIndex == 0 && context->commitsOnPop )
+		CommitActiveFrame( *context );
+}
 
-	m_activeNode->FinishMeasurement();
-	m_activeNode = m_activeNode->parent;
+void Profiler::AddToCounter( char const *id, uint64_t value )
+{
+	ProfilerThreadContext *context = GetOrCreateThreadContext();
+	if( context == nullptr || context->activeFrame == nullptr || m_paused.load( std::memory_order_relaxed ) )
+		return;
+
+	// Tags are literals or interned, so the pointer is the identity
+	ProfileFrame &frame = *context->activeFrame;
+	for( uint i = 0; i < frame.m_counterCount; i++ )
+	{
+		if( frame.m_counters[i].id == id )
+		{
+			frame.m_counters[i].value += value;
+			return;
+		}
+	}
+
+	if( frame.m_counterCount >= PROFILER_MAX_COUNTERS_PER_FRAME )
+	{
+		GUARANTEE_RECOVERABLE( false, "Profiler: Too many counters, increase PROFILER_MAX_COUNTERS_PER_FRAME!" );
+		return;
+	}
+
+	ProfileCounter &counter = frame.m_counters[ frame.m_counterCount++ ];
+	counter.id		= id;
+	counter.value	= value;
 }
 
 void Profiler::MarkFrame()
 {
-	if( m_activeNode != nullptr )
+	ProfilerThreadContext *context = GetOrCreateThreadContext();
+	if( context == nullptr )
+		return;
+
+	if( context->activeFrame != nullptr )
 	{
-		AddReportToHistoryArray( m_activeNode );
-		Pop();
+		// not at root - someone forgot to pop
+		GUARANTEE_OR_DIE( context->activeIndex == 0 && context->skippedDepth == 0, "MarkFrame: someone forgot to Pop!" );
 
-		// not null - someone forgot to pop
-		GUARANTEE_OR_DIE( m_activeNode == nullptr, "MarkFrame: someone forgot to Pop!" );
+		CommitActiveFrame( *context );
 	}
 
 	if( m_isPausing )
@@ -133,7 +242,15 @@ void Profiler::MarkFrame()
 		m_isResuming	= false;
 	}
 
-	Push("frame");
+	// Signal every other thread to swap its arena
+	m_frameThreadIndex.store( context->index, std::memory_order_relaxed );
+	m_frameNumber.fetch_add( 1, std::memory_order_relaxed );
+
+	if( m_paused == false )
+		BeginFrame( *context, "frame", false );
+
+	if( m_traceExporter != nullptr )
+		UpdateTraceExport();
 }
 
 void Profiler::Pause()
@@ -145,55 +262,253 @@ void Profiler::Resume()
 {
 	m_isResuming = true;
 }
-#endif // ENGINE_DISABLE_PROFILER
 
+void Profiler::StartTraceExport( std::string const &filePath )
+{
+	if( m_traceExporter != nullptr )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "Profiler: already exporting to \"%s\"!", m_traceExporter->GetFilePath().c_str() );
+		return;
+	}
+
+	m_traceExporter = new ProfilerTraceExporter( *this, filePath );
+	if( m_traceExporter->IsOpen() == false )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "Profiler: couldn't open \"%s\" for the export!", filePath.c_str() );
+
+		delete m_traceExporter;
+		m_traceExporter = nullptr;
+		return;
+	}
+
+	// Freeze the history, so the ring doesn't get overwritten while it is being written
+	m_resumeAfterExport = ( m_paused == false ) || m_isResuming;
+	m_isResuming		= false;
+	Pause();
+
+	ConsolePrintf( "Profiler: exporting history to \"%s\"..", filePath.c_str() );
+}
 
-ProfileMeasurement* Profiler::CreateMeasurement( std::string const &id )
+void Profiler::UpdateTraceExport()
 {
-	ProfileMeasurement *pm = new ProfileMeasurement( id );
-	pm->StartMeasurement();
+	// Wait till the pause takes effect
+	if( m_paused == false )
+		return;
+
+	m_traceExporter->Update();
+	if( m_traceExporter->IsFinished() == false )
+		return;
+
+	ConsolePrintf( "Profiler: exported %u frames ( %u events ) to \"%s\"", m_traceExporter->GetFramesWritten(), m_traceExporter->GetEventsWritten(), m_traceExporter->GetFilePath().c_str() );
+
+	delete m_traceExporter;
+	m_traceExporter = nullptr;
 
-	return pm;
+	if( m_resumeAfterExport )
+		Resume();
 }
 
-void Profiler::DestroyMeasurementTreeRecursively( ProfileMeasurement* root )
+void Profiler::SetCurrentThreadName( char const *threadName )
 {
-	// For each child
-	for each (ProfileMeasurement* child in root->children)
-	{
-		// If it has children
-		if( child->children.size() != 0 )
-			DestroyMeasurementTreeRecursively( child );		// delete each children
+	if( t_profilerContext == nullptr )
+		t_profilerContext = CreateThreadContext( threadName );
+	else if( t_profilerContext->frames != nullptr )
+		t_profilerContext->name = threadName;
+}
 
-															// Delete this child after deleting all its child->childern
-		delete child;
-		child = nullptr;
-	}
+ProfilerThreadContext* Profiler::GetOrCreateThreadContext()
+{
+	if( t_profilerContext == nullptr )
+		t_profilerContext = CreateThreadContext( "Thread" );
+
+	// A thread which couldn't get a slot gets a context without frames
+	return ( t_profilerContext->frames != nullptr ) ? t_profilerContext : nullptr;
 }
 
-void Profiler::AddReportToHistoryArray( ProfileMeasurement* newReport )
+ProfilerThreadContext* Profiler::CreateThreadContext( char const *threadName )
 {
-	// Get next index to add report at
-	m_currentReportIndex++;
-	m_currentReportIndex = m_currentReportIndex % MAX_HISTORY_COUNT;
+	static ProfilerThreadContext s_unprofiledThreadContext;
 
-	// If report at that index isn't nullptr
-	if( m_measurementHistory[ m_currentReportIndex ] != nullptr )
+	uint slotIndex = m_threadCount.fetch_add( 1 );
+	if( slotIndex >= PROFILER_MAX_THREADS )
 	{
-		// delete it
-		DestroyMeasurementTreeRecursively( m_measurementHistory[ m_currentReportIndex ] );
-		m_measurementHistory[ m_currentReportIndex ] = nullptr;
+		GUARANTEE_RECOVERABLE( false, "Profiler: Too many threads, increase PROFILER_MAX_THREADS!" );
+		return &s_unprofiledThreadContext;
 	}
 
-	// Now add a new entry there..
-	m_measurementHistory[ m_currentReportIndex ] = newReport;
+	// One time allocation of this thread's whole history
+	ProfilerThreadContext &context = m_threadContexts[ slotIndex ];
+	context.name	= threadName;
+	context.index	= slotIndex;
+	context.frames	= new ProfileFrame[ MAX_HISTORY_COUNT ];
+	context.isReady.store( true, std::memory_order_release );
+
+	return &context;
+}
+
+void Profiler::BeginFrame( ProfilerThreadContext &context, char const *rootID, bool commitsOnPop )
+{
+	// Reuse the oldest arena of the history ring
+	int				 slot	= ( context.lastCommittedSlot.load( std::memory_order_relaxed ) + 1 ) % MAX_HISTORY_COUNT;
+	ProfileFrame	&frame	= context.frames[ slot ];
+
+	frame.m_frameNumber			= m_frameNumber.load( std::memory_order_relaxed );
+	frame.m_threadIndex			= context.index;
+	frame.m_measurementCount	= 1;
+	frame.m_droppedCount		= 0;
+	frame.m_counterCount		= 0;
+
+	ProfileMeasurement &root	= frame.m_measurements[0];
+	root.id						= rootID;
+	root.parentIndex			= INVALID_PROFILE_MEASUREMENT_INDEX;
+	root.firstChildIndex		= INVALID_PROFILE_MEASUREMENT_INDEX;
+	root.lastChildIndex			= INVALID_PROFILE_MEASUREMENT_INDEX;
+	root.nextSiblingIndex		= INVALID_PROFILE_MEASUREMENT_INDEX;
+	root.startHPC				= GetPerformanceCounter();
+	root.endHPC					= root.startHPC;
+
+	context.activeFrame			= &frame;
+	context.activeIndex			= 0;
+	context.commitsOnPop		= commitsOnPop;
+}
+
+void Profiler::CommitActiveFrame( ProfilerThreadContext &context )
+{
+	ProfileFrame &frame					= *context.activeFrame;
+	frame.m_measurements[0].endHPC		= GetPerformanceCounter();
+
+	// Publish it for the readers
+	int committedSlot = (int)( &frame - context.frames );
+	context.lastCommittedSlot.store( committedSlot, std::memory_order_release );
+	context.committedCount.fetch_add( 1, std::memory_order_release );
+
+	context.activeFrame = nullptr;
+	context.activeIndex = INVALID_PROFILE_MEASUREMENT_INDEX;
+}
+
+ProfileFrame const* Profiler::GetPreviousFrame( uint skip_count /*= 0 */ )
+{
+	return GetPreviousFrameForThread( m_frameThreadIndex.load( std::memory_order_relaxed ), skip_count );
 }
 
-ProfileMeasurement* Profiler::GetPreviousFrame( uint skip_count /*= 0 */ )
+ProfileFrame const* Profiler::GetPreviousFrameForThread( uint threadIndex, uint skip_count /*= 0 */ )
 {
-	int actualIndex = m_currentReportIndex - (int)skip_count;
+	if( threadIndex >= GetThreadCount() )
+		return nullptr;
+
+	ProfilerThreadContext const &context = m_threadContexts[ threadIndex ];
+	if( context.isReady.load( std::memory_order_acquire ) == false )
+		return nullptr;
+
+	// Last slot of the ring is the one being written
+	uint64_t committedCount = context.committedCount.load( std::memory_order_acquire );
+	if( skip_count >= committedCount || skip_count >= MAX_HISTORY_COUNT - 1 )
+		return nullptr;
+
+	int actualIndex = context.lastCommittedSlot.load( std::memory_order_acquire ) - (int)skip_count;
 	actualIndex		= ModuloNonNegative( actualIndex, MAX_HISTORY_COUNT );
-	return m_measurementHistory[ actualIndex ];
+	return &context.frames[ actualIndex ];
+}
+
+// Committed, and its slot isn't the one being written ( or about to be )
+static bool IsCommitIndexInHistory( ProfilerThreadContext const &context, uint64_t commitIndex )
+{
+	uint64_t committedCount = context.committedCount.load( std::memory_order_acquire );
+	return ( commitIndex < committedCount ) && ( committedCount - commitIndex < MAX_HISTORY_COUNT );
+}
+
+uint64_t Profiler::GetCommittedFrameCount( uint threadIndex ) const
+{
+	if( threadIndex >= GetThreadCount() )
+		return 0U;
+
+	ProfilerThreadContext const &context = m_threadContexts[ threadIndex ];
+	if( context.isReady.load( std::memory_order_acquire ) == false )
+		return 0U;
+
+	return context.committedCount.load( std::memory_order_acquire );
+}
+
+bool Profiler::CopyCommittedFrame( uint threadIndex, uint64_t commitIndex, ProfileFrame &out_frame ) const
+{
+	if( threadIndex >= GetThreadCount() )
+		return false;
+
+	ProfilerThreadContext const &context = m_threadContexts[ threadIndex ];
+	if( context.isReady.load( std::memory_order_acquire ) == false || IsCommitIndexInHistory( context, commitIndex ) == false )
+		return false;
+
+	// Only the used part of the arenas
+	ProfileFrame const &frame		= context.frames[ commitIndex % MAX_HISTORY_COUNT ];
+	out_frame.m_frameNumber			= frame.m_frameNumber;
+	out_frame.m_threadIndex			= frame.m_threadIndex;
+	out_frame.m_measurementCount	= ( frame.m_measurementCount < PROFILER_MAX_MEASUREMENTS_PER_FRAME ) ? frame.m_measurementCount : PROFILER_MAX_MEASUREMENTS_PER_FRAME;
+	out_frame.m_droppedCount		= frame.m_droppedCount;
+	out_frame.m_counterCount		= ( frame.m_counterCount < PROFILER_MAX_COUNTERS_PER_FRAME ) ? frame.m_counterCount : PROFILER_MAX_COUNTERS_PER_FRAME;
+	memcpy( out_frame.m_measurements,	frame.m_measurements,	out_frame.m_measurementCount * sizeof( ProfileMeasurement ) );
+	memcpy( out_frame.m_counters,		frame.m_counters,		out_frame.m_counterCount * sizeof( ProfileCounter ) );
+
+	// Owning thread may have started reusing the slot while it got copied; then the copy is garbage
+	std::atomic_thread_fence( std::memory_order_acquire );
+	return IsCommitIndexInHistory( context, commitIndex );
+}
+
+uint Profiler::GetThreadCount() const
+{
+	uint threadCount = m_threadCount.load( std::memory_order_acquire );
+	return ( threadCount < PROFILER_MAX_THREADS ) ? threadCount : PROFILER_MAX_THREADS;
+}
+
+char const* Profiler::GetThreadName( uint threadIndex ) const
+{
+	if( threadIndex >= GetThreadCount() )
+		return nullptr;
+
+	return m_threadContexts[ threadIndex ].name;
+}
+#endif // ENGINE_DISABLE_PROFILER
+
+char const* Profiler::InternID( std::string const &id )
+{
+	std::lock_guard<std::mutex> internGuard( m_internLock );
+
+	// Elements of std::set never move, so the c_str() stays valid
+	return m_internedIDs.insert( id ).first->c_str();
+}
+
+ProfileMeasurement const* ProfileFrame::GetRoot() const
+{
+	return ( m_measurementCount > 0 ) ? &m_measurements[0] : nullptr;
+}
+
+ProfileMeasurement const* ProfileFrame::GetMeasurement( uint16_t index ) const
+{
+	return ( index < m_measurementCount ) ? &m_measurements[ index ] : nullptr;
+}
+
+ProfileMeasurement const* ProfileFrame::GetParent( ProfileMeasurement const &measurement ) const
+{
+	return GetMeasurement( measurement.parentIndex );
+}
+
+ProfileMeasurement const* ProfileFrame::GetFirstChild( ProfileMeasurement const &measurement ) const
+{
+	return GetMeasurement( measurement.firstChildIndex );
+}
+
+ProfileMeasurement const* ProfileFrame::GetNextSibling( ProfileMeasurement const &measurement ) const
+{
+	return GetMeasurement( measurement.nextSiblingIndex );
+}
+
+uint64_t ProfileFrame::GetElapsedHPC() const
+{
+	return ( m_measurementCount > 0 ) ? m_measurements[0].GetElapsedHPC() : 0U;
+}
+
+ProfileCounter const* ProfileFrame::GetCounter( uint index ) const
+{
+	return ( index < m_counterCount ) ? &m_counters[ index ] : nullptr;
 }
 
 double Profiler::CalculateSecondsPerClockCycle()
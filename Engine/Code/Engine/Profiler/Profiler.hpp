@@ -1,6 +1,8 @@
 #pragma once
-#include <queue>
-#include <vector>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <string>
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Profiler/ProfileScoped.hpp"
 #include "Engine/Profiler/ProfileLogScoped.hpp"
@@ -8,13 +10,30 @@
 
 #define MAX_HISTORY_COUNT 300
 
-#define PROFILE_LOG_SCOPE(tag)			ProfileLogScoped __timer__ ##__LINE__ ## (tag)
-#define PROFILE_LOG_SCOPE_FUNCTION()	ProfileLogScoped __timer__ ##__LINE__ ## (__FUNCTION__)
+#define PROFILER_MAX_THREADS					(8)
+#define PROFILER_MAX_MEASUREMENTS_PER_FRAME		(1024)
+#define PROFILER_MAX_COUNTERS_PER_FRAME			(32)
+#define INVALID_PROFILE_MEASUREMENT_INDEX		(0xffff)
 
-#define PROFILE_SCOPE(tag)				ProfileScoped __timer__ ##__LINE__ ## (tag)
-#define PROFILE_SCOPE_FUNCTION()		ProfileScoped __timer__ ##__LINE__ ## (__FUNCTION__)
+// Two levels, so __LINE__ gets expanded before the paste; nested scopes get names of their own instead of shadowing
+#define PROFILE_CONCAT_INNER(a, b)		a ## b
+#define PROFILE_CONCAT(a, b)			PROFILE_CONCAT_INNER(a, b)
+
+#define PROFILE_LOG_SCOPE(tag)			ProfileLogScoped PROFILE_CONCAT(__timer_, __LINE__)(tag)
+#define PROFILE_LOG_SCOPE_FUNCTION()	ProfileLogScoped PROFILE_CONCAT(__timer_, __LINE__)(__FUNCTION__)
+
+// Tag must outlive the profiler history: use a string literal, or Profiler::GetInstance()->InternID() for runtime strings
+#define PROFILE_SCOPE(tag)				ProfileScoped PROFILE_CONCAT(__timer_, __LINE__)(tag)
+#define PROFILE_SCOPE_FUNCTION()		ProfileScoped PROFILE_CONCAT(__timer_, __LINE__)(__FUNCTION__)
+
+// Counts of the current frame, like draws or culled objects; same rules for the tag as PROFILE_SCOPE
+#define PROFILE_COUNTER(tag, value)		Profiler::GetInstance()->AddToCounter( tag, (uint64_t)(value) )
 
 struct ProfileMeasurement;
+struct ProfileCounter;
+class  ProfileFrame;
+struct ProfilerThreadContext;
+class  ProfilerTraceExporter;
 
 class Profiler
 {
@@ -32,34 +51,58 @@ public:
 
 private:
 	// Pause and Resume
-	bool				m_paused		= false;
+	std::atomic<bool>	m_paused		{ false };		// Read by every profiled thread
 	bool				m_isPausing		= false;
 	bool				m_isResuming	= false;
 
-public:
-	// Measurement History
-	ProfileMeasurement	*m_activeNode;
-	ProfileMeasurement*	 m_measurementHistory[ MAX_HISTORY_COUNT ] = { nullptr };
+	// Frame Counter - advanced only by MarkFrame(), stamped on every thread's frames
+	std::atomic<uint64_t>	m_frameNumber		{ 0 };
+	std::atomic<uint>		m_frameThreadIndex	{ 0 };
+
+private:
+	// Per thread measurement stacks; a slot is claimed once and then only written by its owning thread
+	ProfilerThreadContext	*m_threadContexts	= nullptr;
+	std::atomic<uint>		 m_threadCount		{ 0 };
+
+	ProfilerThreadContext*	GetOrCreateThreadContext();
+	ProfilerThreadContext*	CreateThreadContext( char const *threadName );
+	void					BeginFrame( ProfilerThreadContext &context, char const *rootID, bool commitsOnPop );
+	void					CommitActiveFrame( ProfilerThreadContext &context );
+
+	// Trace Export - history stays paused until the exporter is done with it
+	ProfilerTraceExporter	*m_traceExporter		= nullptr;
+	bool					 m_resumeAfterExport	= false;
+
+	void					UpdateTraceExport();
 
-	// Managing the History
-	int					m_currentReportIndex	=	-1;
-	void				AddReportToHistoryArray( ProfileMeasurement* newReport );
+	// Interned IDs for runtime strings, so measurements only store a pointer
+	std::mutex				m_internLock;
+	std::set<std::string>	m_internedIDs;
 
 public:
 	// Access the History
-	ProfileMeasurement*	GetPreviousFrame( uint skip_count = 0 ); 
+	ProfileFrame const*	GetPreviousFrame( uint skip_count = 0 );									// Of the thread which calls MarkFrame()
+	ProfileFrame const*	GetPreviousFrameForThread( uint threadIndex, uint skip_count = 0 );
+	uint64_t			GetCommittedFrameCount( uint threadIndex ) const;						// Frame with commit index N is the (N+1)th one the thread committed
+	bool				CopyCommittedFrame( uint threadIndex, uint64_t commitIndex, ProfileFrame &out_frame ) const;	// False if it isn't committed yet, or got recycled; safe from any thread
+	uint inline			GetFrameThreadIndex() const { return m_frameThreadIndex.load( std::memory_order_relaxed ); }		// Of the thread which calls MarkFrame()
+	uint				GetThreadCount() const;
+	char const*			GetThreadName( uint threadIndex ) const;
 
 public:
-	void				Push( std::string const &id );
+	void				Push( char const *id );
 	void				Pop();
+	void				AddToCounter( char const *id, uint64_t value );		// Sums up within the frame of the calling thread
 	void				MarkFrame();
 	void				Pause();
 	void				Resume();
 	bool inline			IsPaused() const { return m_paused; }
-	
-public:
-	ProfileMeasurement* CreateMeasurement( std::string const &id );
-	void				DestroyMeasurementTreeRecursively( ProfileMeasurement* root );
+
+	void				StartTraceExport( std::string const &filePath );		// Streams the history as Chrome Trace Event JSON over next few frames
+	bool inline			IsExportingTrace() const { return m_traceExporter != nullptr; }
+
+	void				SetCurrentThreadName( char const *threadName );		// Registers the calling thread, if it isn't already
+	char const*			InternID( std::string const &id );					// Takes a lock; call once & cache the result
 
 public:
 	// Static utility functions
@@ -74,35 +117,68 @@ public:
 struct ProfileMeasurement
 {
 	// Measurement Data
-	std::string	id;
-	uint64_t	startHPC;
-	uint64_t	endHPC;
-
-	// Tree Data
-	ProfileMeasurement					*parent		= nullptr;
-	std::vector< ProfileMeasurement* >	 children;
+	char const	*id;
+	uint64_t	 startHPC;
+	uint64_t	 endHPC;
 
-	// Constructor
-	ProfileMeasurement( std::string id )
-	{
-		this->id = id;
-	}
+	// Tree Data - indices in to the owning ProfileFrame
+	uint16_t	 parentIndex;
+	uint16_t	 firstChildIndex;
+	uint16_t	 lastChildIndex;
+	uint16_t	 nextSiblingIndex;
 
 	// Functions
-	void		AddChild( ProfileMeasurement *child )
-	{
-		children.push_back( child );
-	}
-	void		StartMeasurement()
-	{
-		startHPC = Profiler::GetPerformanceCounter();
-	}
-	void		FinishMeasurement()
-	{
-		endHPC = Profiler::GetPerformanceCounter();
-	}
-	uint64_t	GetElapsedHPC()
+	uint64_t	GetElapsedHPC() const
 	{
 		return (endHPC - startHPC);
 	}
-};
\ No newline at end of file
+};
+
+struct ProfileCounter
+{
+	char const	*id;
+	uint64_t	 value;
+};
+
+//------------------------------------------------------------------------------------------
+// Fixed size arena holding every measurement of one thread for one frame
+//	- Root is always at index zero ( "frame" for the main thread, thread's name otherwise )
+//
+class ProfileFrame
+{
+public:
+	uint64_t			m_frameNumber		= 0;
+	uint				m_threadIndex		= 0;
+	uint				m_measurementCount	= 0;
+	uint				m_droppedCount		= 0;		// Pushes which didn't fit in the arena
+	uint				m_counterCount		= 0;
+	ProfileMeasurement	m_measurements[ PROFILER_MAX_MEASUREMENTS_PER_FRAME ];
+	ProfileCounter		m_counters[ PROFILER_MAX_COUNTERS_PER_FRAME ];		// In the order they were first added to
+
+public:
+	ProfileMeasurement const*	GetRoot() const;
+	ProfileMeasurement const*	GetMeasurement( uint16_t index ) const;
+	ProfileMeasurement const*	GetParent( ProfileMeasurement const &measurement ) const;
+	ProfileMeasurement const*	GetFirstChild( ProfileMeasurement const &measurement ) const;
+	ProfileMeasurement const*	GetNextSibling( ProfileMeasurement const &measurement ) const;
+	uint64_t					GetElapsedHPC() const;
+	ProfileCounter const*		GetCounter( uint index ) const;
+};
+
+struct ProfilerThreadContext
+{
+	char const			*name				= nullptr;
+	uint				 index				= 0;
+	std::atomic<bool>	 isReady			{ false };
+
+	// History ring of arenas; the one after the last committed is being written
+	ProfileFrame		*frames				= nullptr;
+	std::atomic<int>	 lastCommittedSlot	{ -1 };
+	std::atomic<uint64_t> committedCount	{ 0 };			// Commit index N lives in the slot N % MAX_HISTORY_COUNT
+
+	// Active Stack
+	ProfileFrame		*activeFrame		= nullptr;
+	uint16_t			 activeIndex		= INVALID_PROFILE_MEASUREMENT_INDEX;
+	uint				 skippedDepth		= 0;		// Pushes ignored while paused or full, their Pops are ignored too
+	bool				 commitsOnPop		= false;	// Frame was begun by a top level Push(), not by MarkFrame()
+};
@@ -57,10 +57,13 @@ ProfileConsole::ProfileConsole( Renderer* currentRenderer )
 
 	// Graph
 	m_frameGraph = new BarGraph( m_maxGraphRecordsNum );
+	m_graphRecords.resize( m_maxGraphRecordsNum );
+	m_frameToShow = new ProfileFrame();
 }
 
 ProfileConsole::~ProfileConsole()
 {
+	delete m_frameToShow;
 	delete m_frameGraph;
 }
 
@@ -83,9 +86,20 @@ void ProfileConsole::Update( InputSystem& currentInputSystem )
 	// If profiler isn't paused, Append last measurement to graph
 	if( Profiler::GetInstance()->IsPaused() == false )
 	{
-		ProfileMeasurement* lastFrameMeasure	= Profiler::GetInstance()->GetPreviousFrame();
-		double				lastFrameMS			= Profiler::GetMillliSecondsFromPerformanceCounter( lastFrameMeasure->GetElapsedHPC() );
-		m_frameGraph->AppendDataPoint( lastFrameMS, lastFrameMeasure );
+		Profiler			*profiler		= Profiler::GetInstance();
+		ProfileGraphRecord	 lastRecord;
+		lastRecord.threadIndex				= profiler->GetFrameThreadIndex();
+		uint64_t			 committedCount	= profiler->GetCommittedFrameCount( lastRecord.threadIndex );
+		lastRecord.commitIndex				= committedCount - 1U;
+
+		if( committedCount > 0 && profiler->CopyCommittedFrame( lastRecord.threadIndex, lastRecord.commitIndex, *m_frameToShow ) )
+		{
+			double lastFrameMS = Profiler::GetMillliSecondsFromPerformanceCounter( m_frameToShow->GetElapsedHPC() );
+			m_frameGraph->AppendDataPoint( lastFrameMS );
+
+			m_graphRecords[ m_graphRecordCount % m_maxGraphRecordsNum ] = lastRecord;
+			m_graphRecordCount++;
+		}
 	}
 
 	// Get skipIndex, if clicked on graph
@@ -103,16 +117,17 @@ void ProfileConsole::Update( InputSystem& currentInputSystem )
 		}
 	}
 
-	// Fetch Measurement from graph
-	DoubleAndVoidPointer dataPointFromGraph;
-	m_frameGraph->GetPreviousDataPoint( dataPointFromGraph, m_skipIndex );
+	// Fetch the frame of that bar from the profiler's history
+	if( (uint64_t)m_skipIndex >= m_graphRecordCount )
+		return;	// Report in that far history doesn't exists
+
+	ProfileGraphRecord const &recordToShow = m_graphRecords[ ( m_graphRecordCount - 1U - m_skipIndex ) % m_maxGraphRecordsNum ];
+	if( Profiler::GetInstance()->CopyCommittedFrame( recordToShow.threadIndex, recordToShow.commitIndex, *m_frameToShow ) == false )
+		return;	// Profiler has recycled it already
 
-	ProfileMeasurement* measureToShow = (ProfileMeasurement*) dataPointFromGraph.object;
+	ProfileFrame const*	frameToShow = m_frameToShow;
 	ProfileReport		reportToShow;
-	if( measureToShow != nullptr )
-		reportToShow.GenerateReportFromFrame( measureToShow, currentReportFormat );
-	else
-		return;	// Report in that far history doesn't exists
+	reportToShow.GenerateReportFromFrame( frameToShow, currentReportFormat );
 
 	// Do sorting on flat report
 	if( currentReportFormat == PROFILE_REPORT_FLAT )
@@ -131,6 +146,13 @@ void ProfileConsole::Update( InputSystem& currentInputSystem )
 	for ( uint i = 0; i < reportInStrings.size(); i++ )
 		m_profileReportString += ( reportInStrings[i] + "\n " );
 
+	// Counters of the frame, after its timings
+	for( uint i = 0; i < frameToShow->m_counterCount; i++ )
+	{
+		ProfileCounter const &counter = frameToShow->m_counters[i];
+		m_profileReportString += Stringf( "%s: %llu\n ", counter.id, (unsigned long long)counter.value );
+	}
+
 	// FPS
 	uint64_t frameHPC	= reportToShow.m_root->m_totalHPC;
 	m_frameTime			= Profiler::GetSecondsFromPerformanceCounter( frameHPC );
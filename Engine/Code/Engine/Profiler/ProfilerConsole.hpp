@@ -1,14 +1,23 @@
 #pragma once
+#include <vector>
 #include "Engine/Math/AABB2.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/Rgba.hpp"
 
 class Camera;
 class Renderer;
+class ProfileFrame;
 class BarGraph;
 class BitmapFont;
 class InputSystem;
 
+// Which committed frame of the profiler a bar of the graph stands for
+struct ProfileGraphRecord
+{
+	uint		threadIndex	= 0;
+	uint64_t	commitIndex	= 0;
+};
+
 class ProfileConsole
 {
 public:
@@ -41,6 +50,11 @@ private:
 	AABB2			 m_graphBounds;						// Render_GraphBox() calculates it
 	BarGraph		*m_frameGraph				= nullptr;
 
+	// The profiler recycles its history, so the graph refers to frames by commit index & the shown one gets copied
+	std::vector< ProfileGraphRecord >	m_graphRecords;					// Parallel to the data points of m_frameGraph
+	uint64_t							m_graphRecordCount	= 0;
+	ProfileFrame						*m_frameToShow		= nullptr;
+
 public:
 	void Update( InputSystem& currentInputSystem );
 	void Render();
@@ -24,14 +24,15 @@ ProfileReport::~ProfileReport()
 		delete m_root;
 }
 
-void ProfileReport::GenerateReportFromFrame( ProfileMeasurement *root, eProfileReportType reportType /* = PROFILE_REPORT_TREE */ )
+void ProfileReport::GenerateReportFromFrame( ProfileFrame const *frame, eProfileReportType reportType /* = PROFILE_REPORT_TREE */ )
 {
+	ProfileMeasurement const *root = frame->GetRoot();
 	m_root = new ProfileReportEntry( root->id );
 
 	if( reportType == PROFILE_REPORT_FLAT )
-		m_root->PopulateFlat( root );
+		m_root->PopulateFlat( *frame, root );
 	else
-		m_root->PopulateTree( root );
+		m_root->PopulateTree( *frame, root );
 }
 
 void ProfileReport::SortTree( eProfileReportSort sortType /*= PROFILE_REPORT_SORT_SELF_TIME */ )
@@ -26,7 +26,7 @@ public:
 	ProfileReportEntry *m_root	= nullptr;
 
 public:
-	void	GenerateReportFromFrame( ProfileMeasurement *root, eProfileReportType reportType = PROFILE_REPORT_TREE );
+	void	GenerateReportFromFrame( ProfileFrame const *frame, eProfileReportType reportType = PROFILE_REPORT_TREE );
 	void	SortTree( eProfileReportSort sortType = PROFILE_REPORT_SORT_SELF_TIME );
 	void	SortBySelfTime();
 	void	SortByTotalTime();
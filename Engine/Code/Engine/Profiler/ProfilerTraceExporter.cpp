@@ -0,0 +1,157 @@
+#pragma once
+#include "ProfilerTraceExporter.hpp"
+#include "Engine/Core/StringUtils.hpp"
+#include "Engine/Profiler/Profiler.hpp"
+
+ProfilerTraceExporter::ProfilerTraceExporter( Profiler &profiler, std::string const &filePath )
+	: m_profiler( profiler )
+	, m_filePath( filePath )
+{
+	m_frameCopy = new ProfileFrame();
+
+	if( m_file.Open( m_filePath, FILE_OPEN_MODE_TRUNCATE ) == false )
+	{
+		m_isFinished = true;
+		return;
+	}
+
+	m_file.Write( "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+
+	m_threadIndex = 0;
+	StartNextThread();
+}
+
+ProfilerTraceExporter::~ProfilerTraceExporter()
+{
+	if( m_file.IsOpen() )
+		m_file.Close();
+
+	delete m_frameCopy;
+	m_frameCopy = nullptr;
+}
+
+void ProfilerTraceExporter::Update( uint maxFramesToWrite /* = PROFILER_TRACE_FRAMES_PER_UPDATE */ )
+{
+	uint framesWrittenThisUpdate = 0;
+
+	while( m_isFinished == false && framesWrittenThisUpdate < maxFramesToWrite )
+	{
+		// Done with this thread, move on to the next one
+		if( m_nextCommitIndex >= m_endCommitIndex )
+		{
+			m_threadIndex++;
+			StartNextThread();
+			continue;
+		}
+
+		bool isCopied = m_profiler.CopyCommittedFrame( m_threadIndex, m_nextCommitIndex, *m_frameCopy );
+		m_nextCommitIndex++;
+
+		if( isCopied == false )
+			continue;
+
+		WriteFrame( *m_frameCopy );
+		framesWrittenThisUpdate++;
+	}
+}
+
+void ProfilerTraceExporter::StartNextThread()
+{
+	if( m_threadIndex >= m_profiler.GetThreadCount() )
+	{
+		Finish();
+		return;
+	}
+
+	// Whatever of this thread's history is there now; the slot after the last committed one is being written
+	m_endCommitIndex	= m_profiler.GetCommittedFrameCount( m_threadIndex );
+	m_nextCommitIndex	= ( m_endCommitIndex > MAX_HISTORY_COUNT - 1 ) ? ( m_endCommitIndex - (MAX_HISTORY_COUNT - 1) ) : 0U;
+
+	if( m_endCommitIndex > m_nextCommitIndex )
+		WriteThreadNameEvent( m_threadIndex );
+}
+
+void ProfilerTraceExporter::WriteThreadNameEvent( uint threadIndex )
+{
+	char const *threadName = m_profiler.GetThreadName( threadIndex );
+
+	std::string eventStr = m_isFirstEvent ? "" : ",\n";
+	eventStr += Stringf( "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", threadIndex );
+	AppendEscapedJSONString( eventStr, threadName != nullptr ? threadName : "Thread" );
+	eventStr += "}}";
+
+	m_file.Write( eventStr );
+	m_isFirstEvent = false;
+}
+
+void ProfilerTraceExporter::WriteFrame( ProfileFrame const &frame )
+{
+	// Measurements of a committed frame are all closed, so a linear walk is enough
+	std::string framesEventsStr;
+	framesEventsStr.reserve( frame.m_measurementCount * 96U );
+
+	for( uint i = 0; i < frame.m_measurementCount; i++ )
+	{
+		ProfileMeasurement const &measure = frame.m_measurements[i];
+
+		double startMicroSeconds	= Profiler::GetSecondsFromPerformanceCounter( measure.startHPC ) * 1000000.0;
+		double durationMicroSeconds	= Profiler::GetSecondsFromPerformanceCounter( measure.GetElapsedHPC() ) * 1000000.0;
+
+		if( m_isFirstEvent == false )
+			framesEventsStr += ",\n";
+
+		framesEventsStr += "{\"name\":";
+		AppendEscapedJSONString( framesEventsStr, measure.id );
+		framesEventsStr += Stringf( ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", frame.m_threadIndex, startMicroSeconds, durationMicroSeconds );
+
+		m_isFirstEvent = false;
+		m_eventsWritten++;
+	}
+
+	// Counters go at the start of the frame, as counter events
+	double frameStartMicroSeconds = Profiler::GetSecondsFromPerformanceCounter( frame.m_measurements[0].startHPC ) * 1000000.0;
+	for( uint i = 0; i < frame.m_counterCount; i++ )
+	{
+		ProfileCounter const &counter = frame.m_counters[i];
+
+		if( m_isFirstEvent == false )
+			framesEventsStr += ",\n";
+
+		framesEventsStr += "{\"name\":";
+		AppendEscapedJSONString( framesEventsStr, counter.id );
+		framesEventsStr += Stringf( ",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%llu}}", frame.m_threadIndex, frameStartMicroSeconds, (unsigned long long)counter.value );
+
+		m_isFirstEvent = false;
+		m_eventsWritten++;
+	}
+
+	m_file.Write( framesEventsStr );
+	m_framesWritten++;
+}
+
+void ProfilerTraceExporter::Finish()
+{
+	m_isFinished = true;
+
+	if( m_file.IsOpen() == false )
+		return;
+
+	m_file.Write( "\n]}\n" );
+	m_file.Close();
+}
+
+void ProfilerTraceExporter::AppendEscapedJSONString( std::string &out_json, char const *str )
+{
+	out_json += '"';
+
+	for( char const *c = str; c != nullptr && *c != '\0'; c++ )
+	{
+		if( *c == '"' || *c == '\\' )
+			out_json += '\\';
+
+		// Control characters aren't allowed inside JSON strings
+		out_json += ( (unsigned char)*c < 0x20 ) ? ' ' : *c;
+	}
+
+	out_json += '"';
+}
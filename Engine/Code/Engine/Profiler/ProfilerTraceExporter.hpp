@@ -0,0 +1,55 @@
+#pragma once
+#include <string>
+#include "Engine/File/File.hpp"
+#include "Engine/Core/EngineCommon.hpp"
+
+#define DEFAULT_PROFILER_TRACE_FILE_PATH		("Log/profiler_trace.json")
+#define PROFILER_TRACE_FRAMES_PER_UPDATE		(8)
+
+class Profiler;
+class ProfileFrame;
+
+//------------------------------------------------------------------------------------------
+// Streams the recorded profiler history to a Chrome Trace Event JSON file
+//	- Writes a few frames per Update(), so a long history doesn't stall the game loop
+//	- Frames committed after a thread's export started aren't in it; the ones recycled meanwhile get skipped
+//	- Open the file in chrome://tracing or ui.perfetto.dev
+//
+class ProfilerTraceExporter
+{
+public:
+	 ProfilerTraceExporter( Profiler &profiler, std::string const &filePath );
+	~ProfilerTraceExporter();
+
+private:
+	Profiler		&m_profiler;
+	File			 m_file;
+	std::string		 m_filePath;
+
+	// Progress - thread by thread, from the oldest frame to the newest one; by commit index, so frames committed meanwhile don't shift it
+	uint			 m_threadIndex		= 0;
+	uint64_t		 m_nextCommitIndex	= 0;
+	uint64_t		 m_endCommitIndex	= 0;		// Committed count of the thread, when its export started
+	ProfileFrame	*m_frameCopy		= nullptr;	// Frames get copied out first, the owning thread can keep going
+	bool			 m_isFirstEvent		= true;
+	bool			 m_isFinished		= false;
+	uint			 m_framesWritten	= 0;
+	uint			 m_eventsWritten	= 0;
+
+public:
+	bool inline			IsOpen() { return m_file.IsOpen(); }
+	bool inline			IsFinished() const { return m_isFinished; }
+	uint inline			GetFramesWritten() const { return m_framesWritten; }
+	uint inline			GetEventsWritten() const { return m_eventsWritten; }
+	std::string const&	GetFilePath() const { return m_filePath; }
+
+	void				Update( uint maxFramesToWrite = PROFILER_TRACE_FRAMES_PER_UPDATE );	// Closes the file once everything is written
+
+private:
+	void				StartNextThread();
+	void				WriteThreadNameEvent( uint threadIndex );
+	void				WriteFrame( ProfileFrame const &frame );
+	void				Finish();
+
+	static void			AppendEscapedJSONString( std::string &out_json, char const *str );
+};
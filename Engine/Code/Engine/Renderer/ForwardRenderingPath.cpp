@@ -1,5 +1,4 @@
 #pragma once
-#include <tuple>
 #include "ForwardRenderingPath.hpp"
 #include "Engine/Renderer/Shader.hpp"
 #include "Engine/Renderer/Texture.hpp"
@@ -13,10 +12,6 @@
 #include "Engine/Math/Vector3.hpp"
 #include "Engine/Profiler/Profiler.hpp"
 
-typedef std::tuple< float, unsigned int > ContributionLightIndexTuple;
-typedef std::vector< DrawCall > DrawCallList;
-typedef std::tuple< float, DrawCall > ZDistanceDrawcallTuple;
-
 ForwardRenderingPath::ForwardRenderingPath( Renderer &activeRenderer )
 	: m_renderer( activeRenderer )
 {
@@ -57,6 +52,12 @@ void ForwardRenderingPath::RenderSceneForCamera( Camera &camera, Scene &scene, V
 	if( shadowCameraAnchorPos != nullptr )
 		shadowAnchorPosition = *shadowCameraAnchorPos;
 
+	// Bring the scene's trees up to date with what moved
+	{
+		PROFILE_SCOPE( "Scene::UpdateSpatialIndex" );
+		scene.UpdateSpatialIndex();
+	}
+
 	if( camera.ShadowMapEnabled() )
 		RenderSceneForShadowMap( scene, shadowAnchorPosition );
 
@@ -71,11 +72,37 @@ void ForwardRenderingPath::RenderSceneForCamera( Camera &camera, Scene &scene, V
 
 	camera.PreRender( m_renderer );
 
-	// Generate draw calls
-	std::vector< DrawCall > drawCalls;
-	for ( uint renderableIdx = 0; renderableIdx < scene.m_renderables.size(); renderableIdx++ )
+	// Generate draw calls, with their sort keys
+	Matrix44	cameraModel		= camera.GetCameraModelMatrix();
+	Vector3		cameraPosition	= cameraModel.GetTColumn();
+	Vector3		cameraForward	= cameraModel.GetKColumn();
+
+	// Bin the lights for this camera
+	{
+		PROFILE_SCOPE( "LightClusterGrid::Build" );
+		m_lightClusterGrid.Build( camera, scene.m_lights );
+	}
+
+	// Only the renderables in the camera's frustum get draw calls
+	Matrix44 viewProjection;
+	viewProjection.Append( camera.GetProjectionMatrix() );
+	viewProjection.Append( camera.GetViewMatrix() );
+	{
+		PROFILE_SCOPE( "FrustumCuller::Cull" );
+		CullRenderables( scene, viewProjection );
+	}
+	PROFILE_COUNTER( "Camera: Visible Renderables", m_visibleRenderables.size() );
+	PROFILE_COUNTER( "Camera: Culled Renderables", scene.m_renderables.size() - m_visibleRenderables.size() );
+
+	m_renderQueue.Clear();
+	for ( uint visibleIdx = 0; visibleIdx < m_visibleRenderables.size(); visibleIdx++ )
 	{
-		Renderable *thisRenderable = scene.m_renderables[ renderableIdx ];
+		Renderable *thisRenderable = m_visibleRenderables[ visibleIdx ];
+
+		// For now, every materials uses light; all meshes of a renderable get the same ones
+		uint lightCount;
+		uint lightIndices[ MAX_LIGHTS ];
+		m_lightClusterGrid.GetMostContributingLights( thisRenderable->GetPosition(), lightCount, lightIndices );
 
 		// For each mesh in theRenderable, construct a drawcall
 		for( unsigned int mIdx = 0; mIdx < thisRenderable->m_meshes.size(); mIdx++ )
@@ -87,20 +114,24 @@ void ForwardRenderingPath::RenderSceneForCamera( Camera &camera, Scene &scene, V
 			DrawCall dc( *meshToAdd, *materialToAdd, transformToAdd );
 			dc.m_layer				= thisRenderable->GetRenderLayer( mIdx );
 			dc.m_queueTypeIsApha	= thisRenderable->IsAlphaQueueType( mIdx );
-			// For now, every materials uses light
-			SetMostContributingLights( dc.m_lightCount, dc.m_lightIndices, thisRenderable->GetPosition(), scene.m_lights );
+			dc.m_lightCount			= lightCount;
+			for( uint lIdx = 0; lIdx < lightCount; lIdx++ )
+				dc.m_lightIndices[ lIdx ] = lightIndices[ lIdx ];
 			
-			drawCalls.push_back( dc );
+			m_renderQueue.Add( dc, MakeSortKeyForCamera( dc, cameraPosition, cameraForward ) );
 		}
 	}
 
 	// Sort draw calls
-	SortDrawCallsForCamera( drawCalls, camera );
+	{
+		PROFILE_SCOPE( "RenderQueue::Sort" );
+		m_renderQueue.Sort();
+	}
 
 	// Render 'em
-	for( uint dcIdx = 0; dcIdx < drawCalls.size(); dcIdx++ )
+	for( uint dcIdx = 0; dcIdx < m_renderQueue.GetCount(); dcIdx++ )
 	{
-		DrawCall& dc = drawCalls[ dcIdx ];
+		DrawCall& dc = m_renderQueue.GetSorted( dcIdx );
 
 		// Draw for each Shaders present in ShaderGroup
 		uint shaderGroupSize = (uint) dc.m_material->m_shaderGroup.size();
@@ -153,8 +184,17 @@ void ForwardRenderingPath::RenderSceneForShadowMap( Scene &scene, Vector3 const
 		m_renderer.ClearDepth( 1.0f ); 
 		m_renderer.EnableDepth( COMPARE_LESS, true );
 
-		for each (Renderable* thisRenderable in scene.m_renderables)
+		// Casters outside of the light's box can't throw a shadow in to it
 		{
+			PROFILE_SCOPE( "FrustumCuller::Cull" );
+			CullRenderables( scene, viewProjMat );
+		}
+		PROFILE_COUNTER( "Shadow: Visible Renderables", m_visibleRenderables.size() );
+		PROFILE_COUNTER( "Shadow: Culled Renderables", scene.m_renderables.size() - m_visibleRenderables.size() );
+
+		for( uint visibleIdx = 0; visibleIdx < m_visibleRenderables.size(); visibleIdx++ )
+		{
+			Renderable *thisRenderable = m_visibleRenderables[ visibleIdx ];
 			for( unsigned int mIdx = 0; mIdx < thisRenderable->m_meshes.size(); mIdx++ )
 			{
 				// Setup a drawcall
@@ -171,130 +211,52 @@ void ForwardRenderingPath::RenderSceneForShadowMap( Scene &scene, Vector3 const
 	}
 }
 
-void ForwardRenderingPath::SetMostContributingLights( unsigned int &lightCount, unsigned int ( &effectiveLightIndices )[MAX_LIGHTS], Vector3 const &renderablePosition, std::vector< Light* > &lightsInScene ) const
+void ForwardRenderingPath::CullRenderables( Scene const &scene, Matrix44 const &viewProjection ) const
 {
-	PROFILE_SCOPE_FUNCTION();
+	m_frustumCuller.SetViewProjection( viewProjection );
+	m_frustumCuller.Clear();
+	m_candidateRenderables.clear();
+	m_boundedRenderables.clear();
+	m_visibleRenderables.clear();
 
-	lightCount = 0;
+	// Tree skips the branches out of the frustum; its fat boxes are loose, so the candidates get culled by their own bounds
+	scene.QueryRenderablesInFrustum( m_frustumCuller.GetPlanes(), FRUSTUM_PLANE_COUNT, m_candidateRenderables );
 
-	// Get all the lightSources to sort
-	std::vector< ContributionLightIndexTuple > lightSourcesToSort;
-	for( unsigned int idx = 0; idx < lightsInScene.size(); idx++ )
+	// Renderables without bounds always get drawn; the rest go in the culler, in order
+	for( uint candidateIdx = 0; candidateIdx < m_candidateRenderables.size(); candidateIdx++ )
 	{
-		Light* thisLight		= lightsInScene[idx];
-		float lightContribution = thisLight->GetAttenuationForRenderableAt( renderablePosition );
+		Renderable *renderable = m_candidateRenderables[ candidateIdx ];
 
-		ContributionLightIndexTuple thisTuple = std::make_tuple( lightContribution, idx );
-		lightSourcesToSort.push_back( thisTuple );
-	}
-
-	// Bubble Sort
-	int n = (int) lightSourcesToSort.size();
-	for( int i = 0; i < n - 1; i++ )
-	{
-		for( int j = 0; j < n-i-1; j++ )
+		AABB3	worldBounds;
+		Sphere	worldBoundingSphere;
+		if( renderable->GetWorldBounds( worldBounds, worldBoundingSphere ) == false )
 		{
-			float aLightsContribution = std::get<0>( lightSourcesToSort[j] );
-			float bLightsContribution = std::get<0>( lightSourcesToSort[j+1] );
-			if( aLightsContribution < bLightsContribution )
-			{
-				// Swap these two tuples
-				ContributionLightIndexTuple temp = lightSourcesToSort[j];
-				lightSourcesToSort[j]		= lightSourcesToSort[j+1];
-				lightSourcesToSort[j+1]		= temp;
-			}
+			m_visibleRenderables.push_back( renderable );
+			continue;
 		}
-	}
 
-	// Out sorted lights and the count
-	for( int i = 0; i < lightSourcesToSort.size() && i < MAX_LIGHTS; i++ )
-	{
-		effectiveLightIndices[i] = std::get<1>( lightSourcesToSort[i] );
-		lightCount++;
+		m_frustumCuller.Add( worldBounds, worldBoundingSphere );
+		m_boundedRenderables.push_back( renderable );
 	}
-}
 
-void ForwardRenderingPath::SortDrawCallsForCamera( std::vector<DrawCall> &drawCallsToSort, Camera &camera ) const
-{
-	PROFILE_SCOPE_FUNCTION();
-
-	// Separate all the layers in different vectors
-	std::map< unsigned int , DrawCallList > layersAndDrawCalls;
-	while( drawCallsToSort.size() > 0 )
-	{
-		DrawCall lastDrawCall = drawCallsToSort.back();
-		drawCallsToSort.pop_back();
-
-		layersAndDrawCalls[ lastDrawCall.m_layer ].push_back( lastDrawCall );
-	}
-
-	// For each layer
-	for( std::map< unsigned int, DrawCallList >::iterator itLayer = layersAndDrawCalls.begin(); itLayer != layersAndDrawCalls.end(); itLayer++ )
-	{
-		DrawCallList& itDrawCallList = itLayer->second;
-		// For each draw call in that layer
-		for( unsigned int i = 0; i < itDrawCallList.size(); i++ )
-		{
-			// Sort for Opaque
-			DrawCall &drawCallOfThisLayer = itDrawCallList[i];
-			if( drawCallOfThisLayer.m_queueTypeIsApha == false )
-			{
-				drawCallsToSort.push_back( drawCallOfThisLayer );
-				itDrawCallList.erase( itDrawCallList.begin() + i );
-				i--;
-			}
-		}
-
-		// For remaining alpha draw calls in that layer, sort 'em
-		SortAlphaDrawCallsForCameraZ( itDrawCallList, camera );
-		
-		for( unsigned int i = 0; i < itDrawCallList.size(); i++ )
-		{
-			drawCallsToSort.push_back( itDrawCallList[i] );
-		}
-	}
+	m_frustumCuller.Cull();
+	for( uint i = 0; i < m_frustumCuller.GetVisibleCount(); i++ )
+		m_visibleRenderables.push_back( m_boundedRenderables[ m_frustumCuller.GetVisibleIndex( i ) ] );
 }
 
-void ForwardRenderingPath::SortAlphaDrawCallsForCameraZ( std::vector< DrawCall > &drawCallsToSort, Camera &camera ) const
+RenderSortKey ForwardRenderingPath::MakeSortKeyForCamera( DrawCall const &dc, Vector3 const &cameraPosition, Vector3 const &cameraForward ) const
 {
-	// Create vector to sort it
-	std::vector< ZDistanceDrawcallTuple > drawCallTuplesToSort;
-	while( drawCallsToSort.size() > 0 )
-	{
-		DrawCall& toPush	= drawCallsToSort.back();
-		Vector3 direction	= toPush.m_model.GetTColumn() - camera.GetCameraModelMatrix().GetTColumn();
-		Vector3 cameraZ		= camera.GetCameraModelMatrix().GetKColumn();
-		float	projection	= Vector3::DotProduct( direction, cameraZ );
+	// Distance along the camera's forward
+	Vector3	direction	= dc.m_model.GetTColumn() - cameraPosition;
+	float	depth		= Vector3::DotProduct( direction, cameraForward );
 
-		ZDistanceDrawcallTuple tupleToPush = std::make_tuple( projection, toPush );
-		drawCallTuplesToSort.push_back( tupleToPush );
-
-		drawCallsToSort.pop_back();
-	}
+	uint shaderID	= GetRenderSortID( dc.m_material->GetShader() );
+	uint materialID	= GetRenderSortID( dc.m_material );
 
-	// Bubble Sort
-	int n = (int) drawCallTuplesToSort.size();
-	for( int i = 0; i < n - 1; i++ )
-	{
-		for( int j = 0; j < n-i-1; j++ )
-		{
-			float aDrawCallDistance = std::get<0>( drawCallTuplesToSort[j] );
-			float bDrawCallDistance = std::get<0>( drawCallTuplesToSort[j+1] );
-			if( aDrawCallDistance < bDrawCallDistance )
-			{
-				// Swap these two tuples
-				ZDistanceDrawcallTuple temp = drawCallTuplesToSort[j];
-				drawCallTuplesToSort[j]		= drawCallTuplesToSort[j+1];
-				drawCallTuplesToSort[j+1]	= temp;
-			}
-		}
-	}
-
-	// Add all sorted DrawCalls to the out vector
-	for( int i = 0; i < drawCallTuplesToSort.size(); i++ )
-	{
-		drawCallsToSort.push_back( std::get<1>( drawCallTuplesToSort[i] ) );
-	}
+	if( dc.m_queueTypeIsApha )
+		return MakeAlphaSortKey( dc.m_layer, shaderID, materialID, depth );
+	else
+		return MakeOpaqueSortKey( dc.m_layer, shaderID, materialID, GetRenderSortID( dc.m_mesh ), depth );
 }
 
 void ForwardRenderingPath::EnableLightsForDrawCall( DrawCall &dc, std::vector< Light* > &allLights ) const
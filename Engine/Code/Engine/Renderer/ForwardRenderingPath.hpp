@@ -2,6 +2,9 @@
 #include <vector>
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Renderer/DrawCall.hpp"
+#include "Engine/Renderer/RenderQueue.hpp"
+#include "Engine/Renderer/LightClusterGrid.hpp"
+#include "Engine/Renderer/FrustumCuller.hpp"
 
 class Scene;
 class Light;
@@ -11,6 +14,8 @@ class Renderer;
 class Vector3;
 class Sampler;
 class Shader;
+class Matrix44;
+class Renderable;
 
 class ForwardRenderingPath 
 {
@@ -27,14 +32,21 @@ public:
 	Texture		*m_shadowDepthTarget	= nullptr;
 	float		 m_shadowCameraPullback = 20.f;			// How much the shadow-camera gets pulled back from anchor position, if passed
 
+private:
+	mutable RenderQueue			m_renderQueue;			// Draw calls of the camera being rendered; reused every frame
+	mutable LightClusterGrid	m_lightClusterGrid;		// Lights of the camera being rendered
+	mutable FrustumCuller		m_frustumCuller;		// Renderables of the camera, or the light, being rendered
+	mutable std::vector< Renderable* >	m_candidateRenderables;	// From the scene's tree, by their fat bounds
+	mutable std::vector< Renderable* >	m_boundedRenderables;	// Ones in the culler, in its order
+	mutable std::vector< Renderable* >	m_visibleRenderables;	// Which passed the culling
+
 public:
 	void RenderScene( Scene &scene, Vector3 const *shadowCameraAnchorPos = nullptr ) const;								// Renders scene for all of its cameras
 	void RenderSceneForCamera( Camera &camera, Scene &scene, Vector3 const *shadowCameraAnchorPos = nullptr ) const;	// Renders scene for the provided camera
 	void RenderSceneForShadowMap( Scene &scene, Vector3 const &cameraAnchorPosition ) const;
 
 private:
-	void SetMostContributingLights( unsigned int &lightCount, unsigned int (&effectiveLightIndices)[MAX_LIGHTS], Vector3 const &renderablePosition, std::vector< Light* > &lightsInScene ) const;
-	void SortDrawCallsForCamera( std::vector< DrawCall > &drawCallsToSort, Camera &camera ) const;
-	void SortAlphaDrawCallsForCameraZ( std::vector< DrawCall > &drawCallsToSort, Camera &camera ) const;
+	void CullRenderables( Scene const &scene, Matrix44 const &viewProjection ) const;		// Fills m_visibleRenderables; call Scene::UpdateSpatialIndex() first
+	RenderSortKey MakeSortKeyForCamera( DrawCall const &dc, Vector3 const &cameraPosition, Vector3 const &cameraForward ) const;
 	void EnableLightsForDrawCall( DrawCall &dc, std::vector< Light* > &allLights ) const;
 };
\ No newline at end of file
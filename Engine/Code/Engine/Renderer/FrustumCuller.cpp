@@ -0,0 +1,291 @@
+#pragma once
+#include "FrustumCuller.hpp"
+#include <math.h>
+#include "Engine/Core/Clock.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Math/Vector4.hpp"
+#include "Engine/Math/MathUtil.hpp"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE__)
+	#define FRUSTUM_CULLER_USE_SSE
+	#include <xmmintrin.h>
+#endif
+
+void FrustumCuller::SetViewProjection( Matrix44 const &viewProjection )
+{
+	// Rows of the matrix; a point is inside if -w <= x, y, z <= w in clip space
+	Matrix44 const &m = viewProjection;
+	Vector4 rowX = Vector4( m.Ix, m.Jx, m.Kx, m.Tx );
+	Vector4 rowY = Vector4( m.Iy, m.Jy, m.Ky, m.Ty );
+	Vector4 rowZ = Vector4( m.Iz, m.Jz, m.Kz, m.Tz );
+	Vector4 rowW = Vector4( m.Iw, m.Jw, m.Kw, m.Tw );
+
+	Vector4 planes[ FRUSTUM_PLANE_COUNT ] =
+	{
+		rowW + rowX,		// Left
+		rowW - rowX,		// Right
+		rowW + rowY,		// Bottom
+		rowW - rowY,		// Top
+		rowW + rowZ,		// Near
+		rowW - rowZ			// Far
+	};
+
+	// ax + by + cz + w >= 0 is inside; normalized, so distances are in world units
+	for( uint i = 0; i < FRUSTUM_PLANE_COUNT; i++ )
+	{
+		Vector3	normal		= Vector3( planes[i].x, planes[i].y, planes[i].z );
+		float	length		= normal.GetLength();
+		float	inverseLen	= ( length > 0.f ) ? ( 1.f / length ) : 0.f;
+
+		m_planes[i] = Plane3( normal * inverseLen, -planes[i].w * inverseLen );
+	}
+}
+
+void FrustumCuller::Clear()
+{
+	m_centersX.clear();
+	m_centersY.clear();
+	m_centersZ.clear();
+	m_radii.clear();
+	m_boxes.clear();
+	m_visibleIndices.clear();
+}
+
+uint FrustumCuller::Add( AABB3 const &bounds, Sphere const &boundingSphere )
+{
+	m_centersX.push_back( boundingSphere.center.x );
+	m_centersY.push_back( boundingSphere.center.y );
+	m_centersZ.push_back( boundingSphere.center.z );
+	m_radii.push_back( boundingSphere.radius );
+	m_boxes.push_back( bounds );
+
+	return (uint)m_radii.size() - 1U;
+}
+
+void FrustumCuller::Cull()
+{
+	m_visibleIndices.clear();
+
+	uint count = GetCount();
+	for( uint firstIdx = 0; firstIdx < count; firstIdx += 4U )
+	{
+		uint outsideMask;
+		uint crossingMask;
+		TestSpheres( firstIdx, outsideMask, crossingMask );
+
+		uint laneCount = ( count - firstIdx < 4U ) ? ( count - firstIdx ) : 4U;
+		for( uint lane = 0; lane < laneCount; lane++ )
+		{
+			uint laneBit = 1U << lane;
+			if( outsideMask & laneBit )
+				continue;
+
+			if( (crossingMask & laneBit) && IsBoxOutside( m_boxes[ firstIdx + lane ] ) )
+				continue;
+
+			m_visibleIndices.push_back( firstIdx + lane );
+		}
+	}
+}
+
+bool FrustumCuller::IsVisible( AABB3 const &bounds, Sphere const &boundingSphere ) const
+{
+	bool isCrossing = false;
+	for( uint i = 0; i < FRUSTUM_PLANE_COUNT; i++ )
+	{
+		float distance = m_planes[i].GetDistanceFromPoint( boundingSphere.center );
+		if( distance < -boundingSphere.radius )
+			return false;
+
+		isCrossing = isCrossing || ( distance < boundingSphere.radius );
+	}
+
+	return ( isCrossing == false ) || ( IsBoxOutside( bounds ) == false );
+}
+
+void FrustumCuller::TestSpheres( uint firstIdx, uint &outsideMask, uint &crossingMask ) const
+{
+	// The last batch might not have all four; pad it with spheres which don't matter
+	float const *centersX	= &m_centersX[ firstIdx ];
+	float const *centersY	= &m_centersY[ firstIdx ];
+	float const *centersZ	= &m_centersZ[ firstIdx ];
+	float const *radii		= &m_radii[ firstIdx ];
+
+	float paddedX[4], paddedY[4], paddedZ[4], paddedRadii[4];
+	uint  laneCount = GetCount() - firstIdx;
+	if( laneCount < 4U )
+	{
+		for( uint lane = 0; lane < 4U; lane++ )
+		{
+			paddedX[ lane ]		= ( lane < laneCount ) ? centersX[ lane ]	: 0.f;
+			paddedY[ lane ]		= ( lane < laneCount ) ? centersY[ lane ]	: 0.f;
+			paddedZ[ lane ]		= ( lane < laneCount ) ? centersZ[ lane ]	: 0.f;
+			paddedRadii[ lane ]	= ( lane < laneCount ) ? radii[ lane ]		: 0.f;
+		}
+
+		centersX	= paddedX;
+		centersY	= paddedY;
+		centersZ	= paddedZ;
+		radii		= paddedRadii;
+	}
+
+#ifdef FRUSTUM_CULLER_USE_SSE
+	__m128 x			= _mm_loadu_ps( centersX );
+	__m128 y			= _mm_loadu_ps( centersY );
+	__m128 z			= _mm_loadu_ps( centersZ );
+	__m128 radius		= _mm_loadu_ps( radii );
+	__m128 negRadius	= _mm_sub_ps( _mm_setzero_ps(), radius );
+	__m128 isOutside	= _mm_setzero_ps();
+	__m128 isCrossing	= _mm_setzero_ps();
+
+	for( uint i = 0; i < FRUSTUM_PLANE_COUNT; i++ )
+	{
+		Plane3 const &plane = m_planes[i];
+
+		__m128 distance	= _mm_mul_ps( x, _mm_set1_ps( plane.normal.x ) );
+		distance		= _mm_add_ps( distance, _mm_mul_ps( y, _mm_set1_ps( plane.normal.y ) ) );
+		distance		= _mm_add_ps( distance, _mm_mul_ps( z, _mm_set1_ps( plane.normal.z ) ) );
+		distance		= _mm_sub_ps( distance, _mm_set1_ps( plane.d ) );
+
+		isOutside		= _mm_or_ps( isOutside,  _mm_cmplt_ps( distance, negRadius ) );
+		isCrossing		= _mm_or_ps( isCrossing, _mm_cmplt_ps( distance, radius ) );
+	}
+
+	outsideMask		= (uint)_mm_movemask_ps( isOutside );
+	crossingMask	= (uint)_mm_movemask_ps( isCrossing );
+#else
+	outsideMask		= 0U;
+	crossingMask	= 0U;
+	for( uint lane = 0; lane < 4U; lane++ )
+	{
+		for( uint i = 0; i < FRUSTUM_PLANE_COUNT; i++ )
+		{
+			Plane3 const	&plane		= m_planes[i];
+			float			 distance	= centersX[ lane ] * plane.normal.x + centersY[ lane ] * plane.normal.y + centersZ[ lane ] * plane.normal.z - plane.d;
+
+			outsideMask		|= ( distance < -radii[ lane ] )	? ( 1U << lane ) : 0U;
+			crossingMask	|= ( distance <  radii[ lane ] )	? ( 1U << lane ) : 0U;
+		}
+	}
+#endif
+}
+
+bool FrustumCuller::IsBoxOutside( AABB3 const &bounds ) const
+{
+	for( uint i = 0; i < FRUSTUM_PLANE_COUNT; i++ )
+	{
+		// Corner farthest along the normal; if even that's behind, all of it is
+		Plane3 const &plane = m_planes[i];
+		float cornerX = ( plane.normal.x >= 0.f ) ? bounds.maxs.x : bounds.mins.x;
+		float cornerY = ( plane.normal.y >= 0.f ) ? bounds.maxs.y : bounds.mins.y;
+		float cornerZ = ( plane.normal.z >= 0.f ) ? bounds.maxs.z : bounds.mins.z;
+
+		if( cornerX * plane.normal.x + cornerY * plane.normal.y + cornerZ * plane.normal.z - plane.d < 0.f )
+			return true;
+	}
+
+	return false;
+}
+
+void FrustumCullBenchmark( Command &cmd )
+{
+	std::string objectCountStr	= cmd.GetNextString();
+	std::string iterationsStr	= cmd.GetNextString();
+	uint		objectCount		= ( objectCountStr != "" )	? (uint) atoi( objectCountStr.c_str() )	: 20000U;
+	uint		iterations		= ( iterationsStr != "" )	? (uint) atoi( iterationsStr.c_str() )	: 50U;
+	if( objectCount == 0U || iterations == 0U )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "frustum_cull_benchmark: object count & iterations can't be ZERO!" );
+		return;
+	}
+
+	// Camera at the origin, looking down +Z; objects all around it, some long & thin
+	Matrix44 viewProjection = Matrix44::MakePerspective3D( 60.f, 16.f / 9.f, 0.1f, 250.f );
+
+	uint randomState = 1U;
+
+	std::vector< AABB3 >	boxes	( objectCount );
+	std::vector< Sphere >	spheres	( objectCount );
+	for( uint i = 0; i < objectCount; i++ )
+	{
+		Vector3 center		= Vector3( GetSeededRandomFloatInRange( randomState, -300.f, 300.f ), GetSeededRandomFloatInRange( randomState, -50.f, 50.f ), GetSeededRandomFloatInRange( randomState, -300.f, 300.f ) );
+		Vector3 halfSize	= Vector3( GetSeededRandomFloatInRange( randomState, 0.2f, 3.f ), GetSeededRandomFloatInRange( randomState, 0.2f, 3.f ), GetSeededRandomFloatInRange( randomState, 0.2f, 3.f ) );
+		if( GetSeededRandomUInt( randomState ) % 8U == 0U )
+			halfSize.x *= 20.f;
+
+		boxes[i]	= AABB3( center - halfSize, center + halfSize );
+		spheres[i]	= Sphere( center, halfSize.GetLength() );
+	}
+
+	// Batched, with the SIMD; Add() is counted too, as the renderer does it every frame
+	FrustumCuller culler;
+	culler.SetViewProjection( viewProjection );
+
+	double batchedSeconds = 0.0;
+	for( uint iteration = 0; iteration <= iterations; iteration++ )
+	{
+		uint64_t startHPC = Clock::GetCurrentHPC();
+		culler.Clear();
+		for( uint i = 0; i < objectCount; i++ )
+			culler.Add( boxes[i], spheres[i] );
+		culler.Cull();
+
+		if( iteration > 0U )
+			batchedSeconds += Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+	}
+
+	// One at a time
+	std::vector< bool > isVisible( objectCount );
+	double singleSeconds = 0.0;
+	for( uint iteration = 0; iteration <= iterations; iteration++ )
+	{
+		uint64_t startHPC = Clock::GetCurrentHPC();
+		for( uint i = 0; i < objectCount; i++ )
+			isVisible[i] = culler.IsVisible( boxes[i], spheres[i] );
+
+		if( iteration > 0U )
+			singleSeconds += Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+	}
+
+	// Both should keep the same ones; and a culled box can't have a corner inside of the clip space
+	uint mismatchCount		= 0U;
+	uint wronglyCulledCount	= 0U;
+	uint visibleIdx			= 0U;
+	for( uint i = 0; i < objectCount; i++ )
+	{
+		bool isKeptByBatch = ( visibleIdx < culler.GetVisibleCount() ) && ( culler.GetVisibleIndex( visibleIdx ) == i );
+		if( isKeptByBatch )
+			visibleIdx++;
+
+		if( isKeptByBatch != isVisible[i] )
+			mismatchCount++;
+
+		if( isKeptByBatch )
+			continue;
+
+		for( uint corner = 0; corner < 8U; corner++ )
+		{
+			Vector3 position	= Vector3(	( corner & 1U ) ? boxes[i].maxs.x : boxes[i].mins.x,
+											( corner & 2U ) ? boxes[i].maxs.y : boxes[i].mins.y,
+											( corner & 4U ) ? boxes[i].maxs.z : boxes[i].mins.z );
+			Vector4 clip		= viewProjection.Multiply( Vector4( position.x, position.y, position.z, 1.f ) );
+			bool	isInside	= fabsf( clip.x ) <= clip.w && fabsf( clip.y ) <= clip.w && fabsf( clip.z ) <= clip.w;
+			if( isInside )
+			{
+				wronglyCulledCount++;
+				break;
+			}
+		}
+	}
+
+	double usPerIteration = 1000000.0 / (double)iterations;
+	ConsolePrintf( "frustum_cull_benchmark: %u objects, %u iterations", objectCount, iterations );
+#ifdef FRUSTUM_CULLER_USE_SSE
+	ConsolePrintf( "  Batched, SSE  %9.1f us, %7.4f us per object", batchedSeconds * usPerIteration, batchedSeconds * usPerIteration / (double)objectCount );
+#else
+	ConsolePrintf( "  Batched       %9.1f us, %7.4f us per object", batchedSeconds * usPerIteration, batchedSeconds * usPerIteration / (double)objectCount );
+#endif
+	ConsolePrintf( "  One at a time %9.1f us, %7.4f us per object", singleSeconds * usPerIteration, singleSeconds * usPerIteration / (double)objectCount );
+	ConsolePrintf( ( mismatchCount == 0U && wronglyCulledCount == 0U ) ? RGBA_WHITE_COLOR : RGBA_RED_COLOR, "  %u visible, %u culled; %u kept differently, %u culled with a corner in view",
+				   culler.GetVisibleCount(), objectCount - culler.GetVisibleCount(), mismatchCount, wronglyCulledCount );
+}
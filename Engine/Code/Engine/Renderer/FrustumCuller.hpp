@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Input/Command.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/Sphere.hpp"
+#include "Engine/Math/Plane3.hpp"
+#include "Engine/Math/Matrix44.hpp"
+
+#define FRUSTUM_PLANE_COUNT		(6U)
+
+//------------------------------------------------------------------------------------------
+// Culls bounds against the six planes of a view-projection, in batches
+//	- Bounds get added every frame; Cull() then lists the indices of the visible ones, in the order they got added
+//	- Spheres go first, four at a time with SSE ( one at a time, if it isn't there ): outside of any plane is culled
+//	- A sphere crossing a plane gets its box tested too, with its most inside corner; so a long thin mesh isn't kept for nothing
+//	- Conservative: something crossing the corner of two planes may be kept, but nothing visible is ever culled
+//
+class FrustumCuller
+{
+public:
+	 FrustumCuller() { }
+	~FrustumCuller() { }
+
+private:
+	Plane3					m_planes[ FRUSTUM_PLANE_COUNT ];	// Normals face inside: left, right, bottom, top, near, far
+
+	// Bounds, as structure of arrays for the SIMD
+	std::vector< float >	m_centersX;
+	std::vector< float >	m_centersY;
+	std::vector< float >	m_centersZ;
+	std::vector< float >	m_radii;
+	std::vector< AABB3 >	m_boxes;
+	std::vector< uint >		m_visibleIndices;					// Of the last Cull()
+
+public:
+	void	SetViewProjection( Matrix44 const &viewProjection );	// Extracts the planes; Z of the clip space is in [ -w, w ]
+
+	void	Clear();												// Keeps the memory, for the next frame
+	uint	Add( AABB3 const &bounds, Sphere const &boundingSphere );	// Returns its index
+	void	Cull();
+
+	bool	IsVisible( AABB3 const &bounds, Sphere const &boundingSphere ) const;	// Just one, no batching
+
+	inline uint				GetCount() const					{ return (uint)m_radii.size(); }
+	inline uint				GetVisibleCount() const				{ return (uint)m_visibleIndices.size(); }
+	inline uint				GetVisibleIndex( uint idx ) const	{ return m_visibleIndices[ idx ]; }		// As returned by Add()
+	inline Plane3 const&	GetPlane( uint idx ) const			{ return m_planes[ idx ]; }
+	inline Plane3 const*	GetPlanes() const					{ return m_planes; }		// FRUSTUM_PLANE_COUNT of them
+
+private:
+	void	TestSpheres( uint firstIdx, uint &outsideMask, uint &crossingMask ) const;	// Four of them, from firstIdx; a bit per sphere
+	bool	IsBoxOutside( AABB3 const &bounds ) const;
+};
+
+
+// Console Commands
+void FrustumCullBenchmark( Command &cmd );			// frustum_cull_benchmark [objectCount=20000] [iterations=50]
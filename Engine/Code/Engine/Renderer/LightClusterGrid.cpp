@@ -0,0 +1,551 @@
+#pragma once
+#include "LightClusterGrid.hpp"
+#include <math.h>
+#include <string.h>
+#include <float.h>
+#include <tuple>
+#include "Engine/Core/Clock.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Math/Vector4.hpp"
+#include "Engine/Math/MathUtil.hpp"
+#include "Engine/Renderer/Light.hpp"
+#include "Engine/Renderer/Camera.hpp"
+
+// Keeps the top lights sorted, most contributing first; ties keep the lower index first, like a stable sort would
+static inline void InsertIntoMostContributing( float contribution, uint lightIdx, float (&contributions)[MAX_LIGHTS], uint (&lightIndices)[MAX_LIGHTS], uint &lightCount )
+{
+	if( lightCount == MAX_LIGHTS && (contribution > contributions[ MAX_LIGHTS - 1U ]) == false )
+		return;
+
+	uint slot = ( lightCount < MAX_LIGHTS ) ? lightCount++ : MAX_LIGHTS - 1U;
+	while( slot > 0U && contributions[ slot - 1U ] < contribution )
+	{
+		contributions[ slot ]	= contributions[ slot - 1U ];
+		lightIndices[ slot ]	= lightIndices[ slot - 1U ];
+		slot--;
+	}
+
+	contributions[ slot ]	= contribution;
+	lightIndices[ slot ]	= lightIdx;
+}
+
+// Out of range lights get skipped before the square root; a cluster has way more of them than the ones in range
+static inline void RankLight( ClusteredLight const &light, uint lightIdx, Vector3 const &position, float (&contributions)[MAX_LIGHTS], uint (&lightIndices)[MAX_LIGHTS], uint &lightCount )
+{
+	float dx = light.position.x - position.x;
+	float dy = light.position.y - position.y;
+	float dz = light.position.z - position.z;
+	float distanceSquared = dx * dx + dy * dy + dz * dz;
+	if( distanceSquared > light.range * light.range )
+		return;
+
+	// Same as GetContribution(), without the Vector3 temporaries
+	float distance		= sqrtf( distanceSquared );
+	float contribution	= light.intensity / ( light.attenuation.x + distance * light.attenuation.y + distance * distance * light.attenuation.z );
+	InsertIntoMostContributing( contribution, lightIdx, contributions, lightIndices, lightCount );
+}
+
+static inline float GetDistanceSquaredOutside( float value, FloatRange const &range )
+{
+	float distance = ( value < range.min ) ? range.min - value : ( value > range.max ) ? value - range.max : 0.f;
+	return distance * distance;
+}
+
+static inline uint GetTileFromNDC( float ndc, uint tileCount )
+{
+	int tile = (int) floorf( (ndc + 1.f) * 0.5f * (float)tileCount );
+	tile = ( tile < 0 ) ? 0 : tile;
+	tile = ( tile > (int)tileCount - 1 ) ? (int)tileCount - 1 : tile;
+
+	return (uint)tile;
+}
+
+float LightClusterGrid::GetContribution( ClusteredLight const &light, Vector3 const &position )
+{
+	float const distanceFromLight	= (light.position - position).GetLength();
+
+	float const a = light.attenuation.x;
+	float const b = distanceFromLight * light.attenuation.y;
+	float const c = distanceFromLight * distanceFromLight * light.attenuation.z;
+
+	return light.intensity / ( a + b + c );
+}
+
+float LightClusterGrid::GetRange( float intensity, Vector3 const &attenuation )
+{
+	// Where intensity / ( a + b.d + c.d^2 ) comes down to the min contribution
+	float const a = attenuation.x;
+	float const b = attenuation.y;
+	float const c = attenuation.z;
+	float const k = intensity / LIGHT_CLUSTER_MIN_CONTRIBUTION;
+
+	if( (a < k) == false )
+		return 0.f;
+
+	if( c > 0.f )
+	{
+		float const b2	= (b > 0.f) ? b : 0.f;
+		return ( -b2 + sqrtf( b2 * b2 + 4.f * c * (k - a) ) ) / ( 2.f * c );
+	}
+	else if( b > 0.f )
+		return ( k - a ) / b;
+	else
+		return FLT_MAX;
+}
+
+void LightClusterGrid::Build( Camera const &camera, std::vector< Light* > const &lights )
+{
+	BeginBuild( camera.GetViewMatrix(), camera.GetProjectionMatrix(), camera.GetCameraNear(), camera.GetCameraFar() );
+
+	for( uint lightIdx = 0; lightIdx < lights.size(); lightIdx++ )
+	{
+		Light const *light = lights[ lightIdx ];
+		AddLight( light->GetPosition(), light->m_lightColorAndIntensity.w, light->m_attenuation );
+	}
+
+	EndBuild();
+}
+
+void LightClusterGrid::BeginBuild( Matrix44 const &viewMatrix, Matrix44 const &projectionMatrix, float nearZ, float farZ )
+{
+	bool projectionChanged	= ( m_projectionMatrix == projectionMatrix ) == false || nearZ != m_nearZ || farZ != m_farZ || m_sliceDepthRanges.empty();
+
+	m_viewMatrix			= viewMatrix;
+	m_projectionMatrix		= projectionMatrix;
+	m_nearZ					= nearZ;
+	m_farZ					= farZ;
+	m_hasClusters			= farZ > nearZ;
+	m_isDepthExponential	= m_hasClusters && nearZ > 0.f;
+
+	if( m_isDepthExponential )
+		m_depthSliceScale	= (float)LIGHT_CLUSTER_COUNT_Z / logf( farZ / nearZ );
+	else if( m_hasClusters )
+		m_depthSliceScale	= (float)LIGHT_CLUSTER_COUNT_Z / ( farZ - nearZ );
+	else
+		m_depthSliceScale	= 0.f;
+
+	if( projectionChanged && m_hasClusters )
+		UpdateClusterBounds();
+
+	m_lights.clear();
+}
+
+void LightClusterGrid::AddLight( Vector3 const &position, float intensity, Vector3 const &attenuation )
+{
+	ClusteredLight light;
+	light.position		= position;
+	light.intensity		= intensity;
+	light.attenuation	= attenuation;
+	light.range			= GetRange( intensity, attenuation );
+
+	m_lights.push_back( light );
+}
+
+void LightClusterGrid::EndBuild()
+{
+	uint const lightCount = (uint)m_lights.size();
+
+	m_clusterOffsets.assign( LIGHT_CLUSTER_COUNT + 1U, 0U );
+	m_clusterLightIndices.clear();
+	m_lightClusterPairs.clear();
+	if( m_hasClusters == false )
+		return;
+
+	// Clusters of each light: the ones in its bounds, which its sphere touches
+	for( uint lightIdx = 0; lightIdx < lightCount; lightIdx++ )
+	{
+		ClusteredLight const &light = m_lights[ lightIdx ];
+
+		uint minXYZ[3];
+		uint maxXYZ[3];
+		if( GetClusterBounds( light, minXYZ, maxXYZ ) == false )
+			continue;
+
+		// Squared distance to the cluster's box, an axis at a time; a slice or a row too far away skips all of its clusters
+		bool	reachesEverywhere	= light.range == FLT_MAX;
+		float	rangeSquared		= light.range * light.range;
+		Vector3	viewCenter			= m_viewMatrix.Multiply( light.position, 1.f );
+		for( uint z = minXYZ[2]; z <= maxXYZ[2]; z++ )
+		{
+			float zDistanceSquared = GetDistanceSquaredOutside( viewCenter.z, m_sliceDepthRanges[z] );
+			if( reachesEverywhere == false && zDistanceSquared > rangeSquared )
+				continue;
+
+			for( uint y = minXYZ[1]; y <= maxXYZ[1]; y++ )
+			{
+				float yzDistanceSquared = zDistanceSquared + GetDistanceSquaredOutside( viewCenter.y, m_sliceYRanges[ z * LIGHT_CLUSTER_COUNT_Y + y ] );
+				if( reachesEverywhere == false && yzDistanceSquared > rangeSquared )
+					continue;
+
+				for( uint x = minXYZ[0]; x <= maxXYZ[0]; x++ )
+				{
+					float distanceSquared = yzDistanceSquared + GetDistanceSquaredOutside( viewCenter.x, m_sliceXRanges[ z * LIGHT_CLUSTER_COUNT_X + x ] );
+					if( reachesEverywhere == false && distanceSquared > rangeSquared )
+						continue;
+
+					uint clusterIdx = (z * LIGHT_CLUSTER_COUNT_Y + y) * LIGHT_CLUSTER_COUNT_X + x;
+					m_lightClusterPairs.push_back( clusterIdx );
+					m_lightClusterPairs.push_back( lightIdx );
+					m_clusterOffsets[ clusterIdx + 1U ]++;		// One slot ahead, so it adds up to the offsets
+				}
+			}
+		}
+	}
+
+	for( uint clusterIdx = 0; clusterIdx < LIGHT_CLUSTER_COUNT; clusterIdx++ )
+		m_clusterOffsets[ clusterIdx + 1U ] += m_clusterOffsets[ clusterIdx ];
+
+	// Pairs are in the order of lights, so each cluster's lights stay ascending; the offsets get used as write heads, then get set back
+	m_clusterLightIndices.resize( m_clusterOffsets[ LIGHT_CLUSTER_COUNT ] );
+	for( uint pairIdx = 0; pairIdx < m_lightClusterPairs.size(); pairIdx += 2U )
+		m_clusterLightIndices[ m_clusterOffsets[ m_lightClusterPairs[pairIdx] ]++ ] = m_lightClusterPairs[ pairIdx + 1U ];
+
+	for( uint clusterIdx = LIGHT_CLUSTER_COUNT; clusterIdx > 0U; clusterIdx-- )
+		m_clusterOffsets[ clusterIdx ] = m_clusterOffsets[ clusterIdx - 1U ];
+	m_clusterOffsets[0] = 0U;
+}
+
+void LightClusterGrid::GetMostContributingLights( Vector3 const &position, uint &lightCount, uint (&lightIndices)[MAX_LIGHTS] ) const
+{
+	uint clusterIdx;
+	if( m_hasClusters == false || GetClusterIndex( position, clusterIdx ) == false )
+	{
+		GetMostContributingLightsOfAll( position, lightCount, lightIndices );
+		return;
+	}
+
+	float contributions[ MAX_LIGHTS ];
+	lightCount = 0U;
+
+	uint const endOffset = m_clusterOffsets[ clusterIdx + 1U ];
+	for( uint offset = m_clusterOffsets[ clusterIdx ]; offset < endOffset; offset++ )
+	{
+		uint lightIdx = m_clusterLightIndices[ offset ];
+		RankLight( m_lights[ lightIdx ], lightIdx, position, contributions, lightIndices, lightCount );
+	}
+}
+
+void LightClusterGrid::GetMostContributingLightsOfAll( Vector3 const &position, uint &lightCount, uint (&lightIndices)[MAX_LIGHTS] ) const
+{
+	float contributions[ MAX_LIGHTS ];
+	lightCount = 0U;
+
+	for( uint lightIdx = 0; lightIdx < m_lights.size(); lightIdx++ )
+		RankLight( m_lights[ lightIdx ], lightIdx, position, contributions, lightIndices, lightCount );
+}
+
+bool LightClusterGrid::GetClusterIndex( Vector3 const &position, uint &clusterIdx ) const
+{
+	Vector3 viewPosition	= m_viewMatrix.Multiply( position, 1.f );
+	int		slice			= GetDepthSlice( viewPosition.z );
+	if( slice < 0 || slice >= (int)LIGHT_CLUSTER_COUNT_Z )
+		return false;
+
+	Vector4 clipPosition	= m_projectionMatrix.Multiply( Vector4( viewPosition, 1.f ) );
+	if( clipPosition.w <= 0.0001f )
+		return false;
+
+	float ndcX = clipPosition.x / clipPosition.w;
+	float ndcY = clipPosition.y / clipPosition.w;
+	if( ndcX < -1.f || ndcX > 1.f || ndcY < -1.f || ndcY > 1.f )
+		return false;
+
+	uint tileX	= GetTileFromNDC( ndcX, LIGHT_CLUSTER_COUNT_X );
+	uint tileY	= GetTileFromNDC( ndcY, LIGHT_CLUSTER_COUNT_Y );
+	clusterIdx	= ( (uint)slice * LIGHT_CLUSTER_COUNT_Y + tileY ) * LIGHT_CLUSTER_COUNT_X + tileX;
+
+	return true;
+}
+
+int LightClusterGrid::GetDepthSlice( float viewZ ) const
+{
+	if( m_isDepthExponential )
+		return ( viewZ < m_nearZ ) ? -1 : (int) floorf( logf( viewZ / m_nearZ ) * m_depthSliceScale );
+	else
+		return ( viewZ < m_nearZ ) ? -1 : (int) floorf( (viewZ - m_nearZ) * m_depthSliceScale );
+}
+
+float LightClusterGrid::GetDepthOfSlice( uint slice ) const
+{
+	if( m_isDepthExponential )
+		return m_nearZ * expf( (float)slice / m_depthSliceScale );
+	else
+		return m_nearZ + (float)slice / m_depthSliceScale;
+}
+
+void LightClusterGrid::UpdateClusterBounds()
+{
+	// A cluster's box is its slice's depths, by the X of its column & the Y of its row at those depths
+	m_sliceDepthRanges	.resize( LIGHT_CLUSTER_COUNT_Z );
+	m_sliceXRanges		.resize( LIGHT_CLUSTER_COUNT_Z * LIGHT_CLUSTER_COUNT_X );
+	m_sliceYRanges		.resize( LIGHT_CLUSTER_COUNT_Z * LIGHT_CLUSTER_COUNT_Y );
+
+	// View-space X & Y at an NDC & a depth; the projections we make don't mix X & Y with anything but Z
+	Matrix44 const &proj = m_projectionMatrix;
+	bool canUnproject = proj.Ix != 0.f && proj.Jy != 0.f;
+	auto viewXAt = [ &proj ]( float ndcX, float z ) { return ( ndcX * (proj.Kw * z + proj.Tw) - proj.Kx * z - proj.Tx ) / proj.Ix; };
+	auto viewYAt = [ &proj ]( float ndcY, float z ) { return ( ndcY * (proj.Kw * z + proj.Tw) - proj.Ky * z - proj.Ty ) / proj.Jy; };
+
+	for( uint z = 0; z < LIGHT_CLUSTER_COUNT_Z; z++ )
+	{
+		float nearZ = GetDepthOfSlice( z );
+		float farZ	= GetDepthOfSlice( z + 1U );
+		m_sliceDepthRanges[z] = FloatRange( nearZ, farZ );
+
+		for( uint x = 0; x < LIGHT_CLUSTER_COUNT_X; x++ )
+		{
+			FloatRange &range = m_sliceXRanges[ z * LIGHT_CLUSTER_COUNT_X + x ];
+			if( canUnproject == false )
+			{
+				// Every light in the bounds touches it, then
+				range = FloatRange( -FLT_MAX, FLT_MAX );
+				continue;
+			}
+
+			float ndcMin = -1.f + 2.f * (float)x / (float)LIGHT_CLUSTER_COUNT_X;
+			float ndcMax = -1.f + 2.f * (float)(x + 1U) / (float)LIGHT_CLUSTER_COUNT_X;
+			range = FloatRange( viewXAt( ndcMin, nearZ ) );
+			range.ExpandToInclude( viewXAt( ndcMin, farZ ) );
+			range.ExpandToInclude( viewXAt( ndcMax, nearZ ) );
+			range.ExpandToInclude( viewXAt( ndcMax, farZ ) );
+		}
+
+		for( uint y = 0; y < LIGHT_CLUSTER_COUNT_Y; y++ )
+		{
+			FloatRange &range = m_sliceYRanges[ z * LIGHT_CLUSTER_COUNT_Y + y ];
+			if( canUnproject == false )
+			{
+				range = FloatRange( -FLT_MAX, FLT_MAX );
+				continue;
+			}
+
+			float ndcMin = -1.f + 2.f * (float)y / (float)LIGHT_CLUSTER_COUNT_Y;
+			float ndcMax = -1.f + 2.f * (float)(y + 1U) / (float)LIGHT_CLUSTER_COUNT_Y;
+			range = FloatRange( viewYAt( ndcMin, nearZ ) );
+			range.ExpandToInclude( viewYAt( ndcMin, farZ ) );
+			range.ExpandToInclude( viewYAt( ndcMax, nearZ ) );
+			range.ExpandToInclude( viewYAt( ndcMax, farZ ) );
+		}
+	}
+}
+
+bool LightClusterGrid::GetClusterBounds( ClusteredLight const &light, uint (&minXYZ)[3], uint (&maxXYZ)[3] ) const
+{
+	if( (light.range > 0.f) == false )
+		return false;
+
+	minXYZ[0] = 0U;		maxXYZ[0] = LIGHT_CLUSTER_COUNT_X - 1U;
+	minXYZ[1] = 0U;		maxXYZ[1] = LIGHT_CLUSTER_COUNT_Y - 1U;
+	minXYZ[2] = 0U;		maxXYZ[2] = LIGHT_CLUSTER_COUNT_Z - 1U;
+	if( light.range == FLT_MAX )
+		return true;
+
+	// Depth slices
+	float const	range	= light.range;
+	Vector3		center	= m_viewMatrix.Multiply( light.position, 1.f );
+	float		minZ	= center.z - range;
+	float		maxZ	= center.z + range;
+	if( maxZ < m_nearZ || minZ > m_farZ )
+		return false;
+
+	int minSlice = GetDepthSlice( (minZ > m_nearZ) ? minZ : m_nearZ );
+	int maxSlice = GetDepthSlice( (maxZ < m_farZ)  ? maxZ : m_farZ );
+	minXYZ[2] = (uint)( (minSlice < 0) ? 0 : minSlice );
+	maxXYZ[2] = (uint)( (maxSlice > (int)LIGHT_CLUSTER_COUNT_Z - 1) ? (int)LIGHT_CLUSTER_COUNT_Z - 1 : maxSlice );
+
+	// Tiles, from the corners of the sphere's box; if the box goes behind the camera, it gets all of them
+	float minNDC[2] = {  FLT_MAX,  FLT_MAX };
+	float maxNDC[2] = { -FLT_MAX, -FLT_MAX };
+	for( uint cornerIdx = 0; cornerIdx < 8U; cornerIdx++ )
+	{
+		Vector3 corner;
+		corner.x = center.x + ( (cornerIdx & 1U) ? range : -range );
+		corner.y = center.y + ( (cornerIdx & 2U) ? range : -range );
+		corner.z = center.z + ( (cornerIdx & 4U) ? range : -range );
+
+		Vector4 clipCorner = m_projectionMatrix.Multiply( Vector4( corner, 1.f ) );
+		if( clipCorner.w <= 0.0001f )
+			return true;
+
+		float ndcX = clipCorner.x / clipCorner.w;
+		float ndcY = clipCorner.y / clipCorner.w;
+		minNDC[0] = (ndcX < minNDC[0]) ? ndcX : minNDC[0];
+		maxNDC[0] = (ndcX > maxNDC[0]) ? ndcX : maxNDC[0];
+		minNDC[1] = (ndcY < minNDC[1]) ? ndcY : minNDC[1];
+		maxNDC[1] = (ndcY > maxNDC[1]) ? ndcY : maxNDC[1];
+	}
+
+	if( maxNDC[0] < -1.f || minNDC[0] > 1.f || maxNDC[1] < -1.f || minNDC[1] > 1.f )
+		return false;
+
+	minXYZ[0] = GetTileFromNDC( minNDC[0], LIGHT_CLUSTER_COUNT_X );
+	maxXYZ[0] = GetTileFromNDC( maxNDC[0], LIGHT_CLUSTER_COUNT_X );
+	minXYZ[1] = GetTileFromNDC( minNDC[1], LIGHT_CLUSTER_COUNT_Y );
+	maxXYZ[1] = GetTileFromNDC( maxNDC[1], LIGHT_CLUSTER_COUNT_Y );
+
+	return true;
+}
+
+// The way ForwardRenderingPath used to pick the lights: rank all, bubble sort, keep the first MAX_LIGHTS
+static void GetMostContributingLightsByBubbleSort( std::vector< ClusteredLight > const &lights, Vector3 const &position, uint &lightCount, uint (&lightIndices)[MAX_LIGHTS] )
+{
+	std::vector< std::tuple< float, uint > > lightsToSort;
+	for( uint idx = 0; idx < lights.size(); idx++ )
+		lightsToSort.push_back( std::make_tuple( LightClusterGrid::GetContribution( lights[idx], position ), idx ) );
+
+	int n = (int) lightsToSort.size();
+	for( int i = 0; i < n - 1; i++ )
+	{
+		for( int j = 0; j < n-i-1; j++ )
+		{
+			if( std::get<0>( lightsToSort[j] ) < std::get<0>( lightsToSort[j+1] ) )
+			{
+				std::tuple< float, uint > temp	= lightsToSort[j];
+				lightsToSort[j]					= lightsToSort[j+1];
+				lightsToSort[j+1]				= temp;
+			}
+		}
+	}
+
+	lightCount = 0U;
+	for( uint i = 0; i < lightsToSort.size() && i < MAX_LIGHTS; i++ )
+		lightIndices[ lightCount++ ] = std::get<1>( lightsToSort[i] );
+}
+
+// Lights contributing at least LIGHT_CLUSTER_MIN_CONTRIBUTION, in the order they got picked
+static uint CountSignificantLights( std::vector< ClusteredLight > const &lights, Vector3 const &position, uint lightCount, uint const (&lightIndices)[MAX_LIGHTS] )
+{
+	uint significantCount = 0U;
+	while( significantCount < lightCount && LightClusterGrid::GetContribution( lights[ lightIndices[significantCount] ], position ) >= LIGHT_CLUSTER_MIN_CONTRIBUTION )
+		significantCount++;
+
+	return significantCount;
+}
+
+void LightClusterBenchmark( Command &cmd )
+{
+	std::string lightCountStr	= cmd.GetNextString();
+	std::string drawCountStr	= cmd.GetNextString();
+	uint		lightCount		= ( lightCountStr != "" )	? (uint) atoi( lightCountStr.c_str() )	: 256U;
+	uint		drawCount		= ( drawCountStr != "" )	? (uint) atoi( drawCountStr.c_str() )	: 20000U;
+	if( drawCount == 0U )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "light_cluster_benchmark: draw count can't be ZERO!" );
+		return;
+	}
+
+	// Camera at the origin, looking down +Z; lights around what it sees, draws mostly in it, like after culling
+	uint const	iterations	= 10U;
+	float const	nearZ		= 0.1f;
+	float const	farZ		= 250.f;
+	Matrix44	viewMatrix;
+	Matrix44	projectionMatrix = Matrix44::MakePerspective3D( 60.f, 16.f / 9.f, nearZ, farZ );
+
+	uint randomState = 1U;
+
+	std::vector< Vector3 >	lightPositions	( lightCount );
+	std::vector< float >	lightIntensities( lightCount );
+	for( uint i = 0; i < lightCount; i++ )
+	{
+		lightPositions[i]	= Vector3( GetSeededRandomFloatInRange( randomState, -150.f, 150.f ), GetSeededRandomFloatInRange( randomState, -30.f, 30.f ), GetSeededRandomFloatInRange( randomState, -20.f, 260.f ) );
+		lightIntensities[i]	= GetSeededRandomFloatInRange( randomState, 1.f, 5.f );
+	}
+
+	std::vector< Vector3 > drawPositions( drawCount );
+	for( uint i = 0; i < drawCount; i++ )
+	{
+		float z			= GetSeededRandomFloatInRange( randomState, 1.f, 250.f );
+		float halfHeight	= z * 0.58f;										// tan( 30 degrees )
+		drawPositions[i]	= Vector3( GetSeededRandomFloatInRange( randomState, -halfHeight, halfHeight ) * 16.f / 9.f, GetSeededRandomFloatInRange( randomState, -halfHeight, halfHeight ) * 0.5f, z );
+	}
+
+	// Build
+	LightClusterGrid grid;
+	double buildSeconds = 0.0;
+	for( uint iteration = 0; iteration <= iterations; iteration++ )
+	{
+		uint64_t startHPC = Clock::GetCurrentHPC();
+		grid.BeginBuild( viewMatrix, projectionMatrix, nearZ, farZ );
+		for( uint i = 0; i < lightCount; i++ )
+			grid.AddLight( lightPositions[i], lightIntensities[i], Vector3( 0.f, 0.f, 1.f ) );
+		grid.EndBuild();
+
+		if( iteration > 0U )
+			buildSeconds += Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+	}
+
+	// Lights of every draw, from the clusters & from all of them
+	std::vector< uint > clusteredCounts	( drawCount );
+	std::vector< uint > clusteredIndices( drawCount * MAX_LIGHTS );
+	std::vector< uint > allCounts		( drawCount );
+	std::vector< uint > allIndices		( drawCount * MAX_LIGHTS );
+
+	double clusteredSeconds = 0.0;
+	double allSeconds		= 0.0;
+	for( uint iteration = 0; iteration <= iterations; iteration++ )
+	{
+		uint64_t startHPC = Clock::GetCurrentHPC();
+		for( uint i = 0; i < drawCount; i++ )
+			grid.GetMostContributingLights( drawPositions[i], clusteredCounts[i], *reinterpret_cast< uint(*)[MAX_LIGHTS] >( &clusteredIndices[ i * MAX_LIGHTS ] ) );
+		uint64_t clusteredHPC = Clock::GetCurrentHPC();
+		for( uint i = 0; i < drawCount; i++ )
+			grid.GetMostContributingLightsOfAll( drawPositions[i], allCounts[i], *reinterpret_cast< uint(*)[MAX_LIGHTS] >( &allIndices[ i * MAX_LIGHTS ] ) );
+		uint64_t allHPC = Clock::GetCurrentHPC();
+
+		if( iteration > 0U )
+		{
+			clusteredSeconds	+= Clock::GetSecondsFromHPC( clusteredHPC - startHPC );
+			allSeconds			+= Clock::GetSecondsFromHPC( allHPC - clusteredHPC );
+		}
+	}
+
+	// The old way is too slow to do all of them; it also took the lights out of range, so just the ones in range get compared
+	std::vector< ClusteredLight > lights( lightCount );
+	for( uint i = 0; i < lightCount; i++ )
+	{
+		lights[i].position		= lightPositions[i];
+		lights[i].intensity		= lightIntensities[i];
+		lights[i].attenuation	= Vector3( 0.f, 0.f, 1.f );
+		lights[i].range			= LightClusterGrid::GetRange( lightIntensities[i], lights[i].attenuation );
+	}
+
+	uint	 bubbleSortDrawCount	= ( drawCount < 200U ) ? drawCount : 200U;
+	uint	 bubbleSortMismatches	= 0U;
+	uint64_t startHPC				= Clock::GetCurrentHPC();
+	for( uint i = 0; i < bubbleSortDrawCount; i++ )
+	{
+		uint count;
+		uint indices[ MAX_LIGHTS ];
+		GetMostContributingLightsByBubbleSort( lights, drawPositions[i], count, indices );
+
+		uint significantCount = CountSignificantLights( lights, drawPositions[i], count, indices );
+		if( significantCount != clusteredCounts[i] || memcmp( indices, &clusteredIndices[ i * MAX_LIGHTS ], significantCount * sizeof(uint) ) != 0 )
+			bubbleSortMismatches++;
+	}
+	double bubbleSortSeconds = Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+
+	// Clusters should pick the very same lights as ranking all of them does
+	uint mismatchCount		= 0U;
+	uint pickedCount		= 0U;
+	uint outsideCount		= 0U;
+	for( uint i = 0; i < drawCount; i++ )
+	{
+		if( clusteredCounts[i] != allCounts[i] || memcmp( &clusteredIndices[ i * MAX_LIGHTS ], &allIndices[ i * MAX_LIGHTS ], allCounts[i] * sizeof(uint) ) != 0 )
+			mismatchCount++;
+
+		uint clusterIdx;
+		if( grid.GetClusterIndex( drawPositions[i], clusterIdx ) == false )
+			outsideCount++;
+
+		pickedCount += clusteredCounts[i];
+	}
+
+	double usPerIteration = 1000000.0 / (double)iterations;
+	ConsolePrintf( "light_cluster_benchmark: %u lights, %u draws, %ux%ux%u clusters", lightCount, drawCount, LIGHT_CLUSTER_COUNT_X, LIGHT_CLUSTER_COUNT_Y, LIGHT_CLUSTER_COUNT_Z );
+	ConsolePrintf( "  Build             %9.1f us; %.1f lights per cluster", buildSeconds * usPerIteration, (double)grid.GetClusterLightIndexCount() / (double)LIGHT_CLUSTER_COUNT );
+	ConsolePrintf( "  Clustered         %9.1f us, %7.3f us per draw", clusteredSeconds * usPerIteration, clusteredSeconds * usPerIteration / (double)drawCount );
+	ConsolePrintf( "  All lights, top %u %9.1f us, %7.3f us per draw", MAX_LIGHTS, allSeconds * usPerIteration, allSeconds * usPerIteration / (double)drawCount );
+	ConsolePrintf( "  Bubble sort       %9.1f us per draw, on %u draws; %u of them picked differently", bubbleSortSeconds * 1000000.0 / (double)bubbleSortDrawCount, bubbleSortDrawCount, bubbleSortMismatches );
+	ConsolePrintf( ( mismatchCount == 0U && bubbleSortMismatches == 0U ) ? RGBA_WHITE_COLOR : RGBA_RED_COLOR, "  %.2f lights per draw; %u draws outside of the frustum; %u draws picked differently by the clusters",
+				   (double)pickedCount / (double)drawCount, outsideCount, mismatchCount );
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <vector>
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Input/Command.hpp"
+#include "Engine/Math/Vector3.hpp"
+#include "Engine/Math/Matrix44.hpp"
+#include "Engine/Math/FloatRange.hpp"
+
+class Light;
+class Camera;
+
+#define LIGHT_CLUSTER_COUNT_X			(16U)
+#define LIGHT_CLUSTER_COUNT_Y			(9U)
+#define LIGHT_CLUSTER_COUNT_Z			(24U)
+#define LIGHT_CLUSTER_COUNT				( LIGHT_CLUSTER_COUNT_X * LIGHT_CLUSTER_COUNT_Y * LIGHT_CLUSTER_COUNT_Z )
+#define LIGHT_CLUSTER_MIN_CONTRIBUTION	(1.f / 256.f)		// Less than a step of an 8-bit color; a light's range ends here
+
+// What a cluster needs of a light; contribution is the same as Light::GetAttenuationForRenderableAt()
+struct ClusteredLight
+{
+	Vector3	position;
+	float	intensity;
+	Vector3	attenuation;
+	float	range;				// Beyond it, contribution is less than LIGHT_CLUSTER_MIN_CONTRIBUTION; FLT_MAX if never
+};
+
+//------------------------------------------------------------------------------------------
+// Lights of a scene, binned into the froxels of a camera's frustum: view-space tiles in X & Y, slices in Z
+//	- Built once per camera; a light goes into every cluster its range's sphere touches the bounding box of
+//	- Z slices are exponential for a perspective camera, so near ones don't get too deep; linear if near plane isn't positive
+//	- GetMostContributingLights() then ranks just the lights of the draw's cluster, keeping the top MAX_LIGHTS as it goes
+//	- Positions outside of the frustum have no cluster, those rank all the lights
+//	- Lights contributing less than LIGHT_CLUSTER_MIN_CONTRIBUTION never get picked; so a draw may get less than MAX_LIGHTS
+//
+class LightClusterGrid
+{
+public:
+	 LightClusterGrid() { }
+	~LightClusterGrid() { }
+
+private:
+	// Camera of the last build
+	Matrix44						m_viewMatrix;
+	Matrix44						m_projectionMatrix;
+	float							m_nearZ				= 0.f;
+	float							m_farZ				= 0.f;
+	bool							m_hasClusters		= false;	// If the depth range is empty, it's just the lights
+	bool							m_isDepthExponential	= false;
+	float							m_depthSliceScale	= 0.f;		// Slices per unit of depth, or of log( depth )
+
+	// Lights & clusters
+	std::vector< ClusteredLight >	m_lights;						// In the order of the scene
+	std::vector< uint >				m_clusterOffsets;				// Into m_clusterLightIndices; LIGHT_CLUSTER_COUNT + 1
+	std::vector< uint >				m_clusterLightIndices;			// Ascending within a cluster
+	std::vector< uint >				m_lightClusterPairs;			// Cluster & light index, of every light in every cluster; while building
+	std::vector< FloatRange >		m_sliceDepthRanges;				// View-space bounds of the clusters; made again if the projection changes
+	std::vector< FloatRange >		m_sliceXRanges;					// Of a column, in a slice
+	std::vector< FloatRange >		m_sliceYRanges;					// Of a row, in a slice
+
+public:
+	void	Build		( Camera const &camera, std::vector< Light* > const &lights );
+
+	// Build() in steps; lights get added in the order of their indices
+	void	BeginBuild	( Matrix44 const &viewMatrix, Matrix44 const &projectionMatrix, float nearZ, float farZ );
+	void	AddLight	( Vector3 const &position, float intensity, Vector3 const &attenuation );
+	void	EndBuild	();
+
+	void	GetMostContributingLights( Vector3 const &position, uint &lightCount, uint (&lightIndices)[MAX_LIGHTS] ) const;	// Most contributing one first
+	void	GetMostContributingLightsOfAll( Vector3 const &position, uint &lightCount, uint (&lightIndices)[MAX_LIGHTS] ) const;	// Skips the clusters
+	bool	GetClusterIndex( Vector3 const &position, uint &clusterIdx ) const;		// False if outside of the frustum
+
+	inline uint	GetLightCount() const						{ return (uint)m_lights.size(); }
+	inline uint	GetClusterLightIndexCount() const			{ return (uint)m_clusterLightIndices.size(); }
+
+public:
+	static float GetContribution( ClusteredLight const &light, Vector3 const &position );
+	static float GetRange( float intensity, Vector3 const &attenuation );
+
+private:
+	int		GetDepthSlice	( float viewZ ) const;									// Unclamped
+	float	GetDepthOfSlice	( uint slice ) const;									// Where the slice starts
+	bool	GetClusterBounds( ClusteredLight const &light, uint (&minXYZ)[3], uint (&maxXYZ)[3] ) const;	// Clusters the light's box covers
+	void	UpdateClusterBounds();
+};
+
+
+// Console Commands
+void LightClusterBenchmark( Command &cmd );			// light_cluster_benchmark [lightCount=256] [drawCount=20000]
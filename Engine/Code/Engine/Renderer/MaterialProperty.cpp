@@ -1,6 +1,7 @@
 #pragma once
 #include "Engine/Renderer/MaterialProperty.hpp"
 #include "Engine/Renderer/glfunctions.hpp"
+#include "Engine/Renderer/ShaderProgram.hpp"
 
 MaterialPropertyFloat::MaterialPropertyFloat( char const *name, float data )
 {
@@ -8,9 +9,9 @@ MaterialPropertyFloat::MaterialPropertyFloat( char const *name, float data )
 	m_data = data;
 }
 
-void MaterialPropertyFloat::Bind( unsigned int programHandle )
+void MaterialPropertyFloat::Bind( ShaderProgram const &program )
 {
-	GLint idx = glGetUniformLocation( programHandle, m_name.c_str() );
+	GLint idx = program.GetUniformLocation( m_name );
 	if( idx  >= 0 )
 		glUniform1fv( idx, 1, (GLfloat const *) &m_data );
 }
@@ -38,9 +39,9 @@ MaterialPropertyVector2::MaterialPropertyVector2( char const *name, Vector2 cons
 	m_data = data;
 }
 
-void MaterialPropertyVector2::Bind( unsigned int programHandle )
+void MaterialPropertyVector2::Bind( ShaderProgram const &program )
 {
-	GLint idx = glGetUniformLocation( programHandle, m_name.c_str() );
+	GLint idx = program.GetUniformLocation( m_name );
 	if( idx  >= 0 )
 		glUniform2fv( idx, 1, (GLfloat const *) &m_data );
 }
@@ -68,9 +69,9 @@ MaterialPropertyVector3::MaterialPropertyVector3( char const *name, Vector3 cons
 	m_data = data;
 }
 
-void MaterialPropertyVector3::Bind( unsigned int programHandle )
+void MaterialPropertyVector3::Bind( ShaderProgram const &program )
 {
-	GLint idx = glGetUniformLocation( programHandle, m_name.c_str() );
+	GLint idx = program.GetUniformLocation( m_name );
 	if( idx  >= 0 )
 		glUniform3fv( idx, 1, (GLfloat const *) &m_data );
 }
@@ -98,9 +99,9 @@ MaterialPropertyVector4::MaterialPropertyVector4( char const *name, Vector4 cons
 	m_data = data;
 }
 
-void MaterialPropertyVector4::Bind( unsigned int programHandle )
+void MaterialPropertyVector4::Bind( ShaderProgram const &program )
 {
-	GLint idx = glGetUniformLocation( programHandle, m_name.c_str() );
+	GLint idx = program.GetUniformLocation( m_name );
 	if( idx  >= 0 )
 		glUniform4fv( idx, 1, (GLfloat const *) &m_data );
 }
@@ -128,12 +129,12 @@ MaterialPropertyRgba::MaterialPropertyRgba( char const *name, Rgba const &data )
 	m_data = data;
 }
 
-void MaterialPropertyRgba::Bind( unsigned int programHandle )
+void MaterialPropertyRgba::Bind( ShaderProgram const &program )
 {
 	Vector4 colorNormalized;
 	m_data.GetAsFloats( colorNormalized.x, colorNormalized.y, colorNormalized.z, colorNormalized.w );
 	
-	GLint idx = glGetUniformLocation( programHandle, m_name.c_str() );
+	GLint idx = program.GetUniformLocation( m_name );
 	if( idx  >= 0 )
 		glUniform4fv( idx, 1, (GLfloat const *) &colorNormalized );
 }
@@ -6,13 +6,15 @@
 #include "Engine/Core/Rgba.hpp"
 #include "Engine/Core/EngineCommon.hpp"
 
+class ShaderProgram;
+
 class MaterialProperty
 {
 public:
 	virtual ~MaterialProperty() { }
 
 public:
-	virtual void	Bind		( unsigned int programHandle ) = 0;
+	virtual void	Bind		( ShaderProgram const &program ) = 0;
 	virtual void	SetData		( void const *data ) = 0;
 	virtual size_t	GetByteSize	() const = 0;
 	
@@ -29,7 +31,7 @@ public:
 	~MaterialPropertyFloat() override { }
 	
 public:
-	void	Bind		( unsigned int programHandle ) override;
+	void	Bind		( ShaderProgram const &program ) override;
 	void	SetData		( void const *data ) override;
 	size_t	GetByteSize	() const override;
 
@@ -46,7 +48,7 @@ public:
 	~MaterialPropertyVector2() override { }
 	
 public:
-	void	Bind		( unsigned int programHandle ) override;
+	void	Bind		( ShaderProgram const &program ) override;
 	void	SetData		( void const *data ) override;
 	size_t	GetByteSize	() const override;
 
@@ -63,7 +65,7 @@ public:
 	~MaterialPropertyVector3() override { }
 
 public:
-	void	Bind		( unsigned int programHandle ) override;
+	void	Bind		( ShaderProgram const &program ) override;
 	void	SetData		( void const *data ) override;
 	size_t	GetByteSize	() const override;
 
@@ -80,7 +82,7 @@ public:
 	~MaterialPropertyVector4() override { }
 
 public:
-	void	Bind		( unsigned int programHandle ) override;
+	void	Bind		( ShaderProgram const &program ) override;
 	void	SetData		( void const *data ) override;
 	size_t	GetByteSize	() const override;
 
@@ -97,7 +99,7 @@ public:
 	~MaterialPropertyRgba() override { }
 
 public:
-	void	Bind		( unsigned int programHandle ) override;
+	void	Bind		( ShaderProgram const &program ) override;
 	void	SetData		( void const *data ) override;
 	size_t	GetByteSize	() const override;
 
@@ -1,5 +1,6 @@
 #pragma once
 #include "Mesh.hpp"
+#include "Engine/Renderer/ShaderProgram.hpp"
 
 Mesh::Mesh()
 {
@@ -8,6 +9,10 @@ Mesh::Mesh()
 
 Mesh::~Mesh()
 {
+	for( uint i = 0; i < m_vertexArrays.size(); i++ )
+		glDeleteVertexArrays( 1, &m_vertexArrays[i].handle );
+	m_vertexArrays.clear();
+
 	if( m_vbo != nullptr )
 		delete m_vbo;
 	if( m_ibo != nullptr )
@@ -19,18 +24,27 @@ Mesh::~Mesh()
 
 void Mesh::SetIndices( unsigned int count, unsigned const *indices )
 {
-	if( m_ibo != nullptr )
-		delete m_ibo;
-
-	m_ibo = new IndexBuffer( count, sizeof( unsigned int ), indices );
+	// Same buffer gets new data, so the vertex arrays which have it bound stay good
+	if( m_ibo == nullptr )
+		m_ibo = new IndexBuffer( count, sizeof( unsigned int ), indices );
+	else
+	{
+		m_ibo->m_indexCount		= count;
+		m_ibo->m_indexStride	= sizeof( unsigned int );
+		m_ibo->CopyToGPU( count * sizeof( unsigned int ), indices );
+	}
 }
 
 void Mesh::SetVertices( unsigned int count, unsigned int vertexStride, void const *data )
 {
-	if( m_vbo != nullptr )
-		delete m_vbo;
-
-	m_vbo = new VertexBuffer( count, vertexStride, data );
+	if( m_vbo == nullptr )
+		m_vbo = new VertexBuffer( count, vertexStride, data );
+	else
+	{
+		m_vbo->m_vertexCount	= count;
+		m_vbo->m_vertexStride	= vertexStride;
+		m_vbo->CopyToGPU( count * vertexStride, data );
+	}
 }
 
 void Mesh::SetDrawInstruction( ePrimitiveType type, bool useIndices, unsigned int startIndex, unsigned int elementCount )
@@ -41,4 +55,56 @@ void Mesh::SetDrawInstruction( ePrimitiveType type, bool useIndices, unsigned in
 void Mesh::SetDrawInstruction( DrawInstruction const & drawInstruction )
 {
 	m_drawCallInstruction = drawInstruction;
+}
+
+void Mesh::SetBounds( AABB3 const &localBounds, Sphere const &localBoundingSphere )
+{
+	m_localBounds			= localBounds;
+	m_localBoundingSphere	= localBoundingSphere;
+	m_hasBounds				= true;
+	m_boundsVersion++;
+}
+
+MeshVertexArray* Mesh::FindVertexArray( uint programID, VertexLayout const *layout ) const
+{
+	for( uint i = 0; i < m_vertexArrays.size(); i++ )
+	{
+		if( m_vertexArrays[i].programID == programID && m_vertexArrays[i].layout == layout )
+			return &m_vertexArrays[i];
+	}
+
+	return nullptr;
+}
+
+MeshVertexArray* Mesh::CreateVertexArray( uint programID, VertexLayout const *layout ) const
+{
+	MeshVertexArray newVertexArray;
+	newVertexArray.programID	= programID;
+	newVertexArray.layout		= layout;
+	glGenVertexArrays( 1, &newVertexArray.handle );
+
+	m_vertexArrays.push_back( newVertexArray );
+	return &m_vertexArrays.back();
+}
+
+void Mesh::DropRetiredVertexArrays() const
+{
+	uint retiredProgramIDCount = ShaderProgram::GetRetiredProgramIDCount();
+	if( m_retiredProgramIDsChecked == retiredProgramIDCount )
+		return;
+
+	// Swap & pop; order of the vertex arrays doesn't matter
+	for( uint i = 0; i < m_vertexArrays.size(); )
+	{
+		if( ShaderProgram::IsProgramIDRetired( m_vertexArrays[i].programID ) )
+		{
+			glDeleteVertexArrays( 1, &m_vertexArrays[i].handle );
+			m_vertexArrays[i] = m_vertexArrays.back();
+			m_vertexArrays.pop_back();
+		}
+		else
+			i++;
+	}
+
+	m_retiredProgramIDsChecked = retiredProgramIDCount;
 }
\ No newline at end of file
@@ -1,6 +1,10 @@
 #pragma once
+#include <math.h>
+#include <vector>
 #include "Engine/Core/Vertex.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/Sphere.hpp"
 #include "Engine/Renderer/RenderTypes.hpp"
 #include "Engine/Renderer/VertexBuffer.hpp"
 #include "Engine/Renderer/IndexBuffer.hpp"
@@ -23,6 +27,16 @@ struct DrawInstruction
 	}
 };
 
+// Vertex array object of a mesh, for one layout & shader program; attribute locations differ from program to program
+struct MeshVertexArray
+{
+	uint				 programID			= 0U;
+	VertexLayout const	*layout				= nullptr;
+	GLuint				 handle				= NULL;
+	GLuint				 vertexBufferHandle	= NULL;		// Buffers it has bound; if the mesh gets a new one, it gets bound again
+	GLuint				 indexBufferHandle	= NULL;
+};
+
 class Mesh
 {
 public:
@@ -34,10 +48,25 @@ public:
 	IndexBuffer			*m_ibo		= nullptr;
 	DrawInstruction		 m_drawCallInstruction;
 
+public:
+	// Model space bounds, of every vertex; a mesh without them never gets culled
+	AABB3				 m_localBounds;
+	Sphere				 m_localBoundingSphere;
+	bool				 m_hasBounds	= false;
+	uint				 m_boundsVersion	= 0U;		// Goes up whenever the bounds get set, so the cached world bounds of the renderables get made again
+
 public:
 	VertexLayout const	*m_layout;
 	unsigned int		GetVertexStride() const { return m_layout->m_stride; }
 
+public:
+	// Made by the Renderer, on the first draw with a program; deleted with the mesh, or once their program gets relinked or deleted
+	mutable std::vector< MeshVertexArray >	m_vertexArrays;
+	mutable uint							m_retiredProgramIDsChecked = 0U;		// ShaderProgram::GetRetiredProgramIDCount(), as of the last DropRetiredVertexArrays()
+	MeshVertexArray*	FindVertexArray	( uint programID, VertexLayout const *layout ) const;		// nullptr, if not made yet
+	MeshVertexArray*	CreateVertexArray( uint programID, VertexLayout const *layout ) const;
+	void				DropRetiredVertexArrays() const;											// Cheap, if no program got retired since the last call
+
 public:
 	template <typename VERTTYPE>
 	void SetVertices( unsigned int count, VERTTYPE const *vertices )
@@ -46,10 +75,46 @@ public:
 		m_layout = &VERTTYPE::s_layout;
 	}
 
+	template <typename VERTTYPE>
+	void SetBoundsFromVertices( unsigned int count, VERTTYPE const *vertices )
+	{
+		if( count == 0 )
+		{
+			m_hasBounds = false;
+			m_boundsVersion++;
+			return;
+		}
+
+		Vector3 mins = vertices[0].m_position;
+		Vector3 maxs = vertices[0].m_position;
+		for( unsigned int i = 1; i < count; i++ )
+		{
+			Vector3 const &position = vertices[i].m_position;
+			mins.x = ( position.x < mins.x ) ? position.x : mins.x;
+			mins.y = ( position.y < mins.y ) ? position.y : mins.y;
+			mins.z = ( position.z < mins.z ) ? position.z : mins.z;
+			maxs.x = ( position.x > maxs.x ) ? position.x : maxs.x;
+			maxs.y = ( position.y > maxs.y ) ? position.y : maxs.y;
+			maxs.z = ( position.z > maxs.z ) ? position.z : maxs.z;
+		}
+
+		// Sphere around the box's center, as far as the farthest vertex; tighter than the box's corners
+		Vector3	center			= ( mins + maxs ) * 0.5f;
+		float	maxDistanceSq	= 0.f;
+		for( unsigned int i = 0; i < count; i++ )
+		{
+			float distanceSq	= ( vertices[i].m_position - center ).GetLengthSquared();
+			maxDistanceSq		= ( distanceSq > maxDistanceSq ) ? distanceSq : maxDistanceSq;
+		}
+
+		SetBounds( AABB3( mins, maxs ), Sphere( center, sqrtf( maxDistanceSq ) ) );
+	}
+
 public:
 	void SetIndices(  unsigned int count, unsigned const *indices );
 	void SetDrawInstruction( ePrimitiveType type, bool useIndices, unsigned int startIndex, unsigned int elementCount );
 	void SetDrawInstruction( DrawInstruction const & drawInstruction );
+	void SetBounds( AABB3 const &localBounds, Sphere const &localBoundingSphere );
 
 private:
 	void SetVertices( unsigned int count, unsigned int vertexStride, void const *data );
@@ -53,6 +53,7 @@ public:
 		mesh->SetVertices	  <VERTTYPE>( (unsigned int)		  vCount, tempVertexBuffer );
 		mesh->SetIndices				( (unsigned int)m_indices.size(), m_indices.data() );
 		mesh->SetDrawInstruction( m_drawInstruction );
+		mesh->SetBoundsFromVertices<VERTTYPE>( (unsigned int)		  vCount, tempVertexBuffer );
 
 		// temp VertexBuffer's work is done, free it
 		free( tempVertexBuffer );
@@ -0,0 +1,303 @@
+#pragma once
+#include "RenderQueue.hpp"
+#include <string.h>
+#include <algorithm>
+#include "Engine/Core/Clock.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Math/MathUtil.hpp"
+
+#define RENDER_SORT_ID_MASK		( (1U << RENDER_SORT_ID_BITS) - 1U )
+
+uint GetRenderSortID( void const *resource )
+{
+	// Fibonacci hashing; the low bits of a pointer are mostly the allocator's alignment, so they go first
+	uint64_t address = (uint64_t)(uintptr_t)resource >> 4;
+	return (uint)( ( address * 0x9E3779B97F4A7C15ULL ) >> ( 64U - RENDER_SORT_ID_BITS ) );
+}
+
+uint QuantizeRenderDepth( float depth, uint bitCount )
+{
+	// Bits of a non-negative float go up as the float does; its highest bitCount bits, after the sign, are what we keep
+	if( (depth > 0.f) == false )		// NaN too
+		return 0U;
+
+	uint32_t depthBits;
+	memcpy( &depthBits, &depth, sizeof(float) );
+	return (uint)( depthBits >> ( 31U - bitCount ) );
+}
+
+RenderSortKey MakeOpaqueSortKey( uint layer, uint shaderID, uint materialID, uint meshID, float depth )
+{
+	RenderSortKey layerBits	= (RenderSortKey)( layer < 255U ? layer : 255U );
+	RenderSortKey depthBits	= (RenderSortKey)QuantizeRenderDepth( depth, RENDER_SORT_OPAQUE_DEPTH_BITS );
+
+	return	( layerBits							<< 56U ) |
+			( (RenderSortKey)( shaderID & RENDER_SORT_ID_MASK )		<< 43U ) |
+			( (RenderSortKey)( materialID & RENDER_SORT_ID_MASK )	<< 31U ) |
+			( (RenderSortKey)( meshID & RENDER_SORT_ID_MASK )		<< 19U ) |
+			depthBits;
+}
+
+RenderSortKey MakeAlphaSortKey( uint layer, uint shaderID, uint materialID, float depth )
+{
+	RenderSortKey layerBits	= (RenderSortKey)( layer < 255U ? layer : 255U );
+	RenderSortKey maxDepth	= ( 1ULL << RENDER_SORT_ALPHA_DEPTH_BITS ) - 1ULL;
+	RenderSortKey depthBits	= maxDepth - (RenderSortKey)QuantizeRenderDepth( depth, RENDER_SORT_ALPHA_DEPTH_BITS );	// Far ones first
+
+	return	( layerBits							<< 56U ) |
+			( 1ULL								<< 55U ) |
+			( depthBits							<< 31U ) |
+			( (RenderSortKey)( shaderID & RENDER_SORT_ID_MASK )		<< 19U ) |
+			( (RenderSortKey)( materialID & RENDER_SORT_ID_MASK )	<<  7U );
+}
+
+void RenderQueue::Clear()
+{
+	m_drawCalls.clear();
+	m_keys.clear();
+	m_sortedKeys.clear();
+	m_sortedIndices.clear();
+	m_sortPassCount = 0U;
+}
+
+uint RenderQueue::Add( DrawCall const &drawCall, RenderSortKey key )
+{
+	m_drawCalls.push_back( drawCall );
+	m_keys.push_back( key );
+
+	return (uint)m_drawCalls.size() - 1U;
+}
+
+void RenderQueue::Sort()
+{
+	uint const count = (uint)m_keys.size();
+
+	m_sortedKeys	.resize( count );
+	m_sortedIndices	.resize( count );
+	m_scratchKeys	.resize( count );
+	m_scratchIndices.resize( count );
+
+	for( uint i = 0; i < count; i++ )
+	{
+		m_sortedKeys[i]		= m_keys[i];
+		m_sortedIndices[i]	= i;
+	}
+
+	// Histograms of all eight bytes in one go
+	uint histograms[8][256];
+	memset( histograms, 0, sizeof(histograms) );
+	for( uint i = 0; i < count; i++ )
+	{
+		RenderSortKey key = m_keys[i];
+		for( uint byteIdx = 0; byteIdx < 8U; byteIdx++ )
+			histograms[ byteIdx ][ (key >> (byteIdx * 8U)) & 0xFFU ]++;
+	}
+
+	m_sortPassCount = 0U;
+	for( uint byteIdx = 0; byteIdx < 8U; byteIdx++ )
+	{
+		uint		*histogram	= histograms[ byteIdx ];
+		uint const	 shift		= byteIdx * 8U;
+
+		// If every key has the same byte here, this pass wouldn't move anything
+		if( count == 0U || histogram[ (m_sortedKeys[0] >> shift) & 0xFFU ] == count )
+			continue;
+
+		// Counts to where each bucket starts
+		uint offset = 0U;
+		for( uint bucket = 0; bucket < 256U; bucket++ )
+		{
+			uint bucketCount	= histogram[ bucket ];
+			histogram[ bucket ]	= offset;
+			offset			   += bucketCount;
+		}
+
+		// In order, so whatever the earlier passes sorted stays sorted
+		for( uint i = 0; i < count; i++ )
+		{
+			RenderSortKey	key		= m_sortedKeys[i];
+			uint			dest	= histogram[ (key >> shift) & 0xFFU ]++;
+
+			m_scratchKeys[ dest ]		= key;
+			m_scratchIndices[ dest ]	= m_sortedIndices[i];
+		}
+
+		m_sortedKeys.swap( m_scratchKeys );
+		m_sortedIndices.swap( m_scratchIndices );
+		m_sortPassCount++;
+	}
+}
+
+// What a draw call of the synthetic scene would bind
+struct SyntheticDraw
+{
+	uint	shaderID;
+	uint	materialID;
+	uint	meshID;
+	float	depth;
+};
+
+// Against the RenderQueue, a comparison sort which carries the DrawCall along
+struct KeyedDrawCall
+{
+	RenderSortKey	key;
+	uint			index;
+	DrawCall		drawCall;
+};
+
+// Times the shader, material & mesh would get switched, drawing in the given order
+static void CountStateChanges( std::vector< SyntheticDraw > const &draws, std::vector< uint > const &order, uint &shaderChanges, uint &materialChanges, uint &meshChanges )
+{
+	shaderChanges	= 0U;
+	materialChanges	= 0U;
+	meshChanges		= 0U;
+
+	for( uint i = 0; i < order.size(); i++ )
+	{
+		SyntheticDraw const &thisDraw = draws[ order[i] ];
+		if( i == 0U )
+		{
+			shaderChanges++;
+			materialChanges++;
+			meshChanges++;
+			continue;
+		}
+
+		SyntheticDraw const &lastDraw = draws[ order[i - 1U] ];
+		if( thisDraw.shaderID != lastDraw.shaderID )
+			shaderChanges++;
+		if( thisDraw.materialID != lastDraw.materialID )
+			materialChanges++;
+		if( thisDraw.meshID != lastDraw.meshID )
+			meshChanges++;
+	}
+}
+
+void RenderQueueBenchmark( Command &cmd )
+{
+	std::string countStr		= cmd.GetNextString();
+	std::string iterationsStr	= cmd.GetNextString();
+	uint		drawCount		= ( countStr != "" )		? (uint) atoi( countStr.c_str() )		: 20000U;
+	uint		iterations		= ( iterationsStr != "" )	? (uint) atoi( iterationsStr.c_str() )	: 50U;
+	if( drawCount == 0U || iterations == 0U )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "render_queue_benchmark: draw count & iterations can't be ZERO!" );
+		return;
+	}
+
+	// Synthetic scene: few shaders, more materials & meshes, a fifth of it transparent
+	uint const shaderCount		= 16U;
+	uint const materialCount	= 256U;
+	uint const meshCount		= 512U;
+	uint const layerCount		= 4U;
+
+	uint randomState = 1U;
+
+	std::vector< SyntheticDraw >	draws		( drawCount );
+	std::vector< DrawCall >			drawCalls	( drawCount );
+	for( uint i = 0; i < drawCount; i++ )
+	{
+		SyntheticDraw &draw = draws[i];
+		draw.materialID	= (uint)( GetSeededRandomUInt( randomState ) % materialCount );
+		draw.shaderID	= draw.materialID % shaderCount;							// A material always has the same shader
+		draw.meshID		= (uint)( GetSeededRandomUInt( randomState ) % meshCount );
+		draw.depth		= (float)( GetSeededRandomUInt( randomState ) % 500000U ) * 0.001f - 1.f;		// Some are behind the camera
+
+		DrawCall &dc = drawCalls[i];
+		dc.m_model.SetTColumn( Vector3( 0.f, 0.f, draw.depth ) );
+		dc.m_layer				= (uint)( GetSeededRandomUInt( randomState ) % layerCount );
+		dc.m_queueTypeIsApha	= ( GetSeededRandomUInt( randomState ) % 5U ) == 0U;
+		dc.m_lightCount			= 0U;
+	}
+
+	auto makeKey = [ &draws, &drawCalls ]( uint i )
+	{
+		SyntheticDraw const &draw	= draws[i];
+		DrawCall const		&dc		= drawCalls[i];
+		return dc.m_queueTypeIsApha	? MakeAlphaSortKey( dc.m_layer, draw.shaderID, draw.materialID, draw.depth )
+									: MakeOpaqueSortKey( dc.m_layer, draw.shaderID, draw.materialID, draw.meshID, draw.depth );
+	};
+
+	// RenderQueue; once untimed, so growing the vectors isn't part of it
+	RenderQueue queue;
+	double addSeconds	= 0.0;
+	double sortSeconds	= 0.0;
+	for( uint iteration = 0; iteration <= iterations; iteration++ )
+	{
+		uint64_t startHPC = Clock::GetCurrentHPC();
+		queue.Clear();
+		for( uint i = 0; i < drawCount; i++ )
+			queue.Add( drawCalls[i], makeKey(i) );
+		uint64_t addedHPC = Clock::GetCurrentHPC();
+		queue.Sort();
+		uint64_t sortedHPC = Clock::GetCurrentHPC();
+
+		if( iteration > 0U )
+		{
+			addSeconds	+= Clock::GetSecondsFromHPC( addedHPC - startHPC );
+			sortSeconds	+= Clock::GetSecondsFromHPC( sortedHPC - addedHPC );
+		}
+	}
+
+	// Comparison sort of the fat draw calls
+	std::vector< KeyedDrawCall > keyedDrawCalls;
+	keyedDrawCalls.reserve( drawCount );
+	double comparisonSeconds = 0.0;
+	for( uint iteration = 0; iteration <= iterations; iteration++ )
+	{
+		uint64_t startHPC = Clock::GetCurrentHPC();
+		keyedDrawCalls.clear();
+		for( uint i = 0; i < drawCount; i++ )
+		{
+			KeyedDrawCall keyed;
+			keyed.key		= makeKey(i);
+			keyed.index		= i;
+			keyed.drawCall	= drawCalls[i];
+			keyedDrawCalls.push_back( keyed );
+		}
+		std::stable_sort( keyedDrawCalls.begin(), keyedDrawCalls.end(), []( KeyedDrawCall const &a, KeyedDrawCall const &b ) { return a.key < b.key; } );
+
+		if( iteration > 0U )
+			comparisonSeconds += Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+	}
+
+	// Both are stable, so the orders should be the very same; alpha ones should go far to near, after the opaque ones of their layer
+	uint				mismatchCount	= 0U;
+	uint				misorderCount	= 0U;
+	std::vector< uint >	submittedOrder	( drawCount );
+	std::vector< uint >	sortedOrder		( drawCount );
+	for( uint i = 0; i < drawCount; i++ )
+	{
+		submittedOrder[i]	= i;
+		sortedOrder[i]		= queue.GetSortedIndex(i);
+
+		if( sortedOrder[i] != keyedDrawCalls[i].index )
+			mismatchCount++;
+
+		if( i == 0U )
+			continue;
+
+		DrawCall const &lastDC = drawCalls[ sortedOrder[i - 1U] ];
+		DrawCall const &thisDC = drawCalls[ sortedOrder[i] ];
+		bool layerWentBack	= thisDC.m_layer < lastDC.m_layer;
+		bool sameQueue		= thisDC.m_layer == lastDC.m_layer && thisDC.m_queueTypeIsApha == lastDC.m_queueTypeIsApha;
+		bool opaqueAfter	= thisDC.m_layer == lastDC.m_layer && lastDC.m_queueTypeIsApha && thisDC.m_queueTypeIsApha == false;
+		bool alphaGotFarther= sameQueue && thisDC.m_queueTypeIsApha && draws[ sortedOrder[i] ].depth > draws[ sortedOrder[i - 1U] ].depth &&
+							  QuantizeRenderDepth( draws[ sortedOrder[i] ].depth, RENDER_SORT_ALPHA_DEPTH_BITS ) != QuantizeRenderDepth( draws[ sortedOrder[i - 1U] ].depth, RENDER_SORT_ALPHA_DEPTH_BITS );
+		if( layerWentBack || opaqueAfter || alphaGotFarther )
+			misorderCount++;
+	}
+
+	uint submittedShaders, submittedMaterials, submittedMeshes;
+	uint sortedShaders, sortedMaterials, sortedMeshes;
+	CountStateChanges( draws, submittedOrder, submittedShaders, submittedMaterials, submittedMeshes );
+	CountStateChanges( draws, sortedOrder, sortedShaders, sortedMaterials, sortedMeshes );
+
+	double usPerIteration = 1000000.0 / (double)iterations;
+	ConsolePrintf( "render_queue_benchmark: %u draw calls, %u iterations", drawCount, iterations );
+	ConsolePrintf( "  RenderQueue      add %8.1f us, radix sort %8.1f us (%u passes)", addSeconds * usPerIteration, sortSeconds * usPerIteration, queue.GetSortPassCount() );
+	ConsolePrintf( "  std::stable_sort %8.1f us, keys & DrawCall copies included", comparisonSeconds * usPerIteration );
+	ConsolePrintf( "  State changes    submitted: %u shaders, %u materials, %u meshes; sorted: %u shaders, %u materials, %u meshes",
+				   submittedShaders, submittedMaterials, submittedMeshes, sortedShaders, sortedMaterials, sortedMeshes );
+	ConsolePrintf( (mismatchCount == 0U && misorderCount == 0U) ? RGBA_WHITE_COLOR : RGBA_RED_COLOR, "  %u mismatches against std::stable_sort, %u out of order", mismatchCount, misorderCount );
+}
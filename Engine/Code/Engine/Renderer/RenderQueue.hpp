@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Input/Command.hpp"
+#include "Engine/Renderer/DrawCall.hpp"
+
+//------------------------------------------------------------------------------------------
+// Draw calls of a camera, drawn in the order of a 64-bit sort key each
+//	- Draw calls stay where they got added; Sort() orders just the indices, so a DrawCall never gets copied around
+//	- Radix sort, a byte at a time from the lowest one; O(n), stable & it skips the bytes every key has the same
+//	- Key, from the highest bit: layer (8) | alpha queue (1) | the rest (55)
+//		- Opaque: shader (12) | material (12) | mesh (12) | depth (19), so state changes are few & near ones go first
+//		- Alpha:  far-to-near depth (24) | shader (12) | material (12) | unused (7), so blending stays correct
+//	- Shader, material & mesh go in as 12-bit IDs; GetRenderSortID() makes one from a pointer. Two of them sharing an ID just
+//	  won't get grouped, the order is right either way
+//	- Depth is the distance along the camera's forward; behind the camera counts as ZERO
+//
+typedef uint64_t RenderSortKey;
+
+#define RENDER_SORT_LAYER_BITS			(8)
+#define RENDER_SORT_ID_BITS				(12)
+#define RENDER_SORT_OPAQUE_DEPTH_BITS	(19)
+#define RENDER_SORT_ALPHA_DEPTH_BITS	(24)
+
+uint			GetRenderSortID		( void const *resource );			// In [ 0, 2^RENDER_SORT_ID_BITS )
+uint			QuantizeRenderDepth	( float depth, uint bitCount );		// Keeps the order of the non-negative floats
+RenderSortKey	MakeOpaqueSortKey	( uint layer, uint shaderID, uint materialID, uint meshID, float depth );
+RenderSortKey	MakeAlphaSortKey	( uint layer, uint shaderID, uint materialID, float depth );
+
+class RenderQueue
+{
+public:
+	 RenderQueue() { }
+	~RenderQueue() { }
+
+private:
+	std::vector< DrawCall >			m_drawCalls;					// In the order they got added
+	std::vector< RenderSortKey >	m_keys;							// One per draw call
+	std::vector< RenderSortKey >	m_sortedKeys;
+	std::vector< uint >				m_sortedIndices;				// Into m_drawCalls
+	std::vector< RenderSortKey >	m_scratchKeys;					// The other half of each radix pass
+	std::vector< uint >				m_scratchIndices;
+
+	uint							m_sortPassCount		= 0U;		// Of the last Sort(); up to 8, the rest got skipped
+
+public:
+	void			Clear();										// Keeps the memory, for the next frame
+	uint			Add( DrawCall const &drawCall, RenderSortKey key );	// Returns its index
+	void			Sort();
+
+	inline uint				GetCount() const						{ return (uint)m_drawCalls.size(); }
+	inline DrawCall&		GetSorted( uint idx )					{ return m_drawCalls[ m_sortedIndices[idx] ]; }	// Sort() first
+	inline RenderSortKey	GetSortedKey( uint idx ) const			{ return m_sortedKeys[idx]; }
+	inline uint				GetSortedIndex( uint idx ) const		{ return m_sortedIndices[idx]; }	// As returned by Add()
+	inline uint				GetSortPassCount() const				{ return m_sortPassCount; }
+};
+
+
+// Console Commands
+void RenderQueueBenchmark( Command &cmd );			// render_queue_benchmark [drawCount=20000] [iterations=50]
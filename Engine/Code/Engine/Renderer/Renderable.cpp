@@ -68,6 +68,102 @@ bool Renderable::IsAlphaQueueType( uint idx /*= 0 */ ) const
 	return m_materials[ idx ]->GetShader()->m_isAlphaQueueType;
 }
 
+uint64_t Renderable::GetMeshBoundsVersion() const
+{
+	uint64_t boundsVersion = 0U;
+	for( uint i = 0; i < m_meshes.size(); i++ )
+	{
+		if( m_meshes[i] != nullptr )
+			boundsVersion += m_meshes[i]->m_boundsVersion;
+	}
+
+	return boundsVersion;
+}
+
+bool Renderable::GetWorldBounds( AABB3 &outBounds, Sphere &outBoundingSphere ) const
+{
+	// Meshes might have been pushed straight in to m_meshes, so their count is checked too
+	uint64_t changeStamp		= m_modelTransform.GetWorldChangeStamp();
+	uint64_t meshBoundsVersion	= GetMeshBoundsVersion();
+	if( m_boundsAreDirty || changeStamp != m_boundsChangeStamp || m_meshesVersion != m_boundsMeshesVersion || m_boundsMeshCount != (uint)m_meshes.size() || meshBoundsVersion != m_boundsMeshBoundsVersion )
+	{
+		m_boundsChangeStamp			= changeStamp;
+		m_boundsMeshesVersion		= m_meshesVersion;
+		m_boundsMeshBoundsVersion	= meshBoundsVersion;
+		UpdateWorldBounds( m_modelTransform.GetWorldTransformMatrix() );
+	}
+
+	outBounds			= m_worldBounds;
+	outBoundingSphere	= m_worldBoundingSphere;
+
+	return m_hasWorldBounds;
+}
+
+void Renderable::UpdateWorldBounds( Matrix44 const &modelMatrix ) const
+{
+	m_boundsMeshCount	= (uint)m_meshes.size();
+	m_boundsAreDirty	= false;
+	m_hasWorldBounds	= false;
+
+	if( m_meshes.size() == 0 )
+		return;
+
+	// Union of the meshes, in model space
+	AABB3 localBounds;
+	for( uint i = 0; i < m_meshes.size(); i++ )
+	{
+		Mesh const *mesh = m_meshes[i];
+		if( mesh == nullptr || mesh->m_hasBounds == false )
+			return;
+
+		AABB3 const &meshBounds = mesh->m_localBounds;
+		if( i == 0 )
+		{
+			localBounds = meshBounds;
+			continue;
+		}
+
+		localBounds.mins.x = ( meshBounds.mins.x < localBounds.mins.x ) ? meshBounds.mins.x : localBounds.mins.x;
+		localBounds.mins.y = ( meshBounds.mins.y < localBounds.mins.y ) ? meshBounds.mins.y : localBounds.mins.y;
+		localBounds.mins.z = ( meshBounds.mins.z < localBounds.mins.z ) ? meshBounds.mins.z : localBounds.mins.z;
+		localBounds.maxs.x = ( meshBounds.maxs.x > localBounds.maxs.x ) ? meshBounds.maxs.x : localBounds.maxs.x;
+		localBounds.maxs.y = ( meshBounds.maxs.y > localBounds.maxs.y ) ? meshBounds.maxs.y : localBounds.maxs.y;
+		localBounds.maxs.z = ( meshBounds.maxs.z > localBounds.maxs.z ) ? meshBounds.maxs.z : localBounds.maxs.z;
+	}
+
+	// Box in world space, by Arvo's method: the center goes through the matrix, half size through its absolute values
+	Matrix44 const	&m				= modelMatrix;
+	Vector3			 halfSize		= localBounds.GetSize() * 0.5f;
+	Vector3			 worldCenter	= m.Multiply( localBounds.GetCenter(), 1.f );
+	Vector3			 worldHalfSize	= Vector3(	fabsf( m.Ix ) * halfSize.x + fabsf( m.Jx ) * halfSize.y + fabsf( m.Kx ) * halfSize.z,
+												fabsf( m.Iy ) * halfSize.x + fabsf( m.Jy ) * halfSize.y + fabsf( m.Ky ) * halfSize.z,
+												fabsf( m.Iz ) * halfSize.x + fabsf( m.Jz ) * halfSize.y + fabsf( m.Kz ) * halfSize.z );
+	m_worldBounds = AABB3( worldCenter - worldHalfSize, worldCenter + worldHalfSize );
+
+	// Sphere around the box's center, reaching the farthest mesh's sphere; never bigger than the box's own
+	float scaleSqI		= m.Ix * m.Ix + m.Iy * m.Iy + m.Iz * m.Iz;
+	float scaleSqJ		= m.Jx * m.Jx + m.Jy * m.Jy + m.Jz * m.Jz;
+	float scaleSqK		= m.Kx * m.Kx + m.Ky * m.Ky + m.Kz * m.Kz;
+	float maxScaleSq	= ( scaleSqI > scaleSqJ ) ? scaleSqI : scaleSqJ;
+	maxScaleSq			= ( scaleSqK > maxScaleSq ) ? scaleSqK : maxScaleSq;
+	float maxScale		= sqrtf( maxScaleSq );
+
+	float radius = 0.f;
+	for( uint i = 0; i < m_meshes.size(); i++ )
+	{
+		Sphere const	&meshSphere		= m_meshes[i]->m_localBoundingSphere;
+		Vector3			 sphereCenter	= m.Multiply( meshSphere.center, 1.f );
+		float			 reach			= ( sphereCenter - worldCenter ).GetLength() + meshSphere.radius * maxScale;
+		radius = ( reach > radius ) ? reach : radius;
+	}
+
+	float boxRadius	= worldHalfSize.GetLength();
+	radius			= ( boxRadius < radius ) ? boxRadius : radius;
+
+	m_worldBoundingSphere	= Sphere( worldCenter, radius );
+	m_hasWorldBounds		= true;
+}
+
 void Renderable::SetPickID( uint pickID )
 {
 	m_pickID = pickID;
@@ -86,6 +182,8 @@ void Renderable::SetBaseMesh( Mesh *newMesh )
 
 		m_meshes[0] = newMesh;
 	}
+
+	m_meshesVersion++;
 }
 
 void Renderable::SetBaseMaterial( Material *newMaterial )
@@ -106,6 +204,7 @@ void Renderable::SetBaseMaterial( Material *newMaterial )
 uint Renderable::AddSubMesh( Mesh *newMesh )
 {
 	m_meshes.push_back( newMesh );
+	m_meshesVersion++;
 
 	return (uint)m_meshes.size();
 }
@@ -23,15 +23,33 @@ public:
 	std::vector< Mesh* >		m_meshes;
 	std::vector< Material* >	m_materials;
 
+private:
+	uint						m_meshesVersion		= 0U;		// Goes up whenever a mesh is set or added
+
+	// World bounds of all the meshes; made again only if the transform or the meshes change
+	mutable AABB3				m_worldBounds;
+	mutable Sphere				m_worldBoundingSphere;
+	mutable uint64_t			m_boundsChangeStamp	= 0U;
+	mutable uint				m_boundsMeshesVersion	= 0U;
+	mutable uint64_t			m_boundsMeshBoundsVersion	= 0U;
+	mutable uint				m_boundsMeshCount	= 0U;
+	mutable bool				m_boundsAreDirty	= true;
+	mutable bool				m_hasWorldBounds	= false;
+
+	void	UpdateWorldBounds( Matrix44 const &modelMatrix ) const;
+
 public:
 	// Getters
 	Material*			GetMaterial	( uint idx = 0 );
 	Mesh		const*	GetMesh		( uint idx = 0 ) const;
 	Transform	const&	GetTransform()	const;
 	inline		uint	GetPickID()		const { return m_pickID; }
+	inline		uint	GetMeshesVersion() const { return m_meshesVersion; }
+	uint64_t			GetMeshBoundsVersion() const;					// Sum of the meshes' bounds versions; goes up whenever one of them gets new bounds
 
 	uint				GetRenderLayer	( uint idx = 0 ) const;
 	bool				IsAlphaQueueType( uint idx = 0 ) const;
+	bool				GetWorldBounds	( AABB3 &outBounds, Sphere &outBoundingSphere ) const;	// False if a mesh has no bounds; never cull those
 
 	// Quick inline(s)
 	inline Vector3		GetPosition() const { return m_modelTransform.GetWorldPosition(); }
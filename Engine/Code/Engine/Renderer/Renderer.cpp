@@ -6,10 +6,17 @@
 #include "Engine/Renderer/ShaderProgram.hpp"
 #include "Engine/Renderer/MeshBuilder.hpp"
 #include "Engine/Renderer/TextureCube.hpp"
+#include "Engine/Renderer/RenderQueue.hpp"
+#include "Engine/Renderer/LightClusterGrid.hpp"
+#include "Engine/Renderer/FrustumCuller.hpp"
+#include "Engine/Renderer/Scene.hpp"
 #include "Engine/Core/Window.hpp"
+#include "Engine/Core/Clock.hpp"
+#include "Engine/Core/DevConsole.hpp"
 #include "Engine/Math/Vector4.hpp"
 #include "Engine/Math/Matrix44.hpp"
 #include "Engine/Math/Transform.hpp"
+#include "Engine/Math/MathUtil.hpp"
 #include "Engine/Core/Window.hpp"
 #include "Engine/Profiler/Profiler.hpp"
 
@@ -157,6 +164,13 @@ void Renderer::PostStartup()
 	s_maxConstantBufferSize = (unsigned int) uboSize;
 
 	GL_CHECK_ERROR(); 
+
+	// Command Register
+	CommandRegister( "render_queue_benchmark", RenderQueueBenchmark );
+	CommandRegister( "light_cluster_benchmark", LightClusterBenchmark );
+	CommandRegister( "frustum_cull_benchmark", FrustumCullBenchmark );
+	CommandRegister( "scene_tree_benchmark", SceneTreeBenchmark );
+	CommandRegister( "draw_submit_benchmark", DrawSubmitBenchmark );
 }
 
 bool Renderer::CopyFrameBuffer( FrameBuffer *dst, FrameBuffer *src )
@@ -291,7 +305,6 @@ void Renderer::BindMaterialForShaderIndex( Material &material, uint shaderIndex
 {
 	// Bind ShaderProgram and State
 	Shader const	*thisShader			= material.GetShader( shaderIndex );
-	unsigned int	 thisShaderHandle	= thisShader->m_program->GetHandle();
 	UseShader( thisShader );
 
 	// Bind the Material specific properties
@@ -308,12 +321,12 @@ void Renderer::BindMaterialForShaderIndex( Material &material, uint shaderIndex
 
 	// Bind Uniform Properties
 	for each ( MaterialProperty *prop in std::get<1>(material.m_shaderGroup[ shaderIndex ]) )
-		prop->Bind( thisShaderHandle );
+		prop->Bind( *thisShader->m_program );
 }
 
 void Renderer::SetUniform( char const *name, float flt )
 {
-	GLint float_loc = glGetUniformLocation( m_currentShader->m_program->GetHandle(), name );
+	GLint float_loc = m_currentShader->m_program->GetUniformLocation( name );
 	if (float_loc >= 0)
 		glUniform1fv( float_loc, 1, &flt );
 }
@@ -322,7 +335,7 @@ void Renderer::SetUniform( char const *name, Vector3 const &vct )
 {
 	float values[3] = { vct.x, vct.y, vct.z	};
 
-	GLint vec3_loc = glGetUniformLocation( m_currentShader->m_program->GetHandle(), name );
+	GLint vec3_loc = m_currentShader->m_program->GetUniformLocation( name );
 	if (vec3_loc >= 0)
 		glUniform3fv( vec3_loc, 1, (GLfloat*)&values );
 }
@@ -331,7 +344,7 @@ void Renderer::SetUniform( char const *name, Vector4 const &vct )
 {
 	float values[4] = { vct.x, vct.y, vct.z, vct.w	};
 
-	GLint vec4_loc = glGetUniformLocation( m_currentShader->m_program->GetHandle(), name );
+	GLint vec4_loc = m_currentShader->m_program->GetUniformLocation( name );
 	if (vec4_loc >= 0)
 		glUniform4fv( vec4_loc, 1, (GLfloat*)&values );
 }
@@ -341,21 +354,21 @@ void Renderer::SetUniform( char const *name, Rgba const &clr )
 	Vector4 colorNormalized;
 	clr.GetAsFloats( colorNormalized.x, colorNormalized.y, colorNormalized.z, colorNormalized.w );
 
-	GLint floats_loc = glGetUniformLocation( m_currentShader->m_program->GetHandle(), name );
+	GLint floats_loc = m_currentShader->m_program->GetUniformLocation( name );
 	if (floats_loc >= 0)
 		glUniform4fv( floats_loc, 1, (GLfloat*)&colorNormalized );
 }
 
 void Renderer::SetUniform( char const *name, Matrix44 const &mat44 )
 {
-	GLint mat_loc = glGetUniformLocation( m_currentShader->m_program->GetHandle(), name );
+	GLint mat_loc = m_currentShader->m_program->GetUniformLocation( name );
 	if (mat_loc >= 0)
 		glUniformMatrix4fv( mat_loc, 1, GL_FALSE, (GLfloat*)&mat44 );
 }
 
 void Renderer::SetUniform( char const *name, uint unsignedInt )
 {
-	GLint float_loc = glGetUniformLocation( m_currentShader->m_program->GetHandle(), name );
+	GLint float_loc = m_currentShader->m_program->GetUniformLocation( name );
 	if (float_loc >= 0)
 		glUniform1uiv( float_loc, 1, &unsignedInt );
 }
@@ -555,6 +568,11 @@ void BindGLFunctions()
 
 	GL_BIND_FUNCTION( wglSwapIntervalEXT );
 	GL_BIND_FUNCTION( glPointSize );
+
+	GL_BIND_FUNCTION( glGetActiveUniform );
+	GL_BIND_FUNCTION( glGetActiveAttrib );
+	GL_BIND_FUNCTION( glDeleteVertexArrays );
+	GL_BIND_FUNCTION( glFinish );
 }
 	
 //------------------------------------------------------------------------
@@ -881,11 +899,21 @@ void Renderer::DrawMesh( Mesh const &mesh, const Matrix44 & modelMatrix /* = Mat
 {
 	Camera *activeCamera = ( s_current_camera != nullptr ) ? s_current_camera : s_default_camera;
 	
-	BindMeshToProgram( m_currentShader->m_program, &mesh );
+	ShaderProgram const *program = m_currentShader->m_program;
+	BindMeshToProgram( program, &mesh );
 	
-	// Bind all the Uniforms
-	SetUniform( "MODEL", modelMatrix );
-	SetUniform( "EYE_POSITION", activeCamera->m_cameraTransform.GetWorldPosition() );
+	// Bind all the Uniforms, by the locations the program got at its link
+	GLint modelLocation = program->GetBuiltInUniformLocation( UNIFORM_MODEL );
+	if( modelLocation >= 0 )
+		glUniformMatrix4fv( modelLocation, 1, GL_FALSE, (GLfloat const *)&modelMatrix );
+
+	GLint eyePositionLocation = program->GetBuiltInUniformLocation( UNIFORM_EYE_POSITION );
+	if( eyePositionLocation >= 0 )
+	{
+		Vector3	eyePosition	= activeCamera->m_cameraTransform.GetWorldPosition();
+		float	values[3]	= { eyePosition.x, eyePosition.y, eyePosition.z };
+		glUniform3fv( eyePositionLocation, 1, (GLfloat const *)values );
+	}
 
 	// Update the Light UBO
 	UpdateLightUBOs();
@@ -894,42 +922,67 @@ void Renderer::DrawMesh( Mesh const &mesh, const Matrix44 & modelMatrix /* = Mat
 
 	if( mesh.m_drawCallInstruction.isUsingIndices == true )
 	{
-		glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, mesh.m_ibo->GetHandle() );
+		// Index buffer is bound in the mesh's vertex array
 		glDrawElements( glPrimitiveType, mesh.m_drawCallInstruction.elementCount, GL_UNSIGNED_INT, 0 );
 	}
 	else
 	{
 		glDrawArrays( glPrimitiveType, 0, mesh.m_drawCallInstruction.elementCount );
 	}
+
+	// Back to the default one, so the buffer binds of the code after this don't end up in the mesh's vertex array
+	glBindVertexArray( s_default_vao );
 	
 	GL_CHECK_ERROR();
 }
 
 void Renderer::BindMeshToProgram( ShaderProgram const *shaderProgram, Mesh const *mesh )
 {
-	glBindBuffer( GL_ARRAY_BUFFER, mesh->m_vbo->GetHandle() );
+	VertexLayout const	*layout			= mesh->m_layout;
+	uint				 programID		= shaderProgram->GetProgramID();
+	GLuint				 vboHandle		= mesh->m_vbo->GetHandle();
+	GLuint				 iboHandle		= ( mesh->m_ibo != nullptr ) ? mesh->m_ibo->GetHandle() : NULL;
 
-	unsigned int	vertexStride	= mesh->GetVertexStride();
-	GLuint			programHandle	= shaderProgram->GetHandle();
-	unsigned int	attributeCount	= mesh->m_layout->GetAttributeCount();
+	mesh->DropRetiredVertexArrays();
+	MeshVertexArray *vertexArray = mesh->FindVertexArray( programID, layout );
+	if( vertexArray == nullptr )
+		vertexArray = mesh->CreateVertexArray( programID, layout );
 
-	for( unsigned int attributeIdx = 0; attributeIdx < attributeCount; attributeIdx++ )
+	glBindVertexArray( vertexArray->handle );
+
+	// Attribute pointers get set once, on the first draw; again only if the mesh got a new vertex buffer
+	if( vertexArray->vertexBufferHandle != vboHandle )
 	{
-		VertexAttribute const &attribute = mesh->m_layout->GetAttributeAtIndex( attributeIdx );
-		
-		int bind = glGetAttribLocation( programHandle, attribute.name.c_str() );
-		if( bind >= 0 )
+		glBindBuffer( GL_ARRAY_BUFFER, vboHandle );
+
+		unsigned int vertexStride	= layout->m_stride;
+		unsigned int attributeCount	= layout->GetAttributeCount();
+		for( unsigned int attributeIdx = 0; attributeIdx < attributeCount; attributeIdx++ )
 		{
-			glEnableVertexAttribArray( bind );
-
-			glVertexAttribPointer( 
-				bind,
-				attribute.elementsCount,
-				GetAsOpenGLDataType( attribute.type ),
-				attribute.normalize,
-				vertexStride,
-				(GLvoid*) attribute.memberOffset );
+			VertexAttribute const &attribute = layout->GetAttributeAtIndex( attributeIdx );
+		
+			int bind = shaderProgram->GetAttributeLocation( attribute.name );
+			if( bind >= 0 )
+			{
+				glEnableVertexAttribArray( bind );
+
+				glVertexAttribPointer( 
+					bind,
+					attribute.elementsCount,
+					GetAsOpenGLDataType( attribute.type ),
+					attribute.normalize,
+					vertexStride,
+					(GLvoid*) attribute.memberOffset );
+			}
 		}
+
+		vertexArray->vertexBufferHandle = vboHandle;
+	}
+
+	if( vertexArray->indexBufferHandle != iboHandle )
+	{
+		glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, iboHandle );
+		vertexArray->indexBufferHandle = iboHandle;
 	}
 	
 	GL_CHECK_ERROR();
@@ -1483,4 +1536,106 @@ Texture* Renderer::GetDefaultColorTarget()
 Texture* Renderer::GetDefaultDepthTarget()
 {
 	return s_defaultDepthTarget;
+}
+
+void DrawSubmitBenchmark( Command &cmd )
+{
+	std::string drawCountStr	= cmd.GetNextString();
+	std::string iterationsStr	= cmd.GetNextString();
+	uint		drawCount		= ( drawCountStr != "" )	? (uint) atoi( drawCountStr.c_str() )	: 5000U;
+	uint		iterations		= ( iterationsStr != "" )	? (uint) atoi( iterationsStr.c_str() )	: 20U;
+	if( drawCount == 0U || iterations == 0U )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "draw_submit_benchmark: draw count & iterations can't be ZERO!" );
+		return;
+	}
+
+	Renderer *renderer = Renderer::GetInstance();
+	renderer->BindCamera( nullptr );
+	renderer->UseShader( renderer->m_defaultShader );
+
+	ShaderProgram const	*program		= renderer->m_defaultShader->m_program;
+	GLuint				 programHandle	= program->GetHandle();
+	Mesh				*cube			= MeshBuilder::CreateCube( Vector3( 0.5f, 0.5f, 0.5f ) );
+
+	uint randomState = 1U;
+
+	std::vector< Matrix44 > modelMatrices;
+	modelMatrices.reserve( drawCount );
+	for( uint i = 0; i < drawCount; i++ )
+		modelMatrices.push_back( Matrix44( Vector3( GetSeededRandomFloatInRange( randomState, -20.f, 20.f ), GetSeededRandomFloatInRange( randomState, -20.f, 20.f ), GetSeededRandomFloatInRange( randomState, 5.f, 60.f ) ) ) );
+
+	// Like it was: one vertex array for all, pointers set again & every location looked up by its name, on each draw
+	GLenum glPrimitiveType = GetAsOpenGLPrimitiveType( cube->m_drawCallInstruction.primitiveType );
+	auto drawByNames = [ & ]( Matrix44 const &modelMatrix )
+	{
+		glBindBuffer( GL_ARRAY_BUFFER, cube->m_vbo->GetHandle() );
+		for( uint attributeIdx = 0; attributeIdx < cube->m_layout->GetAttributeCount(); attributeIdx++ )
+		{
+			VertexAttribute const &attribute = cube->m_layout->GetAttributeAtIndex( attributeIdx );
+			int bind = glGetAttribLocation( programHandle, attribute.name.c_str() );
+			if( bind >= 0 )
+			{
+				glEnableVertexAttribArray( bind );
+				glVertexAttribPointer( bind, attribute.elementsCount, GetAsOpenGLDataType( attribute.type ), attribute.normalize, cube->GetVertexStride(), (GLvoid*) attribute.memberOffset );
+			}
+		}
+
+		GLint modelLocation = glGetUniformLocation( programHandle, "MODEL" );
+		if( modelLocation >= 0 )
+			glUniformMatrix4fv( modelLocation, 1, GL_FALSE, (GLfloat const *)&modelMatrix );
+
+		GLint eyePositionLocation = glGetUniformLocation( programHandle, "EYE_POSITION" );
+		if( eyePositionLocation >= 0 )
+		{
+			Vector3	eyePosition	= Renderer::s_current_camera->m_cameraTransform.GetWorldPosition();
+			float	values[3]	= { eyePosition.x, eyePosition.y, eyePosition.z };
+			glUniform3fv( eyePositionLocation, 1, (GLfloat const *)values );
+		}
+
+		renderer->UpdateLightUBOs();
+		if( cube->m_drawCallInstruction.isUsingIndices == true )
+		{
+			glBindBuffer( GL_ELEMENT_ARRAY_BUFFER, cube->m_ibo->GetHandle() );
+			glDrawElements( glPrimitiveType, cube->m_drawCallInstruction.elementCount, GL_UNSIGNED_INT, 0 );
+		}
+		else
+			glDrawArrays( glPrimitiveType, 0, cube->m_drawCallInstruction.elementCount );
+	};
+
+	// Only the submission gets timed; the GPU finishes in between, so one run doesn't wait on the other's draws
+	double byNamesSeconds = 0.0;
+	for( uint iteration = 0; iteration <= iterations; iteration++ )
+	{
+		glBindVertexArray( Renderer::s_default_vao );
+
+		uint64_t startHPC = Clock::GetCurrentHPC();
+		for( uint i = 0; i < drawCount; i++ )
+			drawByNames( modelMatrices[i] );
+
+		if( iteration > 0U )
+			byNamesSeconds += Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+		glFinish();
+	}
+
+	// Cached locations & the mesh's own vertex array
+	double cachedSeconds = 0.0;
+	for( uint iteration = 0; iteration <= iterations; iteration++ )
+	{
+		uint64_t startHPC = Clock::GetCurrentHPC();
+		for( uint i = 0; i < drawCount; i++ )
+			renderer->DrawMesh( *cube, modelMatrices[i] );
+
+		if( iteration > 0U )
+			cachedSeconds += Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+		glFinish();
+	}
+
+	delete cube;
+
+	double byNamesMS	= byNamesSeconds * 1000.0 / (double)iterations;
+	double cachedMS		= cachedSeconds  * 1000.0 / (double)iterations;
+	ConsolePrintf( "draw_submit_benchmark: %u draws, over %u iterations", drawCount, iterations );
+	ConsolePrintf( "  By names:  %.3f ms ( %.3f us per draw )", byNamesMS, byNamesMS * 1000.0 / (double)drawCount );
+	ConsolePrintf( "  Cached:    %.3f ms ( %.3f us per draw ), %.2fx", cachedMS, cachedMS * 1000.0 / (double)drawCount, ( cachedMS > 0.0 ) ? byNamesMS / cachedMS : 0.0 );
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "Engine/Core/Image.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Input/Command.hpp"
 #include "Engine/Math/AABB2.hpp"
 #include "Engine/Math/Vector2.hpp"
 #include "Engine/Math/Vector4.hpp"
@@ -223,4 +224,8 @@ private:
 								  const AABB2& uv_top		= AABB2::ONE_BY_ONE, 
 								  const AABB2& uv_side		= AABB2::ONE_BY_ONE, 
 								  const AABB2& uv_bottom	= AABB2::ONE_BY_ONE );
-};
\ No newline at end of file
+};
+
+
+// Console Commands
+void DrawSubmitBenchmark( Command &cmd );			// draw_submit_benchmark [drawCount=5000] [iterations=20]
\ No newline at end of file
@@ -1,6 +1,15 @@
 #pragma once
 #include "Scene.hpp"
+#include <float.h>
+#include <algorithm>
 #include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Core/Clock.hpp"
+#include "Engine/Core/DevConsole.hpp"
+#include "Engine/Math/MathUtil.hpp"
+#include "Engine/Renderer/FrustumCuller.hpp"
+#include "Engine/Renderer/Light.hpp"
+#include "Engine/Renderer/Renderable.hpp"
+#include "Engine/Renderer/LightClusterGrid.hpp"
 
 void Scene::AddLight( Light &light )
 {
@@ -12,6 +21,7 @@ void Scene::AddLight( Light &light )
 	}
 
 	m_lights.push_back( &light );
+	m_lightProxies.push_back( SceneSpatialProxy() );
 }
 
 void Scene::AddCamera( Camera &camera )
@@ -29,6 +39,7 @@ void Scene::AddCamera( Camera &camera )
 void Scene::AddRenderable( Renderable &renderable )
 {
 	m_renderables.push_back( &renderable );
+	m_renderableProxies.push_back( SceneSpatialProxy() );
 }
 
 void Scene::RemoveRenderable( Renderable &removeMe )
@@ -39,14 +50,357 @@ void Scene::RemoveRenderable( Renderable &removeMe )
 	{
 		if( m_renderables[i] == &removeMe )
 		{
+			// Take it out of the index
+			if( m_renderableProxies[i].proxyID != DYNAMIC_AABB_TREE_NULL_NODE )
+				m_renderableTree.DestroyProxy( m_renderableProxies[i].proxyID );
+
+			for( uint j = 0; j < m_unboundedRenderables.size(); j++ )
+			{
+				if( m_unboundedRenderables[j] == &removeMe )
+				{
+					std::swap( m_unboundedRenderables[j], m_unboundedRenderables.back() );
+					m_unboundedRenderables.pop_back();
+					break;
+				}
+			}
+
 			// Swap it with the last one
 			std::swap( m_renderables[i], m_renderables[ totalRenderables - 1 ] );
+			std::swap( m_renderableProxies[i], m_renderableProxies[ totalRenderables - 1 ] );
 
 			// pop back
 			m_renderables.pop_back();
+			m_renderableProxies.pop_back();
 
 			// return..
 			return;
 		}
 	}
 }
+
+void Scene::RemoveLight( Light &removeMe )
+{
+	uint totalLights = (uint) m_lights.size();
+
+	for( uint i = 0; i < totalLights; i++ )
+	{
+		if( m_lights[i] == &removeMe )
+		{
+			if( m_lightProxies[i].proxyID != DYNAMIC_AABB_TREE_NULL_NODE )
+				m_lightTree.DestroyProxy( m_lightProxies[i].proxyID );
+
+			for( uint j = 0; j < m_unboundedLights.size(); j++ )
+			{
+				if( m_unboundedLights[j] == &removeMe )
+				{
+					std::swap( m_unboundedLights[j], m_unboundedLights.back() );
+					m_unboundedLights.pop_back();
+					break;
+				}
+			}
+
+			// Lights are indexed by draw calls, so the order of the rest is kept
+			m_lights.erase( m_lights.begin() + i );
+			m_lightProxies.erase( m_lightProxies.begin() + i );
+
+			return;
+		}
+	}
+}
+
+void Scene::UpdateSpatialIndex()
+{
+	// In case some got pushed straight in to, or erased from, the lists
+	for( size_t i = m_renderables.size(); i < m_renderableProxies.size(); i++ )
+	{
+		if( m_renderableProxies[i].proxyID != DYNAMIC_AABB_TREE_NULL_NODE )
+			m_renderableTree.DestroyProxy( m_renderableProxies[i].proxyID );
+	}
+	for( size_t i = m_lights.size(); i < m_lightProxies.size(); i++ )
+	{
+		if( m_lightProxies[i].proxyID != DYNAMIC_AABB_TREE_NULL_NODE )
+			m_lightTree.DestroyProxy( m_lightProxies[i].proxyID );
+	}
+	m_renderableProxies.resize( m_renderables.size() );
+	m_lightProxies.resize( m_lights.size() );
+
+	m_unboundedRenderables.clear();
+	m_unboundedLights.clear();
+
+	for( uint i = 0; i < m_renderables.size(); i++ )
+	{
+		UpdateRenderableProxy( i );
+		if( m_renderableProxies[i].proxyID == DYNAMIC_AABB_TREE_NULL_NODE )
+			m_unboundedRenderables.push_back( m_renderables[i] );
+	}
+
+	for( uint i = 0; i < m_lights.size(); i++ )
+	{
+		UpdateLightProxy( i );
+		if( m_lightProxies[i].proxyID == DYNAMIC_AABB_TREE_NULL_NODE )
+			m_unboundedLights.push_back( m_lights[i] );
+	}
+}
+
+void Scene::UpdateRenderableProxy( uint renderableIdx )
+{
+	Renderable const	*renderable		= m_renderables[ renderableIdx ];
+	SceneSpatialProxy	&proxy			= m_renderableProxies[ renderableIdx ];
+	uint64_t			 changeStamp	= renderable->GetTransform().GetWorldChangeStamp();
+	uint				 meshCount		= (uint)renderable->m_meshes.size();
+	uint64_t			 boundsVersion	= renderable->GetMeshBoundsVersion();
+
+	bool isUpToDate = proxy.isIndexed && proxy.object == renderable && proxy.changeStamp == changeStamp && proxy.meshesVersion == renderable->GetMeshesVersion() && proxy.meshCount == meshCount && proxy.meshBoundsVersion == boundsVersion;
+	if( isUpToDate )
+		return;
+
+	proxy.isIndexed		= true;
+	proxy.object		= renderable;
+	proxy.changeStamp	= changeStamp;
+	proxy.meshesVersion	= renderable->GetMeshesVersion();
+	proxy.meshCount		= meshCount;
+	proxy.meshBoundsVersion	= boundsVersion;
+
+	AABB3	worldBounds;
+	Sphere	worldBoundingSphere;
+	bool	hasBounds = renderable->GetWorldBounds( worldBounds, worldBoundingSphere );
+
+	if( hasBounds == false )
+	{
+		if( proxy.proxyID != DYNAMIC_AABB_TREE_NULL_NODE )
+			m_renderableTree.DestroyProxy( proxy.proxyID );
+		proxy.proxyID = DYNAMIC_AABB_TREE_NULL_NODE;
+	}
+	else if( proxy.proxyID == DYNAMIC_AABB_TREE_NULL_NODE )
+		proxy.proxyID = m_renderableTree.CreateProxy( worldBounds, (void*) renderable );
+	else
+	{
+		m_renderableTree.SetUserData( proxy.proxyID, (void*) renderable );
+		m_renderableTree.MoveProxy( proxy.proxyID, worldBounds, worldBoundingSphere.center - proxy.center );
+	}
+
+	proxy.center = worldBoundingSphere.center;
+}
+
+void Scene::UpdateLightProxy( uint lightIdx )
+{
+	Light const			*light			= m_lights[ lightIdx ];
+	SceneSpatialProxy	&proxy			= m_lightProxies[ lightIdx ];
+	uint64_t			 changeStamp	= light->m_transform.GetWorldChangeStamp();
+	float				 range			= LightClusterGrid::GetRange( light->m_lightColorAndIntensity.w, light->m_attenuation );
+
+	bool isUpToDate = proxy.isIndexed && proxy.object == light && proxy.changeStamp == changeStamp && proxy.range == range;
+	if( isUpToDate )
+		return;
+
+	proxy.isIndexed		= true;
+	proxy.object		= light;
+	proxy.changeStamp	= changeStamp;
+	proxy.range			= range;
+
+	if( range == FLT_MAX )
+	{
+		if( proxy.proxyID != DYNAMIC_AABB_TREE_NULL_NODE )
+			m_lightTree.DestroyProxy( proxy.proxyID );
+		proxy.proxyID = DYNAMIC_AABB_TREE_NULL_NODE;
+		return;
+	}
+
+	Vector3 position	= light->GetPosition();
+	Vector3 extents		= Vector3( range, range, range );
+	AABB3	bounds		= AABB3( position - extents, position + extents );
+
+	if( proxy.proxyID == DYNAMIC_AABB_TREE_NULL_NODE )
+		proxy.proxyID = m_lightTree.CreateProxy( bounds, (void*) light );
+	else
+	{
+		m_lightTree.SetUserData( proxy.proxyID, (void*) light );
+		m_lightTree.MoveProxy( proxy.proxyID, bounds, position - proxy.center );
+	}
+
+	proxy.center = position;
+}
+
+void Scene::QueryRenderablesInFrustum( Plane3 const *planes, uint planeCount, std::vector< Renderable* > &outRenderables ) const
+{
+	m_queryResults.clear();
+	m_renderableTree.QueryPlanes( planes, planeCount, m_queryResults );
+	AppendResults( outRenderables );
+}
+
+void Scene::QueryRenderablesInBox( AABB3 const &box, std::vector< Renderable* > &outRenderables ) const
+{
+	m_queryResults.clear();
+	m_renderableTree.QueryBox( box, m_queryResults );
+	AppendResults( outRenderables );
+}
+
+void Scene::QueryRenderablesInSphere( Sphere const &sphere, std::vector< Renderable* > &outRenderables ) const
+{
+	m_queryResults.clear();
+	m_renderableTree.QuerySphere( sphere, m_queryResults );
+	AppendResults( outRenderables );
+}
+
+void Scene::QueryRenderablesAlongRay( Vector3 const &start, Vector3 const &direction, float maxDistance, std::vector< Renderable* > &outRenderables ) const
+{
+	m_queryResults.clear();
+	m_renderableTree.QueryRay( start, direction, maxDistance, m_queryResults );
+	AppendResults( outRenderables );
+}
+
+void Scene::QueryLightsInFrustum( Plane3 const *planes, uint planeCount, std::vector< Light* > &outLights ) const
+{
+	m_queryResults.clear();
+	m_lightTree.QueryPlanes( planes, planeCount, m_queryResults );
+	AppendResults( outLights );
+}
+
+void Scene::QueryLightsInBox( AABB3 const &box, std::vector< Light* > &outLights ) const
+{
+	m_queryResults.clear();
+	m_lightTree.QueryBox( box, m_queryResults );
+	AppendResults( outLights );
+}
+
+void Scene::QueryLightsInSphere( Sphere const &sphere, std::vector< Light* > &outLights ) const
+{
+	m_queryResults.clear();
+	m_lightTree.QuerySphere( sphere, m_queryResults );
+	AppendResults( outLights );
+}
+
+void Scene::QueryLightsAlongRay( Vector3 const &start, Vector3 const &direction, float maxDistance, std::vector< Light* > &outLights ) const
+{
+	m_queryResults.clear();
+	m_lightTree.QueryRay( start, direction, maxDistance, m_queryResults );
+	AppendResults( outLights );
+}
+
+void Scene::AppendResults( std::vector< Renderable* > &outRenderables ) const
+{
+	outRenderables.insert( outRenderables.end(), m_unboundedRenderables.begin(), m_unboundedRenderables.end() );
+	for( uint i = 0; i < m_queryResults.size(); i++ )
+		outRenderables.push_back( (Renderable*) m_queryResults[i] );
+}
+
+void Scene::AppendResults( std::vector< Light* > &outLights ) const
+{
+	outLights.insert( outLights.end(), m_unboundedLights.begin(), m_unboundedLights.end() );
+	for( uint i = 0; i < m_queryResults.size(); i++ )
+		outLights.push_back( (Light*) m_queryResults[i] );
+}
+
+void SceneTreeBenchmark( Command &cmd )
+{
+	std::string objectCountStr	= cmd.GetNextString();
+	std::string movingStr		= cmd.GetNextString();
+	uint		objectCount		= ( objectCountStr != "" )	? (uint) atoi( objectCountStr.c_str() )	: 20000U;
+	uint		movingPercent	= ( movingStr != "" )		? (uint) atoi( movingStr.c_str() )		: 10U;
+	if( objectCount == 0U || movingPercent > 100U )
+	{
+		ConsolePrintf( RGBA_RED_COLOR, "scene_tree_benchmark: object count can't be ZERO & moving percent has to be in [0, 100]!" );
+		return;
+	}
+
+	// Objects spread over a big world, camera at the origin looking down +Z; some of them drift every frame
+	uint const	frameCount	= 30U;
+	uint const	movingCount	= objectCount * movingPercent / 100U;
+
+	uint randomState = 1U;
+
+	std::vector< AABB3 >	boxes		( objectCount );
+	std::vector< Sphere >	spheres		( objectCount );
+	std::vector< Vector3 >	velocities	( objectCount );
+	for( uint i = 0; i < objectCount; i++ )
+	{
+		Vector3 center		= Vector3( GetSeededRandomFloatInRange( randomState, -1000.f, 1000.f ), GetSeededRandomFloatInRange( randomState, -50.f, 50.f ), GetSeededRandomFloatInRange( randomState, -1000.f, 1000.f ) );
+		Vector3 halfSize	= Vector3( GetSeededRandomFloatInRange( randomState, 0.2f, 3.f ), GetSeededRandomFloatInRange( randomState, 0.2f, 3.f ), GetSeededRandomFloatInRange( randomState, 0.2f, 3.f ) );
+
+		boxes[i]		= AABB3( center - halfSize, center + halfSize );
+		spheres[i]		= Sphere( center, halfSize.GetLength() );
+		velocities[i]	= Vector3( GetSeededRandomFloatInRange( randomState, -0.3f, 0.3f ), 0.f, GetSeededRandomFloatInRange( randomState, -0.3f, 0.3f ) );
+	}
+
+	FrustumCuller culler;
+	culler.SetViewProjection( Matrix44::MakePerspective3D( 60.f, 16.f / 9.f, 0.1f, 250.f ) );
+
+	// Tree, with user data as the index
+	DynamicAABBTree		tree;
+	std::vector< int >	proxyIDs( objectCount );
+	uint64_t			startHPC = Clock::GetCurrentHPC();
+	for( uint i = 0; i < objectCount; i++ )
+		proxyIDs[i] = tree.CreateProxy( boxes[i], (void*)(size_t)i );
+	double buildSeconds = Clock::GetSecondsFromHPC( Clock::GetCurrentHPC() - startHPC );
+
+	std::vector< void* >	candidates;
+	std::vector< uint >		treeVisible;
+	std::vector< uint >		linearVisible;
+	double	updateSeconds		= 0.0;
+	double	treeSeconds			= 0.0;
+	double	linearSeconds		= 0.0;
+	uint	reinsertCount		= 0U;
+	uint	candidateCount		= 0U;
+	uint	mismatchCount		= 0U;
+	for( uint frame = 0; frame <= frameCount; frame++ )
+	{
+		// Move some, like UpdateSpatialIndex() would
+		uint64_t updateStartHPC = Clock::GetCurrentHPC();
+		for( uint i = 0; i < movingCount; i++ )
+		{
+			boxes[i].TranslateBy( velocities[i] );
+			spheres[i].center += velocities[i];
+			reinsertCount += tree.MoveProxy( proxyIDs[i], boxes[i], velocities[i] ) ? 1U : 0U;
+		}
+		uint64_t updateEndHPC = Clock::GetCurrentHPC();
+
+		// Tree's candidates, then the culler on just those
+		candidates.clear();
+		tree.QueryPlanes( culler.GetPlanes(), FRUSTUM_PLANE_COUNT, candidates );
+		culler.Clear();
+		for( uint i = 0; i < candidates.size(); i++ )
+		{
+			uint objectIdx = (uint)(size_t) candidates[i];
+			culler.Add( boxes[ objectIdx ], spheres[ objectIdx ] );
+		}
+		culler.Cull();
+
+		treeVisible.clear();
+		for( uint i = 0; i < culler.GetVisibleCount(); i++ )
+			treeVisible.push_back( (uint)(size_t) candidates[ culler.GetVisibleIndex( i ) ] );
+		uint64_t treeEndHPC = Clock::GetCurrentHPC();
+
+		// The culler on all of them
+		culler.Clear();
+		for( uint i = 0; i < objectCount; i++ )
+			culler.Add( boxes[i], spheres[i] );
+		culler.Cull();
+
+		linearVisible.clear();
+		for( uint i = 0; i < culler.GetVisibleCount(); i++ )
+			linearVisible.push_back( culler.GetVisibleIndex( i ) );
+		uint64_t linearEndHPC = Clock::GetCurrentHPC();
+
+		// First one is the warm up
+		if( frame > 0U )
+		{
+			updateSeconds	+= Clock::GetSecondsFromHPC( updateEndHPC - updateStartHPC );
+			treeSeconds		+= Clock::GetSecondsFromHPC( treeEndHPC - updateEndHPC );
+			linearSeconds	+= Clock::GetSecondsFromHPC( linearEndHPC - treeEndHPC );
+			candidateCount	+= (uint)candidates.size();
+		}
+
+		// Both have to find the same ones
+		std::sort( treeVisible.begin(), treeVisible.end() );
+		if( treeVisible != linearVisible )
+			mismatchCount++;
+	}
+
+	double usPerFrame = 1000000.0 / (double)frameCount;
+	ConsolePrintf( "scene_tree_benchmark: %u objects, %u moving, %u frames; tree height %d", objectCount, movingCount, frameCount, tree.GetHeight() );
+	ConsolePrintf( "  Build           %9.1f us", buildSeconds * 1000000.0 );
+	ConsolePrintf( "  Update          %9.1f us per frame; %.1f reinserts per frame", updateSeconds * usPerFrame, (double)reinsertCount / (double)( frameCount + 1U ) );
+	ConsolePrintf( "  Tree & culler   %9.1f us per frame; %.1f candidates", treeSeconds * usPerFrame, (double)candidateCount / (double)frameCount );
+	ConsolePrintf( "  Culler on all   %9.1f us per frame", linearSeconds * usPerFrame );
+	ConsolePrintf( ( mismatchCount == 0U ) ? RGBA_WHITE_COLOR : RGBA_RED_COLOR, "  %u visible; %u frames where the tree found different ones", (uint)linearVisible.size(), mismatchCount );
+}
@@ -1,20 +1,87 @@
 #pragma once
 #include <vector>
+#include "Engine/Core/EngineCommon.hpp"
+#include "Engine/Input/Command.hpp"
+#include "Engine/Math/AABB3.hpp"
+#include "Engine/Math/Sphere.hpp"
+#include "Engine/Math/Plane3.hpp"
+#include "Engine/Math/DynamicAABBTree.hpp"
 
 class Light;
 class Camera;
 class Renderable;
 
+// Where an object of the scene is in its tree, & what it was built from
+struct SceneSpatialProxy
+{
+	int			proxyID			= DYNAMIC_AABB_TREE_NULL_NODE;		// NULL if it has no bounds; queries always return those
+	void const	*object			= nullptr;							// Which the tree's user data points at; lists are public, so it may not be the one at this index anymore
+	uint64_t	changeStamp		= 0U;
+	uint		meshesVersion	= 0U;								// Of a renderable
+	uint		meshCount		= 0U;
+	uint64_t	meshBoundsVersion	= 0U;							// Of a renderable
+	float		range			= 0.f;								// Of a light
+	Vector3		center			= Vector3::ZERO;					// Of the bounds, when it last moved; for the tree to see where it's heading
+	bool		isIndexed		= false;
+};
+
+//------------------------------------------------------------------------------------------
+// Renderables, lights & cameras to render together
+//	- Renderables & lights also go in a DynamicAABBTree each, so the queries don't look at all of them
+//	- UpdateSpatialIndex() moves what changed; it just compares Transform's change stamps, so it's cheap if nothing moved
+//	- A renderable is indexed by its world bounds, a light by the sphere of its range
+//	- Things without bounds ( mesh without any, or a light reaching everywhere ) are in every query's results
+//
 class Scene
 {
+public:
+	 Scene() { }
+	~Scene() { }
+
 public:
 	void AddLight			( Light &light );
 	void AddCamera			( Camera &camera );
 	void AddRenderable		( Renderable &renderable );
 	void RemoveRenderable	( Renderable &removeMe );		// It doesn't call deconstructor on Renderable
+	void RemoveLight		( Light &removeMe );			// It doesn't call deconstructor on Light
 
 public:
 	std::vector< Light* >		m_lights;
 	std::vector< Camera* >		m_cameras;
 	std::vector< Renderable* >	m_renderables;
-};
\ No newline at end of file
+
+private:
+	DynamicAABBTree					m_renderableTree;
+	DynamicAABBTree					m_lightTree;
+	std::vector< SceneSpatialProxy >	m_renderableProxies;		// Same order as m_renderables
+	std::vector< SceneSpatialProxy >	m_lightProxies;				// Same order as m_lights
+	std::vector< Renderable* >		m_unboundedRenderables;
+	std::vector< Light* >			m_unboundedLights;
+	mutable std::vector< void* >	m_queryResults;
+
+public:
+	void UpdateSpatialIndex();								// Call before querying, after things moved
+
+	// Queries; candidates by their fat bounds, appended to the out list. Indexed ones are as of the last UpdateSpatialIndex()
+	void QueryRenderablesInFrustum	( Plane3 const *planes, uint planeCount, std::vector< Renderable* > &outRenderables ) const;	// Inside on the front of all planes
+	void QueryRenderablesInBox		( AABB3 const &box, std::vector< Renderable* > &outRenderables ) const;
+	void QueryRenderablesInSphere	( Sphere const &sphere, std::vector< Renderable* > &outRenderables ) const;
+	void QueryRenderablesAlongRay	( Vector3 const &start, Vector3 const &direction, float maxDistance, std::vector< Renderable* > &outRenderables ) const;
+	void QueryLightsInFrustum		( Plane3 const *planes, uint planeCount, std::vector< Light* > &outLights ) const;
+	void QueryLightsInBox			( AABB3 const &box, std::vector< Light* > &outLights ) const;
+	void QueryLightsInSphere		( Sphere const &sphere, std::vector< Light* > &outLights ) const;		// Lights reaching in to the sphere
+	void QueryLightsAlongRay		( Vector3 const &start, Vector3 const &direction, float maxDistance, std::vector< Light* > &outLights ) const;
+
+	inline int	GetRenderableTreeHeight() const		{ return m_renderableTree.GetHeight(); }
+	inline int	GetLightTreeHeight() const			{ return m_lightTree.GetHeight(); }
+
+private:
+	void UpdateRenderableProxy	( uint renderableIdx );
+	void UpdateLightProxy		( uint lightIdx );
+	void AppendResults			( std::vector< Renderable* > &outRenderables ) const;	// From m_queryResults, after the unbounded ones
+	void AppendResults			( std::vector< Light* > &outLights ) const;
+};
+
+
+// Console Commands
+void SceneTreeBenchmark( Command &cmd );			// scene_tree_benchmark [objectCount=20000] [movingPercent=10]
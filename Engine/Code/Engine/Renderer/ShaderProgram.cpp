@@ -2,6 +2,11 @@
 #include "Engine/Renderer/ShaderProgram.hpp"
 #include "Engine/File/File.hpp"
 
+uint		ShaderProgram::s_lastProgramID									= 0U;
+uint		ShaderProgram::s_retiredProgramIDCount							= 0U;
+std::set< uint >	ShaderProgram::s_liveProgramIDs;
+char const*	ShaderProgram::s_builtInUniformNames[ NUM_BUILT_IN_UNIFORMS ]	= { "MODEL", "EYE_POSITION" };
+
 const char* ShaderProgram::m_default_fsp = R"(
 #version 420 core
 
@@ -85,6 +90,7 @@ bool ShaderProgram::LoadFromFiles( char const *root )
 	program_handle = CreateAndLinkProgram( vert_shader, frag_shader ); 
 	glDeleteShader( vert_shader ); 
 	glDeleteShader( frag_shader ); 
+	ReflectLocations();
 
 	return (program_handle != NULL); 
 };
@@ -101,6 +107,7 @@ bool ShaderProgram::LoadFromFiles( std::string vertexShaderPath, std::string fra
 	program_handle = CreateAndLinkProgram( vert_shader, frag_shader );
 	glDeleteShader( vert_shader );
 	glDeleteShader( frag_shader );
+	ReflectLocations();
 
 	return (program_handle != NULL);
 }
@@ -118,6 +125,7 @@ bool ShaderProgram::LoadFromStrings( const char* vs_program, const char* fs_prog
 	program_handle = CreateAndLinkProgram( vert_shader, frag_shader ); 
 	glDeleteShader( vert_shader ); 
 	glDeleteShader( frag_shader ); 
+	ReflectLocations();
 
 	return (program_handle != NULL); 
 }
@@ -260,6 +268,119 @@ GLuint ShaderProgram::GetHandle() const
 	return program_handle;
 }
 
+GLint ShaderProgram::GetUniformLocation( std::string const &name ) const
+{
+	std::map< std::string, GLint >::const_iterator it = m_uniformLocations.find( name );
+	return ( it != m_uniformLocations.end() ) ? it->second : -1;
+}
+
+GLint ShaderProgram::GetUniformLocation( char const *name ) const
+{
+	return GetUniformLocation( std::string( name ) );
+}
+
+ShaderProgram::~ShaderProgram()
+{
+	RetireProgramID();
+}
+
+bool ShaderProgram::IsProgramIDRetired( uint programID )
+{
+	// IDs aren't reused, so any handed out & not live anymore is retired
+	return programID != 0U && s_liveProgramIDs.find( programID ) == s_liveProgramIDs.end();
+}
+
+uint ShaderProgram::GetRetiredProgramIDCount()
+{
+	return s_retiredProgramIDCount;
+}
+
+void ShaderProgram::RetireProgramID()
+{
+	if( m_programID != 0U )
+	{
+		s_liveProgramIDs.erase( m_programID );
+		s_retiredProgramIDCount++;
+	}
+
+	m_programID = 0U;
+}
+
+GLint ShaderProgram::GetAttributeLocation( std::string const &name ) const
+{
+	std::map< std::string, GLint >::const_iterator it = m_attributeLocations.find( name );
+	return ( it != m_attributeLocations.end() ) ? it->second : -1;
+}
+
+void ShaderProgram::ReflectLocations()
+{
+	// Vertex arrays made for the previous link are no good anymore
+	RetireProgramID();
+
+	m_uniformLocations.clear();
+	m_attributeLocations.clear();
+	for( uint i = 0; i < NUM_BUILT_IN_UNIFORMS; i++ )
+		m_builtInUniformLocations[i] = -1;
+
+	if( program_handle == NULL )
+		return;
+	m_programID = ++s_lastProgramID;
+	s_liveProgramIDs.insert( m_programID );
+
+	GLint uniformCount		= 0;
+	GLint attributeCount	= 0;
+	GLint maxUniformLength	= 0;
+	GLint maxAttribLength	= 0;
+	glGetProgramiv( program_handle, GL_ACTIVE_UNIFORMS,				&uniformCount );
+	glGetProgramiv( program_handle, GL_ACTIVE_ATTRIBUTES,			&attributeCount );
+	glGetProgramiv( program_handle, GL_ACTIVE_UNIFORM_MAX_LENGTH,	&maxUniformLength );
+	glGetProgramiv( program_handle, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH,	&maxAttribLength );
+
+	GLsizei	bufferSize	= ( maxUniformLength > maxAttribLength ) ? maxUniformLength : maxAttribLength;
+	char	*nameBuffer	= new char[ bufferSize + 1 ];
+
+	// Uniforms; the ones inside a block have no location, they go through the UBOs
+	for( GLint idx = 0; idx < uniformCount; idx++ )
+	{
+		GLsizei	length	= 0;
+		GLint	size	= 0;
+		GLenum	type	= 0;
+		glGetActiveUniform( program_handle, (GLuint)idx, bufferSize + 1, &length, &size, &type, nameBuffer );
+		nameBuffer[ length ] = NULL;
+
+		GLint location = glGetUniformLocation( program_handle, nameBuffer );
+		if( location < 0 )
+			continue;
+
+		std::string name = nameBuffer;
+		m_uniformLocations[ name ] = location;
+
+		// An array is listed as "name[0]", but gets set by just its name too
+		size_t nameLength = name.length();
+		if( nameLength > 3 && name.compare( nameLength - 3, 3, "[0]" ) == 0 )
+			m_uniformLocations[ name.substr( 0, nameLength - 3 ) ] = location;
+	}
+
+	// Attributes
+	for( GLint idx = 0; idx < attributeCount; idx++ )
+	{
+		GLsizei	length	= 0;
+		GLint	size	= 0;
+		GLenum	type	= 0;
+		glGetActiveAttrib( program_handle, (GLuint)idx, bufferSize + 1, &length, &size, &type, nameBuffer );
+		nameBuffer[ length ] = NULL;
+
+		GLint location = glGetAttribLocation( program_handle, nameBuffer );
+		if( location >= 0 )
+			m_attributeLocations[ std::string( nameBuffer ) ] = location;
+	}
+
+	delete[] nameBuffer;
+
+	for( uint i = 0; i < NUM_BUILT_IN_UNIFORMS; i++ )
+		m_builtInUniformLocations[i] = GetUniformLocation( s_builtInUniformNames[i] );
+}
+
 const char* ShaderProgram::GetDefaultVertexShaderSource()
 {
 	return m_default_vsp;
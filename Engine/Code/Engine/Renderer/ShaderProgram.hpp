@@ -1,14 +1,31 @@
+#pragma once
 // Renderer/shaderprogram.h
+#include <map>
+#include <set>
 #include <string>
 #include "Engine/Core/EngineCommon.hpp"
 #include "Engine/Core/ErrorWarningAssert.hpp"
 #include "Engine/Renderer/glfunctions.hpp"
 
+enum eBuiltInUniform
+{
+	UNIFORM_MODEL = 0,
+	UNIFORM_EYE_POSITION,
+	NUM_BUILT_IN_UNIFORMS
+};
+
+//------------------------------------------------------------------------------------------
+// Locations get reflected once, right after the link; no glGet*Location() while drawing
+//	- Every active uniform & attribute goes in a table by its name; a name not in it is -1, as GL would say
+//	- Uniforms the Renderer sets on every draw are kept in an array too, so those aren't looked up at all
+//	- Program ID is new for every link; vertex arrays of the meshes are made for one, as they depend on its attribute locations
+//	- ID of a relinked or deleted program gets retired, so the meshes can drop their vertex arrays made for it
+//
 class ShaderProgram
 {
 public:
 	 ShaderProgram() {};
-	~ShaderProgram() {};
+	~ShaderProgram();
 
 	bool LoadFromFiles( char const *root ); // load a shader from file
 	bool LoadFromFiles( std::string vertexShaderPath, std::string fragmentShaderPath );
@@ -20,6 +37,13 @@ public:
 	static void LogProgramError(GLuint program_id);
 
 	GLuint GetHandle() const;
+	inline uint		GetProgramID() const									{ return m_programID; }
+	static bool		IsProgramIDRetired( uint programID );
+	static uint		GetRetiredProgramIDCount();								// Only goes up
+	inline GLint	GetBuiltInUniformLocation( eBuiltInUniform uniform ) const	{ return m_builtInUniformLocations[ uniform ]; }
+	GLint			GetUniformLocation	( std::string const &name ) const;
+	GLint			GetUniformLocation	( char const *name ) const;
+	GLint			GetAttributeLocation( std::string const &name ) const;
 
 	static const char* GetDefaultVertexShaderSource();
 	static const char* GetDefaultFragmentShaderSource();
@@ -29,4 +53,19 @@ public:
 
 	static const char* m_default_vsp;
 	static const char* m_default_fsp;
+
+private:
+	static uint						s_lastProgramID;
+	static uint						s_retiredProgramIDCount;
+	static std::set< uint >			s_liveProgramIDs;		// Not the retired ones, so it doesn't grow with every relink
+	uint							m_programID = 0U;		// ZERO, if not linked
+	std::map< std::string, GLint >	m_uniformLocations;
+	std::map< std::string, GLint >	m_attributeLocations;
+	GLint							m_builtInUniformLocations[ NUM_BUILT_IN_UNIFORMS ] = { -1, -1 };
+
+	static char const*				s_builtInUniformNames[ NUM_BUILT_IN_UNIFORMS ];
+
+private:
+	void ReflectLocations();								// Fills the tables, for the program_handle
+	void RetireProgramID();
 };
\ No newline at end of file
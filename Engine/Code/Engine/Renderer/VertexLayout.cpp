@@ -18,4 +18,33 @@ unsigned int VertexLayout::GetAttributeCount() const
 VertexAttribute const& VertexLayout::GetAttributeAtIndex( unsigned const idx ) const
 {
 	return m_attributes[ idx ];
+}
+
+uint VertexLayout::GetLayoutID() const
+{
+	// FNV-1a
+	uint hash = 2166136261U;
+	auto hashBytes = [ &hash ]( void const *data, size_t size )
+	{
+		byte_t const *bytes = (byte_t const *) data;
+		for( size_t i = 0; i < size; i++ )
+			hash = (hash ^ bytes[i]) * 16777619U;
+	};
+
+	hashBytes( &m_stride, sizeof(m_stride) );
+	for( size_t i = 0; i < m_attributes.size(); i++ )
+	{
+		VertexAttribute const	&attribute		= m_attributes[i];
+		uint					 type			= (uint) attribute.type;
+		uint					 normalize		= attribute.normalize ? 1U : 0U;
+		uint					 memberOffset	= (uint) attribute.memberOffset;
+
+		hashBytes( attribute.name.c_str(), attribute.name.size() );
+		hashBytes( &type, sizeof(type) );
+		hashBytes( &attribute.elementsCount, sizeof(attribute.elementsCount) );
+		hashBytes( &normalize, sizeof(normalize) );
+		hashBytes( &memberOffset, sizeof(memberOffset) );
+	}
+
+	return hash;
 }
\ No newline at end of file
@@ -36,4 +36,5 @@ public:
 public:
 	unsigned int			GetAttributeCount() const;
 	VertexAttribute	const&	GetAttributeAtIndex( unsigned const idx ) const;
+	uint					GetLayoutID() const;		// Hash of stride & attributes; same layout => same ID, across runs
 };
\ No newline at end of file
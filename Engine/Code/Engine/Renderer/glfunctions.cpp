@@ -123,3 +123,8 @@ PFNGLSAMPLERPARAMETERFPROC				glSamplerParameterf			= nullptr;
 
 PFNWGLSWAPINTERVALEXTPROC				wglSwapIntervalEXT			= nullptr;
 PFNGLPOINTSIZEPROC						glPointSize					= nullptr;
+
+PFNGLGETACTIVEUNIFORMPROC				glGetActiveUniform			= nullptr;
+PFNGLGETACTIVEATTRIBPROC				glGetActiveAttrib			= nullptr;
+PFNGLDELETEVERTEXARRAYSPROC				glDeleteVertexArrays		= nullptr;
+PFNGLFINISHPROC							glFinish					= nullptr;
@@ -107,3 +107,8 @@ extern PFNGLSAMPLERPARAMETERFPROC			glSamplerParameterf;
 
 extern PFNWGLSWAPINTERVALEXTPROC			wglSwapIntervalEXT;
 extern PFNGLPOINTSIZEPROC					glPointSize;
+
+extern PFNGLGETACTIVEUNIFORMPROC				glGetActiveUniform;
+extern PFNGLGETACTIVEATTRIBPROC				glGetActiveAttrib;
+extern PFNGLDELETEVERTEXARRAYSPROC			glDeleteVertexArrays;
+extern PFNGLFINISHPROC						glFinish;